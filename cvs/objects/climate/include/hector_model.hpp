@@ -184,6 +184,25 @@ private:
 
     //! output stream visitor
     std::auto_ptr<Hector::CSVOutputStreamVisitor> mHosv;
+
+    //! A Hector output recorded each year along with the table it is
+    //! stored in.
+    struct YearlyOutput {
+        //! Name used when logging the value
+        std::string mName;
+
+        //! The Hector datum resolved to the component which provides it
+        Hector::Core::DatumHandle mHandle;
+
+        //! Whether the datum must be requested for a specific date
+        bool mIsDated;
+
+        //! The table the value is stored in, indexed by yearlyDataIndex
+        std::vector<double>* mTable;
+    };
+
+    //! The outputs to retrieve from Hector each year, resolved once per core
+    std::vector<YearlyOutput> mYearlyOutputs;
     
     // private functions
     
@@ -194,9 +213,10 @@ private:
     bool setEmissionsByYear( const std::string& aGasName, const int aYear, double aEmissions );
 
     //! subroutines for getting data from Hector and storing it in the tables
-    void storeConc( const int aYear, const bool aHadError );
-    void storeRF( const int aYear, const bool aHadError );
-    void storeGlobals( const int aYear, const bool aHadError );
+    void setupYearlyOutputs();
+    void addYearlyOutput( const std::string& aName, const std::string& aDatum,
+                          const bool aIsDated, std::vector<double>& aTable );
+    void storeYearlyOutputs( const int aYear, const bool aHadError );
 
     //! set up the tables used by the functions in the previous block
     void setupConcTbl();
@@ -0,0 +1,134 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+
+
+/*! 
+ * \file deferred_climate_model.cpp
+ * \ingroup Objects
+ * \brief Implementation for the DeferredClimateModel class.
+ */
+
+#include "util/base/include/definitions.h"
+
+#include "climate/include/deferred_climate_model.h"
+#include "containers/include/world.h"
+
+using namespace std;
+using namespace xercesc;
+
+/*!
+ * \brief Constructor.
+ * \param aWorld The World which runs the climate model.
+ * \param aClimateModel The climate model to forward to.
+ */
+DeferredClimateModel::DeferredClimateModel( const World* aWorld, IClimateModel* aClimateModel ):
+mWorld( aWorld ),
+mClimateModel( aClimateModel )
+{
+}
+
+DeferredClimateModel::~DeferredClimateModel()
+{
+}
+
+/*!
+ * \brief Get the climate model once any background run has finished.
+ * \return The climate model.
+ */
+IClimateModel* DeferredClimateModel::getClimateModel() const {
+    mWorld->waitForClimateModel();
+    return mClimateModel;
+}
+
+void DeferredClimateModel::XMLParse( const DOMNode* aNode ) {
+    getClimateModel()->XMLParse( aNode );
+}
+
+const string& DeferredClimateModel::getXMLName() const {
+    // The name is fixed so there is no need to wait.
+    return mClimateModel->getXMLName();
+}
+
+void DeferredClimateModel::toDebugXML( const int aPeriod, ostream& aOut, Tabs* aTabs ) const {
+    getClimateModel()->toDebugXML( aPeriod, aOut, aTabs );
+}
+
+void DeferredClimateModel::completeInit( const string& aScenarioName ) {
+    getClimateModel()->completeInit( aScenarioName );
+}
+
+bool DeferredClimateModel::setEmissions( const string& aGasName, const int aPeriod, const double aEmission ) {
+    return getClimateModel()->setEmissions( aGasName, aPeriod, aEmission );
+}
+
+bool DeferredClimateModel::setLUCEmissions( const string& aGasName, const int aYear, const double aEmission ) {
+    return getClimateModel()->setLUCEmissions( aGasName, aYear, aEmission );
+}
+
+double DeferredClimateModel::getEmissions( const string& aGasName, const int aYear ) const {
+    return getClimateModel()->getEmissions( aGasName, aYear );
+}
+
+IClimateModel::runModelStatus DeferredClimateModel::runModel() {
+    return getClimateModel()->runModel();
+}
+
+IClimateModel::runModelStatus DeferredClimateModel::runModel( const int aYear ) {
+    return getClimateModel()->runModel( aYear );
+}
+
+double DeferredClimateModel::getConcentration( const string& aGasName, const int aYear ) const {
+    return getClimateModel()->getConcentration( aGasName, aYear );
+}
+
+double DeferredClimateModel::getTemperature( const int aYear ) const {
+    return getClimateModel()->getTemperature( aYear );
+}
+
+double DeferredClimateModel::getForcing( const string& aGasName, const int aYear ) const {
+    return getClimateModel()->getForcing( aGasName, aYear );
+}
+
+double DeferredClimateModel::getTotalForcing( const int aYear ) const {
+    return getClimateModel()->getTotalForcing( aYear );
+}
+
+double DeferredClimateModel::getNetTerrestrialUptake( const int aYear ) const {
+    return getClimateModel()->getNetTerrestrialUptake( aYear );
+}
+
+double DeferredClimateModel::getNetOceanUptake( const int aYear ) const {
+    return getClimateModel()->getNetOceanUptake( aYear );
+}
+
+void DeferredClimateModel::accept( IVisitor* aVisitor, const int aPeriod ) const {
+    getClimateModel()->accept( aVisitor, aPeriod );
+}
@@ -75,6 +75,25 @@ public:
     unitval sendMessage( const std::string& message,
                         const std::string& datum,
                         const message_data& info ) throw ( h_exception );
+
+    //------------------------------------------------------------------------------
+    /*! \brief A datum resolved to the component which provides it.
+     *  \details Callers which retrieve the same datum repeatedly can resolve it
+     *           once with getDatumHandle and then use getData, which skips the
+     *           parsing and capability lookup done by sendMessage.  A handle is
+     *           only valid for the lifetime of the core which created it.
+     */
+    struct DatumHandle {
+        IModelComponent* component;
+        std::string datum;
+    };
+
+    DatumHandle getDatumHandle( const std::string& datum ) const throw ( h_exception );
+
+    unitval getData( const DatumHandle& handle ) const throw ( h_exception );
+
+    unitval getData( const DatumHandle& handle,
+                     const message_data& info ) const throw ( h_exception );
     
     double getStartDate() const { return startDate; };
     double getEndDate() const { return endDate; };
@@ -124,6 +143,9 @@ private:
     //! Cause all components to run their spinup procedure.
     bool run_spinup();
 
+    //! Get the capability portion of a possibly biome-qualified datum.
+    static std::string getDatumCapability( const std::string& datum ) throw ( h_exception );
+
     
     //------------------------------------------------------------------------------
     //! Current run name.
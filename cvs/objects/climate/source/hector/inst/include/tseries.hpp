@@ -15,6 +15,8 @@
  */
 
 #include <map>
+#include <vector>
+#include <cmath>
 #include <limits>
 #include <sstream>
 
@@ -27,11 +29,25 @@ namespace Hector {
   
 /*! \brief Time series data type.
  *
- *  Currently implemented as an STL map.
+ *  Currently implemented as an STL map.  Values at whole-year dates, which is
+ *  nearly all of them since the model runs on an annual step, are mirrored in
+ *  a contiguous array indexed by year so that get() and exists() do not need
+ *  to search the map.
  */
 template <class T_data>
 class tseries {
     std::map<double, T_data> mapdata;
+
+    //! Values at whole-year dates, indexed by date - densestart.
+    std::vector<T_data> densedata;
+    //! Flags indicating which entries of densedata are set.
+    std::vector<char> densevalid;
+    //! Date of the first entry in densedata.
+    double densestart;
+
+    const T_data* densefind( double ) const;
+    void denseset( double, const T_data& );
+
     double lastInterpYear;
 	bool endinterp_allowed;
     mutable bool dirty;                 // does series need re-interpolating?
@@ -207,6 +223,7 @@ struct interp_helper<unitval> {
 template <class T_data>
 tseries<T_data>::tseries( ) {
     set_interp( std::numeric_limits<double>::min(), false, DEFAULT );         // default values
+    densestart = 0.0;
     dirty = false;
     name = "?";
 }
@@ -218,12 +235,75 @@ tseries<T_data>::tseries( ) {
  */
 template <class T_data>
 void tseries<T_data>::set( double t, T_data d ) {
-    mapdata[ t ] = d;
+    if( !mapdata.empty() && t > mapdata.rbegin()->first ) {
+        // Appending to the end of the series is the common case; give the
+        // map a hint so that the insert is constant time.
+        mapdata.insert( mapdata.end(), std::make_pair( t, d ) );
+    }
+    else {
+        mapdata[ t ] = d;
+    }
+    denseset( t, d );
     if( t < lastInterpYear ) {
         dirty = true;
     }
 }
 
+//-----------------------------------------------------------------------
+/*! \brief Look up a value in the dense year-indexed storage.
+ *
+ *  Returns a pointer to the value at time t, or null if t is not a
+ *  whole-year date held in the dense storage.  A null result does not mean
+ *  the value does not exist; the caller must fall back to the map.
+ */
+template <class T_data>
+const T_data* tseries<T_data>::densefind( double t ) const {
+    const double offset = t - densestart;
+    if( offset >= 0.0 && offset < static_cast<double>( densevalid.size() ) ) {
+        const size_t idx = static_cast<size_t>( offset );
+        if( static_cast<double>( idx ) == offset && densevalid[ idx ] ) {
+            return &densedata[ idx ];
+        }
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------
+/*! \brief Mirror a value into the dense year-indexed storage.
+ *
+ *  Only whole-year dates are stored and the storage is not allowed to span
+ *  an unreasonable range of dates; anything else is left to the map only.
+ */
+template <class T_data>
+void tseries<T_data>::denseset( double t, const T_data& d ) {
+    const double maxspan = 100000.0;
+    if( t != std::floor( t ) ) {
+        return;
+    }
+    if( densevalid.empty() ) {
+        densestart = t;
+    }
+    else if( t < densestart ) {
+        if( densestart - t + densevalid.size() > maxspan ) {
+            return;
+        }
+        const size_t shift = static_cast<size_t>( densestart - t );
+        densedata.insert( densedata.begin(), shift, T_data() );
+        densevalid.insert( densevalid.begin(), shift, 0 );
+        densestart = t;
+    }
+    else if( t - densestart >= maxspan ) {
+        return;
+    }
+    const size_t idx = static_cast<size_t>( t - densestart );
+    if( idx >= densevalid.size() ) {
+        densedata.resize( idx + 1 );
+        densevalid.resize( idx + 1, 0 );
+    }
+    densedata[ idx ] = d;
+    densevalid[ idx ] = 1;
+}
+
 //-----------------------------------------------------------------------
 /*! \brief Does data exist at time (position) t?
  *
@@ -231,7 +311,7 @@ void tseries<T_data>::set( double t, T_data d ) {
  */
 template <class T_data>
 bool tseries<T_data>::exists( double t ) const {
-    return ( mapdata.find( t ) != mapdata.end() );
+    return densefind( t ) || ( mapdata.find( t ) != mapdata.end() );
 }
 
 //-----------------------------------------------------------------------
@@ -247,6 +327,9 @@ template <class T_data>
 T_data tseries<T_data>::get( double t ) const throw( h_exception ) {
     if(mapdata.size() == 1)
         return mapdata.begin()->second;
+    const T_data* denseval = densefind( t );
+    if( denseval )
+        return *denseval;
     typename std::map<double,T_data>::const_iterator itr = mapdata.find( t );
     if( itr != mapdata.end() )
         return (*itr).second;
@@ -389,6 +472,14 @@ void tseries<T>::truncate(double t, bool after)
         it2 = mapdata.lower_bound(t);
     } 
     mapdata.erase(it1,it2); 
+
+    // Drop the same dates from the dense storage.
+    for( size_t idx = 0; idx < densevalid.size(); ++idx ) {
+        const double date = densestart + idx;
+        if( after ? date > t : date < t ) {
+            densevalid[ idx ] = 0;
+        }
+    }
 }
 
 }
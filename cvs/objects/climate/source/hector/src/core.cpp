@@ -627,6 +627,68 @@ unitval Core::sendMessage( const std::string& message,
     return sendMessage( message, datum, message_data() );
 }
 
+//------------------------------------------------------------------------------
+/*! \brief Get the capability named by a datum.
+ *  \details A datum may be qualified by a biome, e.g. "biome.veg_c", in
+ *           which case the capability is the part after the separator.
+ *  \param datum    The datum to parse.
+ *  \exception h_exception If the datum has more than one separator.
+ */
+std::string Core::getDatumCapability( const std::string& datum ) throw ( h_exception )
+{
+    std::vector<std::string> datum_split;
+    boost::split( datum_split, datum, boost::is_any_of( SNBOX_PARSECHAR ) );
+    H_ASSERT( datum_split.size() < 3, "max of one separator allowed in variable names" );
+    if ( datum_split.size() == 2 ) {
+        return datum_split[ 1 ];
+    } else {
+        return datum_split[ 0 ];
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! \brief Resolve the component that provides a datum.
+ *  \param datum    The datum caller is interested in.
+ *  \returns A handle which can be passed to getData.
+ *  \exception h_exception If the core is not initialized or the datum is
+ *             not provided by any component.
+ */
+Core::DatumHandle Core::getDatumHandle( const std::string& datum ) const throw ( h_exception )
+{
+    H_ASSERT( isInited, "getDatumHandle not available until core is initialized" );
+
+    const std::string datum_capability = getDatumCapability( datum );
+    string err = "Unknown model datum: " + datum;
+    H_ASSERT( componentCapabilities.count( datum_capability ), err );
+
+    DatumHandle handle;
+    handle.component = getComponentByName( componentCapabilities.find( datum_capability )->second );
+    handle.datum = datum;
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+/*! \brief Get data for a resolved datum.
+ *  \details Equivalent to sendMessage( M_GETDATA, datum ).
+ *  \param handle   The datum as returned by getDatumHandle.
+ */
+unitval Core::getData( const DatumHandle& handle ) const throw ( h_exception )
+{
+    return getData( handle, message_data() );
+}
+
+//------------------------------------------------------------------------------
+/*! \brief Get data for a resolved datum.
+ *  \details Equivalent to sendMessage( M_GETDATA, datum, info ).
+ *  \param handle   The datum as returned by getDatumHandle.
+ *  \param info     Extra information, such as the date.
+ */
+unitval Core::getData( const DatumHandle& handle,
+                       const message_data& info ) const throw ( h_exception )
+{
+    return handle.component->sendMessage( M_GETDATA, handle.datum, info );
+}
+
 //------------------------------------------------------------------------------
 /*! \brief Look up component and send message in one operation.
  *  \param message  The message to pass (typically "getData").
@@ -639,15 +701,7 @@ unitval Core::sendMessage( const std::string& message,
                           const message_data& info ) throw ( h_exception )
 {
 
-    std::vector<std::string> datum_split;
-    boost::split( datum_split, datum, boost::is_any_of( SNBOX_PARSECHAR ) );
-    H_ASSERT( datum_split.size() < 3, "max of one separator allowed in variable names" );
-    std::string datum_capability;
-    if ( datum_split.size() == 2 ) {
-        datum_capability = datum_split[ 1 ];
-    } else {
-        datum_capability = datum_split[ 0 ];
-    }
+    const std::string datum_capability = getDatumCapability( datum );
 
     if (message == M_GETDATA || message == M_DUMP_TO_DEEP_OCEAN) {
         // M_GETDATA is used extensively by components to query each other re state
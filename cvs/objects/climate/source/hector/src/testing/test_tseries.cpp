@@ -324,3 +324,112 @@ TEST(TestTSeries, PartialInterp) {
     EXPECT_THROW( test.get( 3 ), h_exception );
     EXPECT_NO_THROW( test.get( 1.5 ) );
 }
+
+TEST(TestTSeries, DenseTruncate) {
+	tseries<double> test;
+    for( int i=2000; i<=2010; i++ )
+        test.set( i, i * 2.0 );
+
+    // Dates after the truncation point must be gone from both the map and
+    // the dense year-indexed storage.
+    test.truncate( 2005 );
+    EXPECT_EQ( test.size(), 6 );
+    EXPECT_EQ( test.lastdate(), 2005 );
+    EXPECT_TRUE( test.exists( 2005 ) );
+    EXPECT_FALSE( test.exists( 2006 ) );
+    EXPECT_FALSE( test.exists( 2010 ) );
+    EXPECT_THROW( test.get( 2008 ), h_exception );
+
+    test.truncate( 2002, false );
+    EXPECT_EQ( test.size(), 4 );
+    EXPECT_EQ( test.firstdate(), 2002 );
+    EXPECT_FALSE( test.exists( 2000 ) );
+    EXPECT_FALSE( test.exists( 2001 ) );
+    EXPECT_EQ( test.get( 2002 ), 4004.0 );
+
+    // Truncated dates can be set again.
+    test.set( 2008, 1.0 );
+    EXPECT_TRUE( test.exists( 2008 ) );
+    EXPECT_EQ( test.get( 2008 ), 1.0 );
+    EXPECT_FALSE( test.exists( 2007 ) );
+}
+
+TEST(TestTSeries, DensePrepend) {
+	tseries<double> test;
+    test.set( 2000, 1.0 );
+    test.set( 2001, 2.0 );
+
+    // Setting a date before the start of the dense storage shifts it.
+    test.set( 1990, 3.0 );
+    EXPECT_EQ( test.size(), 3 );
+    EXPECT_EQ( test.firstdate(), 1990 );
+    EXPECT_EQ( test.get( 1990 ), 3.0 );
+    EXPECT_EQ( test.get( 2000 ), 1.0 );
+    EXPECT_EQ( test.get( 2001 ), 2.0 );
+    for( int i=1991; i<2000; i++ )
+        EXPECT_FALSE( test.exists( i ) );
+
+    test.set( 2000, 4.0 );
+    EXPECT_EQ( test.get( 2000 ), 4.0 );
+}
+
+TEST(TestTSeries, DenseNonIntegerDates) {
+	tseries<double> test;
+    test.set( 2000, 1.0 );
+    test.set( 2000.5, 2.0 );
+    test.set( 2001, 3.0 );
+
+    // Fractional dates are kept in the map only.
+    EXPECT_EQ( test.size(), 3 );
+    EXPECT_TRUE( test.exists( 2000.5 ) );
+    EXPECT_FALSE( test.exists( 2000.25 ) );
+    EXPECT_EQ( test.get( 2000.5 ), 2.0 );
+    EXPECT_EQ( test.get( 2000 ), 1.0 );
+    EXPECT_EQ( test.get( 2001 ), 3.0 );
+    EXPECT_THROW( test.get( 2000.25 ), h_exception );
+}
+
+TEST(TestTSeries, DenseMaxSpan) {
+	tseries<double> test;
+    test.set( 0, 1.0 );
+
+    // Dates too far from the dense start fall back to the map.
+    test.set( 500000, 2.0 );
+    test.set( -500000, 3.0 );
+    EXPECT_EQ( test.size(), 3 );
+    EXPECT_TRUE( test.exists( 500000 ) );
+    EXPECT_TRUE( test.exists( -500000 ) );
+    EXPECT_EQ( test.get( 0 ), 1.0 );
+    EXPECT_EQ( test.get( 500000 ), 2.0 );
+    EXPECT_EQ( test.get( -500000 ), 3.0 );
+    EXPECT_FALSE( test.exists( 1 ) );
+
+    test.set( 500000, 4.0 );
+    EXPECT_EQ( test.get( 500000 ), 4.0 );
+    test.truncate( 0 );
+    EXPECT_FALSE( test.exists( 500000 ) );
+}
+
+TEST(TestTSeries, DenseInterpAcrossBoundary) {
+	tseries<double> test;
+
+    // Mix whole-year dates (dense) with a fractional date (map only) and
+    // interpolate between them.
+    test.set( 1, 1.0 );
+    test.set( 2.5, 2.5 );
+    test.set( 4, 4.0 );
+    test.allowInterp( true );
+
+    EXPECT_EQ( test.get( 1 ), 1.0 );
+    EXPECT_EQ( test.get( 2.5 ), 2.5 );
+    EXPECT_EQ( test.get( 4 ), 4.0 );
+    EXPECT_NEAR( test.get( 2 ), 2.0, 1e-9 );
+    EXPECT_NEAR( test.get( 3 ), 3.0, 1e-9 );
+    EXPECT_NEAR( test.get( 1.75 ), 1.75, 1e-9 );
+    EXPECT_NEAR( test.get( 3.25 ), 3.25, 1e-9 );
+
+    // Overwriting a dense value must be seen by the interpolator.
+    test.set( 1, 0.0 );
+    EXPECT_EQ( test.get( 1 ), 0.0 );
+    EXPECT_LT( test.get( 2 ), 2.0 );
+}
@@ -356,6 +356,7 @@ void HectorModel::reset( const int aPeriod ) {
     coreParser.parse( mHectorIniFile );
     mHcore->addVisitor( mHosv.get() ); 
     mHcore->prepareToRun();
+    setupYearlyOutputs();
 
     const Modeltime* modeltime = scenario->getModeltime();
 
@@ -535,9 +536,7 @@ IClimateModel::runModelStatus HectorModel::runModel( const int aYear ) {
                 hadError = true;
             }
         }
-        storeConc( year, hadError );
-        storeRF( year, hadError );
-        storeGlobals( year, hadError );
+        storeYearlyOutputs( year, hadError );
     }
     mLastYear = lastSuccessYear;
     return hadError ? EXCEPTION : SUCCESS;
@@ -684,35 +683,88 @@ int HectorModel::yearlyDataIndex( const int year ) const {
     return year - scenario->getModeltime()->getStartYear();
 }
 
-void HectorModel::storeConc( const int aYear, const bool aHadError ) {
-    ILogger& climatelog = ILogger::getLogger( "climate-log" );
-
-    // No need to check the index because we checked it in runModel
-    int i = yearlyDataIndex( aYear );
+/*!
+ * \brief Resolve the Hector outputs that are recorded each year.
+ * \details Each output is resolved to the Hector component that provides
+ *          it and to the table it is stored in once per core so that
+ *          storeYearlyOutputs avoids any string lookups.  This must be
+ *          called each time a new core is set up.
+ */
+void HectorModel::setupYearlyOutputs() {
+    mYearlyOutputs.clear();
 
     // These are all of the atmospheric concentrations that Hector is
-    // set up to provide.
-    Hector::message_data date( aYear );
-    mConcTable["CH4"][i]   = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_CH4,date );
-    mConcTable["N2O"][i]   = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_N2O,date );
-    mConcTable["O3"][i]    = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_O3, date );
-    mConcTable["CO2"][i]   = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_CO2 );
-
-    // Hector doesn't actually compute concentrations for these
-    // gasses. (we use their emissions to compute O3 concentration,
-    // but don't compute the concentrations of the original gasses.) 
-    // mConcTable["CO"][i]    = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_CO);
-    // mConcTable["NOX"][i]   = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_NOX);
-    // mConcTable["NMVOC"][i] = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_NMVOC);
-
-    // Log the concentrations we are seeing here
+    // set up to provide.  Hector doesn't actually compute concentrations
+    // for CO, NOx, or NMVOC. (we use their emissions to compute O3
+    // concentration, but don't compute the concentrations of the
+    // original gasses.)
+    addYearlyOutput( "CH4 conc", D_ATMOSPHERIC_CH4, true, mConcTable[ "CH4" ] );
+    addYearlyOutput( "N2O conc", D_ATMOSPHERIC_N2O, true, mConcTable[ "N2O" ] );
+    addYearlyOutput( "O3 conc", D_ATMOSPHERIC_O3, true, mConcTable[ "O3" ] );
+    addYearlyOutput( "CO2 conc", D_ATMOSPHERIC_CO2, false, mConcTable[ "CO2" ] );
+
+    // total forcing
+    addYearlyOutput( "total RF", D_RF_TOTAL, false, mTotRFTable );
+
+    // misc gases requested by GCAM.  Be sure to keep this in sync with
+    // setupRFTbl.  If you add a gas here, you need to add it there too!
+    // Hector can also provide the indirect SO2 forcing (which can be
+    // had from SO2 - SO2dir) and volcanic forcing but in the interests
+    // of keeping memory usage down we won't store these unless someone
+    // wants them.
+    addYearlyOutput( "CO2 RF", D_RF_CO2, false, mGasRFTable[ "CO2" ] );
+    addYearlyOutput( "CH4 RF", D_RF_CH4, false, mGasRFTable[ "CH4" ] );
+    addYearlyOutput( "N2O RF", D_RF_N2O, false, mGasRFTable[ "N2O" ] );
+    addYearlyOutput( "BC RF", D_RF_BC, false, mGasRFTable[ "BC" ] );
+    addYearlyOutput( "OC RF", D_RF_OC, false, mGasRFTable[ "OC" ] );
+    addYearlyOutput( "SO2 RF", D_RF_SO2, false, mGasRFTable[ "SO2" ] );
+    addYearlyOutput( "StratH2O RF", D_RF_H2O, false, mGasRFTable[ "StratH2O" ] );
+    addYearlyOutput( "DirSO2 RF", D_RF_SO2d, false, mGasRFTable[ "DirSO2" ] );
+    addYearlyOutput( "TropO3 RF", D_RF_O3, false, mGasRFTable[ "TropO3" ] );
+
+    // global quantities
+    addYearlyOutput( "temperature", D_GLOBAL_TEMP, false, mTemperatureTable );
+    addYearlyOutput( "land flux", D_LAND_CFLUX, false, mLandFlux );
+    addYearlyOutput( "ocean flux", D_OCEAN_CFLUX, false, mOceanFlux );
+}
+
+/*!
+ * \brief Add an output to be recorded each year.
+ * \param aName Name to use when logging the value.
+ * \param aDatum The Hector datum to retrieve.
+ * \param aIsDated Whether the datum must be requested for a specific date
+ *        rather than the current model date.
+ * \param aTable The table to store the value in.  Note that the table must
+ *        not be moved for as long as the output is in use.
+ */
+void HectorModel::addYearlyOutput( const string& aName, const string& aDatum,
+                                   const bool aIsDated, vector<double>& aTable )
+{
+    YearlyOutput output;
+    output.mName = aName;
+    output.mHandle = mHcore->getDatumHandle( aDatum );
+    output.mIsDated = aIsDated;
+    output.mTable = &aTable;
+    mYearlyOutputs.push_back( output );
+}
+
+//! Retrieve each of the yearly outputs from Hector and store it in its table.
+void HectorModel::storeYearlyOutputs( const int aYear, const bool aHadError ) {
+    ILogger& climatelog = ILogger::getLogger( "climate-log" );
     climatelog.setLevel( ILogger::DEBUG );
-    climatelog << "\tstoreConc: year= " << aYear << "  index= " << i << endl
-               << "\t\tCO2 = " << mConcTable["CO2"][i] << endl
-               << "\t\tCH4 = " << mConcTable["CH4"][i] << endl
-               << "\t\tN2O = " << mConcTable["N2O"][i] << endl
-               << "\t\tO3  = " << mConcTable["O3"][i] << endl;
-    
+
+    // No need to check the index because we checked it in runModel
+    const int i = yearlyDataIndex( aYear );
+    const Hector::message_data date( aYear );
+    climatelog << "\tstoreYearlyOutputs:  year= " << aYear << "\tindex= " << i << endl;
+    for( vector<YearlyOutput>::const_iterator it = mYearlyOutputs.begin(); it != mYearlyOutputs.end(); ++it ) {
+        double value = numeric_limits<double>::quiet_NaN();
+        if( !aHadError ) {
+            value = (*it).mIsDated ? mHcore->getData( (*it).mHandle, date ) : mHcore->getData( (*it).mHandle );
+        }
+        (*(*it).mTable)[ i ] = value;
+        climatelog << "\t\t" << (*it).mName << " = " << value << endl;
+    }
 }
 
 void HectorModel::setupConcTbl() {
@@ -724,50 +776,6 @@ void HectorModel::setupConcTbl() {
     mConcTable["CO2"].resize( size );
 }    
 
-// Be sure to keep this in sync with setupRFTbl.  If you add a gas
-// here, you need to add it there too!
-void HectorModel::storeRF(const int aYear, const bool aHadError ) {
-    ILogger& climatelog = ILogger::getLogger( "climate-log" );
-    int i = yearlyDataIndex( aYear );
-    
-    // total
-    mTotRFTable[i]             = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_TOTAL );
-
-    // misc gases requested by GCAM
-    mGasRFTable["CO2"][i]      = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_CO2 );
-    mGasRFTable["CH4"][i]      = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_CH4 );
-    mGasRFTable["N2O"][i]      = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_N2O );
-    mGasRFTable["BC"][i]       = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_BC );
-    mGasRFTable["OC"][i]       = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_OC );
-    mGasRFTable["SO2"][i]      = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_SO2 );
-    mGasRFTable["StratH2O"][i] = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_H2O );
-    mGasRFTable["DirSO2"][i]   = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_SO2d );
-    mGasRFTable["TropO3"][i]   = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_RF_O3 );
-
-#if 0
-    // Forcings that hector can provide, but which are not currently
-    // requested by GCAM.  In the interests of keeping memory usage
-    // down, we won't actually store these unless someone wants them.
-    // Remember, if you enable them here, then you also have to add
-    // them in setupRFTbl below.
-
-    // Not added since can get from SO2 - SO2dir
-    mGasRFTable["SO2i"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_SO2i );
-
-    // Volcanoes!  <- ?
-    
-#endif
-
-    // Log what we saw here in the debugging log
-    climatelog << "\tstoreRF:  year= " << aYear << "\tindex= " << i << endl
-               << "\t\ttotal RF  = " << mTotRFTable[i] << endl
-               << "\t\t     CO2  = " << mGasRFTable["CO2"][i] << endl
-               << "\t\t     CH4  = " << mGasRFTable["CH4"][i] << endl
-               << "\t\t     N2O  = " << mGasRFTable["N2O"][i] << endl
-               << "\t\t      BC  = " << mGasRFTable["BC"][i] << endl
-               << "\t\t      OC  = " << mGasRFTable["OC"][i] << endl;
-}
-
 void HectorModel::setupRFTbl() {
     int size = yearlyDataIndex( mHectorEndYear ) + 1;
 
@@ -782,17 +790,6 @@ void HectorModel::setupRFTbl() {
     mGasRFTable["TropO3"].resize( size );
 }
 
-//! Store the global quantities retrieved from Hector, except total
-//! forcing, which gets stored in storeRF()
-void HectorModel::storeGlobals( const int aYear, const bool aHadError ) {
-    int idx = yearlyDataIndex( aYear );
-
-    mTemperatureTable[idx] = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_GLOBAL_TEMP );
-    mLandFlux[idx]         = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_LAND_CFLUX );
-    mOceanFlux[idx]        = aHadError ? numeric_limits<double>::quiet_NaN() : mHcore->sendMessage( M_GETDATA, D_OCEAN_CFLUX );
-} 
-    
-
 double HectorModel::getNetTerrestrialUptake( const int aYear ) const {
     // Is this the same as land flux?
     return mLandFlux[ yearlyDataIndex( aYear ) ];
@@ -76,6 +76,19 @@ class Timer;
  *          "BatchMode". The name of the configuration file is determined by the
  *          file configuration value "BatchFileName".
  *
+ *          If the integer configuration value "batch-worker-processes" is
+ *          greater than one, and the platform supports forking processes, the
+ *          scenarios are run concurrently in up to that many worker processes.
+ *          The base input file, the configuration scenario components and any
+ *          leading components which contain only a single FileSet are common
+ *          to every scenario and are parsed once before the workers are forked
+ *          so that the parsed model is shared copy-on-write. Each worker then
+ *          parses only the remaining files for its scenario. Workers write
+ *          their logs and batch CSV results to separate files which are merged
+ *          back in scenario order once all workers have completed, and take
+ *          turns writing output to the XML database. Note that each worker
+ *          will use up to "max-parallelism" threads.
+ *
  *          <b>XML specification for BatchRunner</b>
  *          - XML name: \c BatchRunner
  *          - Contained by: None.
@@ -177,12 +190,48 @@ protected:
     //! The current scenario runner.
     IScenarioRunner* mInternalRunner;
 
+    //! The name of the file used to ensure only one worker process writes
+    //! output at a time, empty if scenarios are not run in worker processes.
+    std::string mOutputLockFileName;
+
+    //! A file descriptor to the output lock file held by a worker process or
+    //! -1 if this is not a worker process.
+    int mOutputLock;
+
+    //! A structure which defines a single scenario to run in a worker process.
+    struct WorkerJob {
+        //! The file sets to parse on top of the shared base scenario, named
+        //! for the full scenario.
+        Component mComponent;
+
+        //! The scenario runner to use.
+        IScenarioRunner* mRunner;
+    };
+
 	BatchRunner();
 	bool runSingleScenario( IScenarioRunner* aScenarioRunner,
                             const Component& aCurrComponent,
                             const int aSinglePeriod,
                             Timer& aTimer );
 
+    std::list<Component> createScenarioList();
+
+    bool runScenariosInWorkers( const std::list<Component>& aScenarioList,
+                                const int aSinglePeriod,
+                                const int aNumWorkers,
+                                Timer& aTimer );
+
+    int runWorkerJob( const WorkerJob& aJob,
+                      const std::string& aFileSuffix,
+                      Scenario* aBaseScenario,
+                      const std::list<std::string>& aSharedFiles,
+                      const int aSinglePeriod,
+                      Timer& aTimer );
+
+    void lockOutput() const;
+
+    static std::string getWorkerFileSuffix( const size_t aJobIndex );
+
     bool XMLParseComponentSet( const xercesc::DOMNode* aNode );
 
     bool XMLParseRunnerSet( const xercesc::DOMNode* aNode );
@@ -210,6 +210,21 @@ public:
     virtual void toDebugXML( const int aPeriod,
                              Tabs* aTabs,
                              std::ostream& aOut ) const = 0;
+
+    /*! \brief Write the items stored locally in the IInfo to a binary stream.
+    * \details Items in the parent IInfo are not written.
+    * \param aOut Output stream.
+    * \sa Checkpoint
+    */
+    virtual void writeCheckpoint( std::ostream& aOut ) const = 0;
+
+    /*! \brief Read items written by writeCheckpoint.
+    * \param aIn Input stream.
+    * \param aApply Whether to set the items read or just check that they can be
+    *        read.
+    * \return Whether the items were read successfully.
+    */
+    virtual bool readCheckpoint( std::istream& aIn, const bool aApply ) = 0;
 };
 
 //! Empty inline destructor needed so that IInfo objects can be deleted through
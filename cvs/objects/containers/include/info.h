@@ -104,6 +104,10 @@ public:
     bool hasValue( const std::string& aStringKey ) const;
 
     void toDebugXML( const int aPeriod, Tabs* aTabs, std::ostream& aOut ) const;
+
+    void writeCheckpoint( std::ostream& aOut ) const;
+
+    bool readCheckpoint( std::istream& aIn, const bool aApply );
 protected:
     Info( const IInfo* aParentInfo, const std::string& aOwnerName );
 
@@ -98,6 +98,8 @@ public:
 
     const std::vector<IActivity*> getOrdering( const int aMarketNumber = -1 ) const;
 
+    std::vector<IActivity*> getContributors( const int aMarketNumber ) const;
+
 #if GCAM_PARALLEL_ENABLED
     GcamFlowGraph* getFlowGraph( const int aMarketNumber = -1 );
 #endif
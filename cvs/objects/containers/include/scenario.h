@@ -67,6 +67,9 @@ class OutputMetaData;
 class SolutionInfoParamParser;
 class IModelFeedbackCalc;
 class ManageStateVariables;
+class PerformanceReport;
+class ParallelConsistencyChecker;
+class Checkpoint;
 
 /*!
 * \ingroup Objects
@@ -106,12 +109,17 @@ public:
     std::map<std::string, const Curve*> getEmissionsQuantityCurves( const std::string& ghgName ) const;
     std::map<std::string, const Curve*> getEmissionsPriceCurves( const std::string& ghgName ) const;
     void writeOutputFiles() const;
+    void writePerformanceReport();
+    void writeEnergyBalanceTables() const;
     void accept( IVisitor* aVisitor, const int aPeriod ) const;
     const IClimateModel* getClimateModel() const;
     static const std::string& getXMLNameStatic();
     const std::vector<int>& getUnsolvedPeriods() const;
     void invalidatePeriod( const int aPeriod );
     ManageStateVariables* getManageStateVariables() const;
+    ParallelConsistencyChecker* getParallelConsistencyChecker() const;
+    const SolutionInfoParamParser* getSolutionInfoParamParser() const;
+    void initPeriod( const int aPeriod );
 
     //! Constant which when passed to the run method indicates the run period could not be determined  yet and will generate a warning..
     const static int UNINITIALIZED_RUN_PERIODS = -2;
@@ -159,6 +167,18 @@ protected:
     
     ManageStateVariables* mManageStateVars;
 
+    //! Timings and solver counts by period, only collected if the report is
+    //! configured to be written.
+    PerformanceReport* mPerformanceReport;
+
+    //! Compares parallel calculations to serial while a period is solved, only
+    //! created if configured.
+    ParallelConsistencyChecker* mParallelChecker;
+
+    //! The key of the calibration cache entry for this scenario, calculated
+    //! from the inputs on the first run if the cache is in use.
+    std::string mCalibrationCacheKey;
+
     bool solve( const int period );
 
     bool calculatePeriod( const int aPeriod,
@@ -166,6 +186,14 @@ protected:
         Tabs* aTabs,
         const bool aPrintDebugging );
 
+    bool resumeFromCheckpoint( int& aLastPeriod );
+
+    bool compareToCheckpoint();
+
+    int restoreCalibrationPeriods();
+
+    bool restoreCheckpoint( Checkpoint& aCheckpoint, const int aLastPeriod );
+
     void printGraphs( const int aPeriod ) const;
     void printLandAllocatorGraph( const int aPeriod, const bool aPrintValues ) const;
  
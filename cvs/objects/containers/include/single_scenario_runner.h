@@ -77,6 +77,13 @@ class XMLDBOutputter;
  *
  *          printOutput is called after runScenarios to print output to any
  *          configured databases.
+ *
+ *          A caller which has already parsed the base input file and the
+ *          configuration scenario components, such as a BatchRunner sharing
+ *          that work between worker processes, may hand the resulting Scenario
+ *          over with setParsedBaseScenario. The next call to setupScenarios
+ *          will then take ownership of it and only parse the scenario
+ *          components passed into the function.
  *          
  *          The getInternalScenarios functions only return a valid scenario
  *          after setupScenarios is called.
@@ -112,6 +119,13 @@ public:
 
     XMLDBOutputter* getXMLDBOutputter() const;
 
+    const std::list<std::string>& getScenarioComponents() const;
+
+    static bool parseBaseInputs( Scenario* aScenario );
+
+    static void setParsedBaseScenario( Scenario* aScenario,
+                                       const std::list<std::string>& aParsedComponents );
+
 protected:    
     SingleScenarioRunner();
     static const std::string& getXMLNameStatic();
@@ -122,5 +136,17 @@ protected:
     //! it around in case we want to do additional processing once GCAM
     //! is done running.
     mutable XMLDBOutputter* mXMLDBOutputter;
+
+    //! The scenario components parsed by the last call to setupScenarios,
+    //! including those already parsed into a base scenario.
+    std::list<std::string> mScenComponents;
+
+    //! A scenario which already has the base inputs parsed and will be used
+    //! by the next call to setupScenarios instead of parsing them again.
+    static std::auto_ptr<Scenario> sParsedBaseScenario;
+
+    //! The scenario components which were parsed into sParsedBaseScenario in
+    //! addition to the base inputs.
+    static std::list<std::string> sParsedBaseComponents;
 };
 #endif // _SINGLE_SCENARIO_RUNNER_H_
@@ -48,9 +48,12 @@
 #include <map>
 #include <memory>
 #include <vector>
+#include <string>
+#include <iosfwd>
 
 class SingleScenarioRunner;
 class Curve;
+class Timer;
 
 /*! 
 * \ingroup Objects
@@ -59,6 +62,20 @@ class Curve;
 * \details This class runs a scenario multiple times while varying a fixed
 *          carbon price, to determine the MAC curve and total cost for the
 *          scenario.
+*
+*          The trials are independent of each other given the tax path of the
+*          initial scenario. If the integer configuration value
+*          "cost-curve-worker-processes" is greater than one, the platform
+*          supports starting processes, and the command used to start the model
+*          was set with setWorkerCommand, the trials are run concurrently in up
+*          to that many worker processes. Each worker is a new instance of the
+*          model executable started with the same configuration which parses the
+*          same inputs as the initial scenario, starts from the solved prices
+*          of the initial scenario as a serial trial does, sets the fractional
+*          taxes and runs a single trial. Workers write to their own log files which are appended
+*          to the logs of this process in trial order. The resulting curves are
+*          sent back to the calculator and stored by trial so the results do
+*          not depend on the order in which the workers complete.
 * \author Josh Lurz
 */
 class TotalPolicyCostCalculator {
@@ -67,7 +84,17 @@ public:
     ~TotalPolicyCostCalculator();
     bool calculateAbatementCostCurve();
     void printOutput() const;
+
+    static void setWorkerCommand( const std::string& aExecutable,
+                                  const std::string& aConfigurationFile,
+                                  const std::string& aLoggerFile );
+    static std::string getWorkerLogSuffix( const std::string& aJobFile );
+    static bool runWorker( const std::string& aJobFile, Timer& aTimer );
 private:
+    //! The command line arguments used to start a worker process, empty if
+    //! workers can not be started.
+    static std::vector<std::string> sWorkerCommand;
+
     //! The total global cost of the policy.
     double mGlobalCost;
 
@@ -112,6 +139,12 @@ private:
     RegionCurves mRegionalCostCurves;
 
     bool runTrials();
+    bool runTrial( const int aPoint );
+    bool runTrialsInWorkers( const int aNumWorkers );
+    bool hasAllTrialCurves() const;
+    static std::string getWorkerFileName( const int aParentID, const int aPoint );
+    static void writeCurves( std::ostream& aOut, const RegionCurves& aCurves );
+    static bool readCurves( std::istream& aIn, RegionCurves& aCurves );
     void createCostCurvesByPeriod();
     void createRegionalCostCurves();
     const std::string createXMLOutputString() const;
@@ -49,6 +49,7 @@
 #include <vector>
 #include <list>
 #include <memory>
+#include <future>
 #include <xercesc/dom/DOMNode.hpp>
 #include <boost/core/noncopyable.hpp>
 
@@ -101,14 +102,20 @@ public:
     void setEmissions( int period );
     void runClimateModel();
     void runClimateModel( int period );
+    void waitForClimateModel() const;
+    double getClimateModelTime( const int aPeriod ) const;
     const std::map<std::string,int> getOutputRegionMap() const;
     bool isAllCalibrated( const int period, double calAccuracy, const bool printWarnings ) const;
+    void writeEnergyBalanceTables( std::ostream& aOut, const bool aBinary ) const;
     void setTax( const GHGPolicy* aTax );
     const IClimateModel* getClimateModel() const;
+    const IClimateModel* getDeferredClimateModel() const;
     std::map<std::string, const Curve*> getEmissionsQuantityCurves( const std::string& ghgName ) const;
     std::map<std::string, const Curve*> getEmissionsPriceCurves( const std::string& ghgName ) const;
     CalcCounter* getCalcCounter() const;
     int getGlobalOrderingSize() const {return mGlobalOrdering.size();}
+    std::vector<IActivity*> getGlobalOrdering( const std::vector<IActivity*>& aActivities ) const;
+    const std::vector<IActivity*>& getGlobalOrdering() const {return mGlobalOrdering;}
     
     const GlobalTechnologyDatabase* getGlobalTechnologyDatabase() const;
 
@@ -159,7 +166,30 @@ protected:
     //! The global ordering of activities which can be used to calculate the model.
     std::vector<IActivity*> mGlobalOrdering;
 
+#if GCAM_PARALLEL_ENABLED
+    //! Whether the climate model run for a period should be left running in the
+    //! background while the next period is solved.
+    bool mIsClimateModelAsync;
+
+    //! The climate model run which is in progress if running in the background,
+    //! which returns the time the run took.  This is mutable so that const
+    //! accessors of the climate model may wait for it to finish.
+    mutable std::future<double> mClimateModelRun;
+
+    //! The period of the climate model run in mClimateModelRun.
+    int mClimateModelRunPeriod;
+#endif
+
+    //! The time taken to run the climate model through each period, which is
+    //! only complete once any background run has been waited for.
+    mutable std::vector<double> mClimateModelTimes;
+
+    //! The climate model given to model feedbacks, which waits for any
+    //! background run only if the feedback uses it.
+    IClimateModel* mDeferredClimateModel;
+
     void clear();
+    void addClimateModelTime( const int aPeriod, const double aTime ) const;
 };
 
 #endif // _WORLD_H_
@@ -43,14 +43,27 @@
 
 #include "util/base/include/definitions.h"
 #include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstdio>
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#endif
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "containers/include/batch_runner.h"
 #include "containers/include/scenario_runner_factory.h"
+#include "containers/include/single_scenario_runner.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/configuration.h"
+#include "util/base/include/auto_file.h"
 #include "util/logger/include/ilogger.h"
+#include "util/logger/include/logger_factory.h"
 #include "containers/include/scenario.h"
 #include "reporting/include/batch_csv_outputter.h"
 
@@ -65,7 +78,8 @@ typedef list<IScenarioRunner*>::iterator RunnerIterator;
  * \brief Constructor
  */
 BatchRunner::BatchRunner() :
-mInternalRunner( 0 ){ 
+mInternalRunner( 0 ),
+mOutputLock( -1 ){ 
 }
 
 //! Destructor
@@ -111,6 +125,40 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
         return false;
     }
 
+    // Create the list of scenarios to run.
+    const list<Component> scenarioList = createScenarioList();
+
+#if !defined(_MSC_VER)
+    const int numWorkers = Configuration::getInstance()->getInt( "batch-worker-processes", 1, false );
+    if( numWorkers > 1 ){
+        return runScenariosInWorkers( scenarioList, aSinglePeriod, numWorkers, aTimer );
+    }
+#endif
+
+    bool success = true;
+    BatchCSVOutputter csvOutputter;
+    for( list<Component>::const_iterator fileSetsToRun = scenarioList.begin(); fileSetsToRun != scenarioList.end(); ++fileSetsToRun ){
+        // Run it using each possible type of IScenarioRunner.
+        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+            bool scenarioSuccess = runSingleScenario( *runner, *fileSetsToRun, aSinglePeriod, aTimer );
+            success &= scenarioSuccess;
+            (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
+            csvOutputter.writeDidScenarioSolve( scenarioSuccess );
+            // Clean up the current scenario runner before we move on to the next
+            // so that we do not accumulate a large amount of idle memory.
+            (*runner)->cleanup();
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Create the list of scenarios to run from the component sets.
+ * \details Each scenario is a Component containing one FileSet from each of
+ *          the component sets, named by combining the names of those file sets.
+ * \return The scenarios in the order in which they should be run.
+ */
+list<BatchRunner::Component> BatchRunner::createScenarioList() {
     // Initialize each components iterator to the beginning of the vector. 
     for( ComponentSet::iterator currSet = mComponentSet.begin(); currSet != mComponentSet.end(); ++currSet ){
         currSet->mFileSetIterator = currSet->mFileSets.begin();
@@ -119,7 +167,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     // The scenarios are created by determining all possible combinations of
     // file sets. The algorithm operates as follows:
     // 1) Set the current file set in each component to the initial position.
-    // 2) Run the scenario.
+    // 2) Add the scenario.
     // 3) Set the current component to the first.
     // 4) Increment the current file set in the current component.
     // 5a) If this is a valid position in the current component and go to 2.
@@ -134,9 +182,8 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     //
     // All generated scenarios are run with each scenario runner in the order in
     // which the scenario runners were read.
+    list<Component> scenarioList;
     bool shouldExit = false;
-    bool success = true;
-    BatchCSVOutputter csvOutputter;
     while( !shouldExit ){
         // The data structure containing the current run.
         Component fileSetsToRun;
@@ -146,17 +193,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             fileSetsToRun.mFileSets.push_back( *( currSet->mFileSetIterator ) );
             fileSetsToRun.mName += currSet->mFileSetIterator->mName;
         }
-
-        // Run it using each possible type of IScenarioRunner.
-        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
-            bool scenarioSuccess = runSingleScenario( *runner, fileSetsToRun, aSinglePeriod, aTimer );
-            success &= scenarioSuccess;
-            (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
-            csvOutputter.writeDidScenarioSolve( scenarioSuccess );
-            // Clean up the current scenario runner before we move on to the next
-            // so that we do not accumulate a large amount of idle memory.
-            (*runner)->cleanup();
-        }
+        scenarioList.push_back( fileSetsToRun );
 
         // Loop forward to find a position to increment.
         for( ComponentSet::iterator outPos = mComponentSet.begin(); outPos != mComponentSet.end(); ++outPos ){
@@ -175,7 +212,238 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             }
         }
     }
+    return scenarioList;
+}
+
+/*!
+ * \brief Run the scenarios concurrently in forked worker processes.
+ * \details The inputs which are common to every scenario are parsed once into a
+ *          base scenario before any workers are created. Each worker process
+ *          inherits a copy-on-write image of the base scenario, parses only the
+ *          files specific to its scenario and runs it with a single scenario
+ *          runner. Once all workers have completed their log files and batch
+ *          CSV results are merged in the order the scenarios would have been
+ *          run serially.
+ * \param aScenarioList The scenarios to run as created by createScenarioList.
+ * \param aSinglePeriod The model period to run.
+ * \param aNumWorkers The maximum number of worker processes to run at once.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether all of the scenarios solved successfully.
+ */
+bool BatchRunner::runScenariosInWorkers( const list<Component>& aScenarioList,
+                                         const int aSinglePeriod,
+                                         const int aNumWorkers,
+                                         Timer& aTimer )
+{
+#if !defined(_MSC_VER)
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+
+    // Leading component sets which contain a single file set are common to all
+    // scenarios and may be parsed into the base scenario without changing the
+    // order in which files are read.
+    ComponentSet::const_iterator firstVaried = mComponentSet.begin();
+    list<string> sharedFiles;
+    while( firstVaried != mComponentSet.end() && firstVaried->mFileSets.size() == 1 ){
+        const list<File>& files = firstVaried->mFileSets.front().mFiles;
+        for( list<File>::const_iterator currFile = files.begin(); currFile != files.end(); ++currFile ){
+            sharedFiles.push_back( currFile->mPath );
+        }
+        ++firstVaried;
+    }
+    const size_t numSharedSets = firstVaried - mComponentSet.begin();
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Parsing the base scenario shared by " << aScenarioList.size()
+            << " batch scenarios." << endl;
+    auto_ptr<Scenario> baseScenario( new Scenario );
+    bool success = SingleScenarioRunner::parseBaseInputs( baseScenario.get() );
+    for( list<string>::const_iterator currFile = sharedFiles.begin(); success && currFile != sharedFiles.end(); ++currFile ){
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currFile << " scenario component." << endl;
+        success = XMLHelper<void>::parseXML( *currFile, baseScenario.get() );
+    }
+    if( !success ){
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Failed to parse the base scenario for the batch workers." << endl;
+        return false;
+    }
+
+    // Create a job for each scenario and scenario runner combination which
+    // contains only the file sets not already parsed into the base scenario.
+    vector<WorkerJob> jobs;
+    for( list<Component>::const_iterator currScenario = aScenarioList.begin(); currScenario != aScenarioList.end(); ++currScenario ){
+        WorkerJob job;
+        job.mComponent.mName = currScenario->mName;
+        list<FileSet>::const_iterator currFileSet = currScenario->mFileSets.begin();
+        advance( currFileSet, numSharedSets );
+        job.mComponent.mFileSets.assign( currFileSet, currScenario->mFileSets.end() );
+        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+            job.mRunner = *runner;
+            jobs.push_back( job );
+        }
+    }
+
+    // Workers take a lock on this file before writing output.
+    stringstream lockFileName;
+    lockFileName << ".batch-output-" << getpid() << ".lock";
+    mOutputLockFileName = lockFileName.str();
+
+    // Launch workers until all jobs have been started, waiting for a running
+    // worker to complete whenever the maximum number are active.
+    vector<bool> jobSuccess( jobs.size(), false );
+    map<pid_t, size_t> runningJobs;
+    size_t nextJob = 0;
+    while( nextJob < jobs.size() || !runningJobs.empty() ){
+        while( nextJob < jobs.size() && runningJobs.size() < static_cast<size_t>( aNumWorkers ) ){
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Starting worker for scenario " << jobs[ nextJob ].mComponent.mName
+                    << " with scenario runner " << jobs[ nextJob ].mRunner->getName()
+                    << "." << endl;
+            cout.flush();
+            cerr.flush();
+            const pid_t pid = fork();
+            if( pid == 0 ){
+                _exit( runWorkerJob( jobs[ nextJob ], getWorkerFileSuffix( nextJob ),
+                                     baseScenario.release(), sharedFiles, aSinglePeriod, aTimer ) );
+            }
+            else if( pid < 0 ){
+                mainLog.setLevel( ILogger::SEVERE );
+                mainLog << "Could not create a worker process for scenario "
+                        << jobs[ nextJob ].mComponent.mName << "." << endl;
+            }
+            else {
+                runningJobs[ pid ] = nextJob;
+            }
+            ++nextJob;
+        }
+
+        if( !runningJobs.empty() ){
+            int status = 0;
+            const pid_t pid = wait( &status );
+            map<pid_t, size_t>::iterator finishedJob = runningJobs.find( pid );
+            if( finishedJob != runningJobs.end() ){
+                jobSuccess[ finishedJob->second ] = WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+                if( !WIFEXITED( status ) ){
+                    mainLog.setLevel( ILogger::SEVERE );
+                    mainLog << "Worker for scenario " << jobs[ finishedJob->second ].mComponent.mName
+                            << " terminated abnormally." << endl;
+                }
+                runningJobs.erase( finishedJob );
+            }
+        }
+    }
+    remove( mOutputLockFileName.c_str() );
+    mOutputLockFileName.clear();
+
+    // Merge the worker logs and results in the order the jobs were created.
+    const Configuration* conf = Configuration::getInstance();
+    const string csvFileName = conf->getFile( "batchCSVOutputFile", "batch-csv-out.csv" );
+    AutoOutputFile csvFile( "batchCSVOutputFile", "batch-csv-out.csv" );
+    bool wroteHeader = false;
+    for( size_t jobIndex = 0; jobIndex < jobs.size(); ++jobIndex ){
+        const string suffix = getWorkerFileSuffix( jobIndex );
+        LoggerFactory::appendRedirectedFiles( suffix );
+
+        const string workerCSVFileName = csvFileName + suffix;
+        ifstream workerCSV( workerCSVFileName.c_str() );
+        string line;
+        // Only the first worker file's header is kept.
+        if( workerCSV.is_open() && getline( workerCSV, line ) && !wroteHeader ){
+            *csvFile << line << endl;
+            wroteHeader = true;
+        }
+        while( getline( workerCSV, line ) ){
+            *csvFile << line << endl;
+        }
+        workerCSV.close();
+        remove( workerCSVFileName.c_str() );
+
+        success &= jobSuccess[ jobIndex ];
+        if( !jobSuccess[ jobIndex ] ){
+            mUnsolvedNames.push_back( jobs[ jobIndex ].mComponent.mName );
+        }
+    }
+
+    // Clean up the base scenario and the parser which holds temporary data for it.
+    baseScenario.reset( 0 );
+    scenario = 0;
+    XMLHelper<void>::cleanupParser();
     return success;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief Run a single job in a worker process.
+ * \details Redirects the logs to files for this worker, sets up the scenario
+ *          from the shared base scenario and runs it. The batch CSV results are
+ *          written to a separate file for the parent process to merge.
+ * \param aJob The scenario and scenario runner to run.
+ * \param aFileSuffix Suffix to add to log and result files from this worker.
+ * \param aBaseScenario The parsed base scenario, ownership is transferred.
+ * \param aSharedFiles The scenario component files parsed into the base
+ *        scenario.
+ * \param aSinglePeriod The model period to run.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return The exit code for the worker process, zero if the scenario solved.
+ */
+int BatchRunner::runWorkerJob( const WorkerJob& aJob,
+                               const string& aFileSuffix,
+                               Scenario* aBaseScenario,
+                               const list<string>& aSharedFiles,
+                               const int aSinglePeriod,
+                               Timer& aTimer )
+{
+#if !defined(_MSC_VER)
+    LoggerFactory::redirectToFiles( aFileSuffix );
+    mOutputLock = open( mOutputLockFileName.c_str(), O_RDWR | O_CREAT, 0644 );
+
+    SingleScenarioRunner::setParsedBaseScenario( aBaseScenario, aSharedFiles );
+    bool success = runSingleScenario( aJob.mRunner, aJob.mComponent, aSinglePeriod, aTimer );
+
+    const Configuration* conf = Configuration::getInstance();
+    if( conf->shouldWriteFile( "batchCSVOutputFile" ) && aJob.mRunner->getInternalScenario() ){
+        BatchCSVOutputter csvOutputter( conf->getFile( "batchCSVOutputFile", "batch-csv-out.csv" ) + aFileSuffix );
+        aJob.mRunner->getInternalScenario()->accept( &csvOutputter, -1 );
+        csvOutputter.writeDidScenarioSolve( success );
+    }
+    aJob.mRunner->cleanup();
+
+    // The process will exit without unwinding so ensure the logs are written.
+    LoggerFactory::closeAll();
+    cout.flush();
+    return success ? 0 : 1;
+#else
+    return 1;
+#endif
+}
+
+/*!
+ * \brief Wait until no other worker process is writing output.
+ * \details The lock is held until the worker process exits so that the output
+ *          databases are closed before another worker may open them. This does
+ *          nothing if scenarios are not being run in worker processes.
+ */
+void BatchRunner::lockOutput() const {
+#if !defined(_MSC_VER)
+    if( mOutputLock != -1 ){
+        flock( mOutputLock, LOCK_EX );
+    }
+#endif
+}
+
+/*!
+ * \brief Get the suffix to add to log and result files written by a worker.
+ * \param aJobIndex The index of the job run by the worker.
+ * \return The file suffix.
+ */
+string BatchRunner::getWorkerFileSuffix( const size_t aJobIndex ){
+    stringstream suffix;
+    suffix << ".batch-worker-" << aJobIndex;
+    return suffix.str();
 }
 
 void BatchRunner::printOutput( Timer& aTimer ) const {
@@ -264,7 +532,9 @@ bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
     // Run the scenario.
     success = mInternalRunner->runScenarios( runPeriod, false, aTimer );
     
-    // Print the output.
+    // Print the output. Worker processes take turns so they do not write to
+    // the same output database concurrently.
+    lockOutput();
     mInternalRunner->printOutput( aTimer );
     
     // If the run failed, add to the list of failed runs. CHECK ME!
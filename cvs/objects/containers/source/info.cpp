@@ -43,6 +43,7 @@
 #include "containers/include/info.h"
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/xml_helper.h"
+#include "util/base/include/checkpoint.h"
 
 using namespace std;
 
@@ -261,6 +262,94 @@ void Info::toDebugXML( const int aperiod, Tabs* aTabs, ostream& aOut ) const {
     XMLWriteClosingTag( "Info", aOut, aTabs );
 }
 
+/*! \brief Write the items stored in this Info to a binary stream.
+* \details Each item is written as its key, its type and its value.  Items in
+*          the parent Info are not written.
+* \param aOut Output stream.
+*/
+void Info::writeCheckpoint( ostream& aOut ) const {
+#if GCAM_PARALLEL_ENABLED
+    // get read lock for the info map
+    tbb::queuing_rw_mutex::scoped_lock readlock(mInfoMapMutex, false);
+#endif
+    Checkpoint::writeRaw( aOut, static_cast<boost::uint32_t>( mInfoMap->size() ) );
+    for( InfoMap::const_iterator item = mInfoMap->begin(); item != mInfoMap->end(); ++item ){
+        Checkpoint::writeString( aOut, item->first );
+        Checkpoint::writeRaw( aOut, static_cast<boost::uint8_t>( item->second.first ) );
+        switch( item->second.first ){
+            case eBoolean:
+                Checkpoint::writeRaw( aOut, boost::any_cast<bool>( item->second.second ) );
+                break;
+            case eInteger:
+                Checkpoint::writeRaw( aOut, static_cast<boost::int32_t>( boost::any_cast<int>( item->second.second ) ) );
+                break;
+            case eDouble:
+                Checkpoint::writeRaw( aOut, boost::any_cast<double>( item->second.second ) );
+                break;
+            case eString:
+                Checkpoint::writeString( aOut, boost::any_cast<string>( item->second.second ) );
+                break;
+            // No default so the compiler can flag omissions.
+        }
+    }
+}
+
+/*! \brief Read items written by writeCheckpoint.
+* \details Items are set as if by the corresponding set method so any items
+*          which were not written are left unchanged.
+* \param aIn Input stream.
+* \param aApply Whether to set the items read or just check that they can be
+*        read.
+* \return Whether the items were read successfully.
+*/
+bool Info::readCheckpoint( istream& aIn, const bool aApply ) {
+    boost::uint32_t numItems = 0;
+    Checkpoint::readRaw( aIn, numItems );
+    for( boost::uint32_t i = 0; i < numItems && aIn; ++i ){
+        string key;
+        boost::uint8_t type = 0;
+        Checkpoint::readString( aIn, key );
+        Checkpoint::readRaw( aIn, type );
+        switch( type ){
+            case eBoolean: {
+                bool value = false;
+                Checkpoint::readRaw( aIn, value );
+                if( aApply && aIn ){
+                    setBoolean( key, value );
+                }
+                break;
+            }
+            case eInteger: {
+                boost::int32_t value = 0;
+                Checkpoint::readRaw( aIn, value );
+                if( aApply && aIn ){
+                    setInteger( key, value );
+                }
+                break;
+            }
+            case eDouble: {
+                double value = 0;
+                Checkpoint::readRaw( aIn, value );
+                if( aApply && aIn ){
+                    setDouble( key, value );
+                }
+                break;
+            }
+            case eString: {
+                string value;
+                Checkpoint::readString( aIn, value );
+                if( aApply && aIn ){
+                    setString( key, value );
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return static_cast<bool>( aIn );
+}
+
 /*! \brief Return the initial size for the underlying hashmap.
 * \details Returns how many slots to allocate initially for the hashmap. The
 *          hashmap will increase in size if it gets too full, but the resize
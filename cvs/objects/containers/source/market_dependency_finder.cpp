@@ -255,6 +255,40 @@ const vector<IActivity*> MarketDependencyFinder::getOrdering( const int aMarketN
     }
 }
 
+/*!
+ * \brief Get the activities which may add to the supply or demand of a market.
+ * \details These are all of the activities of the dependency items which are the
+ *          direct entry points into the graph for the market, that is the
+ *          sector, resource, etc. which sets the price or supply of the good
+ *          along with those that consume it.  Unlike getOrdering the activities
+ *          further downstream are not included.
+ * \param aMarketNumber The market number for which to get the contributors.
+ * \return The activities which may contribute to the market, empty if the
+ *         market is not linked to the graph.
+ */
+vector<IActivity*> MarketDependencyFinder::getContributors( const int aMarketNumber ) const {
+    auto_ptr<MarketToDependencyItem> marketToDep( new MarketToDependencyItem( aMarketNumber ) );
+    CMarketToDepIterator mrktIter = mMarketsToDep.find( marketToDep.get() );
+    vector<IActivity*> contributors;
+    if( mrktIter == mMarketsToDep.end() ) {
+        return contributors;
+    }
+
+    set<const DependencyItem*> items;
+    for( CalcVertex* vertex : (*mrktIter)->mImpliedVertices ) {
+        items.insert( vertex->mDepItem );
+    }
+    for( const DependencyItem* item : items ) {
+        for( CalcVertex* vertex : item->mPriceVertices ) {
+            contributors.push_back( vertex->mCalcItem );
+        }
+        for( CalcVertex* vertex : item->mDemandVertices ) {
+            contributors.push_back( vertex->mCalcItem );
+        }
+    }
+    return contributors;
+}
+
 #if GCAM_PARALLEL_ENABLED
 /*!
  * \brief Get flow graph which can be used to calculate the model in parallel.
@@ -43,7 +43,9 @@
 #include <fstream>
 #include <cassert>
 #include <ctime>
+#include <cstdio>
 #include <iomanip>
+#include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
@@ -66,11 +68,12 @@
 #include "containers/include/imodel_feedback_calc.h"
 #include "util/base/include/manage_state_variables.hpp"
 #include "util/base/include/supply_demand_curve_saver.h"
-
-#if GCAM_PARALLEL_ENABLED && PARALLEL_DEBUG
-#include <stdlib.h>
-#include <tbb/tick_count.h>
-#endif
+#include "solution/util/include/calc_counter.h"
+#include "util/base/include/memory_report.h"
+#include "util/base/include/checkpoint.h"
+#include "util/base/include/performance_report.h"
+#include "util/base/include/parallel_consistency_checker.h"
+#include "util/base/include/memory_profiler.h"
 
 using namespace std;
 using namespace xercesc;
@@ -90,6 +93,8 @@ Scenario::Scenario() {
     mSolutionInfoParamParser = 0;
     
     mManageStateVars = 0;
+    mPerformanceReport = 0;
+    mParallelChecker = 0;
 }
 
 //! Destructor
@@ -97,7 +102,9 @@ Scenario::~Scenario() {
     delete mMarketplace;
     delete mWorld;
     delete mSolutionInfoParamParser;
+    delete mParallelChecker;
     delete mManageStateVars;
+    delete mPerformanceReport;
     // model time is really a singleton and so don't
     // try to delete it
 }
@@ -263,6 +270,16 @@ void Scenario::completeInit() {
     // Set the valid period vector to false.
     mIsValidPeriod.clear();
     mIsValidPeriod.resize( mModeltime->getmaxper(), false );
+
+    // Report the memory used by object type now that all technology vintages
+    // have been created.
+    if( Configuration::getInstance()->getBool( "memory-report", false, false ) ) {
+        MemoryReport memoryReport;
+        memoryReport.collect( this );
+        ILogger& memoryLog = ILogger::getLogger( "memory_report_log" );
+        memoryLog.setLevel( ILogger::NOTICE );
+        memoryReport.print( memoryLog );
+    }
 }
 
 //! Return scenario name.
@@ -298,6 +315,11 @@ bool Scenario::run( const int aSinglePeriod,
 
     Timer& fullScenarioTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::FULLSCENARIO );
     fullScenarioTimer.start();
+
+    // Start a new performance report for this run if one will be written.
+    delete mPerformanceReport;
+    mPerformanceReport = Configuration::getInstance()->shouldWriteFile( "performanceReportFileName", false, false ) ?
+        new PerformanceReport() : 0;
     
     // Log that a run is beginning.
     logRunBeginning();
@@ -307,9 +329,34 @@ bool Scenario::run( const int aSinglePeriod,
     // If the single period is RUN_ALL_PERIODS that means to calculate all periods. Loop over
     // time steps and operate model.
     if( aSinglePeriod == RUN_ALL_PERIODS ){
-        for( int per = 0; per < mModeltime->getmaxper(); per++ ){
+        // Pick up from the last completed period if we are resuming a run
+        // which was interrupted.
+        int firstPeriod = 0;
+        if( Configuration::getInstance()->getBool( "resume-from-checkpoint", false, false ) ) {
+            int lastPeriod = -1;
+            if( resumeFromCheckpoint( lastPeriod ) ) {
+                firstPeriod = lastPeriod + 1;
+                success = mUnsolvedPeriods.empty();
+            }
+            else {
+                // Do not run from the start as the user asked to resume from
+                // a specific checkpoint, instead report that nothing solved.
+                for( int per = 0; per < mModeltime->getmaxper(); ++per ) {
+                    mUnsolvedPeriods.push_back( per );
+                }
+                firstPeriod = mModeltime->getmaxper();
+                success = false;
+            }
+        }
+        // Otherwise skip the calibration periods if they have been solved
+        // before with the same inputs.
+        if( firstPeriod == 0 && Configuration::getInstance()->getBool( "use-calibration-cache", false, false ) ) {
+            firstPeriod = restoreCalibrationPeriods() + 1;
+        }
+        for( int per = firstPeriod; per < mModeltime->getmaxper(); per++ ){
             success &= calculatePeriod( per, *XMLDebugFile, &tabs, aPrintDebugging );
         }
+        success &= compareToCheckpoint();
     }
     // Check if the single period is invalid.
     else if( aSinglePeriod >= mModeltime->getmaxper() ){
@@ -384,95 +431,44 @@ bool Scenario::calculatePeriod( const int aPeriod,
                                 Tabs* aTabs,
                                 bool aPrintDebugging )
 {
-    logPeriodBeginning( aPeriod );
-
-    // If this is period 0 initialize market price.
-    if( aPeriod == 0 ){
-        mMarketplace->initPrices(); // initialize prices
-    }
-
-    // Run the iteration of the model.
-    mMarketplace->nullSuppliesAndDemands( aPeriod ); // initialize market demand to null
-    mMarketplace->init_to_last( aPeriod ); // initialize to last period's info
-    mWorld->initCalc( aPeriod ); // call to initialize anything that won't change during calc
-    mMarketplace->assignMarketSerialNumbers( aPeriod ); // give the markets their serial numbers for this period.
-    
-    // Call any model feedback objects before we begin solving this period but after
-    // we are initialized and ready to go.
-    for( auto modelFeedback : mModelFeedbacks ) {
-        modelFeedback->calcFeedbacksBeforePeriod( this, mWorld->getClimateModel(), aPeriod );
+    if( mPerformanceReport ) {
+        mPerformanceReport->startPeriod();
     }
-    
-    // Set up the state data for the current period.
-    delete mManageStateVars;
-    mManageStateVars = new ManageStateVariables( aPeriod );
-    
-    // Be sure to clear out any supplies and demands in the marketplace before making our
-    // initial call to world.calc.  There may already be values in there if for instance
-    // they got set from a restart file.
-    mMarketplace->nullSuppliesAndDemands( aPeriod );
-
-#if GCAM_PARALLEL_ENABLED && PARALLEL_DEBUG
-    mWorld->calc( aPeriod );       // get rid of transient bad data
-    mMarketplace->nullSuppliesAndDemands( aPeriod );
 
-    ILogger &mainlog = ILogger::getLogger("main_log"); 
-    
-    ILogger &pdebug = ILogger::getLogger( "parallel_debug_log" );
-    pdebug.setLevel(ILogger::DEBUG);
-    pdebug << "**************** Starting serial World::calc (period " << aPeriod << ") ****************\n";
+    logPeriodBeginning( aPeriod );
 
-    tbb::tick_count t0 = tbb::tick_count::now();
-#endif
-    
-    mWorld->calc( aPeriod ); // call to calculate initial supply and demand
+    initPeriod( aPeriod );
 
-#if GCAM_PARALLEL_ENABLED && PARALLEL_DEBUG
-    tbb::tick_count t1 = tbb::tick_count::now();
-    
-    pdebug << "****************Ending serial World::calc****************\n";
-    std::vector<double> serialrslt = marketplace->fullstate( aPeriod );
+    MemoryProfiler& memoryProfiler = MemoryProfiler::getInstance();
+    memoryProfiler.markPhase( "init-calc", aPeriod );
+    memoryProfiler.addStateData( aPeriod, mManageStateVars->getStateDataBytes() );
 
-    pdebug << "%%%%%%%%%%%%%%%% Starting parallel World::calc (period " << aPeriod << ") %%%%%%%%%%%%%%%%\n";
-    tbb::tick_count t2;
-    tbb::tick_count t3;
-    mMarketplace->nullSuppliesAndDemands( aPeriod );
+    // Optionally check that the parallel calculations reproduce the serial ones
+    // as the period is solved.
+    if( ParallelConsistencyChecker::isEnabled() ) {
+        mParallelChecker = new ParallelConsistencyChecker( aPeriod );
+    }
 
-    t2 = tbb::tick_count::now();
-    mWorld->calc(aPeriod, world->getGlobalFlowGraph());
-    t3 = tbb::tick_count::now();
-      
-    pdebug << "%%%%%%%%%%%%%%%% Ending parallel World::calc %%%%%%%%%%%%%%%%\n";
-
-    // check for consistency between serial and parallel versions
-
-    ILogger::WarningLevel old_main_log_level = mainlog.setLevel(ILogger::ERROR);
-    if(aPeriod > 0) {
-        if( !mMarketplace->checkstate(aPeriod, serialrslt, &mainlog, DBL_CMP_LOOSE) ) {
-            std::cerr << "ERROR: parallel calc failed to reproduce serial results in period " << aPeriod
-                      << ".\n";
-            mainlog << "ERROR: parallel calc failed to reproduce serial results in period " << aPeriod
-                    << ".\n"; 
-        } 
-        else {
-            mainlog.setLevel(ILogger::NOTICE);
-            std::cerr << "Period " << aPeriod << " parallel calc successful.\n";
-        }
+    // call to calculate initial supply and demand
+    if( mParallelChecker ) {
+        mParallelChecker->checkFullCalc( "initial calc" );
+    }
+    else {
+        mWorld->calc( aPeriod );
     }
 
-    mainlog.setLevel(ILogger::WARNING);
-    double sertime = (t1-t0).seconds();
-    double partime = (t3-t2).seconds();
-    double ratio   = sertime/partime;
-    mainlog << "===Period: " << aPeriod << ":\tserial time: " << sertime
-            << "\tparallel time:  " << partime << "\tspeedup:  " << ratio << "\n";
-    mainlog.setLevel( old_main_log_level );
-#endif
-    
-    
     bool success = solve( aPeriod ); // solution uses Bisect and NR routine to clear markets
 
+    if( mParallelChecker ) {
+        mMarketplace->nullSuppliesAndDemands( aPeriod );
+        mParallelChecker->checkFullCalc( "final solution" );
+        delete mParallelChecker;
+        mParallelChecker = 0;
+    }
+    memoryProfiler.markPhase( "solve", aPeriod );
+
     mWorld->postCalc( aPeriod );
+    memoryProfiler.markPhase( "post-calc", aPeriod );
         
     // Mark that the period is now valid.
     mIsValidPeriod[ aPeriod ] = true;
@@ -482,20 +478,26 @@ bool Scenario::calculatePeriod( const int aPeriod,
         mWorld->runClimateModel( aPeriod );
     }
     else {
+        // The previous period's climate run may still be writing to the climate log.
+        mWorld->waitForClimateModel();
         ILogger& climatelog = ILogger::getLogger( "climate-log" );
         climatelog.setLevel( ILogger::WARNING );
         climatelog << "Solver unsuccessful for period " << aPeriod
                    << ".  Climate model run skipped." << endl;
     }
+    memoryProfiler.markPhase( "climate", aPeriod );
     
     // Call any model feedbacks now that we are done solving the current period and
     // the climate model has been run.
     for( auto modelFeedback : mModelFeedbacks ) {
-        modelFeedback->calcFeedbacksAfterPeriod( this, mWorld->getClimateModel(), aPeriod );
+        modelFeedback->calcFeedbacksAfterPeriod( this, mWorld->getDeferredClimateModel(), aPeriod );
     }
 
     logPeriodEnding( aPeriod );
     
+    Timer& writeTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::WRITE_DATA );
+    writeTimer.start();
+
     // Write out the results for debugging.
     if( aPrintDebugging ){
         writeDebuggingFiles( aXMLDebugFile, aTabs, aPeriod );
@@ -503,10 +505,212 @@ bool Scenario::calculatePeriod( const int aPeriod,
 
     delete mManageStateVars;
     mManageStateVars = 0;
+
+    // Save the complete model state now that all state has been copied back
+    // into the model so the run may be resumed from here.
+    if( Configuration::getInstance()->shouldWriteFile( "checkpoint", false, false ) ) {
+        // The climate model state is part of the checkpoint.
+        mWorld->waitForClimateModel();
+        Checkpoint checkpoint( Checkpoint::getConfiguredFileName( mName ) );
+        checkpoint.save( this, aPeriod );
+    }
+
+    // Store the solved calibration periods so that later runs with the same
+    // inputs to these periods can skip them.
+    if( !mCalibrationCacheKey.empty() && aPeriod == mModeltime->getFinalCalibrationPeriod()
+        && mUnsolvedPeriods.empty() )
+    {
+        mWorld->waitForClimateModel();
+        Checkpoint checkpoint( Checkpoint::getCalibrationCacheFileName( mCalibrationCacheKey ),
+                               mCalibrationCacheKey );
+        checkpoint.save( this, aPeriod );
+    }
+    writeTimer.stop();
+
+    if( mPerformanceReport ) {
+        mPerformanceReport->endPeriod( aPeriod, mModeltime->getper_to_yr( aPeriod ), mWorld->getCalcCounter() );
+    }
     
     return success;
 }
 
+/*!
+ * \brief Restore the model from the configured checkpoint file.
+ * \sa restoreCheckpoint
+ * \param aLastPeriod Set to the last period restored or -1 if there was no
+ *        checkpoint for this scenario.
+ * \return False if there was a checkpoint but it does not match the model.
+ */
+bool Scenario::resumeFromCheckpoint( int& aLastPeriod ) {
+    Checkpoint checkpoint( Checkpoint::getConfiguredFileName( mName ) );
+    aLastPeriod = checkpoint.getLastPeriod( this );
+    if( aLastPeriod < 0 ) {
+        return true;
+    }
+
+    if( !restoreCheckpoint( checkpoint, aLastPeriod ) ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not resume from checkpoint, no periods will be run." << endl;
+        aLastPeriod = -1;
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief Compare the model to the checkpoint-compare file, if one is
+ *        configured.
+ * \details The file should be the checkpoint saved by an uninterrupted run of
+ *          the same scenario.  This checks that a resumed run, or one which
+ *          restored the calibration periods, produced identical results.
+ * \sa Checkpoint::compare
+ * \return False if the model does not match the file.
+ */
+bool Scenario::compareToCheckpoint() {
+    const string fileName = Configuration::getInstance()->getFile( "checkpoint-compare", "", false );
+    if( fileName.empty() ) {
+        return true;
+    }
+    // The checkpoint was saved once the climate model had run.
+    mWorld->waitForClimateModel();
+    Checkpoint checkpoint( fileName );
+    return checkpoint.compare( this );
+}
+
+/*!
+ * \brief Restore the calibration periods from the calibration cache.
+ * \details The cache holds a checkpoint of the calibration periods for each
+ *          set of inputs that has been run, named by a hash of all of the model
+ *          data which may affect those periods.  Period vectors, markets and
+ *          technologies for later periods are not included as the calibration
+ *          periods are solved without regard to them, so for instance policy
+ *          scenarios share the entry of their reference scenario.  If there is
+ *          an entry for this scenario it is restored as when resuming from a
+ *          checkpoint except that data for later periods is left as read from
+ *          the input files.  Otherwise the entry will be saved when the final
+ *          calibration period has solved.  An entry which cannot be
+ *          restored is removed and treated the same as a missing one.
+ * \return The final calibration period if it was restored or -1 if the
+ *         calibration periods must be solved.
+ */
+int Scenario::restoreCalibrationPeriods() {
+    const int finalCalPeriod = mModeltime->getFinalCalibrationPeriod();
+
+    // The key must be calculated before any period has been initialized so
+    // only do so on the first run.
+    if( mCalibrationCacheKey.empty() ) {
+        mCalibrationCacheKey = Checkpoint::calcContentHash( this, finalCalPeriod );
+    }
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    const string fileName = Checkpoint::getCalibrationCacheFileName( mCalibrationCacheKey );
+    if( !ifstream( fileName.c_str() ).is_open() ) {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "No calibration cache entry " << mCalibrationCacheKey
+                << ", calibration periods will be solved." << endl;
+        return -1;
+    }
+
+    Checkpoint checkpoint( fileName, mCalibrationCacheKey );
+    checkpoint.setLastRestoredPeriod( finalCalPeriod );
+    if( checkpoint.getLastPeriod( this ) != finalCalPeriod ) {
+        return -1;
+    }
+
+    // An entry which does not match the model, such as one written by a
+    // different version of the model, is treated as a miss.  The checkpoint is
+    // verified before any data is changed so the calibration periods can be
+    // solved as usual, which re-initializes them.  Remove the entry so that it
+    // will be replaced by this run.
+    if( !restoreCheckpoint( checkpoint, finalCalPeriod ) ) {
+        remove( fileName.c_str() );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not restore calibration cache entry " << mCalibrationCacheKey
+                << ", it has been removed and the calibration periods will be solved." << endl;
+        return -1;
+    }
+    return finalCalPeriod;
+}
+
+/*!
+ * \brief Restore the model from a checkpoint.
+ * \details Each period in the checkpoint is initialized first, without being
+ *          solved, so that any objects created during initCalc exist.  The
+ *          model data is then overwritten by the checkpoint.  Finally each
+ *          restored period is completed as it would have been by
+ *          calculatePeriod: postCalc is called, the climate model is run if
+ *          the period solved, to recreate its state from the restored
+ *          emissions, and the model feedbacks after the period are called.
+ * \param aCheckpoint The checkpoint to load.
+ * \param aLastPeriod The last period in the checkpoint.
+ * \return Whether the checkpoint was loaded.  If not the model data is
+ *         unchanged but the periods have been initialized, so the model must
+ *         be run from period 0.
+ */
+bool Scenario::restoreCheckpoint( Checkpoint& aCheckpoint, const int aLastPeriod ) {
+    for( int per = 0; per <= aLastPeriod; ++per ) {
+        initPeriod( per );
+        delete mManageStateVars;
+        mManageStateVars = 0;
+    }
+
+    if( !aCheckpoint.load( this ) ) {
+        return false;
+    }
+
+    for( int per = 0; per <= aLastPeriod; ++per ) {
+        mWorld->postCalc( per );
+        mIsValidPeriod[ per ] = true;
+        if( find( mUnsolvedPeriods.begin(), mUnsolvedPeriods.end(), per ) == mUnsolvedPeriods.end() ) {
+            mWorld->runClimateModel( per );
+        }
+        for( auto modelFeedback : mModelFeedbacks ) {
+            modelFeedback->calcFeedbacksAfterPeriod( this, mWorld->getDeferredClimateModel(), per );
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Prepare a period to be solved.
+ * \details Initializes prices from the previous period, calls initCalc, runs
+ *          any model feedbacks which act before the period, and sets up the
+ *          state data (loading a restart file if one is configured).  After
+ *          this call the model is ready for World::calc to be called for the
+ *          period.  This is called by calculatePeriod and is public so that
+ *          tools such as the benchmark harness can set up a period without
+ *          solving it.
+ * \param aPeriod Period to initialize.
+ */
+void Scenario::initPeriod( const int aPeriod ) {
+    // If this is period 0 initialize market price.
+    if( aPeriod == 0 ){
+        mMarketplace->initPrices(); // initialize prices
+    }
+
+    // Run the iteration of the model.
+    mMarketplace->nullSuppliesAndDemands( aPeriod ); // initialize market demand to null
+    mMarketplace->init_to_last( aPeriod ); // initialize to last period's info
+    mWorld->initCalc( aPeriod ); // call to initialize anything that won't change during calc
+    mMarketplace->assignMarketSerialNumbers( aPeriod ); // give the markets their serial numbers for this period.
+    
+    // Call any model feedback objects before we begin solving this period but after
+    // we are initialized and ready to go.
+    for( auto modelFeedback : mModelFeedbacks ) {
+        modelFeedback->calcFeedbacksBeforePeriod( this, mWorld->getDeferredClimateModel(), aPeriod );
+    }
+    
+    // Set up the state data for the current period.
+    delete mManageStateVars;
+    mManageStateVars = new ManageStateVariables( aPeriod );
+    
+    // Be sure to clear out any supplies and demands in the marketplace before making our
+    // initial call to world.calc.  There may already be values in there if for instance
+    // they got set from a restart file.
+    mMarketplace->nullSuppliesAndDemands( aPeriod );
+}
+
 /*! \brief Perform any logging which should occur when a period begins.
 * \param aPeriod Model period.
 */
@@ -699,6 +903,7 @@ bool Scenario::solve( const int period ){
     if( !success ) {
         mUnsolvedPeriods.push_back( period );
     }
+    mMarketplace->logPricePrediction( period );
     
     return success;
 }
@@ -720,6 +925,44 @@ void Scenario::writeOutputFiles() const {
     }
 }
 
+/*!
+ * \brief Write the performance report for the last run, if it was configured.
+ * \details This should be called once all outputs have been written so that
+ *          the time taken to write them is included in the run totals.
+ */
+void Scenario::writePerformanceReport() {
+    if( !mPerformanceReport ) {
+        return;
+    }
+    mPerformanceReport->endRun( mWorld );
+    AutoOutputFile reportFile( "performanceReportFileName", "performance-report.csv" );
+    mPerformanceReport->write( *reportFile, mName );
+    delete mPerformanceReport;
+    mPerformanceReport = 0;
+}
+
+/*!
+ * \brief Write the energy balance tables for all regions and periods, if
+ *        they were configured.
+ * \details The tables are written to the energyBalanceTableName file which
+ *          must be explicitly enabled. They are written as CSV unless the
+ *          energy-balance-binary configuration flag is set.
+ */
+void Scenario::writeEnergyBalanceTables() const {
+    const Configuration* conf = Configuration::getInstance();
+    if( !conf->shouldWriteFile( "energyBalanceTableName", false ) ) {
+        return;
+    }
+    const bool isBinary = conf->getBool( "energy-balance-binary", false, false );
+    string fileName = conf->getFile( "energyBalanceTableName",
+                                     isBinary ? "energy-balance.bin" : "energy-balance.csv" );
+    if( conf->shouldAppendScnToFile( "energyBalanceTableName" ) ) {
+        fileName = util::appendScenarioToFileName( fileName );
+    }
+    AutoOutputFile tableFile( fileName, isBinary ? ios_base::out | ios_base::binary : ios_base::out );
+    mWorld->writeEnergyBalanceTables( *tableFile, isBinary );
+}
+
 /*!
  * \brief A convience method to initialize solvers for all periods.
  * \details First look into the configuration file to see if the user
@@ -781,3 +1024,20 @@ ManageStateVariables* Scenario::getManageStateVariables() const {
     return mManageStateVars;
 }
 
+/*!
+ * \brief Get the object checking parallel calculations against serial for the
+ *        period being solved.
+ * \return The ParallelConsistencyChecker or null if checks are not enabled.
+ */
+ParallelConsistencyChecker* Scenario::getParallelConsistencyChecker() const {
+    return mParallelChecker;
+}
+
+/*!
+ * \brief Get the parser which holds user supplied SolutionInfo parameters.
+ * \return The SolutionInfoParamParser.
+ */
+const SolutionInfoParamParser* Scenario::getSolutionInfoParamParser() const {
+    return mSolutionInfoParamParser;
+}
+
@@ -48,6 +48,7 @@
 #include "util/base/include/timer.h"
 #include "util/base/include/configuration.h"
 #include "util/base/include/auto_file.h"
+#include "util/base/include/memory_profiler.h"
 #include "util/logger/include/ilogger.h"
 #include "util/logger/include/logger_factory.h"
 #include "reporting/include/xml_db_outputter.h"
@@ -64,6 +65,9 @@ extern void closeDB();
 extern void openDB();
 extern void createDBout();
 
+std::auto_ptr<Scenario> SingleScenarioRunner::sParsedBaseScenario;
+std::list<std::string> SingleScenarioRunner::sParsedBaseComponents;
+
 /*! \brief Constructor */
 SingleScenarioRunner::SingleScenarioRunner(){
     mXMLDBOutputter = 0;
@@ -100,38 +104,34 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
         mainLog << "Early warning Java checks failed and database output was requested" << endl;
         abort();
     }
-    // Ensure that a new scenario is created for each run.
-    mScenario.reset( new Scenario );
+    // Ensure that a new scenario is created for each run. If the base inputs
+    // have already been parsed then take over that scenario instead.
+    bool success = true;
+    mScenComponents.clear();
+    if( sParsedBaseScenario.get() ){
+        mScenario = sParsedBaseScenario;
+        mScenComponents.swap( sParsedBaseComponents );
+    }
+    else {
+        mScenario.reset( new Scenario );
+        success = parseBaseInputs( mScenario.get() );
+    }
 
     // Set the global scenario pointer.
     // TODO: Remove global scenario pointer.
     scenario = mScenario.get();
 
-    // Parse the input file.
-    bool success =
-        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
-                                   mScenario.get() );
-    
     // Check if parsing succeeded.
     if( !success ){
         return false;
     }
 
-    // Fetch the listing of Scenario Components.
-    list<string> scenComponents = conf->getScenarioComponents();
-
-    // Add on any scenario components that were passed in.
-    for( list<string>::const_iterator curr = aScenComponents.begin();
-		curr != aScenComponents.end(); ++curr )
-	{
-        scenComponents.push_back( *curr );
-    }
-    
-    // Iterate over the vector.
+    // Iterate over the scenario components that were passed in.
+    mScenComponents.insert( mScenComponents.end(), aScenComponents.begin(), aScenComponents.end() );
     typedef list<string>::const_iterator ScenCompIter;
     ILogger& mainLog = ILogger::getLogger( "main_log" );
-    for( ScenCompIter currComp = scenComponents.begin();
-		 currComp != scenComponents.end(); ++currComp )
+    for( ScenCompIter currComp = aScenComponents.begin();
+		 currComp != aScenComponents.end(); ++currComp )
 	{
         mainLog.setLevel( ILogger::NOTICE );
         mainLog << "Parsing " << *currComp << " scenario component." << endl;
@@ -159,10 +159,14 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
     // Print data read in time.
     mainLog.setLevel( ILogger::DEBUG );
     timer.print( mainLog, "XML Readin Time:" );
+    MemoryProfiler& memoryProfiler = MemoryProfiler::getInstance();
+    memoryProfiler.markPhase( "parse" );
 
     // Finish initialization.
     if( mScenario.get() ){
         mScenario->completeInit();
+        memoryProfiler.markPhase( "complete-init" );
+        memoryProfiler.addObjectTypes( "complete-init", mScenario.get() );
     }
     return true;
 }
@@ -216,6 +220,10 @@ void SingleScenarioRunner::printOutput( Timer& aTimer ) const {
     mainLog.setLevel( ILogger::NOTICE );
     mainLog << "Printing output" << endl;
 
+    // Record the objects in the model now that all periods have been run.
+    MemoryProfiler& memoryProfiler = MemoryProfiler::getInstance();
+    memoryProfiler.addObjectTypes( "solved", mScenario.get() );
+
     Timer &writeTimer = TimerRegistry::getInstance().getTimer(TimerRegistry::WRITE_DATA);
     writeTimer.start();
 
@@ -234,7 +242,18 @@ void SingleScenarioRunner::printOutput( Timer& aTimer ) const {
         // Print the output.
         mXMLDBOutputter->finish();
     }
+    // Write the energy balance tables if they were requested.
+    mScenario->writeEnergyBalanceTables();
     writeTimer.stop();
+
+    // Write the performance report now that the output time is known.
+    mScenario->writePerformanceReport();
+
+    memoryProfiler.markPhase( "output" );
+    if( memoryProfiler.isEnabled() ) {
+        AutoOutputFile profileFile( "memoryProfileFileName", "memory-profile.csv" );
+        memoryProfiler.write( *profileFile, mScenario->getName() );
+    }
     
     // Print the timestamps.
     aTimer.stop();
@@ -277,6 +296,83 @@ XMLDBOutputter* SingleScenarioRunner::getXMLDBOutputter() const {
     return mXMLDBOutputter;
 }
 
+/*!
+ * \brief Get the scenario components parsed by setupScenarios.
+ * \details These are in addition to the scenario components listed in the
+ *          configuration file and include any which were parsed into the base
+ *          scenario set with setParsedBaseScenario, so passing them to
+ *          setupScenarios in a new process sets up the same scenario.
+ * \return The scenario components in the order they were parsed.
+ */
+const list<string>& SingleScenarioRunner::getScenarioComponents() const {
+    return mScenComponents;
+}
+
+/*!
+ * \brief Parse the base input file and the scenario components listed in the
+ *        configuration file into the given scenario.
+ * \details These are the inputs which are common to every scenario set up by
+ *          this runner. Scenario components passed into setupScenarios are
+ *          parsed after these.
+ * \param aScenario The scenario to parse the inputs into.
+ * \return Whether all of the inputs were parsed successfully.
+ */
+bool SingleScenarioRunner::parseBaseInputs( Scenario* aScenario ){
+    const Configuration* conf = Configuration::getInstance();
+
+    // Some objects look up the global scenario pointer while parsing.
+    scenario = aScenario;
+
+    // Parse the input file.
+    bool success =
+        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
+                                   aScenario );
+    
+    // Check if parsing succeeded.
+    if( !success ){
+        return false;
+    }
+
+    // Fetch the listing of Scenario Components.
+    const list<string> scenComponents = conf->getScenarioComponents();
+    
+    // Iterate over the vector.
+    typedef list<string>::const_iterator ScenCompIter;
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    for( ScenCompIter currComp = scenComponents.begin();
+		 currComp != scenComponents.end(); ++currComp )
+	{
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currComp << " scenario component." << endl;
+        success = XMLHelper<void>::parseXML( *currComp, aScenario );
+        
+        // Check if parsing succeeded.
+        if( !success ){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Set a scenario which already has the base inputs parsed to be used by
+ *        the next call to setupScenarios.
+ * \details Parsing the base inputs is typically the most expensive part of
+ *          setting up a scenario. A caller which sets up many scenarios from the
+ *          same base inputs may parse them once with parseBaseInputs and hand a
+ *          copy of the result to each run, for instance in a forked process.
+ * \note This method transfers ownership of the scenario.
+ * \param aScenario A scenario which has been passed to parseBaseInputs.
+ * \param aParsedComponents The scenario components which were parsed into
+ *        aScenario after the base inputs, in the order they were parsed.
+ */
+void SingleScenarioRunner::setParsedBaseScenario( Scenario* aScenario,
+                                                  const list<string>& aParsedComponents )
+{
+    sParsedBaseScenario.reset( aScenario );
+    sParsedBaseComponents = aParsedComponents;
+}
+
 /*!
  * \brief Get the XML name of the class.
  * \return The XML name of the class.
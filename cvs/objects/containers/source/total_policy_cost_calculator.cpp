@@ -42,6 +42,15 @@
 #include <cassert>
 #include <vector>
 #include <string>
+#include <list>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <cstdio>
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 #include "containers/include/scenario.h"
 #include "containers/include/world.h"
 #include "util/base/include/util.h"
@@ -59,14 +68,19 @@
 #include "util/logger/include/ilogger.h"
 #include "containers/include/total_policy_cost_calculator.h"
 #include "containers/include/single_scenario_runner.h"
+#include "containers/include/scenario_runner_factory.h"
 #include "policy/include/policy_ghg.h"
 #include "reporting/include/xml_db_outputter.h"
+#include "util/logger/include/logger_factory.h"
 
 #include <boost/algorithm/string/split.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
 
 using namespace std;
 using namespace xercesc;
 
+vector<string> TotalPolicyCostCalculator::sWorkerCommand;
+
 /*! \brief Constructor.
 * \param aSingleScenario The single scenario runner.
 */
@@ -151,6 +165,15 @@ bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
     
     // Run the trials and store the cost curves.
     bool success = runTrials();
+
+    // A worker which failed may not have returned its curves in which case
+    // the cost curves can not be created.
+    if( !hasAllTrialCurves() ){
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Not all cost curve point runs returned results. Skipping cost curve calculation." << endl;
+        return false;
+    }
     
     // Create a cost curve for each period and region.
     createCostCurvesByPeriod();
@@ -164,19 +187,15 @@ bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
 }
 
 /*! \brief Run a trial for each point and store the abatement curves.
-* \details First calculates a fraction of the total carbon tax to use, based 
-* on the trial number and the total number of points, so that the data points are equally
-* distributed from 0 to the full carbon tax for each period. It then calculates and 
-* sets the fixed tax for each year. The scenario is then run, and the emissions and 
-* tax curves are stored for each region.
+* \details Each trial uses a fraction of the total carbon tax, based on the
+* trial number and the total number of points, so that the data points are equally
+* distributed from 0 to the full carbon tax for each period. The trials are run in
+* this process, restoring the original solved prices between each, or concurrently
+* in worker processes if so configured.
 * \return Whether all model runs completed successfully.
 * \author Josh Lurz
 */
 bool TotalPolicyCostCalculator::runTrials(){
-    // Get the number of max periods.
-    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
-    const int maxPeriod = modeltime->getmaxper();
-
     bool success = true;
     const static bool usingRestartPeriod = Configuration::getInstance()->getInt(
         "restart-period", -1 ) != -1;
@@ -184,42 +203,19 @@ bool TotalPolicyCostCalculator::runTrials(){
     if( !usingRestartPeriod ) {
         mSingleScenario->getInternalScenario()->getMarketplace()->store_prices_for_cost_calculation();
     }
-    // Loop through for each point.
-    for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
-        // Determine the fraction of the full tax this tax will be.
-        const double fraction = static_cast<double>( currPoint ) / static_cast<double>( mNumPoints );
-        // Iterate through the regions to set different taxes for each if necessary.
-        // Currently this will set the same for all of them.
-        for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
-            // Vector which will contain taxes for this trial.
-            vector<double> currTaxes( maxPeriod );
-
-            // Set the tax for each year. 
-            for( int per = 0; per < maxPeriod; per++ ){
-                const int year = modeltime->getper_to_yr( per );
-                double origTax = rIter->second->getY( year );
-                currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
-                    origTax * fraction;
-            }
-            // Set the fixed taxes into the world.
-            GHGPolicy tax( mGHGName, rIter->first, currTaxes );
-            mSingleScenario->getInternalScenario()->setTax( &tax );
-        }
 
-        // Create an ending for the output files using the run number.
-        ILogger& mainLog = ILogger::getLogger( "main_log" );
-        mainLog.setLevel( ILogger::NOTICE );
-        mainLog << "Starting cost curve point run number " << currPoint << "." << endl;
-
-        // Run the scenario with the add-on extension to the output file names
-        // as the point number. This allows the output file to be named debug +
-        // point number.
-        success &= mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, true,
-                                                                util::toString( currPoint ) );
+#if !defined(_MSC_VER)
+    // When using a restart period each trial starts from the prices of the
+    // previous one so they are not independent and must be run in order.
+    const int numWorkers = Configuration::getInstance()->getInt( "cost-curve-worker-processes", 1, false );
+    if( numWorkers > 1 && !usingRestartPeriod && !sWorkerCommand.empty() ){
+        return runTrialsInWorkers( numWorkers );
+    }
+#endif
 
-        // Save information.
-        mEmissionsQCurves[ currPoint ] = getEmissionsQuantityCurve();
-        mEmissionsTCurves[ currPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+    // Loop through for each point.
+    for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
+        success &= runTrial( currPoint );
 
         // Restore original solved market prices after each cost iteration to ensure same
         // starting prices for each iteration.  This is necessary due to changing initial prices.
@@ -230,6 +226,342 @@ bool TotalPolicyCostCalculator::runTrials(){
     return success;
 }
 
+/*! \brief Run the trial for a single point and store the abatement curves.
+* \details Sets a fixed tax for each region which is a fraction of the tax in
+*          the initial scenario determined by the point number, runs the
+*          scenario, and stores the resulting emissions and tax curves.
+* \param aPoint The point number to run.
+* \return Whether the model run completed successfully.
+*/
+bool TotalPolicyCostCalculator::runTrial( const int aPoint ){
+    // Get the number of max periods.
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    const int maxPeriod = modeltime->getmaxper();
+
+    // Determine the fraction of the full tax this tax will be.
+    const double fraction = static_cast<double>( aPoint ) / static_cast<double>( mNumPoints );
+    // Iterate through the regions to set different taxes for each if necessary.
+    // Currently this will set the same for all of them.
+    for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
+        // Vector which will contain taxes for this trial.
+        vector<double> currTaxes( maxPeriod );
+
+        // Set the tax for each year. 
+        for( int per = 0; per < maxPeriod; per++ ){
+            const int year = modeltime->getper_to_yr( per );
+            double origTax = rIter->second->getY( year );
+            currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
+                origTax * fraction;
+        }
+        // Set the fixed taxes into the world.
+        GHGPolicy tax( mGHGName, rIter->first, currTaxes );
+        mSingleScenario->getInternalScenario()->setTax( &tax );
+    }
+
+    // Create an ending for the output files using the run number.
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Starting cost curve point run number " << aPoint << "." << endl;
+
+    // Run the scenario with the add-on extension to the output file names
+    // as the point number. This allows the output file to be named debug +
+    // point number.
+    const bool success = mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, true,
+                                                                      util::toString( aPoint ) );
+
+    // Save information.
+    mEmissionsQCurves[ aPoint ] = getEmissionsQuantityCurve();
+    mEmissionsTCurves[ aPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+    return success;
+}
+
+/*! \brief Set the command used to start this model so that trials may be run
+*          in worker processes.
+* \details Workers are started with the same configuration and log
+*          configuration files as this process. This must be called before
+*          the trials are run for workers to be used.
+* \param aExecutable The model executable.
+* \param aConfigurationFile The configuration file the model was started with.
+* \param aLoggerFile The log configuration file the model was started with.
+*/
+void TotalPolicyCostCalculator::setWorkerCommand( const string& aExecutable,
+                                                  const string& aConfigurationFile,
+                                                  const string& aLoggerFile )
+{
+    sWorkerCommand.clear();
+    sWorkerCommand.push_back( aExecutable );
+    sWorkerCommand.push_back( "-C" );
+    sWorkerCommand.push_back( aConfigurationFile );
+    sWorkerCommand.push_back( "-L" );
+    sWorkerCommand.push_back( aLoggerFile );
+}
+
+/*! \brief Get the suffix a worker appends to its log file names.
+* \param aJobFile The job file the worker was started with.
+* \return The log file suffix.
+*/
+string TotalPolicyCostCalculator::getWorkerLogSuffix( const string& aJobFile ){
+    return aJobFile + ".log";
+}
+
+/*! \brief Run the trials concurrently in worker processes.
+* \details A job file is written for each trial which holds the scenario name
+*          and scenario components of the initial scenario, the trial number,
+*          the tax curves and the solved prices of the initial scenario. A new instance of the
+*          model executable is started for each job which runs the trial with
+*          runWorker and writes the resulting curves to a file which is read
+*          back once the worker has exited. The curves and worker logs are
+*          collected by point number so the result is the same regardless of
+*          the order in which workers complete. The scenario in this process is
+*          not modified.
+* \param aNumWorkers The maximum number of worker processes to run at once.
+* \return Whether all model runs completed successfully and returned results.
+*/
+bool TotalPolicyCostCalculator::runTrialsInWorkers( const int aNumWorkers ){
+#if !defined(_MSC_VER)
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    bool success = true;
+
+    // Write the job for each point.
+    const Scenario* initialScenario = mSingleScenario->getInternalScenario();
+    const list<string>& scenComponents = mSingleScenario->getScenarioComponents();
+    for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
+        ofstream job( getWorkerFileName( getpid(), currPoint ).c_str() );
+        job << initialScenario->getName() << endl
+            << currPoint << endl
+            << scenComponents.size() << endl;
+        for( list<string>::const_iterator currComp = scenComponents.begin(); currComp != scenComponents.end(); ++currComp ){
+            job << *currComp << endl;
+        }
+        writeCurves( job, mEmissionsTCurves[ mNumPoints ] );
+        initialScenario->getMarketplace()->writePricesForCostCalculation( job );
+    }
+
+    map<pid_t, int> runningPoints;
+    int nextPoint = mNumPoints - 1;
+    while( nextPoint >= 0 || !runningPoints.empty() ){
+        while( nextPoint >= 0 && runningPoints.size() < static_cast<size_t>( aNumWorkers ) ){
+            // Build the arguments before forking so that the new process only
+            // needs to replace itself with the worker.
+            vector<string> args( sWorkerCommand );
+            args.push_back( "-W" );
+            args.push_back( getWorkerFileName( getpid(), nextPoint ) );
+            vector<char*> argv;
+            for( vector<string>::iterator arg = args.begin(); arg != args.end(); ++arg ){
+                argv.push_back( &( *arg )[ 0 ] );
+            }
+            argv.push_back( 0 );
+
+            const pid_t pid = fork();
+            if( pid == 0 ){
+                execvp( argv[ 0 ], &argv[ 0 ] );
+                _exit( 127 );
+            }
+            else if( pid < 0 ){
+                mainLog.setLevel( ILogger::SEVERE );
+                mainLog << "Could not create a worker process for cost curve point "
+                        << nextPoint << "." << endl;
+                success = false;
+            }
+            else {
+                runningPoints[ pid ] = nextPoint;
+            }
+            --nextPoint;
+        }
+
+        if( !runningPoints.empty() ){
+            int status = 0;
+            const pid_t pid = wait( &status );
+            map<pid_t, int>::iterator finishedPoint = runningPoints.find( pid );
+            if( finishedPoint != runningPoints.end() ){
+                success &= WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+                runningPoints.erase( finishedPoint );
+            }
+        }
+    }
+
+    // Collect the logs and curves in point order.
+    for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
+        const string jobFileName = getWorkerFileName( getpid(), currPoint );
+        const string resultFileName = jobFileName + ".result";
+        LoggerFactory::appendRedirectedFiles( getWorkerLogSuffix( jobFileName ) );
+
+        ifstream in( resultFileName.c_str() );
+        if( !readCurves( in, mEmissionsQCurves[ currPoint ] ) ||
+            !readCurves( in, mEmissionsTCurves[ currPoint ] ) )
+        {
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Cost curve point run number " << currPoint
+                    << " did not return results." << endl;
+            success = false;
+        }
+        in.close();
+        remove( resultFileName.c_str() );
+        remove( jobFileName.c_str() );
+    }
+    return success;
+#else
+    return false;
+#endif
+}
+
+/*! \brief Run a single trial as a worker process.
+* \details Reads the job written by runTrialsInWorkers, sets up the initial
+*          scenario from the configuration and the scenario components in the
+*          job, sets the solved prices of the initial scenario so that the
+*          trial starts from the same prices as in a serial run, runs the trial and writes the resulting curves for the process
+*          which started the worker.
+* \param aJobFile The job file to run.
+* \param aTimer The timer used to print out the amount of time spent
+*        performing operations.
+* \return Whether the trial ran successfully and the results were written.
+*/
+bool TotalPolicyCostCalculator::runWorker( const string& aJobFile, Timer& aTimer ){
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    auto_ptr<SingleScenarioRunner> runner = ScenarioRunnerFactory::createSingleScenarioRunner();
+    TotalPolicyCostCalculator calculator( runner.get() );
+    calculator.mEmissionsQCurves.resize( calculator.mNumPoints + 1 );
+    calculator.mEmissionsTCurves.resize( calculator.mNumPoints + 1 );
+
+    ifstream job( aJobFile.c_str() );
+    string scenarioName;
+    int point = -1;
+    size_t numComponents = 0;
+    getline( job, scenarioName );
+    job >> point >> numComponents >> ws;
+    list<string> scenComponents;
+    for( size_t i = 0; i < numComponents && job; ++i ){
+        string component;
+        getline( job, component );
+        scenComponents.push_back( component );
+    }
+    if( !job || point < 0 || point >= static_cast<int>( calculator.mNumPoints ) ||
+        !readCurves( job, calculator.mEmissionsTCurves[ calculator.mNumPoints ] ) )
+    {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Could not read cost curve worker job " << aJobFile << "." << endl;
+        return false;
+    }
+
+    if( !runner->setupScenarios( aTimer, "", scenComponents ) ){
+        return false;
+    }
+    runner->getInternalScenario()->setName( scenarioName );
+    if( !runner->getInternalScenario()->getMarketplace()->readPricesForCostCalculation( job ) ){
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Could not read the initial scenario prices from cost curve worker job "
+                << aJobFile << "." << endl;
+        return false;
+    }
+
+    const bool success = calculator.runTrial( point );
+    ofstream out( ( aJobFile + ".result" ).c_str() );
+    writeCurves( out, calculator.mEmissionsQCurves[ point ] );
+    writeCurves( out, calculator.mEmissionsTCurves[ point ] );
+    out.close();
+    return success && out;
+}
+
+/*! \brief Check that the curves for every trial are available.
+* \return Whether every trial has a curve for each region in the initial
+*         scenario.
+*/
+bool TotalPolicyCostCalculator::hasAllTrialCurves() const {
+    for( unsigned int currPoint = 0; currPoint < mNumPoints; ++currPoint ){
+        if( mEmissionsQCurves[ currPoint ].size() != mEmissionsQCurves[ mNumPoints ].size() ||
+            mEmissionsTCurves[ currPoint ].size() != mEmissionsTCurves[ mNumPoints ].size() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! \brief Get the name of the job file for a worker.
+* \details The file the worker writes its results to and the suffix of its log
+*          files are derived from this name.
+* \param aParentID The process ID of the process which created the worker.
+* \param aPoint The point number run by the worker.
+* \return The file name.
+*/
+string TotalPolicyCostCalculator::getWorkerFileName( const int aParentID, const int aPoint ){
+    stringstream fileName;
+    fileName << ".cost-curve-point-" << aParentID << "-" << aPoint;
+    return fileName.str();
+}
+
+/*! \brief Write a set of regional curves so they can be read by readCurves.
+* \details The points are written with enough precision to be read back
+*          exactly.
+* \param aOut The stream to write to.
+* \param aCurves The curves by region to write.
+*/
+void TotalPolicyCostCalculator::writeCurves( ostream& aOut, const RegionCurves& aCurves ){
+    aOut.precision( numeric_limits<double>::max_digits10 );
+    aOut << aCurves.size() << endl;
+    for( CRegionCurvesIterator rIter = aCurves.begin(); rIter != aCurves.end(); ++rIter ){
+        aOut << rIter->first << endl
+             << rIter->second->getTitle() << endl
+             << rIter->second->getXAxisLabel() << endl
+             << rIter->second->getYAxisLabel() << endl;
+        const Curve::SortedPairVector points = rIter->second->getSortedPairs();
+        aOut << points.size();
+        for( Curve::SortedPairVector::const_iterator point = points.begin(); point != points.end(); ++point ){
+            aOut << ' ' << point->first << ' ' << point->second;
+        }
+        aOut << endl;
+    }
+}
+
+/*! \brief Read a set of regional curves written by writeCurves.
+* \details The curves are only added if the whole set was read.
+* \note The user is responsible for deallocating the memory in the returned
+*       Curves.
+* \param aIn The stream to read from.
+* \param aCurves The curves by region to add the curves read to.
+* \return Whether the curves were read.
+*/
+bool TotalPolicyCostCalculator::readCurves( istream& aIn, RegionCurves& aCurves ){
+    boost::ptr_map<string, Curve> curves;
+    size_t numCurves = 0;
+    aIn >> numCurves;
+    for( size_t curveIndex = 0; curveIndex < numCurves && aIn; ++curveIndex ){
+        string region;
+        string title;
+        string xLabel;
+        string yLabel;
+        aIn >> ws;
+        getline( aIn, region );
+        getline( aIn, title );
+        getline( aIn, xLabel );
+        getline( aIn, yLabel );
+        size_t numPoints = 0;
+        aIn >> numPoints;
+        auto_ptr<ExplicitPointSet> points( new ExplicitPointSet() );
+        for( size_t pointIndex = 0; pointIndex < numPoints && aIn; ++pointIndex ){
+            double x = 0;
+            double y = 0;
+            aIn >> x >> y;
+            points->addPoint( new XYDataPoint( x, y ) );
+        }
+        auto_ptr<Curve> curve( new PointSetCurve( points.release() ) );
+        curve->setTitle( title );
+        curve->setXAxisLabel( xLabel );
+        curve->setYAxisLabel( yLabel );
+        curves.insert( region, curve.release() );
+    }
+    if( !aIn ){
+        return false;
+    }
+
+    // Hand the curves over to the caller.
+    while( !curves.empty() ){
+        const string region = curves.begin()->first;
+        aCurves[ region ] = curves.release( curves.begin() ).release();
+    }
+    return true;
+}
+
 /*! \brief Create a cost curve for each period and region.
 * \details Using the cost curves generated by the trials, generate and stored a set of cost
 * curves by period and region.
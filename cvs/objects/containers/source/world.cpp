@@ -45,6 +45,7 @@
 #include <cassert>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
@@ -70,6 +71,7 @@
 #include "climate/include/magicc_model.h"
 #include "climate/include/hector_model.hpp"
 #include "climate/include/no_climate_model.h"
+#include "climate/include/deferred_climate_model.h"
 #include "emissions/include/emissions_summer.h"
 #include "emissions/include/luc_emissions_summer.h"
 #include "technologies/include/global_technology_database.h"
@@ -98,6 +100,11 @@ extern Scenario* scenario;
 World::World()
 {
     mClimateModel = 0;
+    mDeferredClimateModel = 0;
+#if GCAM_PARALLEL_ENABLED
+    mIsClimateModelAsync = false;
+    mClimateModelRunPeriod = -1;
+#endif
     mCalcCounter = new CalcCounter();
     mGlobalTechDB = new GlobalTechnologyDatabase();
 }
@@ -109,9 +116,12 @@ World::~World(){
 
 //! Helper member function for the destructor. Performs memory deallocation. 
 void World::clear(){
+    // Make sure the climate model is not still running before deleting it.
+    waitForClimateModel();
     for ( RegionIterator regionIter = mRegions.begin(); regionIter != mRegions.end(); regionIter++ ) {
         delete *regionIter;
     }
+    delete mDeferredClimateModel;
     delete mClimateModel;
     delete mCalcCounter;
     delete mGlobalTechDB;
@@ -173,6 +183,13 @@ void World::completeInit() {
     
     // Initialize Climate Model
     mClimateModel->completeInit( scenario->getName() );
+    mClimateModelTimes.assign( scenario->getModeltime()->getmaxper(), 0.0 );
+#if GCAM_PARALLEL_ENABLED
+    mIsClimateModelAsync = Configuration::getInstance()->getBool( "async-climate-model", false, false );
+    if( mIsClimateModelAsync && !mDeferredClimateModel ) {
+        mDeferredClimateModel = new DeferredClimateModel( this, mClimateModel );
+    }
+#endif
     
     // Finish initializing all the regions.
     for( RegionIterator regionIter = mRegions.begin(); regionIter != mRegions.end(); regionIter++ ) {
@@ -185,6 +202,7 @@ void World::completeInit() {
     MarketDependencyFinder* depFinder = scenario->getMarketplace()->getDependencyFinder();
     depFinder->createOrdering();
     mGlobalOrdering = depFinder->getOrdering();
+    scenario->getMarketplace()->registerActivities( mGlobalOrdering );
 #if GCAM_PARALLEL_ENABLED
     Timer &totalgraphtimer = TimerRegistry::getInstance().getTimer("total-graph");
     totalgraphtimer.start();
@@ -278,6 +296,11 @@ void World::initCalc( const int period ) {
         }
     }
     
+    // The climate model has not yet been run through this period.
+    if( period < static_cast<int>( mClimateModelTimes.size() ) ) {
+        mClimateModelTimes[ period ] = 0.0;
+    }
+
     // Reset the calc counter.
     mCalcCounter->startNewPeriod();
 #if GCAM_PARALLEL_ENABLED
@@ -315,15 +338,40 @@ void World::calc( const int aPeriod, const std::vector<IActivity*>& aItemsToCalc
     // Increment the world.calc count based on the number of items to solve. 
     mCalcCounter->incrementCount( static_cast<double>( aItemsToCalc.size() ) / static_cast<double>( mGlobalOrdering.size() ) );
     
-    // Perform calculation on each item to calculate. 
+    // Perform calculation on each item to calculate.  Let the markets know which
+    // activity is calculating so that they can register the contributors that
+    // are to be accumulated in order during parallel calculations.
+    Marketplace* marketplace = scenario->getMarketplace();
     for( vector<IActivity*>::const_iterator it = aItemsToCalc.begin(); it != aItemsToCalc.end(); ++it ) {
+        marketplace->setCurrentActivity( *it );
         (*it)->calc( aPeriod );
     }
+    marketplace->setCurrentActivity( 0 );
 #ifdef GNU_SOURCE
     feenableexcept(except);
 #endif
 }
 
+/*!
+ * \brief Put the given activities into the global calculation order.
+ * \details Duplicates are removed so that this can be used to merge the
+ *          calculation lists of several markets into a single list suitable
+ *          to pass to calc.
+ * \param aActivities The activities to order, in any order.
+ * \return The unique activities from aActivities in global calculation order.
+ */
+vector<IActivity*> World::getGlobalOrdering( const vector<IActivity*>& aActivities ) const {
+    set<IActivity*> toInclude( aActivities.begin(), aActivities.end() );
+    vector<IActivity*> ret;
+    ret.reserve( toInclude.size() );
+    for( vector<IActivity*>::const_iterator it = mGlobalOrdering.begin(); it != mGlobalOrdering.end() && ret.size() < toInclude.size(); ++it ) {
+        if( toInclude.find( *it ) != toInclude.end() ) {
+            ret.push_back( *it );
+        }
+    }
+    return ret;
+}
+
 #if GCAM_PARALLEL_ENABLED
 /*! Calculate supply, demand, and emissions for a single time period
  * \details This version of calc uses the TBB Flow Graph to do the calculation in
@@ -351,9 +399,22 @@ void World::calc( const int aPeriod, GcamFlowGraph *aWorkGraph, const vector<IAc
         aWorkGraph = mTBBGraphGlobal;
     }
 
-    // do the model calculation
+    // do the model calculation, accumulating supplies and demands per activity
+    // so that the result is independent of thread scheduling
+    Marketplace* marketplace = scenario->getMarketplace();
+    const bool isOrdered = marketplace->beginOrderedAccumulation();
     aWorkGraph->mHead.try_put( tbb::flow::continue_msg() );
     aWorkGraph->mTBBFlowGraph.wait_for_all();
+    if( isOrdered && !marketplace->endOrderedAccumulation( aPeriod ) ) {
+        // Some activity contributed to a market it had not contributed to in
+        // any serial calculation this period.  Repeat the calculation in serial
+        // which registers it so that the result is still independent of thread
+        // scheduling.
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::DEBUG );
+        mainLog << "Repeating calculation in serial to register new contributions to markets." << endl;
+        calc( aPeriod, aCalcList ? *aCalcList : mGlobalOrdering );
+    }
 
 #ifdef GNU_SOURCE
     feenableexcept(except);
@@ -365,6 +426,9 @@ void World::calc( const int aPeriod, GcamFlowGraph *aWorkGraph, const vector<IAc
 /*! Calculates the global emissions.
  */
 void World::setEmissions( int period ) {
+    // The climate model must not be running while its emissions are changed.
+    waitForClimateModel();
+
     // Declare visitors which will aggregate emissions by period.
     EmissionsSummer co2Summer( "CO2" );
     LUCEmissionsSummer co2LandUseSummer( "CO2NetLandUse" );
@@ -647,13 +711,93 @@ void World::runClimateModel() {
     }
     
     // Run the model.
+    Timer& climateTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::CLIMATE_MODEL );
+    climateTimer.start();
     mClimateModel->runModel();
+    climateTimer.stop();
 }
 
+/*!
+ * \brief Run the climate model through the given period.
+ * \details The emissions for the period are always passed to the climate model
+ *          before returning.  If async-climate-model is configured the climate
+ *          model itself is then run on a separate thread so that the next
+ *          period may be solved at the same time.  The climate model only reads
+ *          the emissions it has been given so the results are the same as
+ *          running it directly.  Anything which accesses the climate model
+ *          through this class will first wait for the run to finish.
+ * \param aPeriod The period to run the climate model through.
+ */
 void World::runClimateModel( int aPeriod ) {
     if( aPeriod > 0 ) {
         setEmissions( aPeriod );
-        mClimateModel->runModel( scenario->getModeltime()->getper_to_yr( aPeriod ) );
+        const int year = scenario->getModeltime()->getper_to_yr( aPeriod );
+#if GCAM_PARALLEL_ENABLED
+        if( mIsClimateModelAsync ) {
+            // Use a dedicated thread rather than a TBB task so that a solver
+            // worker waiting on its own tasks never picks up the long running
+            // climate model.
+            // The run is timed on its own thread and the time added to the
+            // climate model timer once it is joined.
+            IClimateModel* climateModel = mClimateModel;
+            mClimateModelRunPeriod = aPeriod;
+            mClimateModelRun = std::async( std::launch::async, [climateModel, year]() {
+                Timer runTimer;
+                runTimer.start();
+                climateModel->runModel( year );
+                runTimer.stop();
+                return runTimer.getTotalTimeDifference();
+            } );
+            return;
+        }
+#endif
+        Timer runTimer;
+        runTimer.start();
+        mClimateModel->runModel( year );
+        runTimer.stop();
+        addClimateModelTime( aPeriod, runTimer.getTotalTimeDifference() );
+    }
+}
+
+/*!
+ * \brief Wait for a climate model run which was started in the background by
+ *        runClimateModel to finish.
+ * \details Returns immediately if no run is in progress.  Any exception thrown
+ *          during the run is rethrown here.  The time the run took is recorded
+ *          for the period it was run through.
+ */
+void World::waitForClimateModel() const {
+#if GCAM_PARALLEL_ENABLED
+    if( mClimateModelRun.valid() ) {
+        addClimateModelTime( mClimateModelRunPeriod, mClimateModelRun.get() );
+    }
+#endif
+}
+
+/*!
+ * \brief Get the time taken by the last climate model run through a period.
+ * \details Waits for any run in the background to finish so that its time is
+ *          included.
+ * \param aPeriod The model period.
+ * \return The run time in seconds, or zero if the climate model has not been
+ *         run through the period.
+ */
+double World::getClimateModelTime( const int aPeriod ) const {
+    waitForClimateModel();
+    return aPeriod < static_cast<int>( mClimateModelTimes.size() ) ? mClimateModelTimes[ aPeriod ] : 0.0;
+}
+
+/*!
+ * \brief Record the time taken to run the climate model through a period.
+ * \details The time is also added to the climate model timer.  This is always
+ *          called from the main thread, after a background run has been joined.
+ * \param aPeriod The model period.
+ * \param aTime The run time in seconds.
+ */
+void World::addClimateModelTime( const int aPeriod, const double aTime ) const {
+    TimerRegistry::getInstance().getTimer( TimerRegistry::CLIMATE_MODEL ).addTime( aTime );
+    if( aPeriod < static_cast<int>( mClimateModelTimes.size() ) ) {
+        mClimateModelTimes[ aPeriod ] = aTime;
     }
 }
 
@@ -697,6 +841,25 @@ bool World::isAllCalibrated( const int period, double calAccuracy, const bool pr
     return isAllCalibrated;
 }
 
+/*!
+ * \brief Write the energy balance table of each region for every period.
+ * \details Non-calibrated values are included so that the tables describe the
+ *          solved model rather than just the calibration data.
+ * \param aOut The stream to write to.
+ * \param aBinary Whether to write binary instead of CSV.
+ * \see EnergyBalanceTable::writeBulk
+ */
+void World::writeEnergyBalanceTables( ostream& aOut, const bool aBinary ) const {
+    const Modeltime* modeltime = scenario->getModeltime();
+    for( int period = 0; period < modeltime->getmaxper(); ++period ) {
+        for( CRegionIterator regionIt = mRegions.begin(); regionIt != mRegions.end(); ++regionIt ) {
+            EnergyBalanceTable table( (*regionIt)->getName(), aOut, false, true );
+            (*regionIt)->accept( &table, period );
+            table.writeBulk( aOut, modeltime->getper_to_yr( period ), aBinary );
+        }
+    }
+}
+
 /*! \brief This function returns a special mapping of strings to ints for use in
 *          the outputs. 
 * \details This map is created such that global maps to zero, region 0 maps to
@@ -730,9 +893,22 @@ void World::setTax( const GHGPolicy* aTax ){
 * \return The climate model.
 */
 const IClimateModel* World::getClimateModel() const {
+    // The results are not complete until any background run has finished.
+    waitForClimateModel();
     return mClimateModel;
 }
 
+/*!
+ * \brief Get the climate model to pass to model feedbacks.
+ * \details If the climate model may be running in the background this returns
+ *          a DeferredClimateModel so that a feedback only waits for the run if
+ *          it reads from the climate model.
+ * \return The climate model.
+ */
+const IClimateModel* World::getDeferredClimateModel() const {
+    return mDeferredClimateModel ? mDeferredClimateModel : mClimateModel;
+}
+
 /*! \brief A function to generate a series of ghg emissions quantity curves based on an already performed model run.
 * \details This function used the information stored in it to create a series of curves, one for each region,
 * with each datapoint containing a time period and an amount of gas emissions.
@@ -820,7 +996,8 @@ void World::accept( IVisitor* aVisitor, const int aPeriod ) const {
     // Visit the marketplace
     scenario->getMarketplace()->accept( aVisitor, aPeriod );
 
-    // Visit the climate model.
+    // Visit the climate model once any background run has finished.
+    waitForClimateModel();
     mClimateModel->accept( aVisitor, aPeriod );
 
     // loop for regions
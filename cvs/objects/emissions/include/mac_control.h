@@ -118,6 +118,11 @@ protected:
     // DEFINE_VARIABLE( ARRAY, "tech-change", mTechChange, std::shared_ptr<objects::PeriodVector<double> > ),
     std::shared_ptr<objects::PeriodVector<double> > mTechChange;
 
+    //! Owns mMacCurve which is shared between copies, i.e. technology vintages,
+    //! until one of them parses changes to it.  mMacCurve is kept as a plain
+    //! pointer for GCAMFusion for the same reason as mTechChange.
+    std::shared_ptr<PointSetCurve> mMacCurveOwner;
+
 private:
     void copy( const MACControl& other );
     double getMACValue( const double aCarbonPrice ) const;
@@ -71,13 +71,14 @@ mZeroCostPhaseInTime( 25 ),
 mMacPhaseInTime( 0 ),
 mCovertPriceValue( 1 ),
 mPriceMarketName( "CO2" ),
-mMacCurve( new PointSetCurve( new ExplicitPointSet() ) )
+mMacCurve( new PointSetCurve( new ExplicitPointSet() ) ),
+mMacCurveOwner( mMacCurve )
 {
 }
 
 //! Default destructor.
 MACControl::~MACControl(){
-    delete mMacCurve;
+    // mMacCurve is deleted by mMacCurveOwner
 }
 
 //! Copy constructor.
@@ -95,9 +96,8 @@ MACControl* MACControl::clone() const {
 //! Assignment operator.
 MACControl& MACControl::operator=( const MACControl& aOther ){
     if( this != &aOther ){
-        // Free memory before copying.  Since this is just a single
-        // variable I am just deleting it directly here.
-        delete mMacCurve;
+        // Release our reference to the curve before copying.
+        mMacCurveOwner.reset();
         mMacCurve = 0;
         AEmissionsControl::operator=( aOther );
         copy( aOther );
@@ -111,7 +111,10 @@ void MACControl::copy( const MACControl& aOther ){
      * \pre mMacCurve should be null otherwise we have a memory leak.
      */
     assert( !mMacCurve );
-    mMacCurve = aOther.mMacCurve->clone();
+    // The curve is not modified after parsing so share it rather than clone,
+    // see XMLDerivedClassParse.
+    mMacCurveOwner = aOther.mMacCurveOwner;
+    mMacCurve = aOther.mMacCurve;
     mNoZeroCostReductions = aOther.mNoZeroCostReductions;
     mTechChange = aOther.mTechChange;
     mFullPhaseInPrice = aOther.mFullPhaseInPrice;
@@ -144,6 +147,11 @@ bool MACControl::XMLDerivedClassParse( const string& aNodeName, const DOMNode* a
         double taxVal = XMLHelper<double>::getAttr( aCurrNode, "tax" );
         double reductionVal = XMLHelper<double>::getValue( aCurrNode );
         XYDataPoint* currPoint = new XYDataPoint( taxVal, reductionVal );
+        // Copy on write if the curve is shared with another vintage.
+        if( mMacCurveOwner.use_count() > 1 ) {
+            mMacCurveOwner.reset( mMacCurve->clone() );
+            mMacCurve = mMacCurveOwner.get();
+        }
         mMacCurve->getPointSet()->addPoint( currPoint );
     }
     else if ( aNodeName == "no-zero-cost-reductions" ){
@@ -203,6 +211,12 @@ void MACControl::completeInit( const string& aRegionName, const string& aSectorN
         mainLog.setLevel( ILogger::WARNING );
         mainLog << "MAC Curve " << getName() << " appears to have no data. " << endl;
     }
+
+    // The curve is evaluated each time emissions are calculated so build the
+    // flat lookup table now that it has been completely read in.  Note the
+    // curve may be shared with other vintages in which case it is simply
+    // rebuilt with the same points.
+    mMacCurve->compile( true );
 }
 
 void MACControl::initCalc( const string& aRegionName,
@@ -0,0 +1,419 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+* \file benchmark.cpp
+* \brief Stand alone benchmark harness for the model evaluation kernels.
+* \details Sets up a single scenario as gcam.exe would, runs it up to the
+*          period before the one requested (or loads the restart file for it
+*          if one is configured), and initializes the requested period.  The
+*          kernels that dominate solution time are then timed repeatedly:
+*          - full World::calc (serial, and with the flow graph if parallel)
+*          - a sample of partial World::calc for single market derivatives
+*          - fdjac, one column at a time and (if parallel) all at once
+*          - one iteration of the LogBroyden solver component
+*          - ManageStateVariables::copyState
+*          Summary statistics for each kernel are written in JSON or CSV so
+*          that results can be compared between versions and configurations.
+*/
+
+#include "util/base/include/definitions.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <ctime>
+
+#include <tbb/tick_count.h>
+
+#include "util/base/include/xml_helper.h"
+#include "util/base/include/configuration.h"
+#include "containers/include/scenario.h"
+#include "containers/include/single_scenario_runner.h"
+#include "containers/include/scenario_runner_factory.h"
+#include "containers/include/world.h"
+#include "marketplace/include/marketplace.h"
+#include "marketplace/include/market.h"
+#include "util/logger/include/ilogger.h"
+#include "util/logger/include/logger_factory.h"
+#include "util/base/include/timer.h"
+#include "util/base/include/version.h"
+#include "util/base/include/model_time.h"
+#include "util/base/include/manage_state_variables.hpp"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "solution/util/include/edfun.hpp"
+#include "solution/util/include/fdjac.hpp"
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/logbroyden.hpp"
+
+using namespace std;
+
+// The rest of the model expects these globals to exist.
+ofstream outFile;
+Scenario* scenario;
+
+namespace {
+    //! Options controlling a benchmark run.
+    struct BenchmarkOptions {
+        string mConfigurationFile;
+        string mLoggerFile;
+        string mOutputFile;
+        string mFormat;
+        int mPeriod;
+        int mRepetitions;
+        int mPartialSample;
+
+        BenchmarkOptions():mConfigurationFile( "configuration.xml" ), mLoggerFile( "log_conf.xml" ),
+            mFormat( "json" ), mPeriod( -1 ), mRepetitions( 10 ), mPartialSample( 20 ) {}
+    };
+
+    //! Summary statistics for the timings of a single kernel.
+    struct KernelResult {
+        string mName;
+        //! Number of model evaluations (World::calc or partial calc) per repetition.
+        int mEvalsPerRep;
+        vector<double> mSeconds;
+
+        double mean() const {
+            return accumulate( mSeconds.begin(), mSeconds.end(), 0.0 ) / mSeconds.size();
+        }
+        double stddev() const {
+            const double avg = mean();
+            double sum2 = 0.0;
+            for( double t : mSeconds ) {
+                sum2 += ( t - avg ) * ( t - avg );
+            }
+            return mSeconds.size() > 1 ? sqrt( sum2 / ( mSeconds.size() - 1 ) ) : 0.0;
+        }
+        double median() const {
+            vector<double> sorted( mSeconds );
+            sort( sorted.begin(), sorted.end() );
+            const size_t n = sorted.size();
+            return n % 2 == 1 ? sorted[ n / 2 ] : 0.5 * ( sorted[ n / 2 - 1 ] + sorted[ n / 2 ] );
+        }
+        double min() const {
+            return *min_element( mSeconds.begin(), mSeconds.end() );
+        }
+        double max() const {
+            return *max_element( mSeconds.begin(), mSeconds.end() );
+        }
+    };
+
+    /*!
+     * \brief Time a kernel repeatedly.
+     * \param aName Name to report for the kernel.
+     * \param aEvalsPerRep Model evaluations performed by each repetition.
+     * \param aReps Number of timed repetitions.
+     * \param aKernel The operation to time.
+     * \param aReset Operation to restore the model state after each repetition.
+     *               This is not included in the timing.
+     * \return The timings.
+     */
+    KernelResult timeKernel( const string& aName, const int aEvalsPerRep, const int aReps,
+                             const function<void()>& aKernel, const function<void()>& aReset )
+    {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Benchmarking " << aName << endl;
+
+        KernelResult result;
+        result.mName = aName;
+        result.mEvalsPerRep = aEvalsPerRep;
+        // One untimed repetition to warm up caches and lazily allocated structures.
+        aKernel();
+        aReset();
+        for( int rep = 0; rep < aReps; ++rep ) {
+            tbb::tick_count t0 = tbb::tick_count::now();
+            aKernel();
+            tbb::tick_count t1 = tbb::tick_count::now();
+            result.mSeconds.push_back( ( t1 - t0 ).seconds() );
+            aReset();
+        }
+        return result;
+    }
+
+    void writeJSON( ostream& aOut, const BenchmarkOptions& aOptions, const int aNumSolvable,
+                    const vector<KernelResult>& aResults )
+    {
+        aOut.precision( 9 );
+        aOut << "{\n"
+             << "  \"gcam-version\": \"" << __ObjECTS_VER__ << "\",\n"
+             << "  \"revision\": \"" << __REVISION_NUMBER__ << "\",\n"
+             << "  \"scenario\": \"" << scenario->getName() << "\",\n"
+             << "  \"period\": " << aOptions.mPeriod << ",\n"
+             << "  \"year\": " << scenario->getModeltime()->getper_to_yr( aOptions.mPeriod ) << ",\n"
+             << "  \"parallel\": " << ( GCAM_PARALLEL_ENABLED ? "true" : "false" ) << ",\n"
+             << "  \"solvable-markets\": " << aNumSolvable << ",\n"
+             << "  \"repetitions\": " << aOptions.mRepetitions << ",\n"
+             << "  \"timestamp\": " << time( 0 ) << ",\n"
+             << "  \"kernels\": [\n";
+        for( size_t i = 0; i < aResults.size(); ++i ) {
+            const KernelResult& res = aResults[ i ];
+            aOut << "    { \"name\": \"" << res.mName << "\", \"evals-per-rep\": " << res.mEvalsPerRep
+                 << ", \"mean\": " << res.mean() << ", \"median\": " << res.median()
+                 << ", \"stddev\": " << res.stddev() << ", \"min\": " << res.min()
+                 << ", \"max\": " << res.max() << ", \"samples\": [";
+            for( size_t j = 0; j < res.mSeconds.size(); ++j ) {
+                aOut << ( j == 0 ? "" : ", " ) << res.mSeconds[ j ];
+            }
+            aOut << "] }" << ( i + 1 < aResults.size() ? "," : "" ) << "\n";
+        }
+        aOut << "  ]\n}" << endl;
+    }
+
+    void writeCSV( ostream& aOut, const BenchmarkOptions& aOptions, const int aNumSolvable,
+                   const vector<KernelResult>& aResults )
+    {
+        aOut.precision( 9 );
+        aOut << "gcam-version,scenario,period,parallel,solvable-markets,kernel,evals-per-rep,repetitions,mean,median,stddev,min,max" << endl;
+        for( const KernelResult& res : aResults ) {
+            aOut << __ObjECTS_VER__ << "," << scenario->getName() << "," << aOptions.mPeriod << ","
+                 << GCAM_PARALLEL_ENABLED << "," << aNumSolvable << "," << res.mName << ","
+                 << res.mEvalsPerRep << "," << res.mSeconds.size() << "," << res.mean() << ","
+                 << res.median() << "," << res.stddev() << "," << res.min() << "," << res.max() << endl;
+        }
+    }
+
+    void printUsageMessage( char* argv[] ) {
+        cout << "Usage: " << argv[ 0 ] << " [-C configurationFileName] [-L loggerFactoryFileName]"
+             << " [-p period] [-n repetitions] [-s partialSampleSize] [-f json|csv] [-o outputFile]" << endl;
+    }
+
+    bool parseArgs( int argc, char* argv[], BenchmarkOptions& aOptions ) {
+        for( int i = 1; i < argc; i += 2 ) {
+            const string flag( argv[ i ] );
+            if( i + 1 == argc ) {
+                cout << "Not enough arguments" << endl;
+                return false;
+            }
+            const string value( argv[ i + 1 ] );
+            if( flag == "-C" ) {
+                aOptions.mConfigurationFile = value;
+            }
+            else if( flag == "-L" ) {
+                aOptions.mLoggerFile = value;
+            }
+            else if( flag == "-p" ) {
+                aOptions.mPeriod = atoi( value.c_str() );
+            }
+            else if( flag == "-n" ) {
+                aOptions.mRepetitions = max( atoi( value.c_str() ), 1 );
+            }
+            else if( flag == "-s" ) {
+                aOptions.mPartialSample = max( atoi( value.c_str() ), 1 );
+            }
+            else if( flag == "-f" && ( value == "json" || value == "csv" ) ) {
+                aOptions.mFormat = value;
+            }
+            else if( flag == "-o" ) {
+                aOptions.mOutputFile = value;
+            }
+            else {
+                cout << "Invalid argument: " << flag << " " << value << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+//! Benchmark program.
+int main( int argc, char *argv[] ) {
+    BenchmarkOptions options;
+    if( !parseArgs( argc, argv, options ) ) {
+        printUsageMessage( argv );
+        return 1;
+    }
+
+    Timer timer;
+    timer.start();
+
+    LoggerFactoryWrapper loggerFactoryWrapper;
+    if( !XMLHelper<void>::parseXML( options.mLoggerFile, &loggerFactoryWrapper ) ) {
+        return 1;
+    }
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+
+    Configuration* conf = Configuration::getInstance();
+    if( !XMLHelper<void>::parseXML( options.mConfigurationFile, conf ) ) {
+        return 1;
+    }
+
+    auto_ptr<SingleScenarioRunner> runner = ScenarioRunnerFactory::createSingleScenarioRunner();
+    if( !runner->setupScenarios( timer ) ) {
+        return 1;
+    }
+    XMLHelper<void>::cleanupParser();
+
+    // Note that the scenario runner sets the global scenario pointer.
+    const Modeltime* modeltime = scenario->getModeltime();
+    if( options.mPeriod < 0 ) {
+        options.mPeriod = min( modeltime->getFinalCalibrationPeriod() + 1, modeltime->getmaxper() - 1 );
+    }
+    if( options.mPeriod >= modeltime->getmaxper() ) {
+        cout << "Invalid period: " << options.mPeriod << endl;
+        return 1;
+    }
+    const int period = options.mPeriod;
+
+    // Bring the model up to the benchmark period.  If a restart file is configured
+    // for the preceding periods they will be loaded rather than solved.
+    if( period > 0 ) {
+        scenario->run( period - 1, false );
+    }
+    scenario->initPeriod( period );
+
+    World* world = scenario->getWorld();
+    Marketplace* marketplace = scenario->getMarketplace();
+    ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    world->calc( period );
+
+    // Use the solver defaults for tolerances.  These do not change the work
+    // done by any of the kernels.
+    SolutionInfoSet solnset( marketplace );
+    solnset.init( period, 0.001, 0.0001, scenario->getSolutionInfoParamParser() );
+    const int nsolv = solnset.getNumSolvable();
+    if( nsolv == 0 ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "No solvable markets in period " << period << ", nothing to benchmark." << endl;
+        return 1;
+    }
+
+    // Save the starting prices so that kernels which move them can be undone.
+    vector<Market*> allMarkets = marketplace->getMarketsToSolve( period );
+    vector<double> savedPrices;
+    for( const Market* market : allMarkets ) {
+        savedPrices.push_back( market->getRawPrice() );
+    }
+    auto resetState = [&]() {
+        for( size_t i = 0; i < allMarkets.size(); ++i ) {
+            allMarkets[ i ]->setRawPrice( savedPrices[ i ] );
+        }
+        marketplace->nullSuppliesAndDemands( period );
+        world->calc( period );
+    };
+    auto noReset = []() {};
+
+    LogEDFun F( solnset, world, marketplace, period, true );
+    UBVECTOR x( nsolv ), fx( nsolv );
+    vector<SolutionInfo> solvables( solnset.getSolvableSet() );
+    for( int i = 0; i < nsolv; ++i ) {
+        x[ i ] = log( max( solvables[ i ].getPrice(), util::getTinyNumber() ) );
+    }
+    F.scaleInitInputs( x );
+    F( x, fx );
+
+    // Pick an evenly spaced sample of markets for the partial derivative kernel.
+    const int nsample = min( options.mPartialSample, nsolv );
+    vector<int> sample;
+    for( int i = 0; i < nsample; ++i ) {
+        sample.push_back( ( i * nsolv ) / nsample );
+    }
+
+    vector<KernelResult> results;
+    const int reps = options.mRepetitions;
+
+    results.push_back( timeKernel( "world-calc-serial", 1, reps, [&]() {
+        marketplace->nullSuppliesAndDemands( period );
+        world->calc( period );
+    }, noReset ) );
+
+#if GCAM_PARALLEL_ENABLED
+    results.push_back( timeKernel( "world-calc-flow-graph", 1, reps, [&]() {
+        marketplace->nullSuppliesAndDemands( period );
+        world->calc( period, world->getGlobalFlowGraph() );
+    }, noReset ) );
+#endif
+
+    UBMATRIX J( nsolv, nsolv );
+    results.push_back( timeKernel( "partial-calc-sample", nsample, reps, [&]() {
+        stateVars->setPartialDeriv( true );
+        for( int j : sample ) {
+            jacol( F, x, fx, j, J, true );
+        }
+        F.partial( -1 );
+    }, noReset ) );
+
+    // The serial Jacobian is computed one column at a time on this thread, as
+    // fdjac does when GCAM_PARALLEL_ENABLED is off, so that it does not go
+    // through the thread pool at all.
+    results.push_back( timeKernel( "fdjac-serial", nsolv, reps, [&]() {
+        stateVars->setPartialDeriv( true );
+        fdjacserial( F, x, fx, J, true );
+        F.partial( -1 );
+    }, noReset ) );
+
+#if GCAM_PARALLEL_ENABLED
+    results.push_back( timeKernel( "fdjac-parallel", nsolv, reps, [&]() {
+        fdjac( F, x, fx, J, true );
+    }, noReset ) );
+#endif
+
+    // copyState resets the calling thread's scratch state from the base state,
+    // which is only a copy in partial derivative mode, as in fdjac.
+    stateVars->setPartialDeriv( true );
+    results.push_back( timeKernel( "copy-state", 0, reps, [&]() {
+        stateVars->copyState();
+    }, noReset ) );
+    F.partial( -1 );
+
+    // The Broyden solver always starts with a Jacobian so a single iteration
+    // includes one fdjac, any preconditioning, and one line search.
+    results.push_back( timeKernel( "logbroyden-iteration", nsolv + 2, reps, [&]() {
+        SolutionInfoSet broydenSet( marketplace );
+        broydenSet.init( period, 0.001, 0.0001, scenario->getSolutionInfoParamParser() );
+        LogBroyden broyden( marketplace, world, world->getCalcCounter(), 1 );
+        broyden.init();
+        broyden.solve( broydenSet, period );
+    }, resetState ) );
+
+    if( options.mOutputFile.empty() ) {
+        options.mFormat == "csv" ? writeCSV( cout, options, nsolv, results ) :
+                                   writeJSON( cout, options, nsolv, results );
+    }
+    else {
+        ofstream out( options.mOutputFile.c_str() );
+        options.mFormat == "csv" ? writeCSV( out, options, nsolv, results ) :
+                                   writeJSON( out, options, nsolv, results );
+    }
+
+    runner->cleanup();
+    return 0;
+}
@@ -0,0 +1,288 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+* \file hash_map_benchmark.cpp
+* \brief Stand alone micro-benchmark comparing HashMap implementations.
+* \details Replays a trace of the inserts and lookups made on every HashMap
+*          during a model run against both the open addressing HashMap and the
+*          chained implementation it replaced. A trace is recorded by building
+*          the model with HASH_MAP_TRACE set to 1 in hash_map.h and running a
+*          scenario, which writes hash-map-trace.txt in the working directory.
+*          Each line of the trace holds the address of the map, i for insert
+*          or f for find, and the key.  Summary statistics for each
+*          implementation are written in JSON or CSV.
+*/
+
+#include "util/base/include/definitions.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <cstdlib>
+
+#include "util/base/include/hash_map.h"
+#include "main/source/chained_hash_map.h"
+
+using namespace std;
+
+namespace {
+    //! Options controlling a benchmark run.
+    struct BenchmarkOptions {
+        string mTraceFile;
+        string mOutputFile;
+        string mFormat;
+        int mRepetitions;
+
+        BenchmarkOptions():mTraceFile( "hash-map-trace.txt" ), mFormat( "json" ), mRepetitions( 10 ) {}
+    };
+
+    //! A single operation from the trace.
+    struct TraceOperation {
+        //! Index of the map the operation was made on.
+        size_t mMap;
+        //! Whether the operation was an insert rather than a find.
+        bool mIsInsert;
+        string mKey;
+    };
+
+    //! Summary statistics for the timings of a single implementation.
+    struct ReplayResult {
+        string mName;
+        //! Number of successful finds, which must agree between implementations.
+        size_t mHits;
+        vector<double> mSeconds;
+
+        double mean() const {
+            return accumulate( mSeconds.begin(), mSeconds.end(), 0.0 ) / mSeconds.size();
+        }
+        double median() const {
+            vector<double> sorted( mSeconds );
+            sort( sorted.begin(), sorted.end() );
+            const size_t n = sorted.size();
+            return n % 2 == 1 ? sorted[ n / 2 ] : 0.5 * ( sorted[ n / 2 - 1 ] + sorted[ n / 2 ] );
+        }
+        double min() const {
+            return *min_element( mSeconds.begin(), mSeconds.end() );
+        }
+        double max() const {
+            return *max_element( mSeconds.begin(), mSeconds.end() );
+        }
+    };
+
+    /*!
+     * \brief Read a trace written by HashMap when HASH_MAP_TRACE is on.
+     * \param aFileName The trace file.
+     * \param aOperations The operations read, with map addresses replaced by
+     *        indices.
+     * \return The number of distinct maps in the trace.
+     */
+    size_t readTrace( const string& aFileName, vector<TraceOperation>& aOperations ) {
+        ifstream traceFile( aFileName.c_str() );
+        if( !traceFile ) {
+            cout << "Could not open trace file: " << aFileName << endl;
+            return 0;
+        }
+        map<string, size_t> mapIndices;
+        string line;
+        while( getline( traceFile, line ) ) {
+            // The key is the remainder of the line after the map and operation
+            // since it may contain spaces.
+            const size_t opStart = line.find( ' ' );
+            if( opStart == string::npos || line.size() < opStart + 3 ) {
+                continue;
+            }
+            TraceOperation op;
+            const string mapAddress = line.substr( 0, opStart );
+            map<string, size_t>::const_iterator mapIter = mapIndices.find( mapAddress );
+            if( mapIter == mapIndices.end() ) {
+                mapIter = mapIndices.insert( make_pair( mapAddress, mapIndices.size() ) ).first;
+            }
+            op.mMap = mapIter->second;
+            op.mIsInsert = line[ opStart + 1 ] == 'i';
+            op.mKey = line.substr( opStart + 3 );
+            aOperations.push_back( op );
+        }
+        return mapIndices.size();
+    }
+
+    /*!
+     * \brief Replay the trace against a map implementation repeatedly.
+     * \details Fresh maps are created for each repetition so that the inserts
+     *          grow the maps just as they did in the model run.
+     * \param aName Name to report for the implementation.
+     * \param aOperations The trace.
+     * \param aNumMaps The number of distinct maps in the trace.
+     * \param aReps Number of timed repetitions.
+     * \return The timings.
+     */
+    template<class MapType>
+    ReplayResult replay( const string& aName, const vector<TraceOperation>& aOperations,
+                         const size_t aNumMaps, const int aReps )
+    {
+        ReplayResult result;
+        result.mName = aName;
+        result.mHits = 0;
+        // One untimed repetition to warm up caches.
+        for( int rep = 0; rep <= aReps; ++rep ) {
+            vector<MapType*> maps( aNumMaps );
+            for( size_t i = 0; i < aNumMaps; ++i ) {
+                maps[ i ] = new MapType();
+            }
+            size_t hits = 0;
+            chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+            for( vector<TraceOperation>::const_iterator op = aOperations.begin(); op != aOperations.end(); ++op ) {
+                MapType& currMap = *maps[ ( *op ).mMap ];
+                if( ( *op ).mIsInsert ) {
+                    currMap.insert( make_pair( ( *op ).mKey, hits ) );
+                }
+                else if( currMap.find( ( *op ).mKey ) != currMap.end() ) {
+                    ++hits;
+                }
+            }
+            chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+            if( rep > 0 ) {
+                result.mSeconds.push_back( chrono::duration<double>( t1 - t0 ).count() );
+            }
+            result.mHits = hits;
+            for( size_t i = 0; i < aNumMaps; ++i ) {
+                delete maps[ i ];
+            }
+        }
+        return result;
+    }
+
+    void writeJSON( ostream& aOut, const BenchmarkOptions& aOptions, const size_t aNumOperations,
+                    const size_t aNumMaps, const vector<ReplayResult>& aResults )
+    {
+        aOut.precision( 9 );
+        aOut << "{\n"
+             << "  \"trace\": \"" << aOptions.mTraceFile << "\",\n"
+             << "  \"operations\": " << aNumOperations << ",\n"
+             << "  \"maps\": " << aNumMaps << ",\n"
+             << "  \"repetitions\": " << aOptions.mRepetitions << ",\n"
+             << "  \"implementations\": [\n";
+        for( size_t i = 0; i < aResults.size(); ++i ) {
+            const ReplayResult& res = aResults[ i ];
+            aOut << "    { \"name\": \"" << res.mName << "\", \"hits\": " << res.mHits
+                 << ", \"mean\": " << res.mean() << ", \"median\": " << res.median()
+                 << ", \"min\": " << res.min() << ", \"max\": " << res.max()
+                 << ", \"ns-per-op\": " << res.median() / aNumOperations * 1e9 << " }"
+                 << ( i + 1 < aResults.size() ? "," : "" ) << "\n";
+        }
+        aOut << "  ]\n}" << endl;
+    }
+
+    void writeCSV( ostream& aOut, const size_t aNumOperations, const vector<ReplayResult>& aResults ) {
+        aOut.precision( 9 );
+        aOut << "name,operations,hits,mean,median,min,max,ns-per-op" << endl;
+        for( size_t i = 0; i < aResults.size(); ++i ) {
+            const ReplayResult& res = aResults[ i ];
+            aOut << res.mName << ',' << aNumOperations << ',' << res.mHits << ',' << res.mean() << ','
+                 << res.median() << ',' << res.min() << ',' << res.max() << ','
+                 << res.median() / aNumOperations * 1e9 << endl;
+        }
+    }
+
+    void printUsageMessage( char* argv[] ) {
+        cout << "Usage: " << argv[ 0 ] << " [-t traceFile] [-n repetitions] [-f json|csv] [-o outputFile]" << endl;
+    }
+
+    bool parseArgs( int argc, char* argv[], BenchmarkOptions& aOptions ) {
+        for( int i = 1; i < argc; i += 2 ) {
+            const string flag( argv[ i ] );
+            if( i + 1 == argc ) {
+                cout << "Not enough arguments" << endl;
+                return false;
+            }
+            const string value( argv[ i + 1 ] );
+            if( flag == "-t" ) {
+                aOptions.mTraceFile = value;
+            }
+            else if( flag == "-n" ) {
+                aOptions.mRepetitions = max( atoi( value.c_str() ), 1 );
+            }
+            else if( flag == "-f" && ( value == "json" || value == "csv" ) ) {
+                aOptions.mFormat = value;
+            }
+            else if( flag == "-o" ) {
+                aOptions.mOutputFile = value;
+            }
+            else {
+                cout << "Invalid argument: " << flag << " " << value << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main( int argc, char *argv[] ) {
+    BenchmarkOptions options;
+    if( !parseArgs( argc, argv, options ) ) {
+        printUsageMessage( argv );
+        return 1;
+    }
+
+    vector<TraceOperation> operations;
+    const size_t numMaps = readTrace( options.mTraceFile, operations );
+    if( operations.empty() ) {
+        cout << "No operations found in trace file: " << options.mTraceFile << endl;
+        return 1;
+    }
+
+    vector<ReplayResult> results;
+    results.push_back( replay<HashMap<string, size_t> >( "open-addressing", operations, numMaps, options.mRepetitions ) );
+    results.push_back( replay<ChainedHashMap<string, size_t> >( "chained", operations, numMaps, options.mRepetitions ) );
+    if( results[ 0 ].mHits != results[ 1 ].mHits ) {
+        cout << "Warning: implementations disagree on the number of successful finds." << endl;
+    }
+
+    ofstream outFile;
+    if( !options.mOutputFile.empty() ) {
+        outFile.open( options.mOutputFile.c_str() );
+    }
+    ostream& out = outFile.is_open() ? static_cast<ostream&>( outFile ) : cout;
+    if( options.mFormat == "csv" ) {
+        writeCSV( out, operations.size(), results );
+    }
+    else {
+        writeJSON( out, options, operations.size(), numMaps, results );
+    }
+    return 0;
+}
@@ -71,6 +71,7 @@
 #include "containers/include/scenario.h"
 #include "containers/include/iscenario_runner.h"
 #include "containers/include/scenario_runner_factory.h"
+#include "containers/include/total_policy_cost_calculator.h"
 #include "util/logger/include/ilogger.h"
 #include "util/logger/include/logger_factory.h"
 #include "util/base/include/timer.h"
@@ -88,7 +89,7 @@ ofstream outFile;
 // Declared outside Main to make global.
 Scenario* scenario; // model scenario info
 
-void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg );
+void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg, string& workerArg );
 void printUsageMessage( unsigned int argc, char* argv[] );
 
 //! Main program. 
@@ -97,8 +98,9 @@ int main( int argc, char *argv[] ) {
     // identify default file names for control input and logging controls
     string configurationArg = "configuration.xml";
     string loggerFactoryArg = "log_conf.xml";
+    string workerArg;
     // Parse any command line arguments.  Can override defaults with command lone args
-    parseArgs( argc, argv, configurationArg, loggerFactoryArg );
+    parseArgs( argc, argv, configurationArg, loggerFactoryArg, workerArg );
 
     // Add OS dependent prefixes to the arguments.
     const string configurationFileName = configurationArg;
@@ -108,6 +110,12 @@ int main( int argc, char *argv[] ) {
     Timer timer;
     timer.start();
 
+    // A worker writes to its own log files so that it does not interleave
+    // messages with the process which started it.
+    if( !workerArg.empty() ) {
+        LoggerFactory::setFileSuffix( TotalPolicyCostCalculator::getWorkerLogSuffix( workerArg ) );
+    }
+
     // Initialize the LoggerFactory
     LoggerFactoryWrapper loggerFactoryWrapper;
     bool success = XMLHelper<void>::parseXML( loggerFileName, &loggerFactoryWrapper );
@@ -171,6 +179,17 @@ int main( int argc, char *argv[] ) {
         return 1;
     }
 
+    // Run a single cost curve trial if this process was started as a worker.
+    if( !workerArg.empty() ) {
+        success = TotalPolicyCostCalculator::runWorker( workerArg, timer );
+        XMLHelper<void>::cleanupParser();
+        return success ? 0 : 1;
+    }
+
+    // Allow cost curve trials to be run in worker processes started with the
+    // same configuration.
+    TotalPolicyCostCalculator::setWorkerCommand( argv[ 0 ], configurationFileName, loggerFileName );
+
     // Create an empty exclusion list so that any type of IScenarioRunner can be
     // created.
     list<string> exclusionList;
@@ -215,9 +234,10 @@ int main( int argc, char *argv[] ) {
 * \param argv List of arguments.
 * \param confArg [out] Name of the configuration file.
 * \param logFacArg [out] Name of the log configuration file.
+* \param workerArg [out] Name of the job file if this process is a worker.
 * \todo Allow a space between the flags and the file names.
 */
-void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg ) {
+void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFacArg, string& workerArg ) {
     for( unsigned int i = 1; i < argc; ){
         string temp( argv[ i ] );
         if( temp == "-C" ) {
@@ -246,6 +266,15 @@ void parseArgs( unsigned int argc, char* argv[], string& confArg, string& logFac
             logFacArg = temp.substr( 2, temp.length() );
             ++i;
         }
+        else if( temp == "-W" ) {
+            if( ( i + 1 ) == argc ) {
+                cout << "Not enough arguments" << endl;
+                printUsageMessage( argc, argv );
+                abort();
+            }
+            workerArg = string( argv[ i + 1 ] );
+            i += 2;
+        }
         else if( temp == "--version" ) {
             cout << "GCAM version " << __ObjECTS_VER__ << " Revision: " << __REVISION_NUMBER__ << endl;
             exit( 0 );
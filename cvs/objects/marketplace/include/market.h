@@ -147,6 +147,9 @@ public:
     double getRawSupply() const;
     virtual double getSupply() const;
     virtual void addToSupply( const double supplyIn );
+    void reduceContributions();
+    void discardContributions();
+    void clearContributionSlots();
     
     const std::string& getName() const;
     const std::string& getRegionName() const;
@@ -221,12 +224,26 @@ protected:
     )
     
 #if GCAM_PARALLEL_ENABLED
+    //! Contributions to demand accumulated during a parallel World::calc, one
+    //! slot per contributing activity in the order they were registered.
+    std::vector<double> mDemandSlots;
+
+    //! Contributions to supply accumulated during a parallel World::calc, one
+    //! slot per contributing activity in the order they were registered.
+    std::vector<double> mSupplySlots;
+
     typedef tbb::speculative_spin_rw_mutex Mutex;
-    //! A fast lock to protect conccurent adds to demand.
+    //! A fast lock to protect the demand slots while they are written and read
+    //! concurrently during a parallel World::calc.
     mutable Mutex mDemandMutex;
-    
-    //! A fast lock to protect concurrent adds to supply.
+
+    //! A fast lock to protect the supply slots while they are written and read
+    //! concurrently during a parallel World::calc.
     mutable Mutex mSupplyMutex;
+
+    bool addToContributionSlot( const bool aIsSupply, const double aValue );
+    static double sumContributionSlots( const Value& aTotal, const std::vector<double>& aSlots,
+                                        Mutex& aMutex );
 #endif
     
     //! Object containing information related to the market.
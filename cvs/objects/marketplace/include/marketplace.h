@@ -48,6 +48,8 @@
 #include <iosfwd>
 #include <string>
 #include <memory>
+#include <map>
+#include <atomic>
 #include <boost/core/noncopyable.hpp>
 
 #include "marketplace/include/imarket_type.h"
@@ -130,6 +132,8 @@ namespace objects {
  *       items.
  */
 
+class IActivity;
+
 class Marketplace: public IVisitable, private boost::noncopyable
 {
     friend class Market;
@@ -170,6 +174,7 @@ public:
         const int period ) const;
 
     void init_to_last( const int period );
+    void logPricePrediction( const int aPeriod );
     int resetToPriceMarket( const int aMarketNumber );
     void setMarketToSolve( const std::string& goodName, const std::string& regionName,
         const int period );
@@ -192,11 +197,44 @@ public:
     
     //! The price to return if no market exists.
     const static double NO_MARKET_PRICE;
+
+    //! The market info key under which the solver leaves the derivative of
+    //! excess demand with respect to log price for the price prediction.
+    const static std::string LOG_PRICE_DERIVATIVE_KEY;
     
     void store_prices_for_cost_calculation();
     void restore_prices_for_cost_calculation();
+    void writePricesForCostCalculation( std::ostream& aOut ) const;
+    bool readPricesForCostCalculation( std::istream& aIn );
     
     MarketDependencyFinder* getDependencyFinder() const;
+    void setIsDerivativeCalc( const bool aIsDerivativeCalc );
+
+    /*!
+     * \brief The slot an activity was given in a market to which it contributes
+     *        supply or demand.
+     * \sa Market::addToContributionSlot
+     */
+    struct ContributionSlot {
+        //! The market contributed to.
+        const Market* mMarket;
+
+        //! Whether the contribution is to supply rather than demand.
+        bool mIsSupply;
+
+        //! The index of the slot in the market's supply or demand slots.
+        int mIndex;
+    };
+
+    //! All of the slots given to a single activity.
+    typedef std::vector<ContributionSlot> ContributionList;
+
+    void registerActivities( const std::vector<IActivity*>& aActivities );
+    ContributionList* getContributionList( const IActivity* aActivity );
+    void setCurrentActivity( const IActivity* aActivity );
+    static void setCurrentContributions( ContributionList* aContributions );
+    bool beginOrderedAccumulation();
+    bool endOrderedAccumulation( const int aPeriod );
 
     // The methods from here down are diagnostics
     std::vector<double> fullstate( int period ) const; //!< Return all supplies and demands in all markets in a single vector
@@ -225,6 +263,32 @@ protected:
     
     //! Flag indicating whether the next call to world->calc() will be part of a partial derivative calculation 
     static bool mIsDerivativeCalc;
+
+    //! Flag indicating that a parallel world->calc() is in progress and markets
+    //! should accumulate supplies and demands per activity (see Market::reduceContributions)
+    static bool mIsOrderedAccumulation;
+
+    //! Flag set if an activity contributed to a market in which it had no slot
+    //! during a parallel world->calc(), in which case the calculation is repeated
+    //! in serial.
+    static std::atomic<bool> mHasUnregisteredContribution;
+
+    //! The contribution slots of the activity currently being calculated on
+    //! this thread, if any.
+    static thread_local ContributionList* mCurrentContributions;
+
+    //! The contribution slots of every activity in the global ordering.
+    std::map<const IActivity*, ContributionList> mActivityContributions;
+
+    //! Number of markets whose starting price came from the price prediction
+    //! in the last call to init_to_last.
+    int mNumPricePredictions;
+
+    //! Number of markets for which the price prediction failed its sanity
+    //! check and last period's price was used instead.
+    int mNumPredictionFallbacks;
+
+    double predictPrice( const int aMarketNumber, const int aPeriod );
 };
 
 #endif
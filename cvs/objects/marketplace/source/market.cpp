@@ -331,11 +331,11 @@ void Market::nullDemand() {
 */
 void Market::addToDemand( const double demandIn ) {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock writeLock( mDemandMutex, true );
+    if( Marketplace::mIsDerivativeCalc ) {
         mDemand += demandIn;
     }
-    else {
+    else if( !addToContributionSlot( false, demandIn ) ) {
+        Mutex::scoped_lock writeLock( mDemandMutex, true );
         mDemand += demandIn;
     }
 #else
@@ -352,13 +352,7 @@ void Market::addToDemand( const double demandIn ) {
 */
 double Market::getRawDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return sumContributionSlots( mDemand, mDemandSlots, mDemandMutex );
 #else
     return mDemand;
 #endif
@@ -373,13 +367,7 @@ double Market::getRawDemand() const {
  */
 double Market::getSolverDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return sumContributionSlots( mDemand, mDemandSlots, mDemandMutex );
 #else
     return mDemand;
 #endif
@@ -391,13 +379,7 @@ double Market::getSolverDemand() const {
 */
 double Market::getDemand() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mDemandMutex, false );
-        return mDemand;
-    }
-    else {
-        return mDemand;
-    }
+    return sumContributionSlots( mDemand, mDemandSlots, mDemandMutex );
 #else
     return mDemand;
 #endif
@@ -419,13 +401,7 @@ void Market::nullSupply() {
 */
 double Market::getRawSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return sumContributionSlots( mSupply, mSupplySlots, mSupplyMutex );
 #else
     return mSupply;
 #endif
@@ -441,13 +417,7 @@ double Market::getRawSupply() const {
 */
 double Market::getSolverSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return sumContributionSlots( mSupply, mSupplySlots, mSupplyMutex );
 #else
     return mSupply;
 #endif
@@ -459,13 +429,7 @@ double Market::getSolverSupply() const {
 */
 double Market::getSupply() const {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock readLock( mSupplyMutex, false );
-        return mSupply;
-    }
-    else {
-        return mSupply;
-    }
+    return sumContributionSlots( mSupply, mSupplySlots, mSupplyMutex );
 #else
     return mSupply;
 #endif
@@ -479,11 +443,11 @@ double Market::getSupply() const {
 */
 void Market::addToSupply( const double supplyIn ) {
 #if GCAM_PARALLEL_ENABLED
-    if( !Marketplace::mIsDerivativeCalc ) {
-        Mutex::scoped_lock writeLock( mSupplyMutex, true );
+    if( Marketplace::mIsDerivativeCalc ) {
         mSupply += supplyIn;
     }
-    else {
+    else if( !addToContributionSlot( true, supplyIn ) ) {
+        Mutex::scoped_lock writeLock( mSupplyMutex, true );
         mSupply += supplyIn;
     }
 #else
@@ -491,6 +455,125 @@ void Market::addToSupply( const double supplyIn ) {
 #endif
 }
 
+/*!
+ * \brief Sum the accumulated contributions from all activities into supply and
+ *        demand.
+ * \details This is called at the end of a parallel World::calc.  The slots are
+ *          summed in the order the activities were registered, which is the
+ *          global ordering, so the result does not depend on the order in which
+ *          threads happened to calculate the activities.
+ */
+void Market::reduceContributions() {
+#if GCAM_PARALLEL_ENABLED
+    for( double& slot : mDemandSlots ) {
+        mDemand += slot;
+        slot = 0.0;
+    }
+    for( double& slot : mSupplySlots ) {
+        mSupply += slot;
+        slot = 0.0;
+    }
+#endif
+}
+
+/*!
+ * \brief Throw away the contributions accumulated during a parallel World::calc
+ *        which will be repeated in serial.
+ * \details Supply and demand are left as they were before the calculation.
+ */
+void Market::discardContributions() {
+#if GCAM_PARALLEL_ENABLED
+    fill( mDemandSlots.begin(), mDemandSlots.end(), 0.0 );
+    fill( mSupplySlots.begin(), mSupplySlots.end(), 0.0 );
+#endif
+}
+
+/*!
+ * \brief Remove all contribution slots so that they can be registered again.
+ */
+void Market::clearContributionSlots() {
+#if GCAM_PARALLEL_ENABLED
+    mDemandSlots.clear();
+    mSupplySlots.clear();
+#endif
+}
+
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief Add a contribution from the currently calculating activity to its slot.
+ * \details During a serial calculation the activity is registered, if it has
+ *          not been already, so that it has a slot in subsequent parallel
+ *          calculations.  The value is not stored in the slot in that case.
+ *          During a parallel calculation the value is added to the activity's
+ *          slot.  Each slot is only ever written by a single activity, and so a
+ *          single thread, but it is written under the market's lock since an
+ *          activity which depends on the market may be summing the slots at the
+ *          same time.  The activity's own list
+ *          of slots is searched rather than the market's so that threads never
+ *          share any lookup structures.  If the activity has no slot the value
+ *          is dropped and Marketplace::endOrderedAccumulation will have the
+ *          calculation repeated in serial, which registers it.
+ * \param aIsSupply Whether the value is added to supply rather than demand.
+ * \param aValue The value to add.
+ * \return Whether the value was handled.  If not the caller must add it
+ *         directly.
+ */
+bool Market::addToContributionSlot( const bool aIsSupply, const double aValue ) {
+    Marketplace::ContributionList* contributions = Marketplace::mCurrentContributions;
+    if( !contributions ) {
+        return false;
+    }
+    for( const Marketplace::ContributionSlot& slot : *contributions ) {
+        if( slot.mMarket == this && slot.mIsSupply == aIsSupply ) {
+            if( !Marketplace::mIsOrderedAccumulation ) {
+                return false;
+            }
+            Mutex::scoped_lock writeLock( aIsSupply ? mSupplyMutex : mDemandMutex, true );
+            ( aIsSupply ? mSupplySlots : mDemandSlots )[ slot.mIndex ] += aValue;
+            return true;
+        }
+    }
+    if( Marketplace::mIsOrderedAccumulation ) {
+        Marketplace::mHasUnregisteredContribution = true;
+        return true;
+    }
+
+    // Serial calculation, register the activity.
+    vector<double>& slots = aIsSupply ? mSupplySlots : mDemandSlots;
+    Marketplace::ContributionSlot newSlot = { this, aIsSupply, static_cast<int>( slots.size() ) };
+    contributions->push_back( newSlot );
+    slots.push_back( 0.0 );
+    return false;
+}
+
+/*!
+ * \brief Add the contributions that have not yet been reduced to a supply or
+ *        demand total.
+ * \details Only parallel calculations leave contributions in the slots so
+ *          outside of those this is just the total.  During a parallel
+ *          calculation the slots are read under the market's lock since other
+ *          threads may be adding to them.  An activity which reads a market it
+ *          depends on in the flow graph, such as a supply sector reading its
+ *          demand, does so once all of the contributing activities are done, so
+ *          the sum does not depend on thread scheduling.
+ * \param aTotal The supply or demand already reduced.
+ * \param aSlots The supply or demand slots to sum.
+ * \param aMutex The lock which protects the total and the slots.
+ * \return The total plus the slots in registration order.
+ */
+double Market::sumContributionSlots( const Value& aTotal, const vector<double>& aSlots, Mutex& aMutex ) {
+    if( !Marketplace::mIsOrderedAccumulation ) {
+        return aTotal;
+    }
+    Mutex::scoped_lock readLock( aMutex, false );
+    double sum = aTotal;
+    for( double slot : aSlots ) {
+        sum += slot;
+    }
+    return sum;
+}
+#endif
+
 /*! \brief Return the market name.
  * \details This function returns the name of the market, as defined by region
  *          name plus good name.
@@ -42,6 +42,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <limits>
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/parallel_for.h>
@@ -69,7 +70,11 @@ using namespace std;
 
 extern Scenario* scenario;
 const double Marketplace::NO_MARKET_PRICE = util::getLargeNumber();
+const string Marketplace::LOG_PRICE_DERIVATIVE_KEY = "log-price-derivative";
 bool Marketplace::mIsDerivativeCalc = false;
+bool Marketplace::mIsOrderedAccumulation = false;
+std::atomic<bool> Marketplace::mHasUnregisteredContribution( false );
+thread_local Marketplace::ContributionList* Marketplace::mCurrentContributions = 0;
 
 /*! \brief Default constructor 
 *
@@ -80,7 +85,9 @@ bool Marketplace::mIsDerivativeCalc = false;
 */
 Marketplace::Marketplace():
 mMarketLocator( new MarketLocator() ),
-mDependencyFinder( new MarketDependencyFinder( this ) )
+mDependencyFinder( new MarketDependencyFinder( this ) ),
+mNumPricePredictions( 0 ),
+mNumPredictionFallbacks( 0 )
 {
 }
 
@@ -684,11 +691,22 @@ vector<Market*> Marketplace::getMarketsToSolve( const int period ) const {
  *          are calibrated prices and should not be reset. After calibration we
  *          attempt to use the trend in prices to forecast prices ( and demands )
  *          to come up with a good guess that would be closer to the solution.
- *          This only occurs for periods greater than 0.
+ *          This only occurs for periods greater than 0.  If use-price-prediction
+ *          is set in the configuration, solved markets after calibration use
+ *          predictPrice instead of the simple trend forecast.
  * \author Sonny Kim
  * \param period Period for which to initialize prices.
  */
 void Marketplace::init_to_last( const int period ) { 
+    // The activities register the slots they contribute to in the markets of
+    // each period anew.
+    for( auto& contributions : mActivityContributions ) {
+        contributions.second.clear();
+    }
+    for( auto marketContainer : mMarkets ) {
+        marketContainer->getMarket( period )->clearContributionSlots();
+    }
+
     // Get the last period to allow using parsed prices, which is the
     // final calibration period.
     const int finalCalPeriod = scenario->getModeltime()->getFinalCalibrationPeriod();
@@ -706,6 +724,19 @@ void Marketplace::init_to_last( const int period ) {
             mMarkets[ i ]->forecastDemand( period );
         }
     }
+    else if( Configuration::getInstance()->getBool( "use-price-prediction", false, false ) ) {
+        mNumPricePredictions = 0;
+        mNumPredictionFallbacks = 0;
+        for ( unsigned int i = 0; i < mMarkets.size(); i++ ) {
+            mMarkets[ i ]->getMarket( period )->set_price_to_last( predictPrice( i, period ) );
+            mMarkets[ i ]->forecastDemand( period );
+        }
+        ILogger& solverLog = ILogger::getLogger( "solver_log" );
+        solverLog.setLevel( ILogger::NOTICE );
+        solverLog << "Price prediction for period " << period << ": " << mNumPricePredictions
+                  << " markets predicted, " << mNumPredictionFallbacks
+                  << " fell back to last period's price." << endl;
+    }
     else {
         for ( unsigned int i = 0; i < mMarkets.size(); i++ ) {
             double forecastedPrice = mMarkets[ i ]->forecastPrice( period );
@@ -726,6 +757,201 @@ void Marketplace::init_to_last( const int period ) {
     }
 }
 
+/*!
+ * \brief Predict a starting price for a market in a new period.
+ * \details The prediction starts from the trend extrapolation of the market's
+ *          solved price history (MarketContainer::forecastPrice).  Markets whose
+ *          price is set exogenously, such as fixed carbon taxes, already hold
+ *          their known price for the new period and the market itself will
+ *          ignore the value returned here.  If the solver left the derivative
+ *          of the excess demand with respect to log price in last period's
+ *          market info, the predicted step is shortened so that the implied
+ *          change in scaled excess demand is no larger than one.  This keeps
+ *          markets with steep supply or demand from being thrown far out of
+ *          balance by a trend that doesn't continue.  The prediction is rejected
+ *          in favor of last period's price if it changes sign, is not a valid
+ *          number, or moves the price by more than a factor of five.
+ * \param aMarketNumber The index of the market to predict.
+ * \param aPeriod The period being initialized.
+ *          The price returned is also recorded as the market's forecast price.
+ * \return The price to start the solution from.
+ */
+double Marketplace::predictPrice( const int aMarketNumber, const int aPeriod ) {
+    // Largest change in scaled excess demand the predicted step may imply.
+    const double MAX_PREDICTED_ED_CHANGE = 1.0;
+    // Largest factor by which the predicted price may differ from last period's.
+    const double MAX_PRICE_RATIO = 5.0;
+
+    const double trendPrice = mMarkets[ aMarketNumber ]->forecastPrice( aPeriod );
+    const Market* lastMarket = mMarkets[ aMarketNumber ]->getMarket( aPeriod - 1 );
+    const double lastPrice = lastMarket->getPrice();
+    if( !mMarkets[ aMarketNumber ]->getMarket( aPeriod )->isSolvable() ) {
+        // Markets that are not solved keep the simple trend forecast used
+        // when price prediction is off.
+        if( ( trendPrice < 0.0 && lastPrice > 0.0 ) ||
+            abs( trendPrice ) > 5.0 * abs( lastPrice ) )
+        {
+            return lastPrice;
+        }
+        return trendPrice;
+    }
+
+    // Sanity check the trend.  Prices that were zero or negative last period
+    // can't be handled in log space so those are only checked for validity.
+    if( !util::isValidNumber( trendPrice ) ||
+        ( lastPrice > 0.0 && ( trendPrice <= 0.0 ||
+                               trendPrice > MAX_PRICE_RATIO * lastPrice ||
+                               trendPrice * MAX_PRICE_RATIO < lastPrice ) ) ||
+        ( lastPrice <= 0.0 && fabs( trendPrice ) > MAX_PRICE_RATIO * ( fabs( lastPrice ) + 1.0 ) ) )
+    {
+        ++mNumPredictionFallbacks;
+        mMarkets[ aMarketNumber ]->getMarket( aPeriod )->setForecastPrice( lastPrice );
+        return lastPrice;
+    }
+
+    double predictedPrice = trendPrice;
+    if( lastPrice > 0.0 && lastMarket->getMarketInfo()->hasValue( LOG_PRICE_DERIVATIVE_KEY ) ) {
+        double logStep = log( trendPrice / lastPrice );
+        double edChange = fabs( lastMarket->getMarketInfo()->getDouble( LOG_PRICE_DERIVATIVE_KEY, true ) * logStep );
+        if( edChange > MAX_PREDICTED_ED_CHANGE ) {
+            logStep *= MAX_PREDICTED_ED_CHANGE / edChange;
+            predictedPrice = lastPrice * exp( logStep );
+        }
+    }
+    ++mNumPricePredictions;
+    mMarkets[ aMarketNumber ]->getMarket( aPeriod )->setForecastPrice( predictedPrice );
+    return predictedPrice;
+}
+
+/*!
+ * \brief Log how well the price prediction did in the given period.
+ * \details Reports the number of markets predicted and the number that fell
+ *          back to last period's price, along with the number of solved markets
+ *          that started closer to their solved price than last period's price.
+ * \param aPeriod The period that was just solved.
+ */
+void Marketplace::logPricePrediction( const int aPeriod ) {
+    if( aPeriod <= scenario->getModeltime()->getFinalCalibrationPeriod() ||
+        !Configuration::getInstance()->getBool( "use-price-prediction", false, false ) )
+    {
+        return;
+    }
+
+    int numCloser = 0;
+    int numSolved = 0;
+    for( unsigned int i = 0; i < mMarkets.size(); ++i ) {
+        const Market* currMarket = mMarkets[ i ]->getMarket( aPeriod );
+        if( !currMarket->isSolvable() ) {
+            continue;
+        }
+        ++numSolved;
+        const double solvedPrice = currMarket->getRawPrice();
+        const double lastPrice = mMarkets[ i ]->getMarket( aPeriod - 1 )->getRawPrice();
+        if( fabs( currMarket->getForecastPrice() - solvedPrice ) < fabs( lastPrice - solvedPrice ) ) {
+            ++numCloser;
+        }
+    }
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Price prediction in period " << aPeriod << ": " << mNumPricePredictions
+            << " markets predicted (" << mNumPredictionFallbacks << " fell back), "
+            << numCloser << " of " << numSolved << " starting prices closer to the solution than last period's price." << endl;
+}
+
+/*!
+ * \brief Give each of the given activities a list to hold the slots it is
+ *        given in the markets to which it contributes.
+ * \details This is called once the global ordering is known so that every
+ *          activity has a list before any calculation is done.  The lists are
+ *          filled in as the activities contribute during serial calculations.
+ * \param aActivities All of the activities in the model.
+ */
+void Marketplace::registerActivities( const vector<IActivity*>& aActivities ) {
+    mActivityContributions.clear();
+    for( const IActivity* activity : aActivities ) {
+        mActivityContributions[ activity ];
+    }
+}
+
+/*!
+ * \brief Get the list of contribution slots for the given activity.
+ * \param aActivity A registered activity.
+ * \return The activity's contribution slots or null if it was not registered.
+ */
+Marketplace::ContributionList* Marketplace::getContributionList( const IActivity* aActivity ) {
+    auto iter = mActivityContributions.find( aActivity );
+    return iter != mActivityContributions.end() ? &iter->second : 0;
+}
+
+/*!
+ * \brief Set the activity which is being calculated on the calling thread.
+ * \details Markets use this to attribute contributions to supply and demand to
+ *          the activity which made them.  It should be reset to null once the
+ *          activity is done calculating.  Partial derivative calculations do
+ *          not accumulate per activity so nothing is looked up for them.
+ * \param aActivity The activity about to be calculated or null.
+ */
+void Marketplace::setCurrentActivity( const IActivity* aActivity ) {
+#if GCAM_PARALLEL_ENABLED
+    mCurrentContributions = aActivity && !mIsDerivativeCalc ? getContributionList( aActivity ) : 0;
+#endif
+}
+
+/*!
+ * \brief Set the contribution slots of the activity being calculated on the
+ *        calling thread.
+ * \details This is used by the flow graph which looks up the list for each of
+ *          its activities when it is created.
+ * \param aContributions The contribution slots from getContributionList or null.
+ */
+void Marketplace::setCurrentContributions( ContributionList* aContributions ) {
+    mCurrentContributions = aContributions;
+}
+
+/*!
+ * \brief Switch markets to accumulating supplies and demands per activity for
+ *        the duration of a parallel world->calc().
+ * \details This has no effect during partial derivative calculations.  Those
+ *          do run concurrently, one Jacobian column per thread in fdjac, but
+ *          each thread accumulates into its own scratch copy of the state so
+ *          there are no shared sums to order.
+ * \return Whether ordered accumulation was started in which case
+ *         endOrderedAccumulation must be called once the calculation is done.
+ */
+bool Marketplace::beginOrderedAccumulation() {
+    if( mIsDerivativeCalc ) {
+        return false;
+    }
+    mHasUnregisteredContribution = false;
+    mIsOrderedAccumulation = true;
+    return true;
+}
+
+/*!
+ * \brief Reduce the per activity contributions in all markets in a fixed order
+ *        and switch back to accumulating directly.
+ * \details If any activity contributed to a market in which it had no slot the
+ *          contributions are instead discarded so that the calculation can be
+ *          repeated in serial, which will register the missing slots.
+ * \param aPeriod The period which was calculated.
+ * \return Whether the contributions were complete.  If not supplies and demands
+ *         are as they were before the calculation and it must be repeated.
+ */
+bool Marketplace::endOrderedAccumulation( const int aPeriod ) {
+    mIsOrderedAccumulation = false;
+    const bool isComplete = !mHasUnregisteredContribution;
+    for( auto marketContainer : mMarkets ) {
+        if( isComplete ) {
+            marketContainer->getMarket( aPeriod )->reduceContributions();
+        }
+        else {
+            marketContainer->getMarket( aPeriod )->discardContributions();
+        }
+    }
+    return isComplete;
+}
+
 /*! \brief Store market prices for policy cost caluclation.
 *
 *
@@ -754,6 +980,65 @@ void Marketplace::restore_prices_for_cost_calculation()
     }
 }
 
+/*! \brief Write the current market prices so that another process running the
+*          same scenario can start a policy cost calculation from them.
+* \details The prices are written with enough precision to be read back
+*          exactly by readPricesForCostCalculation.
+* \param aOut The stream to write to.
+*/
+void Marketplace::writePricesForCostCalculation( ostream& aOut ) const {
+    const int maxPeriod = scenario->getModeltime()->getmaxper();
+    aOut.precision( numeric_limits<double>::max_digits10 );
+    aOut << mMarkets.size() << endl;
+    for( unsigned int i = 0; i < mMarkets.size(); ++i ){
+        aOut << mMarkets[ i ]->getName() << endl;
+        for( int period = 0; period < maxPeriod; ++period ){
+            aOut << ' ' << mMarkets[ i ]->getMarket( period )->getRawPrice();
+        }
+        aOut << endl;
+    }
+}
+
+/*! \brief Set the market prices written by writePricesForCostCalculation and
+*          store them for the policy cost calculation.
+* \details The markets must be the same as those which were written, which is
+*          the case when the same scenario components have been parsed.  The
+*          prices are only changed if the entire set was read and matched.
+* \param aIn The stream to read from.
+* \return Whether the prices were read and set.
+*/
+bool Marketplace::readPricesForCostCalculation( istream& aIn ){
+    const int maxPeriod = scenario->getModeltime()->getmaxper();
+    size_t numMarkets = 0;
+    aIn >> numMarkets;
+    if( !aIn || numMarkets != mMarkets.size() ){
+        return false;
+    }
+    vector<double> prices( numMarkets * maxPeriod );
+    for( unsigned int i = 0; i < mMarkets.size() && aIn; ++i ){
+        string name;
+        aIn >> ws;
+        getline( aIn, name );
+        if( name != mMarkets[ i ]->getName() ){
+            return false;
+        }
+        for( int period = 0; period < maxPeriod; ++period ){
+            aIn >> prices[ i * maxPeriod + period ];
+        }
+    }
+    if( !aIn ){
+        return false;
+    }
+
+    for( unsigned int i = 0; i < mMarkets.size(); ++i ){
+        for( int period = 0; period < maxPeriod; ++period ){
+            mMarkets[ i ]->getMarket( period )->setRawPrice( prices[ i * maxPeriod + period ] );
+        }
+    }
+    store_prices_for_cost_calculation();
+    return true;
+}
+
 /*! \brief Get the information object for the specified market and period which
 *          can then be used to query for specific values.
 * \details Returns the internal IInfo object of the specified market and period
@@ -898,6 +1183,17 @@ MarketDependencyFinder* Marketplace::getDependencyFinder() const {
     return mDependencyFinder.get();
 }
 
+/*!
+ * \brief Set whether the following calls to world->calc() are partial
+ *        calculations which should only record changes to supplies and demands.
+ * \details Solvers which calculate some markets with partial calculations
+ *          outside of an EDFun use this to switch in and out of that mode.
+ * \param aIsDerivativeCalc Whether partial calculations are being done.
+ */
+void Marketplace::setIsDerivativeCalc( const bool aIsDerivativeCalc ) {
+    mIsDerivativeCalc = aIsDerivativeCalc;
+}
+
 /*!
  * \brief Get the full state of the marketplace.
  * \param period The model period.
@@ -42,6 +42,8 @@
 #include "containers/include/world.h"
 #include "containers/include/iactivity.h"
 #include "containers/include/market_dependency_finder.h"
+#include "marketplace/include/marketplace.h"
+#include "containers/include/scenario.h"
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/auto_file.h"
@@ -53,6 +55,8 @@
 
 using namespace std;
 
+extern Scenario* scenario;
+
 int GcamFlowGraph::mPeriod = 0;
 tbb::global_control* GcamFlowGraph::mParallelismConfig = 0;
 
@@ -152,12 +156,17 @@ void GcamParallel::makeTBBFlowGraph( const MarketDependencyFinder& aDependencyFi
     
     // we have to take two passes, first to create each of the verticies which
     // apparently can not be copied so we hang on to them with a pointer
+    // each vertex also looks up where its activity accumulates its contributions
+    // to markets once here rather than every time it is calculated
     vector<continue_node<continue_msg>*> tbbVert;
     tbbVert.reserve( calcVertexList.size() );
     for( MarketDependencyFinder::CalcVertex* vert : calcVertexList ) {
         IActivity* activity = vert->mCalcItem;
-        tbbVert.push_back(new continue_node<continue_msg>(tbbFlowGraph, [activity](continue_msg) {
+        Marketplace::ContributionList* contributions = scenario->getMarketplace()->getContributionList(activity);
+        tbbVert.push_back(new continue_node<continue_msg>(tbbFlowGraph, [activity, contributions](continue_msg) {
+            Marketplace::setCurrentContributions(contributions);
             activity->calc(GcamFlowGraph::mPeriod);
+            Marketplace::setCurrentContributions(0);
         }));
     }
     // now create the edges
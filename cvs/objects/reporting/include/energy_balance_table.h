@@ -81,6 +81,7 @@ public:
                         const bool aIncludeNonCalValues );
     virtual ~EnergyBalanceTable();
     void finish() const;
+    void writeBulk( std::ostream& aOut, const int aYear, const bool aBinary ) const;
     void startVisitSector( const Sector* aSector, const int aPeriod );
     void endVisitSector( const Sector* aSector, const int aPeriod );
     void startVisitSubsector( const Subsector* aSubsector, const int aPeriod );
@@ -142,7 +143,7 @@ private:
 
     std::string getKey() const;
     
-    double getTotalSectorOutput( const std::string& aSectorName ) const;
+    std::map<std::string, double> getTotalSectorOutputs() const;
 };
 
 #endif // _ENERGY_BALANCE_TABLE_H_
@@ -49,12 +49,18 @@
 
 #include <string>
 #include <vector>
+#include <iosfwd>
+#include "util/base/include/hash_map.h"
 
 /*! 
 * \ingroup Objects
 * \brief A datastructure which stores in a row column format which is referenced by the column and row names.
-* \details This is a sparse table as all columns do not have to contain the same rows. SWAP. For this reason the columns
-* can be iterated by the rows cannot.
+* \details Row and column labels are interned into hashed indexes the first
+*          time they are used so that lookups do not need to compare against
+*          every existing label. Values are stored densely by column, with a
+*          missing value treated as zero, so that columns need not contain the
+*          same rows. The table may be written out in bulk as CSV or as a
+*          compact binary block.
 * \author Josh Lurz
 * \todo Fix handling of total row so that a consumer of this class must request it.
 */
@@ -71,32 +77,35 @@ public:
     double getValue( const std::string& aRow, const std::string& aCol ) const;
     const std::vector<std::string> getRowLabels() const;
     const std::vector<std::string> getColLabels() const;
+    void writeCSV( std::ostream& aOut ) const;
+    void writeBinary( std::ostream& aOut ) const;
 private:
-    int getRowIndex( const std::string& aRow ) const;
     const static int NO_ITEM_FOUND = -1;
+    int getRowIndex( const std::string& aRow ) const;
+    int getColIndex( const std::string& aCol ) const;
+    unsigned int findOrAddRow( const std::string& aRow );
+    unsigned int findOrAddCol( const std::string& aCol );
+    double& getCell( const unsigned int aRowIndex, const unsigned int aColIndex );
+    double getValue( const unsigned int aRowIndex, const std::string& aCol ) const;
+
+    //! Column labels which were explicitly added, in the order added.
     std::vector<std::string> mColLabels;
-    //! Structure for each Item
-    struct Item {
-        explicit Item( const std::string& aLabel );
-        std::string label;
-        double value;
-    };
 
-    //! Structure for each Column.
-    struct Row {
-        explicit Row( const std::string& aLabel );
-        int getColIndex( const std::string& aCol ) const;
-        std::string label;
-        std::vector<Item> data;
-        double total;
-    };
-    //! Structure for the internal storage.
-    struct InternalTable {
-        std::string label;
-        std::vector<Row> rows;
-    };
-	InternalTable mInternalTable; //!< The internal storage.
+    //! Row labels in the order they were first used.
+    std::vector<std::string> mRowLabels;
+
+    //! Map of row label to index in mRowLabels.
+    HashMap<std::string, unsigned int> mRowIndex;
+
+    //! Map of column label to index in mColumns.
+    HashMap<std::string, unsigned int> mColIndex;
+
+    //! Values stored by column then row. A column may be shorter than the
+    //! number of rows in which case the missing values are zero.
+    std::vector<std::vector<double> > mColumns;
+
+    //! The sum of all values added to each row.
+    std::vector<double> mRowTotals;
 };
 
 #endif // _STORAGE_TABLE_H_
-
@@ -68,6 +68,20 @@ mIsFirstScenario(true)
 {
 }
 
+/*!
+ * \brief Constructor which writes to the given file instead of the one set in
+ *        the configuration.
+ * \details This is used by batch worker processes which each write the results
+ *          of their own scenario to a separate file to be merged once all of the
+ *          workers are done.
+ * \param aFileName The name of the file to write results to.
+ */
+BatchCSVOutputter::BatchCSVOutputter( const string& aFileName ):
+mFile( aFileName ),
+mIsFirstScenario(true)
+{
+}
+
 /*!
  * \brief Destructor
  */
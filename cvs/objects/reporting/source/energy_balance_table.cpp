@@ -44,6 +44,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <boost/cstdint.hpp>
 
 #include "reporting/include/energy_balance_table.h"
 
@@ -93,6 +94,33 @@ void EnergyBalanceTable::finish() const {
     }
 }
 
+/*!
+ * \brief Write the gathered values in bulk without any formatting.
+ * \details Unlike finish this does not annotate columns with their sector,
+ *          subsector and technology so it is cheap even for large tables.
+ *          The table is preceded by the region name and year, either as a CSV
+ *          line or, in binary mode, as a length prefixed string and a 32 bit
+ *          integer. See StorageTable::writeCSV and StorageTable::writeBinary
+ *          for the layout of the table itself.
+ * \param aOut The stream to write to.
+ * \param aYear The year the table was gathered for.
+ * \param aBinary Whether to write binary instead of CSV.
+ */
+void EnergyBalanceTable::writeBulk( ostream& aOut, const int aYear, const bool aBinary ) const {
+    if( aBinary ) {
+        const boost::uint32_t length = static_cast<boost::uint32_t>( mRegionName.size() );
+        const boost::int32_t year = aYear;
+        aOut.write( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+        aOut.write( mRegionName.data(), length );
+        aOut.write( reinterpret_cast<const char*>( &year ), sizeof( year ) );
+        mTable->writeBinary( aOut );
+    }
+    else {
+        aOut << "Region:," << mRegionName << ",Year:," << aYear << '\n';
+        mTable->writeCSV( aOut );
+    }
+}
+
 /*!
  * \brief Write the complete version of the table.
  * \details This will dissaggregate a sector to differentiate between subsectors and technologies.
@@ -165,6 +193,7 @@ void EnergyBalanceTable::writeFullTable() const {
     mFile << "---" << endl;
 
     // write table data
+    const map<string, double> sectorOutputs = getTotalSectorOutputs();
     for( vector<string>::const_iterator rowIt = rows.begin(); rowIt != rows.end(); ++rowIt ) {
         if( *rowIt != "Output" ) {
             mFile << *rowIt << ',';
@@ -173,7 +202,9 @@ void EnergyBalanceTable::writeFullTable() const {
             }
             
             // calculate the Difference and add it as the last column
-            mFile << getTotalSectorOutput( *rowIt ) - mTable->getValue( *rowIt, totalColName ) << endl;
+            map<string, double>::const_iterator outputIt = sectorOutputs.find( *rowIt );
+            const double sectorOutput = outputIt != sectorOutputs.end() ? outputIt->second : 0.0;
+            mFile << sectorOutput - mTable->getValue( *rowIt, totalColName ) << endl;
         }
     }
 
@@ -376,23 +407,19 @@ string EnergyBalanceTable::getKey() const {
 }
 
 /*!
- * \brief Gets the total sector output for the given sector name.
+ * \brief Gets the total output of each sector.
  * \details This is useful when creating an expanded table since multiple
  *          columns will need to be sumed to get the total.  We do this by
- *          iterating over each entry in mColToSectorMap and comparing the
- *          value to see if it matches the given sector name and add the
- *          "Output" row of that column to the sum if it does.
- * \param aSectorName The name of the sector to get the total output for.
- * \return The total output for the sector.
+ *          iterating over each entry in mColToSectorMap once and adding the
+ *          "Output" row of that column to the sum for the sector it belongs to.
+ * \return A map of sector name to the total output for the sector.
  */
-double EnergyBalanceTable::getTotalSectorOutput( const string& aSectorName ) const {
-    double outputSum = 0;
+map<string, double> EnergyBalanceTable::getTotalSectorOutputs() const {
+    map<string, double> sectorOutputs;
     for( map<string, string>::const_iterator it = mColToSectorMap.begin(); it != mColToSectorMap.end(); ++it ) {
-        if( (*it).second == aSectorName ) {
-            outputSum += mTable->getValue( "Output", (*it).first );
-        }
+        sectorOutputs[ (*it).second ] += mTable->getValue( "Output", (*it).first );
     }
-    return outputSum;
+    return sectorOutputs;
 }
 
 void EnergyBalanceTable::setRegionName( const string& aRegionName ) {
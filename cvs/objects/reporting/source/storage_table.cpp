@@ -43,12 +43,18 @@
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <iostream> // until we get logger.
+#include <iostream>
+#include <boost/cstdint.hpp>
 #include "reporting/include/storage_table.h"
 #include "util/base/include/util.h"
 
 using namespace std;
 
+namespace {
+    //! The label of the row total column.
+    const string TOTAL_COL_LABEL = "Total";
+}
+
 //! Default Constructor
 StorageTable::StorageTable(){
 }
@@ -56,12 +62,17 @@ StorageTable::StorageTable(){
 //! Clear the data in the table. 
 // This does not clear column labels.
 void StorageTable::clear() {
-    mInternalTable.rows.clear();
+    mRowLabels.clear();
+    mRowIndex = HashMap<string, unsigned int>();
+    mRowTotals.clear();
+    for( vector<vector<double> >::iterator colIt = mColumns.begin(); colIt != mColumns.end(); ++colIt ){
+        colIt->clear();
+    }
 }
 
 //! Return if the table has any rows.
 bool StorageTable::isEmpty() const {
-    return mInternalTable.rows.empty();
+    return mRowLabels.empty();
 }
 
 /*! \brief Add a column label to the list of columns.
@@ -72,6 +83,9 @@ void StorageTable::addColumn( const string& aColLabel ){
     if( find( mColLabels.begin(), mColLabels.end(), aColLabel ) == mColLabels.end() ){
         // Add the label.
         mColLabels.push_back( aColLabel );
+        // Intern the label now so that the first value added to it does not
+        // have to.
+        findOrAddCol( aColLabel );
     }
     else {
         // When logging is added this could be at DEBUG level.
@@ -88,73 +102,25 @@ void StorageTable::addToType( const int aRow, const string& aCol, const double a
 
 //! Add to the value for the table specified by the account type key. 
 void StorageTable::addToType( const string& aRow, const string& aCol, const double aValue ){
-    // Find the correct column.
-    int rowIndex = getRowIndex( aRow );
-    
-    // If the row does not exist insert one on the end.
-    if( rowIndex == NO_ITEM_FOUND ){
-        mInternalTable.rows.push_back( Row( aRow ) );
-        // Set the row index to the new row so we can add the value.
-        rowIndex = static_cast<int>( mInternalTable.rows.size() ) - 1;
-    }
-
-    // Find the column index.
-    int colIndex = mInternalTable.rows[ rowIndex ].getColIndex( aCol );
-
-    // If the column does not exist add it onto the end of the row.
-    if( colIndex == NO_ITEM_FOUND ){
-        mInternalTable.rows[ rowIndex ].data.push_back( Item( aCol ) );
-        // Set the col index to the new col so we can add the value.
-        colIndex = static_cast<int>( mInternalTable.rows[ rowIndex ].data.size() ) - 1;
-    }
-    // Add the value to the correct position.
-    mInternalTable.rows[ rowIndex ].data[ colIndex ].value += aValue;
+    const unsigned int rowIndex = findOrAddRow( aRow );
+    getCell( rowIndex, findOrAddCol( aCol ) ) += aValue;
     // Add to the total.
-    mInternalTable.rows[ rowIndex ].total += aValue;
+    mRowTotals[ rowIndex ] += aValue;
 }
 
 //! set the value for the table specified by the account type key.
-// This function should be replaced with a clear row and then use addToType.
-// Right now it is massive copy-paste.
+// Note that this does not update the row total.
 void StorageTable::setType( const string& aRow, const string& aCol,
                               const double aValue )
 {
- 	// Find the correct column.
-    int rowIndex = getRowIndex( aRow );
-    
-    // If the row does not exist insert one on the end.
-    if( rowIndex == NO_ITEM_FOUND ){
-        mInternalTable.rows.push_back( Row( aRow ) );
-        // Set the row index to the new row so we can add the value.
-        rowIndex = static_cast<int>( mInternalTable.rows.size() ) - 1;
-    }
-
-    // Find the column index.
-    int colIndex = mInternalTable.rows[ rowIndex ].getColIndex( aCol );
-
-    // If the column does not exist add it onto the end of the row.
-    if( colIndex == NO_ITEM_FOUND ){
-        mInternalTable.rows[ rowIndex ].data.push_back( Item( aCol ) );
-        // Set the col index to the new col so we can add the value.
-        colIndex = static_cast<int>( mInternalTable.rows[ rowIndex ].data.size() ) - 1;
-    }
-    // Add the value to the correct position.
-    mInternalTable.rows[ rowIndex ].data[ colIndex ].value = aValue;
+    getCell( findOrAddRow( aRow ), findOrAddCol( aCol ) ) = aValue;
 }
 
 //! Get the value for the table specified by the account type key. 
 double StorageTable::getValue( const string& aRow, const string& aCol ) const {
     const int rowIndex = getRowIndex( aRow );
     if( rowIndex != NO_ITEM_FOUND ){
-        // Special case total here.
-        if( aCol == "Total" ){
-            return mInternalTable.rows[ rowIndex ].total;
-        }
-        // Find the correct column.
-        const int colIndex = mInternalTable.rows[ rowIndex ].getColIndex( aCol );
-        if( colIndex != NO_ITEM_FOUND ){
-            return mInternalTable.rows[ rowIndex ].data[ colIndex ].value;
-        }
+        return getValue( static_cast<unsigned int>( rowIndex ), aCol );
     }
     // Is this an error?
     return 0;
@@ -162,15 +128,7 @@ double StorageTable::getValue( const string& aRow, const string& aCol ) const {
 
 //! Get the list of all row labels in order.
 const vector<string> StorageTable::getRowLabels() const {
-    vector<string> rowLabels;
-
-    // Loop through the rows and add the label for each to the vector.
-    for( unsigned int row = 0; row < mInternalTable.rows.size(); ++row ){
-        rowLabels.push_back( mInternalTable.rows[ row ].label );
-    }
-
-    // Return the list of row labels.
-    return rowLabels;
+    return mRowLabels;
 }
 
 //! Get the list of all column labels.
@@ -178,48 +136,161 @@ const vector<string> StorageTable::getColLabels() const {
     // Create a copy of the internal labels and tack total onto it if it does not exist.
     // Maybe users should have to request total explicitly?
     vector<string> colLabels( mColLabels );
-    if( find( colLabels.begin(), colLabels.end(), "Total" ) == colLabels.end() ){
-        colLabels.push_back( "Total" );
+    if( find( colLabels.begin(), colLabels.end(), TOTAL_COL_LABEL ) == colLabels.end() ){
+        colLabels.push_back( TOTAL_COL_LABEL );
     }
     return colLabels;
 }
 
+/*!
+ * \brief Write the entire table as CSV.
+ * \details The first line contains the column labels as returned by
+ *          getColLabels and each following line contains a row label and
+ *          the value of each column for that row.
+ * \param aOut The stream to write to.
+ */
+void StorageTable::writeCSV( ostream& aOut ) const {
+    const vector<string> colLabels = getColLabels();
+    for( vector<string>::const_iterator colIt = colLabels.begin(); colIt != colLabels.end(); ++colIt ){
+        aOut << ',' << *colIt;
+    }
+    aOut << '\n';
+
+    for( unsigned int row = 0; row < mRowLabels.size(); ++row ){
+        aOut << mRowLabels[ row ];
+        for( vector<string>::const_iterator colIt = colLabels.begin(); colIt != colLabels.end(); ++colIt ){
+            aOut << ',' << getValue( row, *colIt );
+        }
+        aOut << '\n';
+    }
+    aOut.flush();
+}
+
+/*!
+ * \brief Write the entire table as a binary block.
+ * \details The block consists of the number of rows and columns as 32 bit
+ *          unsigned integers, then each row label followed by each column
+ *          label as returned by getColLabels, where each label is its length
+ *          as a 32 bit unsigned integer followed by its characters, and finally
+ *          the values as doubles in column major order. All values are written
+ *          in the native byte order.
+ * \param aOut The stream to write to which should be opened in binary mode.
+ */
+void StorageTable::writeBinary( ostream& aOut ) const {
+    const vector<string> colLabels = getColLabels();
+    const boost::uint32_t numRows = static_cast<boost::uint32_t>( mRowLabels.size() );
+    const boost::uint32_t numCols = static_cast<boost::uint32_t>( colLabels.size() );
+    aOut.write( reinterpret_cast<const char*>( &numRows ), sizeof( numRows ) );
+    aOut.write( reinterpret_cast<const char*>( &numCols ), sizeof( numCols ) );
+
+    vector<string> labels( mRowLabels );
+    labels.insert( labels.end(), colLabels.begin(), colLabels.end() );
+    for( vector<string>::const_iterator labelIt = labels.begin(); labelIt != labels.end(); ++labelIt ){
+        const boost::uint32_t length = static_cast<boost::uint32_t>( labelIt->size() );
+        aOut.write( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+        aOut.write( labelIt->data(), length );
+    }
+
+    vector<double> column( numRows );
+    for( vector<string>::const_iterator colIt = colLabels.begin(); colIt != colLabels.end(); ++colIt ){
+        const int colIndex = getColIndex( *colIt );
+        if( *colIt == TOTAL_COL_LABEL ){
+            column = mRowTotals;
+        }
+        else if( colIndex != NO_ITEM_FOUND ){
+            // Columns are stored contiguously so copy the stored part and pad
+            // the rest with zeros.
+            const vector<double>& stored = mColumns[ colIndex ];
+            copy( stored.begin(), stored.end(), column.begin() );
+            fill( column.begin() + stored.size(), column.end(), 0.0 );
+        }
+        else {
+            fill( column.begin(), column.end(), 0.0 );
+        }
+        if( numRows > 0 ){
+            aOut.write( reinterpret_cast<const char*>( &column[ 0 ] ), numRows * sizeof( double ) );
+        }
+    }
+    aOut.flush();
+}
+
 /*! \brief Get the row index for a given string which represents a row label.
 * \param aTypeRow The row label string.
 * \return The index of the row, NO_ITEM_FOUND if it is not found.
 * \author Josh Lurz
 */
 int StorageTable::getRowIndex( const string& aRow ) const {
-    // Search the vector.
-    for( unsigned int row = 0; row < mInternalTable.rows.size(); ++row ){
-        if( mInternalTable.rows[ row ].label == aRow ){ // The row label matches the search label.
-            return row;
-        }
+    HashMap<string, unsigned int>::const_iterator iter = mRowIndex.find( aRow );
+    return iter != mRowIndex.end() ? static_cast<int>( iter->second ) : NO_ITEM_FOUND;
+}
+
+/*! \brief Get the column index for a given string which represents a column label.
+* \param aCol The column label string.
+* \return The index of the column in mColumns, NO_ITEM_FOUND if it is not found.
+*/
+int StorageTable::getColIndex( const string& aCol ) const {
+    HashMap<string, unsigned int>::const_iterator iter = mColIndex.find( aCol );
+    return iter != mColIndex.end() ? static_cast<int>( iter->second ) : NO_ITEM_FOUND;
+}
+
+/*! \brief Get the row index for a row label, adding the row to the end of the
+*          table if it does not exist.
+* \param aRow The row label string.
+* \return The index of the row.
+*/
+unsigned int StorageTable::findOrAddRow( const string& aRow ) {
+    // Note HashMap::insert replaces the value of an existing key so a find is
+    // required first.
+    HashMap<string, unsigned int>::const_iterator iter = mRowIndex.find( aRow );
+    if( iter != mRowIndex.end() ){
+        return iter->second;
     }
-    // The index does not exist.
-    return NO_ITEM_FOUND;
+    const unsigned int rowIndex = static_cast<unsigned int>( mRowLabels.size() );
+    mRowIndex.insert( make_pair( aRow, rowIndex ) );
+    mRowLabels.push_back( aRow );
+    mRowTotals.push_back( 0 );
+    return rowIndex;
 }
 
-//! Constructor for the Item.
-StorageTable::Item::Item( const string& aLabel ):
-label( aLabel ),
-value( 0 ){
+/*! \brief Get the column index for a column label, interning the label if it
+*          does not exist.
+* \param aCol The column label string.
+* \return The index of the column in mColumns.
+*/
+unsigned int StorageTable::findOrAddCol( const string& aCol ) {
+    HashMap<string, unsigned int>::const_iterator iter = mColIndex.find( aCol );
+    if( iter != mColIndex.end() ){
+        return iter->second;
+    }
+    const unsigned int colIndex = static_cast<unsigned int>( mColumns.size() );
+    mColIndex.insert( make_pair( aCol, colIndex ) );
+    mColumns.push_back( vector<double>() );
+    return colIndex;
 }
 
-//! Constructor for a Row
-StorageTable::Row::Row( const string& aLabel ):
-label( aLabel ),
-total( 0 ){
+/*! \brief Get a reference to the stored value at the given position, growing
+*          the column to include the row if necessary.
+* \param aRowIndex The index of the row.
+* \param aColIndex The index of the column.
+* \return A reference to the value.
+*/
+double& StorageTable::getCell( const unsigned int aRowIndex, const unsigned int aColIndex ) {
+    vector<double>& column = mColumns[ aColIndex ];
+    if( column.size() <= aRowIndex ){
+        column.resize( mRowLabels.size(), 0.0 );
+    }
+    return column[ aRowIndex ];
 }
 
-//! Get the index of a column within a row.
-int StorageTable::Row::getColIndex( const string& aCol ) const {
-    // Search the vector.
-    for( unsigned int col = 0; col < data.size(); ++col ){
-        if( data[ col ].label == aCol ){ // The column label matches the search label.
-            return col;
-        }
+//! Get the value for a row index and column label.
+double StorageTable::getValue( const unsigned int aRowIndex, const string& aCol ) const {
+    // Special case total here.
+    if( aCol == TOTAL_COL_LABEL ){
+        return mRowTotals[ aRowIndex ];
     }
-    // The index does not exist.
-    return NO_ITEM_FOUND;
+    const int colIndex = getColIndex( aCol );
+    if( colIndex != NO_ITEM_FOUND && aRowIndex < mColumns[ colIndex ].size() ){
+        return mColumns[ colIndex ][ aRowIndex ];
+    }
+    return 0;
 }
@@ -45,6 +45,7 @@
 * \author Sonny Kim
 */
 #include <memory>
+#include <vector>
 #include <xercesc/dom/DOMNode.hpp>
 #include <boost/core/noncopyable.hpp>
 
@@ -107,6 +108,9 @@ protected:
     virtual const std::string& getXMLName() const;
     virtual bool XMLDerivedClassParse( const std::string& nodeName, const xercesc::DOMNode* node );
 
+    void buildGradeTable( const int aPeriod );
+    unsigned int findGrade( const double aPrice, const int aPeriod ) const;
+
     DEFINE_DATA(
         /* Declare all subclasses of SubResource to allow automatic traversal of the
          * hierarchy under introspection.
@@ -152,6 +156,33 @@ protected:
     
     //!< The subsector's information store.
     std::auto_ptr<IInfo> mSubresourceInfo;
+
+    /*!
+     * \brief A flattened copy of the grade cost curve for a single period.
+     * \details Grade costs and availabilities do not change once initCalc has
+     *          been called for a period, so they are copied into contiguous
+     *          arrays along with the running sum of availability.  This lets the
+     *          supply calculations locate the bracketing grades by binary search
+     *          without calling back into each Grade on every solver iteration.
+     */
+    struct GradeTable {
+        GradeTable():mIsSorted( false ) {}
+
+        //! Total cost of each grade.
+        std::vector<double> mCost;
+
+        //! Available amount of each grade.
+        std::vector<double> mAvailable;
+
+        //! Sum of the available amounts of all grades up to and including each grade.
+        std::vector<double> mCumulAvailable;
+
+        //! Whether mCost is non-decreasing so that a binary search may be used.
+        bool mIsSorted;
+    };
+
+    //! The grade cost curve for each period, built at the end of initCalc.
+    objects::PeriodVector<GradeTable> mGradeTables;
 };
 
 #endif // _SUBRESOURCE_H_
@@ -156,43 +156,38 @@ void SubRenewableResource::annualsupply( const string& aRegionName, const string
 {
     ITechnology* currTech = mTechnology->getNewVintageTechnology( aPeriod );
     currTech->calcCost( aRegionName, aResourceName, aPeriod );
-    double fractionAvailable = -1;
+    double fractionAvailable;
     const double effectivePrice = aPrice + mPriceAdder[ aPeriod ] - currTech->getCost( aPeriod );
 
-    // Move up the cost curve until a point is found above the current price.
-    for ( unsigned int i = 0; i < mGrade.size(); ++i ) {
-        if( effectivePrice <= mGrade[ i ]->getCost( aPeriod ) ) {
-            if( i == 0 ) {
-                // Below the bottom of the supply curve which means the fraction
-                // available is zero.
-                fractionAvailable = 0;
-            }
-            else {
-                // Determine the cost and available for the previous
-                // point. 
-                double prevGradeCost = mGrade[ i - 1 ]->getCost( aPeriod );
-                double prevGradeAvailable = mGrade[ i - 1 ]->getAvail();
-
-                // This should not be able to happen because the above if
-                // statement would fail.
-                assert( mGrade[ i ]->getCost( aPeriod ) > prevGradeCost );
-                double gradeFraction = ( effectivePrice - prevGradeCost )
-                    / ( mGrade[ i ]->getCost( aPeriod ) - prevGradeCost );
-                // compute production as fraction of total possible
-                fractionAvailable = prevGradeAvailable + gradeFraction
-                    * ( mGrade[ i ]->getAvail() - prevGradeAvailable ); 
-            }
-
-            break;
-        }
+    // Find the first point on the cost curve at or above the current price.
+    const GradeTable& table = mGradeTables[ aPeriod ];
+    const unsigned int i = findGrade( effectivePrice, aPeriod );
+    if( i == 0 ) {
+        // Below the bottom of the supply curve which means the fraction
+        // available is zero.
+        fractionAvailable = 0;
     }
+    else if( i < table.mCost.size() ) {
+        // Determine the cost and available for the previous
+        // point. 
+        double prevGradeCost = table.mCost[ i - 1 ];
+        double prevGradeAvailable = table.mAvailable[ i - 1 ];
 
-    // If the fraction available has not been set there is not a point with a
-    // cost greater than the price. This means the price is above the curve.
-    if( fractionAvailable == -1 ){
-        // Calculate the total fraction of the max subresource to use. Note that
-        // the max fraction available can be more than 100 percent.
-        double maxFraction = mGrade[ mGrade.size() - 1 ]->getAvail();
+        // This should not be able to happen because the grade found is the
+        // first with a cost at or above the price.
+        assert( table.mCost[ i ] > prevGradeCost );
+        double gradeFraction = ( effectivePrice - prevGradeCost )
+            / ( table.mCost[ i ] - prevGradeCost );
+        // compute production as fraction of total possible
+        fractionAvailable = prevGradeAvailable + gradeFraction
+            * ( table.mAvailable[ i ] - prevGradeAvailable ); 
+    }
+    else {
+        // There is not a point with a cost greater than the price. This means
+        // the price is above the curve.  Calculate the total fraction of the max
+        // subresource to use. Note that the max fraction available can be more
+        // than 100 percent.
+        double maxFraction = table.mAvailable[ table.mCost.size() - 1 ];
         fractionAvailable = maxFraction;
     }
 
@@ -43,6 +43,7 @@
 #include <string>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
@@ -248,7 +249,58 @@ void SubResource::initCalc( const string& aRegionName, const string& aResourceNa
         // Determine cost
         mGrade[gr]->calcCost( mCumulativeTechChange[ aPeriod ], aPeriod );
     }
-    
+
+    // The grade costs and availabilities are now fixed for the period.
+    buildGradeTable( aPeriod );
+}
+
+/*!
+ * \brief Copy the grade cost curve for the given period into mGradeTables.
+ * \details Must be called after the grades have calculated their cost for the
+ *          period.  Any grade level adjustments such as those made by
+ *          AccumulatedGrade happen during Grade::initCalc and so are captured.
+ * \param aPeriod Model period.
+ */
+void SubResource::buildGradeTable( const int aPeriod ) {
+    GradeTable& table = mGradeTables[ aPeriod ];
+    const size_t numGrades = mGrade.size();
+    table.mCost.resize( numGrades );
+    table.mAvailable.resize( numGrades );
+    table.mCumulAvailable.resize( numGrades );
+    table.mIsSorted = true;
+    double cumulAvailable = 0.0;
+    for( size_t i = 0; i < numGrades; ++i ) {
+        table.mCost[ i ] = mGrade[ i ]->getCost( aPeriod );
+        table.mAvailable[ i ] = mGrade[ i ]->getAvail();
+        cumulAvailable += table.mAvailable[ i ];
+        table.mCumulAvailable[ i ] = cumulAvailable;
+        if( i > 0 && table.mCost[ i ] < table.mCost[ i - 1 ] ) {
+            table.mIsSorted = false;
+        }
+    }
+}
+
+/*!
+ * \brief Find the first grade with a cost at or above the given price.
+ * \details Grade costs are typically increasing in which case a binary search
+ *          is used.  Otherwise the grades are scanned in order which gives the
+ *          same result as moving up the cost curve one grade at a time.
+ * \param aPrice The effective price.
+ * \param aPeriod Model period.
+ * \return The index of the grade or the number of grades if the price exceeds
+ *         the cost of all grades.
+ */
+unsigned int SubResource::findGrade( const double aPrice, const int aPeriod ) const {
+    const GradeTable& table = mGradeTables[ aPeriod ];
+    if( table.mIsSorted ) {
+        return static_cast<unsigned int>( std::lower_bound( table.mCost.begin(), table.mCost.end(), aPrice )
+                                          - table.mCost.begin() );
+    }
+    unsigned int i = 0;
+    while( i < table.mCost.size() && table.mCost[ i ] < aPrice ) {
+        ++i;
+    }
+    return i;
 }
 
 /*! \brief Perform any initializations needed after each period.
@@ -352,46 +404,37 @@ void SubResource::cumulsupply( const string& aRegionName, const string& aResourc
     mEffectivePrice[ aPeriod ] = aPrice + mPriceAdder[ aPeriod ] - currTech->getCost( aPeriod );
     
     double prevCumul = aPeriod != 0 ? mCumulProd[ aPeriod - 1 ] : 0.0;
+    const double effectivePrice = mEffectivePrice[ aPeriod ];
+    const GradeTable& table = mGradeTables[ aPeriod ];
+    const unsigned int numGrades = table.mCost.size();
 
+    double cumulProd;
     // Case 1
     // if market price is less than cost of first grade, then zero cumulative
     // production
-    if ( mEffectivePrice[ aPeriod ] <= mGrade[0]->getCost( aPeriod )) {
-        mCumulProd[ aPeriod ] = prevCumul;
+    if ( effectivePrice <= table.mCost[ 0 ] ) {
+        cumulProd = prevCumul;
+    }
+    // Case 3
+    // if market price greater than the cost of the last grade, then
+    // cumulative production is the amount in all grades
+    else if ( effectivePrice > table.mCost[ numGrades - 1 ] ) {
+        cumulProd = table.mCumulAvailable[ numGrades - 1 ];
     }
-    
     // Case 2
     // if market price is in between cost of first and last grade, then calculate
     // cumulative production in between those grades
-    if ( mEffectivePrice[ aPeriod ] > mGrade[0]->getCost( aPeriod ) && mEffectivePrice[ aPeriod ] <= mGrade[ mGrade.size() - 1 ]->getCost( aPeriod )) {
-        mCumulProd[ aPeriod ] = 0;
-        int i = 0;
-        int iL = 0;
-        int iU = 0;
-        while ( mGrade[ i ]->getCost( aPeriod ) < mEffectivePrice[ aPeriod ] ) {
-            iL=i; i++; iU=i;
-        }
+    else {
+        const unsigned int iU = findGrade( effectivePrice, aPeriod );
+        const unsigned int iL = iU - 1;
         // add subrsrcs up to the lower grade
-        for ( i = 0; i <= iL; i++ ) {
-            mCumulProd[ aPeriod ] += Value( mGrade[i]->getAvail() );
-        }
+        cumulProd = table.mCumulAvailable[ iL ];
         // price must reach upper grade cost to produce all of lower grade
-        double slope = mGrade[iL]->getAvail()
-            / ( mGrade[iU]->getCost( aPeriod ) - mGrade[iL]->getCost( aPeriod ) );
-        mCumulProd[ aPeriod ] -= Value( slope * ( mGrade[iU]->getCost( aPeriod ) - mEffectivePrice[ aPeriod ] ) );
-    }
-    
-    // Case 3
-    // if market price greater than the cost of the last grade, then
-    // cumulative production is the amount in all grades
-    if ( mEffectivePrice[ aPeriod ] > mGrade[ mGrade.size() - 1 ]->getCost( aPeriod ) ) {
-        mCumulProd[ aPeriod ] = 0;
-        for ( unsigned int i = 0; i < mGrade.size(); i++ ) {
-            mCumulProd[ aPeriod ] += Value( mGrade[i]->getAvail() );
-        }
+        double slope = table.mAvailable[ iL ] / ( table.mCost[ iU ] - table.mCost[ iL ] );
+        cumulProd -= slope * ( table.mCost[ iU ] - effectivePrice );
     }
     
-    mCumulProd[ aPeriod ] = std::max( mCumulProd[ aPeriod ].get(), prevCumul );
+    mCumulProd[ aPeriod ] = std::max( cumulProd, prevCumul );
 }
 
 double SubResource::getCumulProd( const int aPeriod ) const {
@@ -73,35 +73,22 @@ public:
     virtual void toDebugXML( const int aPeriod, std::ostream& aOut, Tabs* aTabs ) const;
     virtual void initCalc( const IInfo* aTechInfo );
     
-    virtual double getMarginalBackupCapacity( const std::string& aSector,
-                                              const std::string& aElectricSector,
-                                              const std::string& aResource,
-                                              const std::string& aRegion,
+    virtual double getMarginalBackupCapacity( const double aTrialShare,
+                                              const double aResourceVariance,
                                               const double aTechCapacityFactor,
                                               const double aReserveMargin,
-                                              const double aAverageGridCapacityFactor,
-                                              const int aPeriod ) const;
+                                              const double aAverageGridCapacityFactor ) const;
     
-    virtual double getAverageBackupCapacity( const std::string& aSector,
-                                             const std::string& aElectricSector,
-                                             const std::string& aResource,
-                                             const std::string& aRegion,
+    virtual double getAverageBackupCapacity( const double aTrialShare,
+                                             const double aResourceVariance,
                                              const double aTechCapacityFactor,
                                              const double aReserveMargin,
-                                             const double aAverageGridCapacityFactor,
-                                             const int aPeriod ) const;
+                                             const double aAverageGridCapacityFactor ) const;
 protected:
     static const std::string& getXMLNameStatic();
     CSPBackupCalculator();
 
-    double calcIntermittentShare( const std::string& aSector,
-                                  const std::string& aElectricSector,
-                                  const std::string& aResource,
-                                  const std::string& aRegion,
-                                  const double aTechCapacityFactor,
-                                  const double aReserveMargin,
-                                  const double aAverageGridCapacityFactor,
-                                  const int aPeriod ) const;
+    double calcIntermittentShare( const double aTrialShare ) const;
 
     // Define data such that introspection utilities can process the data from this
     // subclass together with the data members of the parent classes.
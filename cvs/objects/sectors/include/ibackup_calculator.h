@@ -79,6 +79,9 @@ public:
 
     /*!
      * \brief Pass parameter information into the backup calculator from the technology.
+     * \details This is called each period before any backup is calculated so
+     *          that any values which are fixed within the period may be looked
+     *          up once.
      * \param aTechInfo An info object containing information to be passed to the backup component.
      * \author Steve Smith
      */
@@ -88,51 +91,49 @@ public:
      * \brief Compute backup required for the marginal unit of energy output.
      * \details Compute backup required per resource energy output on the margin
      *          (since energy output is what the modeled market is based on).
-     * \param aSector The name of the sector which requires backup capacity.
-     * \param aElectricSector The name of the electricity sector into which the
-     *        sector having a backup amount calculated for will feed.
-     * \param aResource The name of the resource the sector consumes.
-     * \param aRegion Name of the containing region.
+     *          The trial share and resource variance are read from their
+     *          markets by the technology so that the markets may be located
+     *          once per period and so that the result may be reused while
+     *          neither value has changed.
+     * \param aTrialShare The trial share of the intermittent technology in
+     *        the electricity sector, or -1 if the trial market does not exist.
+     * \param aResourceVariance The variance of the intermittent resource as
+     *        of the current calculation.
+     * \param aTechCapacityFactor The capacity factor of the intermittent
+     *        technology.
      * \param aReserveMargin Reserve margin for the electricity sector.
      * \param aAverageGridCapacityFactor The average electricity grid capacity
      *        factor.
-     * \param aPeriod Model period.
      * \return Reserve capacity per marginal intermittent electricity resource
      *         output.
      */
-    virtual double getMarginalBackupCapacity( const std::string& aSector,
-                                              const std::string& aElectricSector,
-                                              const std::string& aResource,
-                                              const std::string& aRegion,
+    virtual double getMarginalBackupCapacity( const double aTrialShare,
+                                              const double aResourceVariance,
                                               const double aTechCapacityFactor,
                                               const double aReserveMargin,
-                                              const double aAverageGridCapacityFactor,
-                                              const int aPeriod ) const = 0;
+                                              const double aAverageGridCapacityFactor ) const = 0;
 
     /*!
      * \brief Compute the average backup required per unit for the intermittent
      *        subsector.
      * \details Computes the average quantity of backup capacity required per
      *          unit of energy output.
-     * \param aSector The name of the sector which requires backup capacity.
-     * \param aElectricSector The name of the electricity sector into which the
-     *        sector having a backup amount calculated for will feed.
-     * \param aResource The name of the resource the sector consumes.
-     * \param aRegion Name of the containing region.
+     * \param aTrialShare The trial share of the intermittent technology in
+     *        the electricity sector, or -1 if the trial market does not exist.
+     * \param aResourceVariance The variance of the intermittent resource as
+     *        of the current calculation.
+     * \param aTechCapacityFactor The capacity factor of the intermittent
+     *        technology.
      * \param aReserveMargin Reserve margin for the electricity sector.
      * \param aAverageGridCapacityFactor The average electricity grid capacity
      *        factor.
-     * \param aPeriod Model period.
      * \return The average backup capacity required per unit of output.
      */
-    virtual double getAverageBackupCapacity( const std::string& aSector,
-                                             const std::string& aElectricSector,
-                                             const std::string& aResource,
-                                             const std::string& aRegion,
+    virtual double getAverageBackupCapacity( const double aTrialShare,
+                                             const double aResourceVariance,
                                              const double aTechCapacityFactor,
                                              const double aReserveMargin,
-                                             const double aAverageGridCapacityFactor,
-                                             const int aPeriod ) const = 0;
+                                             const double aAverageGridCapacityFactor ) const = 0;
     
 protected:
     
@@ -102,23 +102,17 @@ public:
     virtual void toDebugXML( const int aPeriod, std::ostream& aOut, Tabs* aTabs ) const;
     virtual void initCalc( const IInfo* aTechInfo );
     
-    virtual double getMarginalBackupCapacity( const std::string& aSector,
-                                              const std::string& aElectricSector,
-                                              const std::string& aResource,
-                                              const std::string& aRegion,
+    virtual double getMarginalBackupCapacity( const double aTrialShare,
+                                              const double aResourceVariance,
                                               const double aTechCapacityFactor,
                                               const double aReserveMargin,
-                                              const double aAverageGridCapacityFactor,
-                                              const int aPeriod ) const;
+                                              const double aAverageGridCapacityFactor ) const;
 
-    virtual double getAverageBackupCapacity( const std::string& aSector,
-                                             const std::string& aElectricSector,
-                                             const std::string& aResource,
-                                             const std::string& aRegion,
+    virtual double getAverageBackupCapacity( const double aTrialShare,
+                                             const double aResourceVariance,
                                              const double aTechCapacityFactor,
                                              const double aReserveMargin,
-                                             const double aAverageGridCapacityFactor,
-                                             const int aPeriod ) const;
+                                             const double aAverageGridCapacityFactor ) const;
 protected:
     
     // Define data such that introspection utilities can process the data from this
@@ -129,14 +123,11 @@ protected:
     
     static const std::string& getXMLNameStatic();
 
-    double getBackupCapacityFraction( const std::string& aSector,
-                                      const std::string& aElectricSector,
-                                      const std::string& aResource,
-                                      const std::string& aRegion,
+    double getBackupCapacityFraction( const double aTrialShare,
+                                      const double aResourceVariance,
                                       const double aTechCapacityFactor,
                                       const double aReserveMargin,
-                                      const double aAverageGridCapacityFactor,
-                                      const int aPeriod ) const;
+                                      const double aAverageGridCapacityFactor ) const;
 
     double getReserveTotal( const std::string& aElectricSector,
                             const std::string& aRegion,
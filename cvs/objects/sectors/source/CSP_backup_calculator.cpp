@@ -155,14 +155,11 @@ void CSPBackupCalculator::initCalc( const IInfo* aTechInfo ) {
                      - min( scheduledMaintenance * ( 1 - randomMaintenanceFraction ), justNoSunDayBackup );
 }
 
-double CSPBackupCalculator::getMarginalBackupCapacity( const string& aSector,
-                                                       const string& aElectricSector,
-                                                       const string& aResource,
-                                                       const string& aRegion,
+double CSPBackupCalculator::getMarginalBackupCapacity( const double aTrialShare,
+                                                       const double aResourceVariance,
                                                        const double aTechCapacityFactor,
                                                        const double aReserveMargin,
-                                                       const double aAverageGridCapacityFactor,
-                                                       const int aPeriod ) const
+                                                       const double aAverageGridCapacityFactor ) const
 {    
     //! Marginal backup calculation is used for marginal cost of backup capacity
     //! and used in the cost of backup for share equations. 
@@ -171,31 +168,22 @@ double CSPBackupCalculator::getMarginalBackupCapacity( const string& aSector,
 
     return 0.0;
 }
-double CSPBackupCalculator::getAverageBackupCapacity( const string& aSector,
-                                                      const string& aElectricSector,
-                                                      const string& aResource,
-                                                      const string& aRegion,
+double CSPBackupCalculator::getAverageBackupCapacity( const double aTrialShare,
+                                                      const double aResourceVariance,
                                                       const double aTechCapacityFactor,
                                                       const double aReserveMargin,
-                                                      const double aAverageGridCapacityFactor,
-                                                      const int aPeriod ) const
+                                                      const double aAverageGridCapacityFactor ) const
 {
     //! Average backup is needed for CSP since it is used to compute the amount
     //! of energy used by the backup technology.
     
     // Preconditions
-    assert( !aSector.empty() );
-    assert( !aElectricSector.empty() );
-    assert( !aResource.empty() );
-    assert( !aRegion.empty() );
     assert( aReserveMargin >= 0 );
     assert( aAverageGridCapacityFactor > 0 );
 
     // Determine the intermittent share of output.
     // Note that this method in CSP differs as it is based on energy share not capacity
-    double elecShare = calcIntermittentShare( aSector, aElectricSector, aResource,
-                                              aRegion, aTechCapacityFactor, aReserveMargin, aAverageGridCapacityFactor,
-                                              aPeriod );
+    double elecShare = calcIntermittentShare( aTrialShare );
 
     // No backup required for zero share.
     if( elecShare < util::getSmallNumber() ){
@@ -227,29 +215,15 @@ double CSPBackupCalculator::getAverageBackupCapacity( const string& aSector,
  * \details Calculates the share of energy of the intermittent resource within
  *          the electricity sector. This is determined using trial values for
  *          the intermittent sector and electricity sector production.
- * \param aSector The name of the sector which requires backup capacity.
- * \param aElectricSector The name of the electricity sector into which the
- *        sector having a backup amount calculated for will feed.
- * \param aResource The name of the resource the sector consumes.
- * \param aRegion Name of the containing region.
- * \param aReserveMargin Reserve margin for the electricity sector.
- * \param aAverageGridCapacityFactor The average electricity grid capacity
- *        factor.
- * \param aPeriod Model period.
+ * \param aTrialShare The trial share of the intermittent technology in the
+ *        electricity sector.
  * \return Share of the intermittent resource within within the electricity
  *         sector.
  */
-double CSPBackupCalculator::calcIntermittentShare( const string& aSector,
-                                                   const string& aElectricSector,
-                                                   const string& aResource,
-                                                   const string& aRegion,
-                                                   const double aTechCapacityFactor,
-                                                   const double aReserveMargin,
-                                                   const double aAverageGridCapacityFactor,
-                                                   const int aPeriod ) const
+double CSPBackupCalculator::calcIntermittentShare( const double aTrialShare ) const
 {
     //! Note that the CSP backup is based on share of energy, not capacity, 
     //! so capacity factor and conversions to capacity not used.
     
-    return SectorUtils::getTrialSupply( aRegion, aSector, aPeriod ) / mMaxSectorLoadServed;
+    return aTrialShare / mMaxSectorLoadServed;
 }
@@ -100,31 +100,21 @@ void WindBackupCalculator::initCalc( const IInfo* aTechInfo ) {
     // No information needs to be passed in
 }
 
-double WindBackupCalculator::getAverageBackupCapacity( const string& aSector,
-                                                       const string& aElectricSector,
-                                                       const string& aResource,
-                                                       const string& aRegion,
+double WindBackupCalculator::getAverageBackupCapacity( const double aTrialShare,
+                                                       const double aResourceVariance,
                                                        const double aTechCapacityFactor,
                                                        const double aReserveMargin,
-                                                       const double aAverageGridCapacityFactor,
-                                                       const int aPeriod ) const
+                                                       const double aAverageGridCapacityFactor ) const
 {
     // Preconditions
-    assert( !aSector.empty() );
-    assert( !aElectricSector.empty() );
-    assert( !aResource.empty() );
-    assert( !aRegion.empty() );
     assert( aReserveMargin >= 0 );
     assert( aAverageGridCapacityFactor > 0 );
     
-    double backupFraction = getBackupCapacityFraction( aSector,
-                                                       aElectricSector,
-                                                       aResource,
-                                                       aRegion,
+    double backupFraction = getBackupCapacityFraction( aTrialShare,
+                                                       aResourceVariance,
                                                        aTechCapacityFactor,
                                                        aReserveMargin,
-                                                       aAverageGridCapacityFactor,
-                                                       aPeriod );
+                                                       aAverageGridCapacityFactor );
     
     // This is confusing but mathematically correct.  The backupCapacityFraction is in units of 
     // GW per GW.  The denominator (intermittent sector capacity GW) needs to be converted to energy,
@@ -135,20 +125,13 @@ double WindBackupCalculator::getAverageBackupCapacity( const string& aSector,
     return backupFraction;
 }
 
-double WindBackupCalculator::getMarginalBackupCapacity( const string& aSector,
-                                                        const string& aElectricSector,
-                                                        const string& aResource,
-                                                        const string& aRegion,
+double WindBackupCalculator::getMarginalBackupCapacity( const double aTrialShare,
+                                                        const double aResourceVariance,
                                                         const double aTechCapacityFactor,
                                                         const double aReserveMargin,
-                                                        const double aAverageGridCapacityFactor,
-                                                        const int aPeriod ) const
+                                                        const double aAverageGridCapacityFactor ) const
 {
     // Preconditions
-    assert( !aSector.empty() );
-    assert( !aElectricSector.empty() );
-    assert( !aResource.empty() );
-    assert( !aRegion.empty() );
     assert( aReserveMargin >= 0 );
     assert( aAverageGridCapacityFactor > 0 );
     
@@ -156,9 +139,8 @@ double WindBackupCalculator::getMarginalBackupCapacity( const string& aSector,
     const double HOURS_PER_YEAR = 8760;
     const double UC = 1 / (EJ_PER_GWH * HOURS_PER_YEAR); // [GWe/EJ]
 
-    double variance = SectorUtils::getVariance( aResource, aRegion, aPeriod );
-    double trialCapacityShare = SectorUtils::getTrialSupply( aRegion, aSector, aPeriod )
-                              * ( aAverageGridCapacityFactor / aTechCapacityFactor );
+    double variance = aResourceVariance;
+    double trialCapacityShare = aTrialShare * ( aAverageGridCapacityFactor / aTechCapacityFactor );
     
     // Compute terms for Winds operating reserve due to intermittency formula
     // This is the derivative of the total backup capacity equation.
@@ -180,32 +162,23 @@ double WindBackupCalculator::getMarginalBackupCapacity( const string& aSector,
  *          intermittent capacity, then convert to backup capacity as fraction
  *          of wind resource output in energy terms, since that is what the
  *          model and market are based on.
- * \param aSector The name of the sector which requires backup capacity.
- * \param aElectricSector The name of the electricity sector into which the
- *        sector having a backup amount calculated for will feed.
- * \param aResource The name of the resource the sector consumes.
- * \param aRegion Name of the containing region.
+ * \param aTrialShare The trial share of the intermittent technology in the
+ *        electricity sector.
+ * \param aResourceVariance The variance of the intermittent resource.
+ * \param aTechCapacityFactor The capacity factor of the intermittent technology.
  * \param aReserveMargin Reserve margin for the electricity sector.
  * \param aAverageGridCapacityFactor The average electricity grid capacity
  *        factor.
- * \param aPeriod Model period.
  * \return Percent of reserve capacity per unit of intermittent capacity (e.g.,
  *         GW/GW).
  */
-double WindBackupCalculator::getBackupCapacityFraction( const string& aSector,
-                                                        const string& aElectricSector,
-                                                        const string& aResource,
-                                                        const string& aRegion,
+double WindBackupCalculator::getBackupCapacityFraction( const double aTrialShare,
+                                                        const double aResourceVariance,
                                                         const double aTechCapacityFactor,
                                                         const double aReserveMargin,
-                                                        const double aAverageGridCapacityFactor,
-                                                        const int aPeriod ) const
+                                                        const double aAverageGridCapacityFactor ) const
 {
     // Preconditions
-    assert( !aSector.empty() );
-    assert( !aElectricSector.empty() );
-    assert( !aResource.empty() );
-    assert( !aRegion.empty() );
     assert( aReserveMargin >= 0 );
     assert( aAverageGridCapacityFactor > 0 );
 
@@ -213,9 +186,8 @@ double WindBackupCalculator::getBackupCapacityFraction( const string& aSector,
     const double HOURS_PER_YEAR = 8760;
     const double UC = 1 / (EJ_PER_GWH * HOURS_PER_YEAR); // [GWe/EJ]
 
-    double variance = SectorUtils::getVariance( aResource, aRegion, aPeriod );
-    double trialCapacityShare = SectorUtils::getTrialSupply( aRegion, aSector, aPeriod )
-                              * ( aAverageGridCapacityFactor / aTechCapacityFactor );
+    double variance = aResourceVariance;
+    double trialCapacityShare = aTrialShare * ( aAverageGridCapacityFactor / aTechCapacityFactor );
 
     // Compute terms for Winds operating reserve due to intermittency formula
     double backupCapacityFraction = aReserveMargin * UC / aTechCapacityFactor / trialCapacityShare *
@@ -0,0 +1,145 @@
+#ifndef _ANDERSON_ACCELERATION_HPP_
+#define _ANDERSON_ACCELERATION_HPP_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file anderson_acceleration.hpp
+ * \ingroup Objects
+ * \brief Header file for the Anderson acceleration solver component.
+ */
+
+#include <string>
+#include <memory>
+
+class CalcCounter; 
+class Marketplace;
+class World;
+class SolutionInfoSet;
+class ISolutionInfoFilter;
+
+/*!
+ * \ingroup Objects
+ * \brief A SolverComponent which accelerates a damped fixed-point iteration on
+ *        prices with Anderson mixing.
+ *
+ * \details In the early iterations of a period prices are often far enough
+ *          from the solution that the Jacobian LogBroyden calculates up front
+ *          is of little use by the time it gets close.  This component instead
+ *          iterates the fixed-point map G( x ) = x + beta * S * F( x ), where
+ *          F is the same LogEDFun the other solvers use and S is a diagonal
+ *          scaling, which costs a single model evaluation per iteration.  By
+ *          default S = -1 / diag( J ) which is cheap to get with partial
+ *          derivatives, turning the iteration into a Jacobi-Newton step.
+ *
+ *          Anderson mixing then combines the last memory-depth iterates to
+ *          extrapolate the next point:  gamma minimizes
+ *          | g_k - dG gamma | where g = G( x ) - x and dG holds the
+ *          differences of successive g, and the new point is
+ *          x_k + g_k - ( dX + dG ) gamma.  The following safeguards are
+ *          applied:
+ *          - Columns are dropped from the history, oldest first, while the
+ *            least squares problem is rank deficient.
+ *          - The step is scaled back so no price moves by more than max-step.
+ *          - If |F| grows by more than safeguard-factor relative to the best
+ *            point found the step is rejected, the history is cleared and the
+ *            iteration restarts from the best point with a plain damped step.
+ *            Repeated failures of plain steps halve the relaxation beta.
+ *
+ *          The component always leaves the markets at the best point it found
+ *          so that it may be followed by another solver component for the
+ *          final convergence.  Iterations and evaluations are both reported
+ *          through the CalcCounter.
+ *
+ *          <anderson-solver-component>
+ *              <max-iterations>Maximum iterations</max-iterations>
+ *              <ftol>Convergence tolerance</ftol>
+ *              <memory-depth>Number of past iterates to mix</memory-depth>
+ *              <relaxation>Damping beta of the fixed-point map</relaxation>
+ *              <max-step>Largest change in any scaled price per iteration</max-step>
+ *              <safeguard-factor>Growth in |F| at which a step is rejected</safeguard-factor>
+ *              <diagonal-scaling>bool</diagonal-scaling>
+ *              <linear-price/> or <log-price/>
+ *              <solution-info-filter>filter</solution-info-filter>
+ *          </anderson-solver-component>
+ */
+class AndersonAcceleration: public SolverComponent {
+public:
+    AndersonAcceleration( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter );
+    virtual ~AndersonAcceleration();
+    static const std::string& getXMLNameStatic();
+
+    // SolverComponent methods
+    virtual void init();
+    virtual ReturnCode solve( SolutionInfoSet& aSolutionSet, const int aPeriod );
+    virtual const std::string& getXMLName() const;
+
+    // IParsable methods
+    virtual bool XMLParse( const xercesc::DOMNode* aNode );
+
+protected:
+    //! Maximum number of iterations
+    unsigned int mMaxIter;
+
+    //! Tolerance for the convergence test on the scaled excess demands
+    double mFTOL;
+
+    //! The number of past iterates used in the Anderson mixing
+    unsigned int mMemoryDepth;
+
+    //! The damping beta in the fixed-point map
+    double mRelaxation;
+
+    //! The largest change allowed in any scaled price in a single iteration
+    double mMaxStep;
+
+    //! The growth in |F| relative to the best point at which a step is rejected
+    double mSafeguardFactor;
+
+    //! Whether to scale the fixed-point map by the diagonal of the Jacobian
+    bool mUseDiagScaling;
+
+    //! Flag indicating whether we should work in price or log-price
+    bool mLogPricep;
+
+    //! A filter which will be used to determine which SolutionInfos this solver
+    //! component will work on.
+    std::auto_ptr<ISolutionInfoFilter> mSolutionInfoFilter;
+};
+
+#endif // _ANDERSON_ACCELERATION_HPP_
@@ -51,11 +51,21 @@ class CalcCounter;
 class Marketplace;
 class World;
 class SolutionInfoSet;
+class SolutionInfo;
 class ISolutionInfoFilter;
 
 /*! 
 * \ingroup Objects
 * \brief A class interface which defines the BisectAll solver component.
+* \details When use-partial-calcs is set each bisection iteration first bisects
+*          every bracketed, unsolved market on its own using partial calculations
+*          of just the activities which depend on it, holding all other prices
+*          fixed.  The markets are bisected concurrently each in its own
+*          "scratch" state.  This only picks the next trial price of each market,
+*          the combined prices are then confirmed with a single full evaluation
+*          and the brackets updated from it as usual.  This pays
+*          off when many of the markets are nearly independent of each other,
+*          such as regional water or land constraints.
 * \author Josh Lurz
 */
 
@@ -84,12 +94,21 @@ protected:
 
     //! Max iterations for bracketing
     unsigned int mMaxBracketIterations;
+
+    //! Whether to bisect each market with partial calculations before each
+    //! full evaluation
+    bool mUsePartialCalcs;
+
+    //! Max partial bisection steps for each market per iteration
+    unsigned int mMaxPartialIterations;
     
     //! A filter which will be used to determine which SolutionInfos this solver component
     //! will work on.
     std::auto_ptr<ISolutionInfoFilter> mSolutionInfoFilter;
     
     bool areAllBracketsEqual( SolutionInfoSet& aSolutionSet ) const;
+
+    double bisectPartial( const SolutionInfo& aSol, const int aPeriod ) const;
 };
 
 #endif // _BISECT_ALL_H_
@@ -0,0 +1,135 @@
+#ifndef _BLOCK_TRIANGULAR_SOLVER_HPP_
+#define _BLOCK_TRIANGULAR_SOLVER_HPP_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file block_triangular_solver.hpp
+ * \ingroup Objects
+ * \brief Header file for the block triangular solver component.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "solution/util/include/ublas-helpers.hpp"
+
+class CalcCounter; 
+class Marketplace;
+class World;
+class SolutionInfoSet;
+class SolutionInfo;
+class ISolutionInfoFilter;
+class LogEDFun;
+class IActivity;
+
+/*!
+ * \ingroup Objects
+ * \brief A SolverComponent which splits the markets into independent blocks
+ *        and solves each block separately.
+ *
+ * \details The structure of which markets' excess demands depend on which
+ *          markets' prices is determined by the market dependencies found by
+ *          the MarketDependencyFinder: changing the price of a market only
+ *          recalculates the activities that depend on it and only the markets
+ *          to which those activities contribute can change.  This is known
+ *          without calculating any derivatives.  The strongly connected
+ *          components of that structure, in topological order, reduce the
+ *          system to block triangular form.
+ *
+ *          Blocks are then solved in topological order using Broyden's method
+ *          on just the markets in the block.  Each evaluation only recalculates
+ *          the activities which depend on the markets in the block, relative to
+ *          the state of the last full model calculation.  Blocks which do not
+ *          depend on each other (the same level in the topological order) are
+ *          solved in parallel.  After each level a full model calculation
+ *          is done so that the following levels see the updated prices.
+ *
+ *          When most markets are only loosely coupled (many small blocks) this
+ *          replaces a dense solve, whose cost grows as the cube of the number of
+ *          markets, with many small ones.  Any coupling that only appears away
+ *          from the initial point is caught by the convergence check after the
+ *          final full calculation in which case a failure code is returned so
+ *          that subsequent solver components can finish the job.
+ *
+ *          <block-triangular-solver-component>
+ *              <max-iterations>Maximum iterations per block</max-iterations>
+ *              <ftol>Convergence tolerance</ftol>
+ *              <linear-price/> or <log-price/>
+ *              <solution-info-filter>filter</solution-info-filter>
+ *          </block-triangular-solver-component>
+ */
+class BlockTriangularSolver: public SolverComponent {
+public:
+    BlockTriangularSolver( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter );
+    virtual ~BlockTriangularSolver();
+    static const std::string& getXMLNameStatic();
+
+    // SolverComponent methods
+    virtual void init();
+    virtual ReturnCode solve( SolutionInfoSet& aSolutionSet, const int aPeriod );
+    virtual const std::string& getXMLName() const;
+
+    // IParsable methods
+    virtual bool XMLParse( const xercesc::DOMNode* aNode );
+
+protected:
+    //! Maximum number of iterations to use when solving a single block
+    unsigned int mMaxIter;
+
+    //! Tolerance for the convergence test on the scaled excess demands
+    double mFTOL;
+
+    //! Flag indicating whether we should work in price or log-price
+    bool mLogPricep;
+
+    //! A filter which will be used to determine which SolutionInfos this solver
+    //! component will work on.
+    std::auto_ptr<ISolutionInfoFilter> mSolutionInfoFilter;
+
+    void findDependencies( const std::vector<SolutionInfo>& aMarkets, const int aPeriod,
+                           UBMATRIX& aPattern ) const;
+
+    static void findBlocks( const UBMATRIX& aJ, std::vector<std::vector<int> >& aBlocks,
+                            std::vector<int>& aLevels );
+
+    int solveBlock( LogEDFun& aF, const UBVECTOR& aX, const UBVECTOR& aFX,
+                    const std::vector<int>& aBlock, const std::vector<IActivity*>& aCalcList,
+                    UBVECTOR& aXOut, int& aNumEval ) const;
+};
+
+#endif // _BLOCK_TRIANGULAR_SOLVER_HPP_
@@ -73,11 +73,14 @@ class SolutionInfoSet;
  * \author Robert Link
  */
 class LogBroyden: public SolverComponent {
+  // The saved Jacobian is written to checkpoints.
+  friend class Checkpoint;
 public:
   LogBroyden(Marketplace *mktplc, World *world, CalcCounter *ccounter, int itmax=250,
              double ftol=1.0e-4) :
       SolverComponent(mktplc,world,ccounter), mMaxIter( itmax ), mFTOL( ftol ),
-      mLogPricep( true ), mMaxJacobainReuse( 100 ) {}
+      mLogPricep( true ), mMaxJacobainReuse( 100 ), mReuseJacobianAcrossPeriods( false ),
+      mLinesearchPoints( 1 ) {}
   virtual ~LogBroyden() {}
 
   // SolverComponent methods
@@ -96,7 +99,12 @@ public:
 protected:
   //! Perform the Broyden's method iterations.
   int bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
-             UBMATRIX &B, int &neval);
+             UBMATRIX &B, int &neval, bool aReusedB = false);
+  //! Seed the initial Jacobian from the one saved at the end of the previous period.
+  int seedJacobianFromLastPeriod(const SolutionInfoSet &aSolnset, LogEDFun &F, const UBVECTOR &x,
+                                 const UBVECTOR &fx, UBMATRIX &J, int aPeriod);
+  //! Save the final Jacobian so that the next period can start from it.
+  void saveJacobian(const SolutionInfoSet &aSolnset, const LogEDFun &F, const UBMATRIX &B, int aPeriod);
   //! Additional logging for visualizing solver progress.
   void reportVec(const std::string &aname, const UBVECTOR &av, const std::vector<int> &amktids,
                  const std::vector<bool> &aissolvable);
@@ -128,6 +136,24 @@ protected:
   //! which if set to zero implies this algorithm just collapse to a regular NR algorithm
   int mMaxJacobainReuse;
 
+  //! Flag indicating that the initial Jacobian should be seeded from the
+  //! final Broyden matrix of the previous period rather than computed from
+  //! scratch.  Columns for markets that were not solved in the previous
+  //! period are still computed by finite differences.
+  bool mReuseJacobianAcrossPeriods;
+
+  //! The number of step lengths the line search tries at once when it has to
+  //! backtrack.  A value of one gives the original serial line search.
+  int mLinesearchPoints;
+
+  // The saved Jacobian is shared by all logbroyden solvers for the same reason
+  // as mLastPer.  It is stored unscaled so that it can be rescaled using the
+  // scale factors of the period in which it is reused.
+  static UBMATRIX mLastJacobian;           //<! unscaled final Broyden matrix from the last solve
+  static std::vector<int> mLastJacobianMktIDs; //<! market serial numbers for the rows/cols of mLastJacobian
+  static int mLastJacobianPer;             //<! period in which mLastJacobian was saved (-1 if none)
+  static bool mLastJacobianLogPricep;      //<! whether mLastJacobian was computed in log-price mode
+
 private:
   static std::string SOLVER_NAME;
 };
@@ -0,0 +1,134 @@
+#ifndef _NEWTON_KRYLOV_HPP_
+#define _NEWTON_KRYLOV_HPP_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file newton_krylov.hpp
+ * \ingroup Objects
+ * \brief Header file for the Jacobian-free Newton-Krylov solver component.
+ */
+
+#include <string>
+#include <memory>
+
+class CalcCounter; 
+class Marketplace;
+class World;
+class SolutionInfoSet;
+class ISolutionInfoFilter;
+
+/*!
+ * \ingroup Objects
+ * \brief A SolverComponent based on Newton's method in which each Newton step
+ *        is solved with a Krylov subspace method without ever forming the
+ *        Jacobian.
+ *
+ * \details Both LogBroyden and LogNewtonRaphson store a dense Jacobian and
+ *          factor it, which for configurations with a very large number of
+ *          solvable markets dominates both the time and memory of the solver.
+ *          Here each step J dx = -F(x) is instead solved with GMRES or
+ *          BiCGStab, which only need products of J with a vector.  These are
+ *          approximated by directional differences of the same LogEDFun the
+ *          other solvers use: J v ~= ( F( x + h v ) - F( x ) ) / h, at the cost
+ *          of one model evaluation each.
+ *
+ *          The Krylov solve is preconditioned by the diagonal of the Jacobian
+ *          which is cheap to calculate with partial derivatives, and only
+ *          needs to be stored as a vector.  The diagonal is calculated once and
+ *          only refreshed when the Newton step fails to make progress.  The
+ *          Newton steps are inexact: the linear solve only needs to reduce the
+ *          residual by the forcing term relative to |F(x)|.  Steps are then
+ *          globalized with the same line search used by LogBroyden.
+ *
+ *          <newton-krylov-solver-component>
+ *              <max-iterations>Maximum Newton iterations</max-iterations>
+ *              <ftol>Convergence tolerance</ftol>
+ *              <krylov-method>gmres or bicgstab</krylov-method>
+ *              <krylov-restart>GMRES restart length</krylov-restart>
+ *              <max-krylov-iterations>Maximum Krylov iterations per step</max-krylov-iterations>
+ *              <forcing-term>Relative tolerance of each linear solve</forcing-term>
+ *              <diagonal-preconditioner>bool</diagonal-preconditioner>
+ *              <linear-price/> or <log-price/>
+ *              <solution-info-filter>filter</solution-info-filter>
+ *          </newton-krylov-solver-component>
+ */
+class NewtonKrylov: public SolverComponent {
+public:
+    NewtonKrylov( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter );
+    virtual ~NewtonKrylov();
+    static const std::string& getXMLNameStatic();
+
+    // SolverComponent methods
+    virtual void init();
+    virtual ReturnCode solve( SolutionInfoSet& aSolutionSet, const int aPeriod );
+    virtual const std::string& getXMLName() const;
+
+    // IParsable methods
+    virtual bool XMLParse( const xercesc::DOMNode* aNode );
+
+protected:
+    //! Maximum number of Newton iterations
+    unsigned int mMaxIter;
+
+    //! Tolerance for the convergence test on the scaled excess demands
+    double mFTOL;
+
+    //! Whether to use BiCGStab rather than GMRES to solve each Newton step
+    bool mUseBiCGStab;
+
+    //! The number of GMRES iterations between restarts
+    int mKrylovRestart;
+
+    //! The maximum number of Krylov iterations per Newton step
+    int mMaxKrylovIter;
+
+    //! The tolerance of each linear solve relative to |F(x)|
+    double mForcingTerm;
+
+    //! Whether to precondition with the diagonal of the Jacobian
+    bool mUseDiagPreconditioner;
+
+    //! Flag indicating whether we should work in price or log-price
+    bool mLogPricep;
+
+    //! A filter which will be used to determine which SolutionInfos this solver
+    //! component will work on.
+    std::auto_ptr<ISolutionInfoFilter> mSolutionInfoFilter;
+};
+
+#endif // _NEWTON_KRYLOV_HPP_
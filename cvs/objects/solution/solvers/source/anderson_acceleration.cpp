@@ -0,0 +1,365 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file anderson_acceleration.cpp
+ * \ingroup objects
+ * \brief AndersonAcceleration class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/anderson_acceleration.hpp"
+#include "solution/util/include/calc_counter.h"
+#include "marketplace/include/marketplace.h"
+#include "containers/include/world.h"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+#include "util/base/include/xml_helper.h"
+#include "solution/util/include/solution_info_filter_factory.h"
+#include "solution/util/include/solvable_solution_info_filter.h"
+
+#include "solution/util/include/fdjac.hpp"
+#include "solution/util/include/edfun.hpp"
+
+#include "util/base/include/timer.h"
+
+#include <Eigen/QR>
+
+using namespace std;
+using namespace xercesc;
+
+AndersonAcceleration::AndersonAcceleration( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter ):
+SolverComponent( aMarketplace, aWorld, aCalcCounter ),
+mMaxIter( 30 ),
+mFTOL( 1.0e-4 ),
+mMemoryDepth( 5 ),
+mRelaxation( 1.0 ),
+mMaxStep( 1.0 ),
+mSafeguardFactor( 2.0 ),
+mUseDiagScaling( true ),
+mLogPricep( true )
+{
+}
+
+AndersonAcceleration::~AndersonAcceleration() {
+}
+
+const string& AndersonAcceleration::getXMLNameStatic() {
+    const static string SOLVER_NAME = "anderson-solver-component";
+    return SOLVER_NAME;
+}
+
+const string& AndersonAcceleration::getXMLName() const {
+    return getXMLNameStatic();
+}
+
+void AndersonAcceleration::init() {
+    if( !mSolutionInfoFilter.get() ) {
+        mSolutionInfoFilter.reset( new SolvableSolutionInfoFilter() );
+    }
+}
+
+bool AndersonAcceleration::XMLParse( const DOMNode* aNode ) {
+    // assume we were passed a valid node.
+    assert( aNode );
+
+    // get the children of the node.
+    DOMNodeList* nodeList = aNode->getChildNodes();
+
+    // loop through the children
+    for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+        DOMNode* curr = nodeList->item( i );
+        string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+
+        if( nodeName == "#text" ) {
+            continue;
+        }
+        else if( nodeName == "max-iterations" ) {
+            mMaxIter = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "ftol" ) {
+            mFTOL = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "memory-depth" ) {
+            mMemoryDepth = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "relaxation" ) {
+            mRelaxation = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "max-step" ) {
+            mMaxStep = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "safeguard-factor" ) {
+            mSafeguardFactor = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "diagonal-scaling" ) {
+            mUseDiagScaling = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "linear-price" ) {
+            mLogPricep = false;
+        }
+        else if( nodeName == "log-price" ) {
+            mLogPricep = true;
+        }
+        else if( nodeName == "solution-info-filter" ) {
+            mSolutionInfoFilter.reset(
+                SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
+        }
+        else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
+            mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing "
+                    << getXMLNameStatic() << "." << endl;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Anderson accelerated fixed-point iteration.
+ * \details See the class documentation for a description of the algorithm.
+ * \param aSolutionSet The set of markets to solve.
+ * \param aPeriod Model period.
+ * \return Status code indicating whether the algorithm was successful or not.
+ */
+SolverComponent::ReturnCode AndersonAcceleration::solve( SolutionInfoSet& aSolutionSet, const int aPeriod ) {
+    // If all markets are solved, then return with success code.
+    if( aSolutionSet.isAllSolved() ) {
+        return SUCCESS;
+    }
+
+    startMethod();
+
+    // Need to update solvable status before starting solution (Ignore return code)
+    aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
+
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::NOTICE );
+    const int nsolv = aSolutionSet.getNumSolvable();
+    solverLog << "Beginning Anderson acceleration for period " << aPeriod
+              << ", solving " << nsolv << " markets with memory depth " << mMemoryDepth << "." << endl;
+    if( nsolv == 0 ) {
+        solverLog << "No markets were assigned to this solver.  Exiting." << endl;
+        return SUCCESS;
+    }
+
+    ILogger& worstMarketLog = ILogger::getLogger( "worst_market_log" );
+    worstMarketLog.setLevel( ILogger::DEBUG );
+
+    Timer& solverTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::SOLVER );
+    solverTimer.start();
+
+    vector<SolutionInfo> smkts( aSolutionSet.getSolvableSet() );
+    UBVECTOR x( nsolv ), fx( nsolv );
+    for( int i = 0; i < nsolv; ++i ) {
+        x[ i ] = mLogPricep ? log( max( smkts[ i ].getPrice(), util::getTinyNumber() ) ) : smkts[ i ].getPrice();
+    }
+
+    LogEDFun F( aSolutionSet, world, marketplace, aPeriod, mLogPricep );
+    F.scaleInitInputs( x );
+    F( x, fx );
+    int neval = 1;
+
+    // The scaling S in G( x ) = x + beta * S * F( x ).  Excess demand falls as
+    // price rises in a normal market so without any other information we can
+    // just use S = 1.  Otherwise use the inverse of the diagonal of the
+    // Jacobian which also corrects for markets where that is not the case.
+    UBVECTOR S( UBVECTOR::Ones( nsolv ) );
+    if( mUseDiagScaling ) {
+        UBVECTOR D( nsolv );
+        fdjacdiag( F, x, fx, D, true );
+        neval += nsolv;
+        for( int i = 0; i < nsolv; ++i ) {
+            if( util::isValidNumber( D[ i ] ) && fabs( D[ i ] ) > util::getVerySmallNumber() ) {
+                S[ i ] = -1.0 / D[ i ];
+            }
+        }
+    }
+
+    double beta = mRelaxation;
+    UBVECTOR g( beta * S.cwiseProduct( fx ) );
+
+    // The history of differences in x and g, most recent last.
+    vector<UBVECTOR> dxHist, dgHist;
+
+    UBVECTOR xbest( x );
+    double fbest = fx.norm();
+    int status = -1;
+    int numRejected = 0;
+    unsigned int iter = 0;
+    for( ; iter < mMaxIter; ++iter ) {
+        calcCounter->incrementIterations();
+        const double maxval = fx.cwiseAbs().maxCoeff();
+        solverLog.setLevel( ILogger::DEBUG );
+        solverLog << "Anderson iter= " << iter << "\tneval= " << neval << "\tmemory= " << dxHist.size()
+                  << "\tmax F(x)= " << maxval << "\n";
+        if( maxval <= mFTOL ) {
+            status = 0;
+            break;
+        }
+
+        // Mix the history to get the next step.  Drop the oldest columns while
+        // the least squares problem is rank deficient.
+        UBVECTOR dx( g );
+        const bool isAccelerated = !dxHist.empty();
+        while( !dgHist.empty() ) {
+            const int m = dgHist.size();
+            UBMATRIX dG( nsolv, m );
+            for( int j = 0; j < m; ++j ) {
+                dG.col( j ) = dgHist[ j ];
+            }
+            Eigen::ColPivHouseholderQR<UBMATRIX> qr( dG );
+            if( qr.rank() < m ) {
+                dxHist.erase( dxHist.begin() );
+                dgHist.erase( dgHist.begin() );
+                continue;
+            }
+            const UBVECTOR gamma( qr.solve( g ) );
+            for( int j = 0; j < m; ++j ) {
+                dx -= gamma[ j ] * ( dxHist[ j ] + dgHist[ j ] );
+            }
+            break;
+        }
+
+        const double maxdx = dx.cwiseAbs().maxCoeff();
+        if( !util::isValidNumber( maxdx ) ) {
+            dx = g;
+            dxHist.clear();
+            dgHist.clear();
+        }
+        else if( maxdx > mMaxStep ) {
+            dx *= mMaxStep / maxdx;
+        }
+
+        UBVECTOR xnew( x + dx ), fxnew( nsolv );
+        F( xnew, fxnew );
+        ++neval;
+        const double fnew = fxnew.norm();
+
+        if( !util::isValidNumber( fnew ) || fnew > mSafeguardFactor * fbest ) {
+            // Reject the step and go back to the best point, the model state
+            // must be restored too.
+            ++numRejected;
+            solverLog << "Rejected " << ( isAccelerated ? "accelerated" : "plain" )
+                      << " step with |F|= " << fnew << "  best |F|= " << fbest << "\n";
+            dxHist.clear();
+            dgHist.clear();
+            if( !isAccelerated ) {
+                beta *= 0.5;
+                if( beta < 1.0e-3 * mRelaxation ) {
+                    status = -4;
+                    x = xbest;
+                    F( x, fx );
+                    ++neval;
+                    break;
+                }
+            }
+            x = xbest;
+            F( x, fx );
+            ++neval;
+            g = beta * S.cwiseProduct( fx );
+            continue;
+        }
+
+        const UBVECTOR gnew( beta * S.cwiseProduct( fxnew ) );
+        dxHist.push_back( xnew - x );
+        dgHist.push_back( gnew - g );
+        if( dxHist.size() > mMemoryDepth ) {
+            dxHist.erase( dxHist.begin() );
+            dgHist.erase( dgHist.begin() );
+        }
+        x = xnew;
+        fx = fxnew;
+        g = gnew;
+        if( fnew < fbest ) {
+            fbest = fnew;
+            xbest = x;
+        }
+
+        const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
+        addIteration( maxred->getName(), maxred->getRelativeED() );
+        worstMarketLog << "Anderson:  " << *maxred << "\n";
+    }
+
+    // Leave the markets at the best point found for whichever solver component
+    // goes next.
+    if( status != 0 && fx.norm() > fbest ) {
+        x = xbest;
+        F( x, fx );
+        ++neval;
+    }
+
+    solverTimer.stop();
+
+    ReturnCode code;
+    solverLog.setLevel( ILogger::NOTICE );
+    solverLog << "Anderson solver:  neval= " << neval << "  iterations= " << iter
+              << "  rejected steps= " << numRejected
+              << "\nResult:  ";
+    if( status == 0 ) {
+        code = SUCCESS;
+        solverLog << "Anderson solution success." << endl;
+    }
+    else if( status == -1 ) {
+        code = FAILURE_ITER_MAX_REACHED;
+        solverLog << "Anderson solution failed: Iteration max reached." << endl;
+    }
+    else {
+        code = FAILURE_POOR_PROGRESS;
+        solverLog << "Anderson solution failed:  repeated poor progress." << endl;
+    }
+    if( !aSolutionSet.isAllSolved() ) {
+        solverLog << "The following markets were not solved:" << endl;
+        aSolutionSet.printUnsolved( solverLog );
+    }
+
+    const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
+    addIteration( maxred->getName(), maxred->getRelativeED() );
+    worstMarketLog << "###Anderson-end:  " << *maxred << endl;
+
+    return code;
+}
@@ -40,6 +40,8 @@
 
 #include "util/base/include/definitions.h"
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
@@ -59,6 +61,15 @@
 #include "solution/util/include/solvable_solution_info_filter.h"
 
 #include "util/base/include/timer.h"
+#include "containers/include/scenario.h"
+#include "util/base/include/manage_state_variables.hpp"
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+#endif
+
+extern Scenario* scenario;
 
 using namespace std;
 using namespace xercesc;
@@ -68,7 +79,9 @@ BisectAll::BisectAll( Marketplace* marketplaceIn, World* worldIn, CalcCounter* c
 mMaxIterations( 30 ),
 mDefaultBracketInterval( 0.4 ),
 mBracketTolerance( 1.0e-8 ),
-mMaxBracketIterations( 40 )
+mMaxBracketIterations( 40 ),
+mUsePartialCalcs( false ),
+mMaxPartialIterations( 10 )
 {
 }
 
@@ -118,6 +131,12 @@ bool BisectAll::XMLParse( const DOMNode* aNode ) {
         else if( nodeName == "max-bracket-iterations" ) {
             mMaxBracketIterations = XMLHelper<unsigned int>::getValue( curr );
         }
+        else if( nodeName == "use-partial-calcs" ) {
+            mUsePartialCalcs = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "max-partial-iterations" ) {
+            mMaxPartialIterations = XMLHelper<unsigned int>::getValue( curr );
+        }
         else if( nodeName == "solution-info-filter" ) {
             mSolutionInfoFilter.reset(
                 SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
@@ -201,8 +220,51 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
     do {
         solverLog.setLevel( ILogger::NOTICE );
         solverLog << "BisectionAll " << numIterations << endl;
+        calcCounter->incrementIterations();
         aSolutionSet.printMarketInfo( "Bisect All", calcCounter->getPeriodCount(), singleLog );
 
+        // Bisect each market on its own first if requested.  Note the model
+        // state is up to date with the current prices after bracketing and
+        // after each full evaluation below so it can serve as the "base" state.
+        vector<bool> isPartialBisected( aSolutionSet.getNumSolvable(), false );
+        if( mUsePartialCalcs ) {
+            vector<unsigned int> toBisect;
+            for ( unsigned int i = 0; i < aSolutionSet.getNumSolvable(); ++i ) {
+                const SolutionInfo& currSol = aSolutionSet.getSolvable( i );
+                if( currSol.isBracketed() && !currSol.isWithinTolerance() && !currSol.getDependencies().empty() ) {
+                    toBisect.push_back( i );
+                }
+            }
+            vector<double> newPrices( toBisect.size() );
+            marketplace->setIsDerivativeCalc( true );
+            scenario->getManageStateVariables()->setPartialDeriv( true );
+#if GCAM_PARALLEL_ENABLED
+            tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+            tbb::task_group tg;
+            threadPool.execute( [&]() {
+                tg.run( [&]() {
+                    tbb::parallel_for( size_t( 0 ), toBisect.size(), [&]( const size_t j ) {
+                        newPrices[ j ] = bisectPartial( aSolutionSet.getSolvable( toBisect[ j ] ), aPeriod );
+                    } );
+                } );
+            } );
+            threadPool.execute( [&tg]() { tg.wait(); } );
+#else
+            for( size_t j = 0; j < toBisect.size(); ++j ) {
+                newPrices[ j ] = bisectPartial( aSolutionSet.getSolvable( toBisect[ j ] ), aPeriod );
+            }
+#endif
+            marketplace->setIsDerivativeCalc( false );
+            scenario->getManageStateVariables()->setPartialDeriv( false );
+
+            // Now that we are back in the "base" state set the combined prices.
+            for( size_t j = 0; j < toBisect.size(); ++j ) {
+                aSolutionSet.getSolvable( toBisect[ j ] ).setPrice( newPrices[ j ] );
+                isPartialBisected[ toBisect[ j ] ] = true;
+            }
+            solverLog << "Bisected " << toBisect.size() << " markets using partial calculations." << endl;
+        }
+
         // Since bisection is called after bracketing, the current price and ED will be the
         // one of the brackets.
         // Start bisection with mid-point to improve efficiency.
@@ -212,8 +274,8 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
             if( !currSol.isBracketed() ) {
                 continue;
             }
-            // If not solved.
-            if ( !currSol.isWithinTolerance() ) {
+            // If not solved and not already moved by the partial bisection.
+            if ( !currSol.isWithinTolerance() && !isPartialBisected[ i ] ) {
                 // Set new trial value to center
                 currSol.setPriceToCenter();
             }   
@@ -281,6 +343,58 @@ SolverComponent::ReturnCode BisectAll::solve( SolutionInfoSet& aSolutionSet, con
     return code;
 }
 
+/*!
+ * \brief Bisect a single market using partial calculations to pick its next
+ *        trial price.
+ * \details Each step resets the "scratch" state for the current thread back to
+ *          the "base" state, sets the price of the market to the center of the
+ *          brackets and recalculates only the activities which depend on it.
+ *          The brackets are moved as in the regular bisection, but on a copy of
+ *          aSol since partial excess demands hold all other prices fixed and
+ *          so can not be used to rule out any prices.  The brackets of aSol are
+ *          only moved by the full evaluation in solve.  This stops once the
+ *          market is within tolerance, the brackets have collapsed, or
+ *          mMaxPartialIterations steps have been taken.  The caller must have
+ *          turned on partial derivative state, and may call this concurrently
+ *          for different markets.
+ * \param aSol The market to bisect.
+ * \param aPeriod Model period.
+ * \return The price found, which the caller must set in the "base" state.
+ */
+double BisectAll::bisectPartial( const SolutionInfo& aSol, const int aPeriod ) const {
+    ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    SolutionInfo trialSol( aSol );
+    const unsigned int maxIter = max( mMaxPartialIterations, 1u );
+    double prevED = 0.0;
+    for( unsigned int iter = 0; iter < maxIter; ++iter ) {
+        stateVars->copyState();
+        if( iter == 0 ) {
+            prevED = trialSol.getED();
+        }
+        trialSol.setPriceToCenter();
+        // Same special case for constraints as in solve.
+        if ( fabs( trialSol.getPrice() ) < util::getSmallNumber() && prevED < 0 ) {
+            trialSol.setPrice( 0 );
+        }
+        world->calc( aPeriod, trialSol.getDependencies() );
+
+        prevED = trialSol.getED();
+        if( trialSol.isWithinTolerance() ) {
+            break;
+        }
+        if( prevED < 0 ) {
+            trialSol.moveRightBracketToX();
+        }
+        else {
+            trialSol.moveLeftBracketToX();
+        }
+        if( util::isEqual( trialSol.getCurrentBracketInterval(), 0.0, mBracketTolerance ) ) {
+            break;
+        }
+    }
+    return trialSol.getPrice();
+}
+
 /*!
  * \brief Check if all of the solvable solution infos have either left and right brackets
  *        separated by less than the bracket tolerance or are solved.
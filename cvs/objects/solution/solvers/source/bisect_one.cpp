@@ -162,6 +162,7 @@ SolverComponent::ReturnCode BisectOne::solve( SolutionInfoSet& aSolutionSet, con
                                aSolutionSet, worstSol, calcCounter, mSolutionInfoFilter.get(), aPeriod );
     unsigned int numIterations = 0;
     do {
+        calcCounter->incrementIterations();
         aSolutionSet.printMarketInfo( "Bisect One on " + worstSol->getName(), calcCounter->getPeriodCount(), singleLog );
 
         // Move the right price bracket in if Supply > Demand
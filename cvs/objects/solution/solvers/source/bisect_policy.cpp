@@ -166,6 +166,7 @@ SolverComponent::ReturnCode BisectPolicy::solve( SolutionInfoSet& aSolutionSet,
                                    aSolutionSet, worstSol, calcCounter, mSolutionInfoFilter.get(), aPeriod );
         if( !worstSol->isSolved() ){
             do {
+                calcCounter->incrementIterations();
                 aSolutionSet.printMarketInfo( "BisectPolicy on " + worstSol->getName(), calcCounter->getPeriodCount(), singleLog );
 
                 // Move the right price bracket in if Supply > Demand
@@ -0,0 +1,603 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file block_triangular_solver.cpp
+ * \ingroup objects
+ * \brief BlockTriangularSolver class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <math.h>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/task_group.h>
+#include <tbb/parallel_for.h>
+#endif
+
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/block_triangular_solver.hpp"
+#include "solution/util/include/calc_counter.h"
+#include "marketplace/include/marketplace.h"
+#include "containers/include/world.h"
+#include "containers/include/scenario.h"
+#include "containers/include/market_dependency_finder.h"
+#include "marketplace/include/market.h"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+#include "util/base/include/xml_helper.h"
+#include "util/base/include/manage_state_variables.hpp"
+#include "solution/util/include/solution_info_filter_factory.h"
+#include "solution/util/include/solvable_nr_solution_info_filter.h"
+
+#include "solution/util/include/linesearch.hpp"
+#include "solution/util/include/edfun.hpp"
+#include "solution/util/include/fdjac.hpp"
+
+#include <Eigen/LU>
+
+#include "util/base/include/timer.h"
+
+using namespace std;
+using namespace xercesc;
+
+extern Scenario* scenario;
+
+namespace {
+    /*!
+     * \brief Adapts a LogEDFun to a function of only the markets in a single block.
+     * \details The prices of markets outside of the block are held at the
+     *          values they had when this object was created and only the
+     *          activities which depend on the markets in the block are
+     *          recalculated.  Evaluations may run concurrently.
+     */
+    class BlockEDFun : public VecFVec {
+    public:
+        BlockEDFun( LogEDFun& aF, const UBVECTOR& aX, const vector<int>& aBlock,
+                    const vector<IActivity*>& aCalcList )
+            :mF( aF ), mX( aX ), mBlock( aBlock ), mCalcList( aCalcList )
+        {
+            na = nr = aBlock.size();
+            mdiagnostic = false;
+        }
+
+        virtual void operator()( const UBVECTOR& aXBlock, UBVECTOR& aFXBlock, const int aPartj = -1 ) {
+            UBVECTOR x( mX );
+            UBVECTOR fx( mX.size() );
+            for( size_t i = 0; i < mBlock.size(); ++i ) {
+                x[ mBlock[ i ] ] = aXBlock[ i ];
+            }
+            mF( x, fx, mBlock, mCalcList );
+            for( size_t i = 0; i < mBlock.size(); ++i ) {
+                aFXBlock[ i ] = fx[ mBlock[ i ] ];
+            }
+        }
+
+    private:
+        LogEDFun& mF;
+        const UBVECTOR& mX;
+        const vector<int>& mBlock;
+        const vector<IActivity*>& mCalcList;
+    };
+
+    /*!
+     * \brief Calculate the finite difference Jacobian of a block one column at
+     *        a time on the calling thread.
+     * \details Blocks are solved concurrently so this uses fdjacserial rather
+     *          than fdjac, which would run its columns on the thread pool and
+     *          time them with the shared JACOBIAN timer from each block's
+     *          thread.  Each column is a full evaluation of the block.
+     * \param aF The ED function for the block.
+     * \param aX The point at which to calculate the Jacobian.
+     * \param aFX aF(aX).
+     * \param aJ The Jacobian of aF.
+     */
+    void blockJacobian( BlockEDFun& aF, const UBVECTOR& aX, const UBVECTOR& aFX, UBMATRIX& aJ ) {
+        fdjacserial( aF, aX, aFX, aJ, false );
+    }
+
+    /*!
+     * \brief Tarjan's algorithm to find the strongly connected components of
+     *        the graph in which there is an edge j -> i if J(i,j) is non-zero.
+     */
+    struct BlockFinder {
+        BlockFinder( const UBMATRIX& aJ ):mJ( aJ ), mIndex( aJ.rows(), -1 ),
+            mLowLink( aJ.rows(), -1 ), mOnStack( aJ.rows(), false ), mComponent( aJ.rows(), -1 ),
+            mNextIndex( 0 ) {}
+
+        void visit( const int aJ ) {
+            mIndex[ aJ ] = mLowLink[ aJ ] = mNextIndex++;
+            mStack.push_back( aJ );
+            mOnStack[ aJ ] = true;
+            for( int i = 0; i < mJ.rows(); ++i ) {
+                if( i == aJ || mJ( i, aJ ) == 0.0 ) {
+                    continue;
+                }
+                if( mIndex[ i ] < 0 ) {
+                    visit( i );
+                    mLowLink[ aJ ] = min( mLowLink[ aJ ], mLowLink[ i ] );
+                }
+                else if( mOnStack[ i ] ) {
+                    mLowLink[ aJ ] = min( mLowLink[ aJ ], mIndex[ i ] );
+                }
+            }
+            if( mLowLink[ aJ ] == mIndex[ aJ ] ) {
+                // aJ is the root of a component, note components are completed
+                // downstream first
+                vector<int> component;
+                int i;
+                do {
+                    i = mStack.back();
+                    mStack.pop_back();
+                    mOnStack[ i ] = false;
+                    mComponent[ i ] = mComponents.size();
+                    component.push_back( i );
+                } while( i != aJ );
+                sort( component.begin(), component.end() );
+                mComponents.push_back( component );
+            }
+        }
+
+        const UBMATRIX& mJ;
+        vector<int> mIndex;
+        vector<int> mLowLink;
+        vector<bool> mOnStack;
+        vector<int> mComponent;
+        vector<int> mStack;
+        vector<vector<int> > mComponents;
+        int mNextIndex;
+    };
+}
+
+BlockTriangularSolver::BlockTriangularSolver( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter ):
+SolverComponent( aMarketplace, aWorld, aCalcCounter ),
+mMaxIter( 50 ),
+mFTOL( 1.0e-4 ),
+mLogPricep( true )
+{
+}
+
+BlockTriangularSolver::~BlockTriangularSolver() {
+}
+
+const string& BlockTriangularSolver::getXMLNameStatic() {
+    const static string SOLVER_NAME = "block-triangular-solver-component";
+    return SOLVER_NAME;
+}
+
+const string& BlockTriangularSolver::getXMLName() const {
+    return getXMLNameStatic();
+}
+
+void BlockTriangularSolver::init() {
+    if( !mSolutionInfoFilter.get() ) {
+        mSolutionInfoFilter.reset( new SolvableNRSolutionInfoFilter() );
+    }
+}
+
+bool BlockTriangularSolver::XMLParse( const DOMNode* aNode ) {
+    // assume we were passed a valid node.
+    assert( aNode );
+
+    // get the children of the node.
+    DOMNodeList* nodeList = aNode->getChildNodes();
+
+    // loop through the children
+    for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+        DOMNode* curr = nodeList->item( i );
+        string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+
+        if( nodeName == "#text" ) {
+            continue;
+        }
+        else if( nodeName == "max-iterations" ) {
+            mMaxIter = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "ftol" ) {
+            mFTOL = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "linear-price" ) {
+            mLogPricep = false;
+        }
+        else if( nodeName == "log-price" ) {
+            mLogPricep = true;
+        }
+        else if( nodeName == "solution-info-filter" ) {
+            mSolutionInfoFilter.reset(
+                SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
+        }
+        else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
+            mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing "
+                    << getXMLNameStatic() << "." << endl;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Reduce the markets to block triangular form and solve each block.
+ * \details See the class documentation for a description of the algorithm.
+ * \param aSolutionSet The set of markets to solve.
+ * \param aPeriod Model period.
+ * \return SUCCESS if all markets are within mFTOL after the final full model
+ *         calculation, otherwise a failure code describing the worst outcome
+ *         of the individual blocks.
+ */
+SolverComponent::ReturnCode BlockTriangularSolver::solve( SolutionInfoSet& aSolutionSet, const int aPeriod ) {
+    // If all markets are solved, then return with success code.
+    if( aSolutionSet.isAllSolved() ) {
+        return SUCCESS;
+    }
+
+    startMethod();
+
+    // Need to update solvable status before starting solution (Ignore return code)
+    aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
+
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::NOTICE );
+    const size_t nsolv = aSolutionSet.getNumSolvable();
+    solverLog << "Beginning block triangular solution for period " << aPeriod
+              << ", solving " << nsolv << " markets." << endl;
+    if( nsolv == 0 ) {
+        solverLog << "No markets were assigned to this solver.  Exiting." << endl;
+        return SUCCESS;
+    }
+
+    Timer& solverTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::SOLVER );
+    solverTimer.start();
+
+    vector<SolutionInfo> smkts( aSolutionSet.getSolvableSet() );
+    UBVECTOR x( nsolv ), fx( nsolv );
+    for( size_t i = 0; i < nsolv; ++i ) {
+        x[ i ] = mLogPricep ? log( max( smkts[ i ].getPrice(), util::getTinyNumber() ) ) : smkts[ i ].getPrice();
+    }
+
+    LogEDFun F( aSolutionSet, world, marketplace, aPeriod, mLogPricep );
+    F.scaleInitInputs( x );
+    F( x, fx );
+    int neval = 1;
+
+    // Find which markets interact from the market dependencies rather than a
+    // full Jacobian which would cost an evaluation per market.
+    UBMATRIX pattern( nsolv, nsolv );
+    findDependencies( smkts, aPeriod, pattern );
+
+    vector<vector<int> > blocks;
+    vector<int> levels;
+    findBlocks( pattern, blocks, levels );
+
+    size_t largestBlock = 0;
+    for( size_t b = 0; b < blocks.size(); ++b ) {
+        largestBlock = max( largestBlock, blocks[ b ].size() );
+    }
+    solverLog << "Found " << blocks.size() << " blocks in " << ( levels.empty() ? 0 : levels.back() + 1 )
+              << " levels, the largest block has " << largestBlock << " markets." << endl;
+
+    // Merge the activities that depend on each market in a block into a single
+    // list for the block.
+    vector<vector<IActivity*> > calcLists( blocks.size() );
+    for( size_t b = 0; b < blocks.size(); ++b ) {
+        vector<IActivity*> blockActivities;
+        for( size_t i = 0; i < blocks[ b ].size(); ++i ) {
+            const vector<IActivity*>& deps = smkts[ blocks[ b ][ i ] ].getDependencies();
+            blockActivities.insert( blockActivities.end(), deps.begin(), deps.end() );
+        }
+        calcLists[ b ] = world->getGlobalOrdering( blockActivities );
+    }
+
+    vector<int> status( blocks.size(), 0 );
+    vector<int> blockEval( blocks.size(), 0 );
+    size_t levelStart = 0;
+    while( levelStart < blocks.size() ) {
+        size_t levelEnd = levelStart;
+        while( levelEnd < blocks.size() && levels[ levelEnd ] == levels[ levelStart ] ) {
+            ++levelEnd;
+        }
+
+        // The blocks in a level only read from this copy of the inputs so that
+        // they may safely write their own entries in x.
+        const UBVECTOR xLevel( x );
+        scenario->getManageStateVariables()->setPartialDeriv( true );
+#if GCAM_PARALLEL_ENABLED
+        tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+        tbb::task_group tg;
+        threadPool.execute( [&]() {
+            tg.run( [&]() {
+                tbb::parallel_for( levelStart, levelEnd, [&]( const size_t b ) {
+                    status[ b ] = solveBlock( F, xLevel, fx, blocks[ b ], calcLists[ b ], x, blockEval[ b ] );
+                } );
+            } );
+        } );
+        threadPool.execute( [&tg]() { tg.wait(); } );
+#else
+        for( size_t b = levelStart; b < levelEnd; ++b ) {
+            status[ b ] = solveBlock( F, xLevel, fx, blocks[ b ], calcLists[ b ], x, blockEval[ b ] );
+        }
+#endif
+
+        // Bring the "base" state up to date with the new prices for the
+        // benefit of the next level.
+        F.partial( -1 );
+        F( x, fx );
+        ++neval;
+        levelStart = levelEnd;
+    }
+
+    int numSingular = 0;
+    int numIterMax = 0;
+    int numPoorProgress = 0;
+    for( size_t b = 0; b < blocks.size(); ++b ) {
+        neval += blockEval[ b ];
+        if( status[ b ] > 0 ) {
+            ++numSingular;
+        }
+        else if( status[ b ] == -1 ) {
+            ++numIterMax;
+        }
+        else if( status[ b ] < 0 ) {
+            ++numPoorProgress;
+        }
+    }
+    const double maxED = fx.cwiseAbs().maxCoeff();
+
+    solverTimer.stop();
+
+    ReturnCode code;
+    solverLog << "Block triangular solver:  neval= " << neval << ", max F(x)= " << maxED << "\nResult:  ";
+    if( maxED <= mFTOL ) {
+        code = SUCCESS;
+        solverLog << "Block triangular solution success." << endl;
+    }
+    else if( numSingular > 0 ) {
+        code = FAILURE_SINGULAR_MATRIX;
+        solverLog << "Block triangular solution failed:  " << numSingular << " blocks were singular." << endl;
+    }
+    else if( numIterMax > 0 ) {
+        code = FAILURE_ITER_MAX_REACHED;
+        solverLog << "Block triangular solution failed:  Iteration max reached in " << numIterMax << " blocks." << endl;
+    }
+    else {
+        code = FAILURE_POOR_PROGRESS;
+        solverLog << "Block triangular solution failed:  " << numPoorProgress
+                  << " blocks made poor progress, the remaining markets are not independent." << endl;
+    }
+    if( !aSolutionSet.isAllSolved() ) {
+        solverLog << "The following markets were not solved:" << endl;
+        aSolutionSet.printUnsolved( solverLog );
+    }
+
+    const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
+    addIteration( maxred->getName(), maxred->getRelativeED() );
+
+    return code;
+}
+
+/*!
+ * \brief Find which markets' excess demands depend on which markets' prices.
+ * \details Market i depends on market j if any of the activities which are
+ *          recalculated when the price of j changes may contribute to i, as
+ *          given by MarketDependencyFinder::getContributors.  This can include
+ *          pairs which turn out not to interact, which only makes some blocks
+ *          larger than they need to be.  Markets which are not linked to the
+ *          dependency graph are assumed to depend on every market.
+ * \param aMarkets The markets being solved.
+ * \param aPeriod Model period.
+ * \param aPattern Set to one where market i depends on market j and zero
+ *                 otherwise.
+ */
+void BlockTriangularSolver::findDependencies( const vector<SolutionInfo>& aMarkets, const int aPeriod,
+                                              UBMATRIX& aPattern ) const
+{
+    const int nsolv = aMarkets.size();
+    aPattern.setZero();
+
+    // The solution infos only know their market's serial number so map those
+    // back to market numbers.
+    const vector<Market*> allMarkets = marketplace->getMarketsToSolve( aPeriod );
+    map<int, int> serialToMarketNumber;
+    for( size_t m = 0; m < allMarkets.size(); ++m ) {
+        serialToMarketNumber[ allMarkets[ m ]->getSerialNumber() ] = m;
+    }
+
+    // Map each activity to the markets it may contribute to.
+    const MarketDependencyFinder* depFinder = marketplace->getDependencyFinder();
+    map<const IActivity*, vector<int> > contributesTo;
+    for( int i = 0; i < nsolv; ++i ) {
+        aPattern( i, i ) = 1.0;
+        const vector<IActivity*> contributors =
+            depFinder->getContributors( serialToMarketNumber[ aMarkets[ i ].getSerialNumber() ] );
+        if( contributors.empty() ) {
+            aPattern.row( i ).setOnes();
+        }
+        for( const IActivity* activity : contributors ) {
+            contributesTo[ activity ].push_back( i );
+        }
+    }
+
+    for( int j = 0; j < nsolv; ++j ) {
+        for( const IActivity* activity : aMarkets[ j ].getDependencies() ) {
+            auto contribIter = contributesTo.find( activity );
+            if( contribIter != contributesTo.end() ) {
+                for( const int i : contribIter->second ) {
+                    aPattern( i, j ) = 1.0;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Find the block triangular structure of a Jacobian.
+ * \details The blocks are the strongly connected components of the graph in
+ *          which market i depends on market j if J(i,j) is non-zero.  They are
+ *          returned in topological order, sorted by level.  A level of zero
+ *          indicates a block depends on no other block, otherwise the level is
+ *          one greater than the highest level of the blocks it depends on.
+ *          Blocks in the same level are therefore independent of each other.
+ * \param aJ The Jacobian.
+ * \param aBlocks The indices of the markets in each block.
+ * \param aLevels The level of each block, sorted ascending.
+ */
+void BlockTriangularSolver::findBlocks( const UBMATRIX& aJ, vector<vector<int> >& aBlocks,
+                                        vector<int>& aLevels )
+{
+    BlockFinder finder( aJ );
+    for( int j = 0; j < aJ.cols(); ++j ) {
+        if( finder.mIndex[ j ] < 0 ) {
+            finder.visit( j );
+        }
+    }
+
+    // Components are found downstream first so go through them in reverse to
+    // have all of the blocks a block depends on leveled before it.
+    const int numBlocks = finder.mComponents.size();
+    vector<int> componentLevel( numBlocks, 0 );
+    for( int c = numBlocks - 1; c >= 0; --c ) {
+        const vector<int>& component = finder.mComponents[ c ];
+        for( size_t k = 0; k < component.size(); ++k ) {
+            const int i = component[ k ];
+            for( int j = 0; j < aJ.cols(); ++j ) {
+                const int dependsOn = finder.mComponent[ j ];
+                if( dependsOn != c && aJ( i, j ) != 0.0 ) {
+                    componentLevel[ c ] = max( componentLevel[ c ], componentLevel[ dependsOn ] + 1 );
+                }
+            }
+        }
+    }
+
+    vector<pair<int, int> > order;
+    for( int c = numBlocks - 1; c >= 0; --c ) {
+        order.push_back( make_pair( componentLevel[ c ], c ) );
+    }
+    stable_sort( order.begin(), order.end(),
+                 []( const pair<int, int>& aLHS, const pair<int, int>& aRHS ) { return aLHS.first < aRHS.first; } );
+
+    aBlocks.clear();
+    aLevels.clear();
+    for( size_t k = 0; k < order.size(); ++k ) {
+        aLevels.push_back( order[ k ].first );
+        aBlocks.push_back( finder.mComponents[ order[ k ].second ] );
+    }
+}
+
+/*!
+ * \brief Solve a single block using Broyden's method.
+ * \details The initial Broyden matrix is a finite difference Jacobian of just
+ *          the block.  Should the line search fail the Jacobian is calculated
+ *          again at the current point and the iteration is retried once.  The
+ *          caller must have turned on partial derivative state.
+ * \param aF The ED function for all of the markets being solved.
+ * \param aX The current (scaled) inputs for all markets.
+ * \param aFX F(aX) from the last full model calculation.
+ * \param aBlock The indices of the markets in this block.
+ * \param aCalcList The activities which depend on the markets in the block.
+ * \param aXOut The solution for the markets in this block is written into
+ *              the corresponding entries of this vector.
+ * \param aNumEval Incremented by the number of model evaluations.
+ * \return 0 for success, -1 if the iteration max was reached, -4 for repeated
+ *         line search failure, or a positive value if the block was singular.
+ */
+int BlockTriangularSolver::solveBlock( LogEDFun& aF, const UBVECTOR& aX, const UBVECTOR& aFX,
+                                       const vector<int>& aBlock, const vector<IActivity*>& aCalcList,
+                                       UBVECTOR& aXOut, int& aNumEval ) const
+{
+    BlockEDFun FB( aF, aX, aBlock, aCalcList );
+    const int nb = aBlock.size();
+    UBVECTOR xb( nb ), fb( nb ), dx( nb ), gx( nb ), xnew( nb ), fbnew( nb );
+    UBMATRIX B( nb, nb );
+    for( int i = 0; i < nb; ++i ) {
+        xb[ i ] = aX[ aBlock[ i ] ];
+        fb[ i ] = aFX[ aBlock[ i ] ];
+    }
+    blockJacobian( FB, xb, fb, B );
+    aNumEval += nb;
+
+    double f0 = fb.dot( fb );
+    bool isFreshJacobian = true;
+    int status = -1;
+    for( unsigned int iter = 0; iter < mMaxIter; ++iter ) {
+        calcCounter->incrementIterations();
+        if( fb.cwiseAbs().maxCoeff() <= mFTOL ) {
+            status = 0;
+            break;
+        }
+
+        Eigen::PartialPivLU<UBMATRIX> lu( B );
+        dx = lu.solve( -1.0 * fb );
+        gx = B.transpose() * fb;
+        double fnew;
+        const bool isSingular = lu.determinant() == 0 || !util::isValidNumber( dx.dot( dx ) );
+        const int numEvalBeforeLinesearch = aNumEval;
+        const bool isStepOK = !isSingular && linesearch( FB, xb, f0, gx, dx, xnew, fnew, fbnew, 0.0, aNumEval ) == 0;
+        calcCounter->incrementEventCount( CalcCounter::LINE_SEARCH_STEP, aNumEval - numEvalBeforeLinesearch );
+        if( !isStepOK ) {
+            if( isFreshJacobian ) {
+                status = isSingular ? 1 : -4;
+                break;
+            }
+            // Try again with a finite difference Jacobian at the current point.
+            blockJacobian( FB, xb, fb, B );
+            aNumEval += nb;
+            isFreshJacobian = true;
+            continue;
+        }
+        isFreshJacobian = false;
+
+        // Broyden's secant update
+        const UBVECTOR xstep( xnew - xb );
+        const UBVECTOR fstep( fbnew - fb );
+        B += ( ( fstep - B * xstep ) * xstep.transpose() ) / xstep.dot( xstep );
+        xb = xnew;
+        fb = fbnew;
+        f0 = fnew;
+    }
+
+    for( int i = 0; i < nb; ++i ) {
+        aXOut[ aBlock[ i ] ] = xb[ i ];
+    }
+    return status;
+}
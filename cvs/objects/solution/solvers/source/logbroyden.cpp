@@ -41,6 +41,7 @@
 #include "util/base/include/definitions.h"
 #include <string>
 #include <queue>
+#include <map>
 #include <algorithm>
 #include <iomanip>
 #include <math.h>
@@ -111,6 +112,10 @@ namespace {
 
 int LogBroyden::mLastPer = 0;
 int LogBroyden::mPerIter = 0;
+UBMATRIX LogBroyden::mLastJacobian;
+std::vector<int> LogBroyden::mLastJacobianMktIDs;
+int LogBroyden::mLastJacobianPer = -1;
+bool LogBroyden::mLastJacobianLogPricep = true;
 
 bool LogBroyden::XMLParse( const DOMNode* aNode ) {
     // assume we were passed a valid node.
@@ -146,6 +151,12 @@ bool LogBroyden::XMLParse( const DOMNode* aNode ) {
         else if(nodeName == "max-jacobian-reuse") {
             mMaxJacobainReuse = XMLHelper<int>::getValue( curr );
         }
+        else if(nodeName == "reuse-jacobian-across-periods") {
+            mReuseJacobianAcrossPeriods = XMLHelper<bool>::getValue( curr );
+        }
+        else if(nodeName == "linesearch-points") {
+            mLinesearchPoints = XMLHelper<int>::getValue( curr );
+        }
         else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
             mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
         }
@@ -181,6 +192,13 @@ bool LogBroyden::XMLParse( const DOMNode* aNode ) {
  * difference approximations for the new column, and we'll zero the
  * off-diagonal terms of the new row.
  *
+ * If reuse-jacobian-across-periods is set, the initial approximation
+ * is instead taken from the final Broyden matrix of the previous
+ * period, matched up market by market.  Only the columns for markets
+ * that weren't in the previous solution are computed by finite
+ * differences.  If the reused matrix fails to make adequate progress
+ * on the first iteration, bsolve() falls back to a fresh Jacobian.
+ *
  * The solver can run in either log-log mode or linear-linear mode.
  *
  * \author Robert Link 
@@ -280,7 +298,16 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     // Precondition the x values to avoid singular columns in the Jacobian
     solverLog.setLevel(ILogger::DEBUG);
     UBMATRIX J(F.narg(), F.nrtn());
-    fdjac(F, x, fx, J, true);
+    int njaccol = -1;
+    if( mReuseJacobianAcrossPeriods ) {
+        njaccol = seedJacobianFromLastPeriod(solnset, F, x, fx, J, period);
+    }
+    bool reusedJ = njaccol >= 0;
+    if( !reusedJ ) {
+        fdjac(F, x, fx, J, true);
+        njaccol = nsolv;
+    }
+    neval += njaccol;
 
     solverLog << ">>>> Main loop jacobian called.\n";
     int pcfail = jacobian_precondition(x, fx, J, F, &solverLog, mLogPricep);
@@ -297,9 +324,21 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     cSolInfo = &solnset;        // make available for log outputs
 
     // call the solver
-    int bstatus = bsolve(F, x, fx, J, neval);
+    int bstatus = bsolve(F, x, fx, J, neval, reusedJ);
     mPerIter++;                 // increment the iteration count.  This should produce a visible gap in the trace plots.
 
+    if( mReuseJacobianAcrossPeriods && bstatus == 0 ) {
+        saveJacobian(solnset, F, J, period);
+    }
+    if( bstatus == 0 && Configuration::getInstance()->getBool( "use-price-prediction", false, false ) ) {
+        // Leave the diagonal of the final Jacobian with the markets for use in
+        // predicting next period's prices.  Convert to d(F)/d(log p), noting that
+        // in linear mode d(x)/d(log p) == x.
+        for(size_t i=0; i<nsolv; ++i) {
+            solnset.getSolvable(i).setLogPriceDerivative(mLogPricep ? J(i,i) : J(i,i) * x[i]);
+        }
+    }
+
     solverTimer.stop(); 
 
     solverLog.setLevel(ILogger::NOTICE);
@@ -353,11 +392,104 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     return code;
 }
 
+/*!
+ * \brief Build the initial Jacobian from the one saved at the end of the previous period.
+ * \details Rows and columns of the saved matrix are matched to the current
+ *          solvable set by market serial number and rescaled using the
+ *          current scale factors.  Columns for markets that have no
+ *          counterpart in the saved matrix are computed by finite
+ *          differences; the off-diagonal entries of their rows are zeroed.
+ * \param aSolnset The solution info set being solved.
+ * \param F The ED function for this solve.  F(x) must have just been evaluated.
+ * \param x The current (scaled) inputs.
+ * \param fx F(x)
+ * \param J The Jacobian to fill in.
+ * \param aPeriod Model period.
+ * \return The number of columns computed by finite differences, or -1 if
+ *         there was no usable saved Jacobian.
+ */
+int LogBroyden::seedJacobianFromLastPeriod(const SolutionInfoSet &aSolnset, LogEDFun &F, const UBVECTOR &x,
+                                           const UBVECTOR &fx, UBMATRIX &J, int aPeriod)
+{
+    if( mLastJacobianPer < 0 || mLastJacobianPer >= aPeriod || mLastJacobianLogPricep != mLogPricep ) {
+        return -1;
+    }
+
+    std::vector<int> mktids;
+    aSolnset.getMarketIDs(mktids, true);
+    std::map<int, int> lastIndex;
+    for(size_t i=0; i<mLastJacobianMktIDs.size(); ++i) {
+        lastIndex[mLastJacobianMktIDs[i]] = i;
+    }
+    std::vector<int> oldidx(mktids.size(), -1);
+    std::vector<int> newcols;
+    for(size_t i=0; i<mktids.size(); ++i) {
+        std::map<int, int>::const_iterator it = lastIndex.find(mktids[i]);
+        if(it != lastIndex.end()) {
+            oldidx[i] = it->second;
+        }
+        else {
+            newcols.push_back(i);
+        }
+    }
+    if(newcols.size() == mktids.size()) {
+        // nothing in common with the last solution
+        return -1;
+    }
+
+    const UBVECTOR &xscl = F.getInputScale();
+    const UBVECTOR &fxscl = F.getOutputScale();
+    for(size_t j=0; j<mktids.size(); ++j) {
+        if(oldidx[j] < 0) {
+            continue;
+        }
+        for(size_t i=0; i<mktids.size(); ++i) {
+            J(i,j) = oldidx[i] < 0 ? 0.0 :
+                mLastJacobian(oldidx[i], oldidx[j]) * fxscl[i] * xscl[j];
+        }
+    }
+    fdjac(F, x, fx, J, newcols, true);
+
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog << "Reusing Jacobian from period " << mLastJacobianPer << " for "
+              << (mktids.size() - newcols.size()) << " of " << mktids.size()
+              << " markets; computed " << newcols.size() << " new columns.\n";
+
+    return newcols.size();
+}
+
+/*!
+ * \brief Save the final Broyden matrix for use by the next period.
+ * \details The matrix is stored with the scale factors of this solve removed.
+ * \param aSolnset The solution info set that was solved.
+ * \param F The ED function used in the solve.
+ * \param B The final Broyden matrix.
+ * \param aPeriod Model period.
+ */
+void LogBroyden::saveJacobian(const SolutionInfoSet &aSolnset, const LogEDFun &F, const UBMATRIX &B, int aPeriod)
+{
+    aSolnset.getMarketIDs(mLastJacobianMktIDs, true);
+    const UBVECTOR &xscl = F.getInputScale();
+    const UBVECTOR &fxscl = F.getOutputScale();
+    mLastJacobian.resize(B.rows(), B.cols());
+    for(int j=0; j<B.cols(); ++j) {
+        for(int i=0; i<B.rows(); ++i) {
+            double val = B(i,j) / (fxscl[i] * xscl[j]);
+            mLastJacobian(i,j) = util::isValidNumber(val) ? val : 0.0;
+        }
+    }
+    mLastJacobianPer = aPeriod;
+    mLastJacobianLogPricep = mLogPricep;
+}
+
 int LogBroyden::bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
-                       UBMATRIX & B, int &neval)
+                       UBMATRIX & B, int &neval, bool aReusedB)
 {
   int nrow = B.rows(), ncol = B.cols();
-  int ageB = 0;   // number of iterations since the last reset on B
+  // number of iterations since the last reset on B.  A B carried over from
+  // another period is treated as already aged so that it can be reset if it
+  // isn't working.
+  int ageB = aReusedB ? 1 : 0;
   // svd decomposition elements (note nrow == ncol)
 
   ILogger &solverLog = ILogger::getLogger("solver_log");
@@ -388,7 +520,7 @@ int LogBroyden::bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
 
   solverLog.setLevel(ILogger::DEBUG);
   
-  neval += 1 + x.size();        // initial function evaluation + jacobian calculations
+  neval += 1;        // initial function evaluation (jacobian calculations are counted by the caller)
 
   const double FTINY = mFTOL*mFTOL;
 
@@ -430,6 +562,7 @@ int LogBroyden::bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
     // log some debug info
     
     solverLog << "Broyden iter= " << iter << "\tneval= " << neval << "\n";
+    calcCounter->incrementIterations();
     solverLog << "Internal iteration count ( mPerIter )= " << mPerIter << "\n";
     cSolInfo->printMarketInfo("Broyden ", calcCounter->getPeriodCount(), singleLog);
     for(int j=0;j<F.narg();++j) {
@@ -555,7 +688,10 @@ int LogBroyden::bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
           past_f_values = std::queue<double>();
       }
       UBVECTOR fxnew(fx.size());
-    int lserr = linesearch(F,x,f0,gx,dx, xnew,fnew, fxnew, fxIncr, neval, &solverLog);
+    const int nevalBeforeLinesearch = neval;
+    int lserr = linesearchMultiPoint(F,x,f0,gx,dx, xnew,fnew, fxnew, fxIncr, neval,
+                                     mLinesearchPoints, &solverLog);
+    calcCounter->incrementEventCount( CalcCounter::LINE_SEARCH_STEP, neval - nevalBeforeLinesearch );
 
     if(lserr != 0) {
       // line search failed.  There are a couple of things that could
@@ -667,7 +803,7 @@ int LogBroyden::bsolve(VecFVec &F, UBVECTOR &x, UBVECTOR &fx,
     
     // update B for next iteration
       double fratio_cutoff = 1.0 - 1.0/nrow;
-    if(ageB < mMaxJacobainReuse && (fnew/f0 < fratio_cutoff || iter == 0)) { // making adequate progress with the Broyden formula
+    if(ageB < mMaxJacobainReuse && (fnew/f0 < fratio_cutoff || (iter == 0 && !aReusedB))) { // making adequate progress with the Broyden formula
       double dx2 = xstep.dot(xstep);
       UBVECTOR Bdx(F.nrtn());
         fxstep -= B * xstep;
@@ -0,0 +1,362 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file newton_krylov.cpp
+ * \ingroup objects
+ * \brief NewtonKrylov class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/newton_krylov.hpp"
+#include "solution/util/include/calc_counter.h"
+#include "marketplace/include/marketplace.h"
+#include "containers/include/world.h"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "util/base/include/util.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+#include "util/base/include/xml_helper.h"
+#include "solution/util/include/solution_info_filter_factory.h"
+#include "solution/util/include/solvable_nr_solution_info_filter.h"
+
+#include "solution/util/include/linesearch.hpp"
+#include "solution/util/include/fdjac.hpp"
+#include "solution/util/include/krylov.hpp"
+#include "solution/util/include/edfun.hpp"
+
+#include "util/base/include/timer.h"
+
+using namespace std;
+using namespace xercesc;
+
+NewtonKrylov::NewtonKrylov( Marketplace* aMarketplace, World* aWorld, CalcCounter* aCalcCounter ):
+SolverComponent( aMarketplace, aWorld, aCalcCounter ),
+mMaxIter( 100 ),
+mFTOL( 1.0e-4 ),
+mUseBiCGStab( false ),
+mKrylovRestart( 30 ),
+mMaxKrylovIter( 100 ),
+mForcingTerm( 0.1 ),
+mUseDiagPreconditioner( true ),
+mLogPricep( true )
+{
+}
+
+NewtonKrylov::~NewtonKrylov() {
+}
+
+const string& NewtonKrylov::getXMLNameStatic() {
+    const static string SOLVER_NAME = "newton-krylov-solver-component";
+    return SOLVER_NAME;
+}
+
+const string& NewtonKrylov::getXMLName() const {
+    return getXMLNameStatic();
+}
+
+void NewtonKrylov::init() {
+    if( !mSolutionInfoFilter.get() ) {
+        mSolutionInfoFilter.reset( new SolvableNRSolutionInfoFilter() );
+    }
+}
+
+bool NewtonKrylov::XMLParse( const DOMNode* aNode ) {
+    // assume we were passed a valid node.
+    assert( aNode );
+
+    // get the children of the node.
+    DOMNodeList* nodeList = aNode->getChildNodes();
+
+    // loop through the children
+    for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+        DOMNode* curr = nodeList->item( i );
+        string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+
+        if( nodeName == "#text" ) {
+            continue;
+        }
+        else if( nodeName == "max-iterations" ) {
+            mMaxIter = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "ftol" ) {
+            mFTOL = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "krylov-method" ) {
+            const string method = XMLHelper<string>::getValue( curr );
+            if( method == "bicgstab" ) {
+                mUseBiCGStab = true;
+            }
+            else if( method == "gmres" ) {
+                mUseBiCGStab = false;
+            }
+            else {
+                ILogger& mainLog = ILogger::getLogger( "main_log" );
+                mainLog.setLevel( ILogger::WARNING );
+                mainLog << "Unknown krylov-method: " << method << ", using gmres." << endl;
+                mUseBiCGStab = false;
+            }
+        }
+        else if( nodeName == "krylov-restart" ) {
+            mKrylovRestart = XMLHelper<int>::getValue( curr );
+        }
+        else if( nodeName == "max-krylov-iterations" ) {
+            mMaxKrylovIter = XMLHelper<int>::getValue( curr );
+        }
+        else if( nodeName == "forcing-term" ) {
+            mForcingTerm = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "diagonal-preconditioner" ) {
+            mUseDiagPreconditioner = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "linear-price" ) {
+            mLogPricep = false;
+        }
+        else if( nodeName == "log-price" ) {
+            mLogPricep = true;
+        }
+        else if( nodeName == "solution-info-filter" ) {
+            mSolutionInfoFilter.reset(
+                SolutionInfoFilterFactory::createSolutionInfoFilterFromString( XMLHelper<string>::getValue( curr ) ) );
+        }
+        else if( SolutionInfoFilterFactory::hasSolutionInfoFilter( nodeName ) ) {
+            mSolutionInfoFilter.reset( SolutionInfoFilterFactory::createAndParseSolutionInfoFilter( nodeName, curr ) );
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing "
+                    << getXMLNameStatic() << "." << endl;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Jacobian-free Newton-Krylov solver.
+ * \details See the class documentation for a description of the algorithm.
+ * \param aSolutionSet The set of markets to solve.
+ * \param aPeriod Model period.
+ * \return Status code indicating whether the algorithm was successful or not.
+ */
+SolverComponent::ReturnCode NewtonKrylov::solve( SolutionInfoSet& aSolutionSet, const int aPeriod ) {
+    // If all markets are solved, then return with success code.
+    if( aSolutionSet.isAllSolved() ) {
+        return SUCCESS;
+    }
+
+    startMethod();
+
+    // Need to update solvable status before starting solution (Ignore return code)
+    aSolutionSet.updateSolvable( mSolutionInfoFilter.get() );
+
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::NOTICE );
+    const int nsolv = aSolutionSet.getNumSolvable();
+    solverLog << "Beginning Newton-Krylov solution for period " << aPeriod
+              << ", solving " << nsolv << " markets using " << ( mUseBiCGStab ? "BiCGStab" : "GMRES" )
+              << "." << endl;
+    if( nsolv == 0 ) {
+        solverLog << "No markets were assigned to this solver.  Exiting." << endl;
+        return SUCCESS;
+    }
+
+    ILogger& worstMarketLog = ILogger::getLogger( "worst_market_log" );
+    worstMarketLog.setLevel( ILogger::DEBUG );
+
+    Timer& solverTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::SOLVER );
+    solverTimer.start();
+
+    vector<SolutionInfo> smkts( aSolutionSet.getSolvableSet() );
+    UBVECTOR x( nsolv ), fx( nsolv );
+    for( int i = 0; i < nsolv; ++i ) {
+        x[ i ] = mLogPricep ? log( max( smkts[ i ].getPrice(), util::getTinyNumber() ) ) : smkts[ i ].getPrice();
+    }
+
+    LogEDFun F( aSolutionSet, world, marketplace, aPeriod, mLogPricep );
+    F.scaleInitInputs( x );
+    F( x, fx );
+    int neval = 1;
+
+    // The preconditioner is the diagonal of the Jacobian which only takes
+    // partial derivatives to calculate.
+    UBVECTOR D( UBVECTOR::Ones( nsolv ) );
+    UBVECTOR Minv( UBVECTOR::Ones( nsolv ) );
+    auto updatePreconditioner = [&]() {
+        fdjacdiag( F, x, fx, D, true );
+        neval += nsolv;
+        for( int i = 0; i < nsolv; ++i ) {
+            Minv[ i ] = D[ i ] != 0.0 && util::isValidNumber( D[ i ] ) ? 1.0 / D[ i ] : 1.0;
+        }
+    };
+    if( mUseDiagPreconditioner ) {
+        updatePreconditioner();
+    }
+
+    // Jacobian-vector products by directional difference at the current x.
+    // Note F( x ) is always the current fx.
+    const double heps = 1.0e-6;
+    LinearOperator jacvec = [&]( const UBVECTOR& aV, UBVECTOR& aJV ) {
+        aJV.resize( nsolv );
+        const double vnorm = aV.norm();
+        if( vnorm == 0.0 ) {
+            aJV.setZero();
+            return;
+        }
+        const double h = heps * ( 1.0 + x.norm() ) / vnorm;
+        const UBVECTOR xh( x + h * aV );
+        F( xh, aJV );
+        aJV = ( aJV - fx ) / h;
+        ++neval;
+    };
+
+    double f0 = fx.dot( fx );
+    int status = -1;
+    int totalKrylovIter = 0;
+    bool isFreshPreconditioner = true;
+    for( unsigned int iter = 0; iter < mMaxIter; ++iter ) {
+        calcCounter->incrementIterations();
+        const double maxval = fx.cwiseAbs().maxCoeff();
+        solverLog.setLevel( ILogger::DEBUG );
+        solverLog << "Newton-Krylov iter= " << iter << "\tneval= " << neval
+                  << "\tmax F(x)= " << maxval << "\n";
+        if( maxval <= mFTOL ) {
+            status = 0;
+            break;
+        }
+
+        // Solve J dx = -F( x ) only as far as the forcing term requires.
+        UBVECTOR dx( UBVECTOR::Zero( nsolv ) );
+        UBVECTOR r( nsolv );
+        const UBVECTOR b( -1.0 * fx );
+        const double tol = mForcingTerm * fx.norm();
+        int kiter = 0;
+        const int kstatus = mUseBiCGStab ?
+            bicgstab( jacvec, Minv, b, dx, r, tol, mMaxKrylovIter, kiter ) :
+            gmres( jacvec, Minv, b, dx, r, tol, mKrylovRestart, mMaxKrylovIter, kiter );
+        totalKrylovIter += kiter;
+        solverLog << "Krylov iterations= " << kiter << "  relative residual= " << ( r.norm() / fx.norm() )
+                  << ( kstatus != 0 ? "  (not converged)" : "" ) << "\n";
+
+        // The line search only needs the rate of decrease g0.dx = F( x ).( J dx )
+        // which we know from the linear residual r = -F( x ) - J dx without
+        // having to do another evaluation.
+        const double g0dx = -f0 - fx.dot( r );
+        bool isStepOK = false;
+        UBVECTOR xnew( nsolv ), fxnew( nsolv );
+        double fnew = f0;
+        if( g0dx < 0.0 && util::isValidNumber( dx.dot( dx ) ) ) {
+            const UBVECTOR g0( ( g0dx / dx.dot( dx ) ) * dx );
+            const int nevalBeforeLinesearch = neval;
+            isStepOK = linesearch( F, x, f0, g0, dx, xnew, fnew, fxnew, 0.0, neval, &solverLog ) == 0;
+            calcCounter->incrementEventCount( CalcCounter::LINE_SEARCH_STEP, neval - nevalBeforeLinesearch );
+        }
+
+        if( !isStepOK ) {
+            // The model was last evaluated at some other point, restore it.
+            F( x, fx );
+            ++neval;
+            if( mUseDiagPreconditioner && !isFreshPreconditioner ) {
+                solverLog << "Failed Newton step, refreshing the preconditioner.\n";
+                updatePreconditioner();
+                isFreshPreconditioner = true;
+                continue;
+            }
+            // Same relaxed convergence test as LogBroyden
+            if( f0 / nsolv < mFTOL ) {
+                solverLog << "Relaxed success" << endl;
+                status = 0;
+            }
+            else {
+                status = -4;
+            }
+            break;
+        }
+        isFreshPreconditioner = false;
+        x = xnew;
+        fx = fxnew;
+        f0 = fnew;
+
+        const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
+        addIteration( maxred->getName(), maxred->getRelativeED() );
+        worstMarketLog << "Newton-Krylov:  " << *maxred << "\n";
+    }
+
+    if( status == 0 && mUseDiagPreconditioner &&
+        Configuration::getInstance()->getBool( "use-price-prediction", false, false ) )
+    {
+        // Leave the diagonal with the markets for use in predicting next
+        // period's prices, see LogBroyden.
+        for( int i = 0; i < nsolv; ++i ) {
+            smkts[ i ].setLogPriceDerivative( mLogPricep ? D[ i ] : D[ i ] * x[ i ] );
+        }
+    }
+
+    solverTimer.stop();
+
+    ReturnCode code;
+    solverLog.setLevel( ILogger::NOTICE );
+    solverLog << "Newton-Krylov solver:  neval= " << neval << "  Krylov iterations= " << totalKrylovIter
+              << "\nResult:  ";
+    if( status == 0 ) {
+        code = SUCCESS;
+        solverLog << "Newton-Krylov solution success." << endl;
+    }
+    else if( status == -1 ) {
+        code = FAILURE_ITER_MAX_REACHED;
+        solverLog << "Newton-Krylov solution failed: Iteration max reached." << endl;
+    }
+    else {
+        code = FAILURE_POOR_PROGRESS;
+        solverLog << "Newton-Krylov solution failed:  repeated poor progress." << endl;
+    }
+    if( !aSolutionSet.isAllSolved() ) {
+        solverLog << "The following markets were not solved:" << endl;
+        aSolutionSet.printUnsolved( solverLog );
+    }
+
+    const SolutionInfo* maxred = aSolutionSet.getWorstSolutionInfo();
+    addIteration( maxred->getName(), maxred->getRelativeED() );
+    worstMarketLog << "###Newton-Krylov-end:  " << *maxred << endl;
+
+    return code;
+}
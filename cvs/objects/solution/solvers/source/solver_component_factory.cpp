@@ -55,6 +55,9 @@
 #include "solution/solvers/include/bisect_policy.h"
 #include "solution/solvers/include/logbroyden.hpp"
 #include "solution/solvers/include/preconditioner.hpp"
+#include "solution/solvers/include/block_triangular_solver.hpp"
+#include "solution/solvers/include/newton_krylov.hpp"
+#include "solution/solvers/include/anderson_acceleration.hpp"
 
 using namespace std;
 using namespace xercesc;
@@ -75,7 +78,10 @@ bool SolverComponentFactory::hasSolverComponent( const string& aXMLName ) {
         || BisectOne::getXMLNameStatic() == aXMLName
         || BisectPolicy::getXMLNameStatic() == aXMLName
         || LogBroyden::getXMLNameStatic() == aXMLName
-        || Preconditioner::getXMLNameStatic() == aXMLName;
+        || Preconditioner::getXMLNameStatic() == aXMLName
+        || BlockTriangularSolver::getXMLNameStatic() == aXMLName
+        || NewtonKrylov::getXMLNameStatic() == aXMLName
+        || AndersonAcceleration::getXMLNameStatic() == aXMLName;
 }
 
 /*!
@@ -127,6 +133,15 @@ SolverComponentFactory::createAndParseSolverComponent( const string& aXMLName,
     else if( Preconditioner::getXMLNameStatic() == aXMLName ) {
         retSolverComponent = new Preconditioner( aMarketplace, aWorld, aCalcCounter );
     }
+    else if( BlockTriangularSolver::getXMLNameStatic() == aXMLName ) {
+        retSolverComponent = new BlockTriangularSolver( aMarketplace, aWorld, aCalcCounter );
+    }
+    else if( NewtonKrylov::getXMLNameStatic() == aXMLName ) {
+        retSolverComponent = new NewtonKrylov( aMarketplace, aWorld, aCalcCounter );
+    }
+    else if( AndersonAcceleration::getXMLNameStatic() == aXMLName ) {
+        retSolverComponent = new AndersonAcceleration( aMarketplace, aWorld, aCalcCounter );
+    }
     else {
         // this must mean createAndParseSolverComponent and hasSolverComponent
         // are out of sync with known solver components
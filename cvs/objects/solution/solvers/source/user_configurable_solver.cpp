@@ -56,6 +56,7 @@
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/util.h"
 #include "util/base/include/auto_file.h"
+#include "util/base/include/timer.h"
 
 using namespace std;
 using namespace xercesc;
@@ -220,12 +221,24 @@ bool UserConfigurableSolver::solve( const int aPeriod, const SolutionInfoParamPa
             // solve successfully it is not necessarily working on the entire solution set.
             solverLog << "\n%%%%%%%%%%%%%%%%Solution Set State:\n" << solution_set
                       << "\n%%%%%%%%%%%%%%%%\n";
+            // Track the time taken by each component for the performance report.
+            Timer componentTimer;
+            const double startCPUTime = util::getProcessCPUTime();
+            componentTimer.start();
             (*it)->solve( solution_set, aPeriod );
+            componentTimer.stop();
+            mCalcCounter->addMethodTime( (*it)->getXMLName(), componentTimer.getTotalTimeDifference(),
+                                         util::getProcessCPUTime() - startCPUTime );
         }
         
         // Determine if the model has solved. 
     } while ( !solution_set.isAllSolved() &&
               mCalcCounter->getPeriodCount() < mMaxModelCalcs );
+
+    // Report the model evaluations and iterations each solver component took
+    // so that their cost can be compared.
+    solverLog.setLevel( ILogger::NOTICE );
+    solverLog << "Solver cost by component for period " << aPeriod << ":\n" << *mCalcCounter << endl;
     
     if( conf->getBool( "CalibrationActive" )
             && !world->isAllCalibrated( aPeriod, mCalibrationTolerance, true ) ) {
@@ -48,6 +48,7 @@
 #include <string>
 #include <iosfwd>
 #include <map>
+#include <vector>
 
 #include "util/base/include/definitions.h"
 
@@ -73,16 +74,44 @@ class CalcCounter {
         return os;
     }
 public:
+    //! Events which are counted per solution method in addition to the
+    //! world.calc count.
+    enum EventType {
+        //! Calls to world.calc for all markets.
+        FULL_EVALUATION,
+        //! Calls to world.calc for a subset of markets.
+        PARTIAL_EVALUATION,
+        //! Finite difference Jacobian or Jacobian diagonal calculations.
+        JACOBIAN,
+        //! Trial steps taken in a line search.
+        LINE_SEARCH_STEP,
+        //! Marker for the number of events.
+        END
+    };
+
     CalcCounter();
     int getTotalCount() const;
     int getPeriodCount() const;
     int getMethodCount( const std::string methodName ) const;
     void incrementCount( const double additional = 1 );
+    int getMethodIterations( const std::string methodName ) const;
+    void incrementIterations( const int additional = 1 );
+    int getMethodEventCount( const std::string methodName, const EventType aEvent ) const;
+    void incrementEventCount( const EventType aEvent, const int additional = 1 );
+    double getMethodWallTime( const std::string methodName ) const;
+    double getMethodCPUTime( const std::string methodName ) const;
+    void addMethodTime( const std::string methodName, const double aWallTime, const double aCPUTime );
+    std::vector<std::string> getMethodNames() const;
     void setCurrentMethod( const std::string methodName );
     void startNewPeriod();
 private:
     std::string currMethodName;
     std::map<std::string, double> methodCounts;
+    std::map<std::string, int> methodIterations;
+    //! Event counts by method indexed by EventType.
+    std::map<std::string, std::vector<int> > methodEvents;
+    //! Wall clock and CPU seconds spent by method.
+    std::map<std::string, std::pair<double, double> > methodTimes;
     double totalCount;
     double periodCount;
 #if GCAM_PARALLEL_ENABLED
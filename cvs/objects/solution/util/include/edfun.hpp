@@ -47,6 +47,7 @@
 
 class Marketplace;
 class World;
+class IActivity;
 
 
 /*!
@@ -100,10 +101,17 @@ public:
   
   // basic vector function interface
   virtual void operator()(const UBVECTOR &x, UBVECTOR &fx, const int partj=-1);
+  void operator()(const UBVECTOR &x, UBVECTOR &fx, const std::vector<int> &aChanged,
+                  const std::vector<IActivity*> &aCalcList);
   virtual void partial(int ip);
   virtual double partialSize(int ip) const;
+  virtual void evalMultiple(const std::vector<UBVECTOR> &ax, std::vector<UBVECTOR> &afx);
   void scaleInitInputs(UBVECTOR &ax);
   void setSlope(UBVECTOR &adx);
+  //! Scale factors applied to the inputs (x = x_scaled * xscl)
+  const UBVECTOR &getInputScale() const {return mxscl;}
+  //! Scale factors applied to the outputs (fx_scaled = fx * fxscl)
+  const UBVECTOR &getOutputScale() const {return mfxscl;}
 
   // Constants to protect against overflow: 
   static const double PMAX;            //!< Greatest allowable price
@@ -112,6 +120,9 @@ public:
   static const double MINXSCL;
 
 protected:
+  void setPrices(const UBVECTOR &x, const std::vector<int> &aChanged);
+  void collectOutputs(const UBVECTOR &x, UBVECTOR &fx);
+
   // scale factors for input and output
   UBVECTOR mxscl;
   UBVECTOR mfxscl;
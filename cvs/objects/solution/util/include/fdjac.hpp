@@ -47,6 +47,7 @@
  */
 
 #include <iostream>
+#include <vector>
 #include "solution/util/include/functor.hpp"
 #include "solution/util/include/ublas-helpers.hpp"
 #include "util/base/include/definitions.h"
@@ -56,6 +57,10 @@ void jacol(VecFVec &F, const UBVECTOR &x,
                   UBMATRIX &J,
            bool usepartial=true, std::ostream *diagnostic=NULL);
 
+void fdjacserial(VecFVec &F, const UBVECTOR &x,
+                 const UBVECTOR &fx, UBMATRIX &J, bool usepartial=true,
+                 std::ostream *diagnostic=NULL);
+
 void fdjac(VecFVec &F, const UBVECTOR &x,
            const UBVECTOR &fx, UBMATRIX &J, bool usepartial=true,
            std::ostream *diagnostic=NULL);
@@ -63,4 +68,11 @@ void fdjac(VecFVec &F, const UBVECTOR &x,
 void fdjac(VecFVec &F, const UBVECTOR &x,
            UBMATRIX &J, bool usepartial=true);
 
+void fdjac(VecFVec &F, const UBVECTOR &x,
+           const UBVECTOR &fx, UBMATRIX &J, const std::vector<int> &cols,
+           bool usepartial=true);
+
+void fdjacdiag(VecFVec &F, const UBVECTOR &x,
+               const UBVECTOR &fx, UBVECTOR &D, bool usepartial=true);
+
 #endif
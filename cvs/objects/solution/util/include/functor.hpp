@@ -45,6 +45,7 @@
  */
 
 #include <iostream>
+#include <vector>
 #include "solution/util/include/ublas-helpers.hpp"
 
 /*!
@@ -107,6 +108,25 @@ public:
    * derivative.
    */
   virtual double partialSize(int ip) const {return 1.0;}
+  /*!
+   * Evaluates the function at several points.
+   *
+   * The default implementation simply evaluates each point in turn.
+   * Subclasses which can evaluate independent points concurrently may
+   * override this.  Which point, if any, the function is left at
+   * afterward is implementation-defined, so the caller must
+   * re-evaluate the point it intends to keep.
+   *
+   * \param[in] ax: The points at which to evaluate the function.
+   * \param[out] afx: The function values, resized to match ax.
+   */
+  virtual void evalMultiple(const std::vector<UBVECTOR> &ax, std::vector<UBVECTOR> &afx) {
+    afx.resize(ax.size());
+    for(size_t i=0; i<ax.size(); ++i) {
+      afx[i].resize(nr);
+      (*this)(ax[i], afx[i]);
+    }
+  }
   /*!
    * Turns on implementation-defined diagnostics (default is no-op)
    */
@@ -0,0 +1,62 @@
+#ifndef KRYLOV_HPP_
+#define KRYLOV_HPP_
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+ * \file krylov.hpp
+ * \ingroup Solution
+ * \brief Matrix-free Krylov subspace linear solvers for use in Newton-Krylov root finders
+ * \details The matrix is never formed, instead the solvers only need the product of the
+ *          matrix with a vector which for a Jacobian can be approximated by a directional
+ *          difference of the function.  Both solvers use right preconditioning with a
+ *          diagonal preconditioner so that the residuals they report are the residuals
+ *          of the original system.
+ */
+
+#include <functional>
+#include "solution/util/include/ublas-helpers.hpp"
+
+/*!
+ * The product of some linear operator A with a vector: Av = A*v
+ */
+typedef std::function<void (const UBVECTOR &v, UBVECTOR &Av)> LinearOperator;
+
+int gmres(const LinearOperator &A, const UBVECTOR &Minv, const UBVECTOR &b,
+          UBVECTOR &x, UBVECTOR &r, double tol, int restart, int maxit, int &niter);
+
+int bicgstab(const LinearOperator &A, const UBVECTOR &Minv, const UBVECTOR &b,
+             UBVECTOR &x, UBVECTOR &r, double tol, int maxit, int &niter);
+
+#endif
@@ -70,7 +70,7 @@
  * \return : 0= success, anything else= fail
  *
  */
-int linesearch(VecFVec &f, const UBVECTOR &x0,
+inline int linesearch(VecFVec &f, const UBVECTOR &x0,
                double f0, const UBVECTOR &g0,
                const UBVECTOR &dx, UBVECTOR &x,
                double &fx, UBVECTOR& fxVec, const double fxIncr, int &neval, std::ostream *solverlog = 0)
@@ -151,4 +151,118 @@ int linesearch(VecFVec &f, const UBVECTOR &x0,
   return 1;              
 }
 
+/*!
+ * Perform a line search in which the backtracking steps are tried several at
+ * a time.  The parameters and return value are the same as linesearch, with
+ * the addition of npoints.
+ *
+ * The full step is tried first on its own since it is accepted most of the
+ * time.  If it is rejected, each round of backtracking evaluates npoints
+ * step lengths together using VecFVec::evalMultiple, starting from the
+ * minimum of the quadratic fit used by linesearch and halving from there.
+ * Of the step lengths that give sufficient decrease the one with the smallest
+ * f(x) is kept and re-evaluated so that the function (and for LogEDFun the
+ * model "base" state) is left at the returned x.  This costs one more
+ * evaluation than linesearch would need but the evaluations within a round
+ * run concurrently when f supports it.
+ *
+ * \param[in] npoints: The number of step lengths to try in each round, with
+ *                     npoints <= 1 this is equivalent to linesearch.
+ */
+inline int linesearchMultiPoint(VecFVec &f, const UBVECTOR &x0,
+                                double f0, const UBVECTOR &g0,
+                                const UBVECTOR &dx, UBVECTOR &x,
+                                double &fx, UBVECTOR& fxVec, const double fxIncr, int &neval,
+                                const int npoints, std::ostream *solverlog = 0)
+{
+  if(npoints <= 1) {
+    return linesearch(f, x0, f0, g0, dx, x, fx, fxVec, fxIncr, neval, solverlog);
+  }
+
+  const double lseps = 1.0e-7;   // same as linesearch
+  const double TOLX = 1.0e-6;
+  int n = x0.size();
+  double g0dx=g0.dot(dx);
+
+  if(g0dx >= 0) {
+    if(solverlog)
+      (*solverlog) << "Linesearch aborted.  Not an initial descent direction.  g0dx= "
+                   << g0dx << "\n";
+    return 1;
+  }
+
+  double maxval = 0.0;
+  for(int i=0; i<n; ++i) {
+    maxval = std::max(fabs(dx[i] / (x0[i] + TOLX)), maxval);
+  }
+  double lmin = TOLX / maxval;
+
+  if(solverlog)
+    (*solverlog) << "Beginning multi-point linesearch: lmin = " << lmin << "  f0 = " << f0
+                 << "  points = " << npoints << "\n";
+
+  // try the full step on its own
+  double lambda = 1.0;
+  x = x0 + dx;
+  f(x, fxVec);
+  fx = fxVec.dot(fxVec);
+  neval++;
+  if(solverlog) {
+    (*solverlog) << "\tlambda = " << lambda << "  fx = " << fx << std::endl;
+  }
+  if(fx <= f0 + lseps*lambda*g0dx + fxIncr)
+    return 0;
+
+  double flambda = fx;
+  std::vector<UBVECTOR> xtrial(npoints), fxtrial;
+  std::vector<double> ltrial(npoints);
+  while(true) {
+    // the first trial is the same quadratic backtracking step linesearch
+    // would take, the rest keep halving it
+    double denom = flambda - f0 - g0dx*lambda;
+    double lnext = denom != 0.0 ? -g0dx * (lambda*lambda)/(2.0 * denom) : 0.5*lambda;
+    lnext = std::max(0.1*lambda, std::min(0.5*lambda, lnext));
+    int ntrial = 0;
+    for(; ntrial < npoints && lnext > lmin; ++ntrial, lnext *= 0.5) {
+      ltrial[ntrial] = lnext;
+      xtrial[ntrial] = x0 + lnext*dx;
+    }
+    if(ntrial == 0)
+      break;
+    xtrial.resize(ntrial);
+    f.evalMultiple(xtrial, fxtrial);
+    neval += ntrial;
+
+    int best = -1;
+    double fbest = 0.0;
+    for(int k=0; k<ntrial; ++k) {
+      double fk = fxtrial[k].dot(fxtrial[k]);
+      if(solverlog) {
+        (*solverlog) << "\tlambda = " << ltrial[k] << "  fx = " << fk << std::endl;
+      }
+      if(fk <= f0 + lseps*ltrial[k]*g0dx + fxIncr && (best < 0 || fk < fbest)) {
+        best = k;
+        fbest = fk;
+      }
+    }
+
+    if(best >= 0) {
+      // SUCCESS, commit the chosen point
+      x = xtrial[best];
+      f(x, fxVec);
+      fx = fxVec.dot(fxVec);
+      neval++;
+      return 0;
+    }
+
+    // none were good enough, continue backtracking from the shortest step
+    lambda = ltrial[ntrial-1];
+    flambda = fxtrial[ntrial-1].dot(fxtrial[ntrial-1]);
+    xtrial.resize(npoints);
+  }
+
+  // The line search failed.  Note f was left at the full step.
+  return 1;
+}
+
 #endif
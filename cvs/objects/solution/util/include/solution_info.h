@@ -137,6 +137,7 @@ public:
     void setForecastDemand( const double aDemand );
     double getCorrectionSlope() const;
     void setCorrectionSlope( const double aSlope );
+    void setLogPriceDerivative( const double aDerivative );
 
     int getSerialNumber( void ) const;
     
@@ -42,6 +42,7 @@
 #include <cassert>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 #include "util/base/include/util.h"
 #include "solution/util/include/calc_counter.h"
@@ -88,11 +89,110 @@ void CalcCounter::incrementCount( const double additional ){
     totalCount += additional;
     periodCount += additional;
     methodCounts[ currMethodName ] += additional;
+    vector<int>& events = methodEvents[ currMethodName ];
+    events.resize( END, 0 );
+    ++events[ additional < 1 ? PARTIAL_EVALUATION : FULL_EVALUATION ];
 #if GCAM_PARALLEL_ENABLED
     mCounterLock.unlock();
 #endif
 }
 
+/*! \brief Return the number of solver iterations taken so far by a given solution method in the current period.
+* \details Together with getMethodCount this allows the cost of a method per
+*          iteration to be compared between solver components.
+* \param methodName The name of the method for which to get the number of iterations.
+* \return The number of iterations reported by the given solution method in the current period.
+*/
+int CalcCounter::getMethodIterations( const string methodName ) const {
+    return util::searchForValue( methodIterations, methodName );
+}
+
+/*!\brief Increment the iteration count for the current method by a given amount, 1 by default.
+* \param additional Amount to increment the count by, 1 is the default.
+*/
+void CalcCounter::incrementIterations( const int additional ){
+#if GCAM_PARALLEL_ENABLED
+    mCounterLock.lock();
+#endif
+    methodIterations[ currMethodName ] += additional;
+#if GCAM_PARALLEL_ENABLED
+    mCounterLock.unlock();
+#endif
+}
+
+/*! \brief Return the number of times an event occurred in a given solution method in the current period.
+* \param methodName The name of the method for which to get the count.
+* \param aEvent The event to get the count of.
+* \return The number of times the event occurred in the given method in the current period.
+*/
+int CalcCounter::getMethodEventCount( const string methodName, const EventType aEvent ) const {
+    map<string, vector<int> >::const_iterator iter = methodEvents.find( methodName );
+    return iter != methodEvents.end() ? iter->second[ aEvent ] : 0;
+}
+
+/*!\brief Increment the count of an event for the current method by a given amount, 1 by default.
+* \details World.calc evaluations are counted automatically by incrementCount.
+* \param aEvent The event which occurred.
+* \param additional Amount to increment the count by, 1 is the default.
+*/
+void CalcCounter::incrementEventCount( const EventType aEvent, const int additional ){
+#if GCAM_PARALLEL_ENABLED
+    mCounterLock.lock();
+#endif
+    vector<int>& events = methodEvents[ currMethodName ];
+    events.resize( END, 0 );
+    events[ aEvent ] += additional;
+#if GCAM_PARALLEL_ENABLED
+    mCounterLock.unlock();
+#endif
+}
+
+/*! \brief Return the wall clock time spent by a given solution method in the current period.
+* \param methodName The name of the method for which to get the time.
+* \return The time in seconds.
+*/
+double CalcCounter::getMethodWallTime( const string methodName ) const {
+    return util::searchForValue( methodTimes, methodName ).first;
+}
+
+/*! \brief Return the process CPU time spent by a given solution method in the current period.
+* \param methodName The name of the method for which to get the time.
+* \return The time in seconds summed over all threads.
+*/
+double CalcCounter::getMethodCPUTime( const string methodName ) const {
+    return util::searchForValue( methodTimes, methodName ).second;
+}
+
+/*! \brief Add time spent by a solution method in the current period.
+* \details The method name is given explicitly since the time is measured by
+*          the caller of the method rather than the method itself.
+* \param methodName The name of the method which took the time.
+* \param aWallTime The wall clock time in seconds.
+* \param aCPUTime The process CPU time in seconds.
+*/
+void CalcCounter::addMethodTime( const string methodName, const double aWallTime, const double aCPUTime ){
+    pair<double, double>& times = methodTimes[ methodName ];
+    times.first += aWallTime;
+    times.second += aCPUTime;
+}
+
+/*! \brief Get the names of all methods which have been used in the current period.
+* \return The method names in sorted order.
+*/
+vector<string> CalcCounter::getMethodNames() const {
+    vector<string> names;
+    for( map<string, double>::const_iterator iter = methodCounts.begin(); iter != methodCounts.end(); ++iter ){
+        names.push_back( iter->first );
+    }
+    for( map<string, pair<double, double> >::const_iterator iter = methodTimes.begin(); iter != methodTimes.end(); ++iter ){
+        if( methodCounts.find( iter->first ) == methodCounts.end() ){
+            names.push_back( iter->first );
+        }
+    }
+    sort( names.begin(), names.end() );
+    return names;
+}
+
 /*! \brief Set the name of the method currently being used to solve.
 * \param methodName The name of the method now being used to solve.
 */
@@ -101,11 +201,16 @@ void CalcCounter::setCurrentMethod( const string methodName ){
 }
 
 /*! \brief Start a new period. 
-* \details Starts a new period by resetting the period based counters.
+* \details Starts a new period by resetting the period based counters. Calls
+*          made before a solution method is set are not attributed to any method.
 */
 void CalcCounter::startNewPeriod(){
+    currMethodName.clear();
     periodCount = 0;
     methodCounts.clear();
+    methodIterations.clear();
+    methodEvents.clear();
+    methodTimes.clear();
 }
 
 /*! \brief Utility helper function to convert to an integer from the ceiling of a double.
@@ -127,7 +232,10 @@ void CalcCounter::print( ostream& out ) const {
     typedef map<string, double>::const_iterator MethodCountIterator;
 
     for( MethodCountIterator iter = methodCounts.begin(); iter != methodCounts.end(); ++iter ){
-        out << "Method: " << iter->first << " Count: " << iter->second << endl;
+        out << "Method: " << iter->first << " Count: " << iter->second
+            << " Iterations: " << util::searchForValue( methodIterations, iter->first )
+            << " Jacobians: " << getMethodEventCount( iter->first, JACOBIAN )
+            << " Line search steps: " << getMethodEventCount( iter->first, LINE_SEARCH_STEP ) << endl;
     }
     out << endl;
 }
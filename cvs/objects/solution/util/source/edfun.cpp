@@ -46,6 +46,11 @@
 
 #include "util/base/include/timer.h"
 
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+#endif
+
 extern Scenario* scenario;
 
 const double LogEDFun::PMAX = 1.0e24;
@@ -330,7 +335,122 @@ void LogEDFun::operator()(const UBVECTOR &ax, UBVECTOR &fx, const int partj)
    * 3 Collect the outputs from the solutionInfo objects and repack them in the
    *   output vector
    ****/
-  
+  collectOutputs(x, fx);
+
+  edfunPostTimer.stop();
+
+  edfunMiscTimer.stop();
+}
+
+/*!
+ * \brief Evaluate the function as a partial calculation in which the prices
+ *        of several markets have changed at once.
+ * \details The model state is reset to the "base" state, the prices of the
+ *          markets listed in aChanged are set from x, and only the activities
+ *          in aCalcList are recalculated.  The caller must have turned on
+ *          partial derivative state (ManageStateVariables::setPartialDeriv) and
+ *          aCalcList must contain, in global calculation order, every activity
+ *          that depends on any of the changed markets.  Since each call
+ *          starts from the "base" state and the state is thread local this may
+ *          be called concurrently for disjoint sets of markets.
+ * \param ax The (scaled) inputs.  Only the entries listed in aChanged are used.
+ * \param fx The outputs for all markets.
+ * \param aChanged The indices of the markets whose price should be set from x.
+ * \param aCalcList The activities to recalculate.
+ */
+void LogEDFun::operator()(const UBVECTOR &ax, UBVECTOR &fx, const std::vector<int> &aChanged,
+                          const std::vector<IActivity*> &aCalcList)
+{
+  assert(ax.size() == mkts.size());
+  assert(fx.size() == mkts.size());
+
+  Timer& edfunMiscTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EDFUN_MISC );
+  edfunMiscTimer.start();
+
+  UBVECTOR x(ax.size());
+  for(unsigned int i=0; i<x.size(); ++i)
+      x[i] = ax[i]*mxscl[i];
+
+  scenario->mManageStateVars->copyState();
+  mktplc->mIsDerivativeCalc = true;
+  setPrices(x, aChanged);
+  edfunMiscTimer.stop();
+
+  Timer& evalPartTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::EVAL_PART );
+  evalPartTimer.start();
+  world->calc(period, aCalcList);
+  evalPartTimer.stop();
+
+  edfunMiscTimer.start();
+  collectOutputs(x, fx);
+  edfunMiscTimer.stop();
+}
+
+/*!
+ * \brief Evaluate the function at several points concurrently.
+ * \details Each point is a full model evaluation, however it is run in the
+ *          partial derivative "scratch" state of whichever thread picks it up
+ *          so that the points can be evaluated at the same time.  That means
+ *          the "base" state is left untouched and the caller must do a regular
+ *          evaluation of the point it keeps.  Without GCAM_PARALLEL_ENABLED
+ *          this falls back to evaluating each point in turn.
+ * \param ax The (scaled) inputs for each point.
+ * \param afx The outputs for each point.
+ */
+void LogEDFun::evalMultiple(const std::vector<UBVECTOR> &ax, std::vector<UBVECTOR> &afx)
+{
+#if GCAM_PARALLEL_ENABLED
+  afx.resize(ax.size());
+  std::vector<int> allMkts(mkts.size());
+  for(size_t i=0; i<allMkts.size(); ++i) {
+      allMkts[i] = i;
+  }
+  const std::vector<IActivity*>& calcList = world->getGlobalOrdering();
+
+  scenario->getManageStateVariables()->setPartialDeriv(true);
+  tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+  tbb::task_group tg;
+  threadPool.execute([&](){
+      tg.run([&](){
+          tbb::parallel_for(size_t(0), ax.size(), [&](const size_t k) {
+              afx[k].resize(nr);
+              (*this)(ax[k], afx[k], allMkts, calcList);
+          });
+      });
+  });
+  threadPool.execute([&tg](){ tg.wait(); });
+  partial(-1);
+#else
+  VecFVec::evalMultiple(ax, afx);
+#endif
+}
+
+/*!
+ * \brief Set the prices of the given markets from the (unscaled) inputs.
+ * \param x The unscaled inputs.
+ * \param aChanged The indices of the markets to set.
+ */
+void LogEDFun::setPrices(const UBVECTOR &x, const std::vector<int> &aChanged)
+{
+  for(std::vector<int>::const_iterator it = aChanged.begin(); it != aChanged.end(); ++it) {
+    const int i = *it;
+    if(!mLogPricep)
+      mkts[i].setPrice(x[i]); // input vector = price
+    else if(x[i] > ARGMAX)
+      mkts[i].setPrice(PMAX);
+    else
+      mkts[i].setPrice(exp(x[i])); // input vector = log(price)
+  }
+}
+
+/*!
+ * \brief Retrieve the supplies and demands of all markets and calculate the
+ *        (scaled) outputs according to market type.
+ * \param x The unscaled inputs at which the model was just evaluated.
+ * \param fx The outputs to fill in.
+ */
+void LogEDFun::collectOutputs(const UBVECTOR &x, UBVECTOR &fx)
+{
   // at this point we've recalculated all the supplies and demands.
   // Retrieve them, calculate output according to market type, and
   // store them in fx
@@ -397,9 +517,4 @@ void LogEDFun::operator()(const UBVECTOR &ax, UBVECTOR &fx, const int partj)
   // Do the scaling for fx
   for(unsigned i=0; i<fx.size(); ++i)
       fx[i] *= mfxscl[i];
-  
-  edfunPostTimer.stop();
-
-  edfunMiscTimer.stop();
 }
-
@@ -35,33 +35,50 @@
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/task_group.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_for.h>
 #endif
 
 #include "util/base/include/timer.h"
 #include "containers/include/scenario.h"
+#include "containers/include/world.h"
+#include "solution/util/include/calc_counter.h"
 #include "util/base/include/manage_state_variables.hpp"
+#include "util/base/include/parallel_consistency_checker.h"
 
 extern Scenario* scenario;
 
 /*!
- * Compute a single column in a Jacobian matrix.  We have broken this
- * out from the fdjac subroutine so that we can easily test a single
- * column for nonsingularity without duplicating any code.
+ * Perturb a single element of xx by the finite difference step used for
+ * every Jacobian calculated here.
+ * \param[in,out] xx: The point to perturb
+ * \param[in] j: The element of xx to perturb
+ * \return The step actually taken
  */
-inline void jacol(VecFVec &F, const UBVECTOR &x,
-                  const UBVECTOR &fx, int j,
-                  UBMATRIX &J,
-                  bool usepartial, std::ostream *diagnostic) {
+static double fdstep(UBVECTOR &xx, int j) {
   const double heps = 1.0e-6;
   const double TINY = 1.0e-6;
-  UBVECTOR xx(x); // temporary, so we can respect the const on x
-  UBVECTOR fxx(fx.size());        // hold the values of F(xx)
   double t = xx[j];            // store the old value
   double h = heps * (fabs(t)+TINY);
-  
+
   xx[j] = t+h;
-  h     = xx[j]-t; // reduce roundoff error, since (t+h)-t is not
+  return xx[j]-t;  // reduce roundoff error, since (t+h)-t is not
                    // necessarily identical to the original h
+}
+
+/*!
+ * Compute a single column in a Jacobian matrix.  We have broken this
+ * out from the fdjac subroutine so that we can easily test a single
+ * column for nonsingularity without duplicating any code.
+ */
+void jacol(VecFVec &F, const UBVECTOR &x,
+           const UBVECTOR &fx, int j,
+           UBMATRIX &J,
+           bool usepartial, std::ostream *diagnostic) {
+  UBVECTOR xx(x); // temporary, so we can respect the const on x
+  UBVECTOR fxx(fx.size());        // hold the values of F(xx)
+  double t = xx[j];            // store the old value
+  double h = fdstep(xx, j);
+
   if(diagnostic) {
       (*diagnostic) << "j= " << j << "\th= " << h << "\nxx:\n" << xx << "\n";
   }
@@ -102,29 +119,70 @@ void fdjac(VecFVec &F, const UBVECTOR &x,
 
   Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
   jacTimer.start();
+  scenario->getWorld()->getCalcCounter()->incrementEventCount( CalcCounter::JACOBIAN );
     if(usepartial) { scenario->getManageStateVariables()->setPartialDeriv(true); }
   
 #if !GCAM_PARALLEL_ENABLED
-  for(size_t j=0; j<x.size(); ++j) {
-    jacol(F, x, fx, j, J, usepartial, diagnostic);
-  }
+  fdjacserial(F, x, fx, J, usepartial, diagnostic);
 #else
+    ParallelConsistencyChecker* checker = usepartial ? scenario->getParallelConsistencyChecker() : 0;
+    if(checker) {
+      std::vector<int> cols(x.size());
+      for(int j=0; j<x.size(); ++j) {
+        cols[j] = j;
+      }
+      checker->sampleJacobianColumns(cols);
+    }
     tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
     tbb::task_group tg;
     threadPool.execute([&](){
         tg.run([&](){
             tbb::parallel_for_each( x, [&]( const double& j ) {
                 jacol(F, x, fx, (&j - &x[0]), J, usepartial, 0/*diagnostic*/);
+                if(checker) { checker->saveColumnState(&j - &x[0]); }
             });
         });
     });
     threadPool.execute([&tg](){ tg.wait(); });
+    if(checker) {
+      // recalculate the sampled columns one at a time into a scratch matrix
+      UBMATRIX Jcheck(J);
+      threadPool.execute([&](){
+          checker->checkJacobianColumns([&](const int j) {
+              jacol(F, x, fx, j, Jcheck, usepartial, 0);
+          });
+      });
+    }
 #endif
     if(usepartial) { F.partial(-1); }
 
   jacTimer.stop();
 }
 
+/*!
+ * Compute the Jacobian of a vector function F at point x one column at a
+ * time on the calling thread.
+ * \param[in] F: The function to have its Jacobian calculated
+ * \param[in] x: The point at which to calculate the Jacobian
+ * \param[in] fx: F(x)
+ * \param[out] J: The Jacobian of F
+ * \param[in] usepartial: (optional) use partial model evaluation for partial derivatives
+ * \param[in] diagnostic: (optional) ostream pointer to which to send additional diagnostics
+ * \details This is what fdjac does without GCAM_PARALLEL_ENABLED.  It does not
+ *          use the thread pool or the JACOBIAN timer, so it may be called from
+ *          code which is already running concurrently.  As with jacol the
+ *          caller is responsible for putting the state in partial derivative
+ *          mode when usepartial is set.
+ */
+void fdjacserial(VecFVec &F, const UBVECTOR &x,
+                 const UBVECTOR &fx, UBMATRIX &J, bool usepartial,
+                 std::ostream *diagnostic)
+{
+  for(int j=0; j<x.size(); ++j) {
+    jacol(F, x, fx, j, J, usepartial, diagnostic);
+  }
+}
+
 /*!
  * Compute the Jacobian of a vector function F at point x.
  * \param[in] F: The function to have its Jacobian calculated
@@ -146,3 +204,109 @@ void fdjac(VecFVec &F, const UBVECTOR &x,
     fdjac(F,x,fx,J,usepartial);
 }
 
+
+/*!
+ * Compute a subset of the columns of the Jacobian of F at point x.
+ * \param[in] F: The function to have its Jacobian calculated
+ * \param[in] x: The point at which to calculate the Jacobian
+ * \param[in] fx: F(x)
+ * \param[in,out] J: The Jacobian of F; only the columns listed in cols are modified
+ * \param[in] cols: Indices of the columns to calculate
+ * \param[in] usepartial: (optional) use partial model evaluation for partial derivatives
+ * \details This is useful when most of J is already known (for instance, when it
+ *          has been carried over from a previous solution) and only a handful of
+ *          columns need to be filled in.
+ */
+void fdjac(VecFVec &F, const UBVECTOR &x,
+           const UBVECTOR &fx, UBMATRIX &J, const std::vector<int> &cols,
+           bool usepartial)
+{
+  if(cols.empty()) {
+    return;
+  }
+
+  Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
+  jacTimer.start();
+  scenario->getWorld()->getCalcCounter()->incrementEventCount( CalcCounter::JACOBIAN );
+    if(usepartial) { scenario->getManageStateVariables()->setPartialDeriv(true); }
+
+#if !GCAM_PARALLEL_ENABLED
+  for(size_t k=0; k<cols.size(); ++k) {
+    jacol(F, x, fx, cols[k], J, usepartial, 0);
+  }
+#else
+    ParallelConsistencyChecker* checker = usepartial ? scenario->getParallelConsistencyChecker() : 0;
+    if(checker) { checker->sampleJacobianColumns(cols); }
+    tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+    tbb::task_group tg;
+    threadPool.execute([&](){
+        tg.run([&](){
+            tbb::parallel_for_each( cols, [&]( const int j ) {
+                jacol(F, x, fx, j, J, usepartial, 0/*diagnostic*/);
+                if(checker) { checker->saveColumnState(j); }
+            });
+        });
+    });
+    threadPool.execute([&tg](){ tg.wait(); });
+    if(checker) {
+      // recalculate the sampled columns one at a time into a scratch matrix
+      UBMATRIX Jcheck(J);
+      threadPool.execute([&](){
+          checker->checkJacobianColumns([&](const int j) {
+              jacol(F, x, fx, j, Jcheck, usepartial, 0);
+          });
+      });
+    }
+#endif
+    if(usepartial) { F.partial(-1); }
+
+  jacTimer.stop();
+}
+
+/*!
+ * Compute only the diagonal of the Jacobian of F at point x.
+ * \param[in] F: The function to have its Jacobian calculated
+ * \param[in] x: The point at which to calculate the Jacobian
+ * \param[in] fx: F(x)
+ * \param[out] D: The diagonal of the Jacobian of F, D[j] = \partial F_j / \partial x_j
+ * \param[in] usepartial: (optional) use partial model evaluation for partial derivatives
+ * \details This takes the same number of function evaluations as the full Jacobian
+ *          but only needs to store the diagonal, which is useful for preconditioning
+ *          solvers that never form the full matrix.
+ */
+void fdjacdiag(VecFVec &F, const UBVECTOR &x,
+               const UBVECTOR &fx, UBVECTOR &D, bool usepartial)
+{
+  Timer& jacTimer = TimerRegistry::getInstance().getTimer( TimerRegistry::JACOBIAN );
+  jacTimer.start();
+  scenario->getWorld()->getCalcCounter()->incrementEventCount( CalcCounter::JACOBIAN );
+    if(usepartial) { scenario->getManageStateVariables()->setPartialDeriv(true); }
+
+  D.resize(x.size());
+  auto diagcol = [&](const int j) {
+    UBVECTOR xx(x);
+    UBVECTOR fxx(fx.size());
+    double h = fdstep(xx, j);
+    if(usepartial) {F.partial(j);}
+    F(xx, fxx, usepartial ? j : -1);
+    D[j] = (fxx[j] - fx[j]) / h;
+  };
+
+#if !GCAM_PARALLEL_ENABLED
+  for(int j=0; j<x.size(); ++j) {
+    diagcol(j);
+  }
+#else
+    tbb::task_arena& threadPool = scenario->getManageStateVariables()->mThreadPool;
+    tbb::task_group tg;
+    threadPool.execute([&](){
+        tg.run([&](){
+            tbb::parallel_for( 0, static_cast<int>(x.size()), diagcol );
+        });
+    });
+    threadPool.execute([&tg](){ tg.wait(); });
+#endif
+    if(usepartial) { F.partial(-1); }
+
+  jacTimer.stop();
+}
@@ -0,0 +1,200 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+#include "solution/util/include/krylov.hpp"
+#include <math.h>
+
+/*!
+ * Solve A*x = b using restarted GMRES with right preconditioning.
+ * \param[in] A: The linear operator
+ * \param[in] Minv: The diagonal of the inverse of the preconditioner
+ * \param[in] b: The right hand side
+ * \param[inout] x: On input the initial guess, on output the solution
+ * \param[out] r: The final residual, b - A*x
+ * \param[in] tol: Stop when the norm of the residual is less than this value
+ * \param[in] restart: The number of iterations between restarts
+ * \param[in] maxit: The maximum total number of iterations
+ * \param[out] niter: The number of iterations performed
+ * \return 0 if converged, 1 otherwise
+ * \remark Each iteration requires one application of A, plus one more for the
+ *         true residual at each restart.
+ */
+int gmres(const LinearOperator &A, const UBVECTOR &Minv, const UBVECTOR &b,
+          UBVECTOR &x, UBVECTOR &r, double tol, int restart, int maxit, int &niter)
+{
+  const int n = b.size();
+  UBVECTOR w(n);
+  niter = 0;
+
+  if(x.isZero()) {
+    r = b;
+  }
+  else {
+    A(x, w);
+    r = b - w;
+  }
+  double beta = r.norm();
+
+  while(beta > tol && niter < maxit) {
+    const int m = std::min(restart, maxit - niter);
+    UBMATRIX V(n, m+1);
+    UBMATRIX H(UBMATRIX::Zero(m+1, m));
+    UBVECTOR cs(m), sn(m);
+    UBVECTOR g(UBVECTOR::Zero(m+1));
+    g[0] = beta;
+    V.col(0) = r / beta;
+
+    int k = 0;
+    while(k < m) {
+      // Arnoldi step with modified Gram-Schmidt
+      A(Minv.cwiseProduct(V.col(k)), w);
+      ++niter;
+      for(int i=0; i<=k; ++i) {
+        H(i,k) = w.dot(V.col(i));
+        w -= H(i,k) * V.col(i);
+      }
+      const double hnext = w.norm();
+      H(k+1,k) = hnext;
+      if(hnext > 0.0) {
+        V.col(k+1) = w / hnext;
+      }
+
+      // apply the previous Givens rotations to the new column of H, then
+      // compute and apply a new one to eliminate H(k+1,k)
+      for(int i=0; i<k; ++i) {
+        double tmp = cs[i]*H(i,k) + sn[i]*H(i+1,k);
+        H(i+1,k) = -sn[i]*H(i,k) + cs[i]*H(i+1,k);
+        H(i,k) = tmp;
+      }
+      double denom = hypot(H(k,k), H(k+1,k));
+      cs[k] = denom > 0.0 ? H(k,k) / denom : 1.0;
+      sn[k] = denom > 0.0 ? H(k+1,k) / denom : 0.0;
+      H(k,k) = cs[k]*H(k,k) + sn[k]*H(k+1,k);
+      H(k+1,k) = 0.0;
+      g[k+1] = -sn[k] * g[k];
+      g[k] = cs[k] * g[k];
+      ++k;
+
+      // fabs(g[k]) is the norm of the residual if we stopped now
+      if(fabs(g[k]) <= tol || hnext == 0.0) {
+        break;
+      }
+    }
+
+    // update x with the least squares solution in the Krylov subspace
+    UBVECTOR y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+    x += Minv.cwiseProduct(V.leftCols(k) * y);
+
+    // calculate the true residual, which we need to restart in any case
+    A(x, w);
+    r = b - w;
+    beta = r.norm();
+  }
+
+  return beta <= tol ? 0 : 1;
+}
+
+/*!
+ * Solve A*x = b using BiCGStab with right preconditioning.
+ * \param[in] A: The linear operator
+ * \param[in] Minv: The diagonal of the inverse of the preconditioner
+ * \param[in] b: The right hand side
+ * \param[inout] x: On input the initial guess, on output the solution
+ * \param[out] r: The final residual, b - A*x
+ * \param[in] tol: Stop when the norm of the residual is less than this value
+ * \param[in] maxit: The maximum number of iterations
+ * \param[out] niter: The number of iterations performed
+ * \return 0 if converged, 1 otherwise (including breakdown)
+ * \remark Each iteration requires two applications of A.  Unlike GMRES the
+ *         storage required does not grow with the number of iterations.
+ */
+int bicgstab(const LinearOperator &A, const UBVECTOR &Minv, const UBVECTOR &b,
+             UBVECTOR &x, UBVECTOR &r, double tol, int maxit, int &niter)
+{
+  const int n = b.size();
+  UBVECTOR v(UBVECTOR::Zero(n)), p(UBVECTOR::Zero(n));
+  UBVECTOR s(n), t(n), phat(n), shat(n);
+  niter = 0;
+
+  if(x.isZero()) {
+    r = b;
+  }
+  else {
+    A(x, t);
+    r = b - t;
+  }
+  if(r.norm() <= tol) {
+    return 0;
+  }
+
+  const UBVECTOR rhat(r);
+  double rho = 1.0, alpha = 1.0, omega = 1.0;
+  while(niter < maxit) {
+    ++niter;
+    double rho1 = rhat.dot(r);
+    if(rho1 == 0.0) {
+      // breakdown
+      return 1;
+    }
+    if(niter == 1) {
+      p = r;
+    }
+    else {
+      double beta = (rho1/rho) * (alpha/omega);
+      p = r + beta * (p - omega * v);
+    }
+    phat = Minv.cwiseProduct(p);
+    A(phat, v);
+    alpha = rho1 / rhat.dot(v);
+    s = r - alpha * v;
+    if(s.norm() <= tol) {
+      x += alpha * phat;
+      r = s;
+      return 0;
+    }
+    shat = Minv.cwiseProduct(s);
+    A(shat, t);
+    omega = t.dot(s) / t.dot(t);
+    x += alpha * phat + omega * shat;
+    r = s - omega * t;
+    rho = rho1;
+    if(r.norm() <= tol) {
+      return 0;
+    }
+    if(omega == 0.0) {
+      // breakdown
+      return 1;
+    }
+  }
+  return 1;
+}
@@ -46,6 +46,7 @@
 #include "solution/util/include/solution_info_set.h"
 #include "solution/util/include/solver_library.h"
 #include "marketplace/include/market.h"
+#include "marketplace/include/marketplace.h"
 #include "util/logger/include/ilogger.h"
 #include "containers/include/info.h"
 
@@ -651,6 +652,19 @@ void SolutionInfo::setCorrectionSlope(const double aSlope) {
     }
 }
 
+/*!
+ * \brief Store the derivative of this market's (scaled) excess demand with
+ *        respect to the log of its price, as found by the solver.
+ * \details This is stored in the market info so that the price prediction in
+ *          Marketplace::init_to_last can use it when setting up the next period.
+ * \param aDerivative The derivative to store.
+ */
+void SolutionInfo::setLogPriceDerivative(const double aDerivative) {
+    if( util::isValidNumber( aDerivative ) ) {
+        linkedMarket->getMarketInfo()->setDouble( Marketplace::LOG_PRICE_DERIVATIVE_KEY, aDerivative );
+    }
+}
+
 int SolutionInfo::getSerialNumber( void ) const
 {
     return linkedMarket->getSerialNumber();
@@ -46,11 +46,13 @@
 */
 
 #include <string>
+#include <memory>
 #include "technologies/include/technology.h"
 #include "util/base/include/value.h"
 #include "sectors/include/ibackup_calculator.h"
 
 class IInfo;
+class CachedMarket;
 /*
  * \ingroup Objects
  * \brief A Technology which represents production from an intermittent
@@ -172,11 +174,38 @@ protected:
         DEFINE_VARIABLE( SIMPLE, "average-grid-capacity-factor", mAveGridCapacityFactor, Value ),
 
         //! State value necessary to track tech output ration
-        DEFINE_VARIABLE( SIMPLE | STATE, "tech-output-ratio", mIntermitOutTechRatio, Value )
+        DEFINE_VARIABLE( SIMPLE | STATE, "tech-output-ratio", mIntermitOutTechRatio, Value ),
+
+        //! The trial share for which the backup capacities were last calculated.
+        DEFINE_VARIABLE( SIMPLE | STATE, "backup-trial-share", mBackupTrialShare, Value ),
+
+        //! The resource variance for which the backup capacities were last calculated.
+        DEFINE_VARIABLE( SIMPLE | STATE, "backup-resource-variance", mBackupResourceVariance, Value ),
+
+        //! Marginal backup capacity per unit of output at mBackupTrialShare and
+        //! mBackupResourceVariance.
+        DEFINE_VARIABLE( SIMPLE | STATE, "marginal-backup-capacity", mMarginalBackupCapacity, Value ),
+
+        //! Average backup capacity per unit of output at mBackupTrialShare and
+        //! mBackupResourceVariance.
+        DEFINE_VARIABLE( SIMPLE | STATE, "average-backup-capacity", mAverageBackupCapacity, Value )
     )
     
     //! Info object used to pass parameter information into backup calculators.
     std::auto_ptr<IInfo> mIntermittTechInfo;
+
+    //! The name of the trial market good, set in completeInit.
+    std::string mTrialMarketGoodName;
+
+    //! The electricity market located for the current period.
+    std::auto_ptr<CachedMarket> mElectricMarket;
+
+    //! The trial market located for the current period.
+    std::auto_ptr<CachedMarket> mTrialMarket;
+
+    //! The resource market located for the current period, which holds the
+    //! resource variance.
+    std::auto_ptr<CachedMarket> mResourceMarket;
     
     void copy( const IntermittentTechnology& aOther );
 
@@ -200,13 +229,12 @@ protected:
                                    const std::string& aSectorName,
                                    const int aPeriod );
 
-    double getMarginalBackupCapacity( const std::string& aRegionName,
-                                      const std::string& aSectorName,
-                                      const int aPeriod ) const;
+    void calcBackupCapacity( const std::string& aRegionName,
+                             const int aPeriod );
+
+    double getMarginalBackupCapacity() const;
 
-    double getAverageBackupCapacity( const std::string& aRegionName,
-                                     const std::string& aSectorName,
-                                     const int aPeriod ) const;
+    double getAverageBackupCapacity() const;
 
     double calcEnergyFromBackup() const;
 
@@ -51,6 +51,7 @@
 #include "util/base/include/model_time.h"
 #include "util/base/include/xml_helper.h"
 #include "marketplace/include/marketplace.h"
+#include "marketplace/include/cached_market.h"
 #include "sectors/include/ibackup_calculator.h"
 #include "sectors/include/backup_calculator_factory.h"
 #include "sectors/include/sector_utils.h"
@@ -264,6 +265,7 @@ void IntermittentTechnology::completeInit( const string& aRegionName,
     if( mElectricSectorMarket.empty() ) {
         mElectricSectorMarket = aRegionName;
     }
+    mTrialMarketGoodName = SectorUtils::getTrialMarketName( mTrialMarketName );
 
     // Create trial market for intermettent technology if backup exists and needs to be
     // calculated.
@@ -271,7 +273,7 @@ void IntermittentTechnology::completeInit( const string& aRegionName,
         SectorUtils::createTrialSupplyMarket( aRegionName, mTrialMarketName, mIntermittTechInfo.get(), mElectricSectorMarket );
         MarketDependencyFinder* depFinder = scenario->getMarketplace()->getDependencyFinder();
         depFinder->addDependency( aSectorName, aRegionName,
-                                  SectorUtils::getTrialMarketName( mTrialMarketName ),
+                                  mTrialMarketGoodName,
                                   aRegionName );
         if( aSectorName != mElectricSectorName ) {
             // This dependency can not be removed since it is inherently different
@@ -304,15 +306,31 @@ void IntermittentTechnology::initCalc( const string& aRegionName,
     // Note: initCalc is called for all past, current and future technologies.
     Technology::initCalc( aRegionName, aSectorName, aSubsectorInfo,
         aDemographics, aPrevPeriodInfo, aPeriod );
+    initializeInputLocations( aRegionName, aSectorName, aPeriod );
+
+    // Locate the markets used in every calculation once for the period.
+    const Marketplace* marketplace = scenario->getMarketplace();
+    mElectricMarket = marketplace->locateMarket( mElectricSectorName, mElectricSectorMarket, aPeriod );
+    mTrialMarket = marketplace->locateMarket( mTrialMarketGoodName, aRegionName, aPeriod );
+    if( mResourceInput != mInputs.end() ) {
+        mResourceMarket = marketplace->locateMarket( ( *mResourceInput )->getName(), aRegionName, aPeriod );
+    }
+
     if ( mBackupCalculator ) {
         mBackupCalculator->initCalc( mIntermittTechInfo.get() );
 
         // The renewable trial market is a share calculation so we can give the
         // solver some additional hints that the range should be between 0 and 1.
-        SectorUtils::setSupplyBehaviorBounds( SectorUtils::getTrialMarketName( mTrialMarketName ),
+        SectorUtils::setSupplyBehaviorBounds( mTrialMarketGoodName,
                                               aRegionName, 0, 1, aPeriod );
     }
-    initializeInputLocations( aRegionName, aSectorName, aPeriod );
+
+    // Clear the backup capacities calculated for the previous period so that
+    // they will be recalculated the first time they are needed.
+    mBackupTrialShare = -util::getLargeNumber();
+    mBackupResourceVariance = -util::getLargeNumber();
+    mMarginalBackupCapacity = 0;
+    mAverageBackupCapacity = 0;
 }
 
 void IntermittentTechnology::postCalc( const string& aRegionName,
@@ -344,7 +362,7 @@ void IntermittentTechnology::production( const string& aRegionName,
     
     // For the trial intermittent technology market, set the trial supply amount to
     // the ratio of intermittent-technology output to the electricity output.
-    double dependentSectorOutput = scenario->getMarketplace()->getDemand( mElectricSectorName, mElectricSectorMarket, aPeriod );
+    double dependentSectorOutput = mElectricMarket->getDemand( mElectricSectorName, mElectricSectorMarket, aPeriod );
 
     if ( dependentSectorOutput > 0 ){
         mIntermitOutTechRatio = std::min( getOutput( aPeriod ) / dependentSectorOutput, 1.0 );
@@ -355,7 +373,10 @@ void IntermittentTechnology::production( const string& aRegionName,
 
     // Multiple vintaged intermittent technology ratios are additive. This gives one 
     // share for backup calculation and proper behavior for vintaging intermittent technologies.
-    SectorUtils::addToTrialDemand( aRegionName, mTrialMarketName, mIntermitOutTechRatio, aPeriod );
+    // The trial market is not created until period 1.
+    if( aPeriod > 0 ) {
+        mTrialMarket->addToDemand( mTrialMarketGoodName, aRegionName, mIntermitOutTechRatio, aPeriod, true );
+    }
 }
 
 /*! \brief Set tech shares based on backup energy needs for an intermittent
@@ -371,8 +392,7 @@ void IntermittentTechnology::setCoefficients( const string& aRegionName,
     // (in EJ) per unit of resource energy (in EJ) using backup capacity factor.
     // Based on average backup capacity as this is multiplied by sector output
     // to get total backup electricity.
-    double backupEnergyFraction = getAverageBackupCapacity( aRegionName, aSectorName,
-                                  aPeriod ) * calcEnergyFromBackup();
+    double backupEnergyFraction = getAverageBackupCapacity() * calcEnergyFromBackup();
 
     /*! \invariant Backup energy fraction must be positive. */
     assert( util::isValidNumber( backupEnergyFraction ) &&
@@ -426,6 +446,9 @@ void IntermittentTechnology::calcCost( const string& aRegionName,
                                        const string& aSectorName,
                                        const int aPeriod )
 {
+    // Update the backup capacities if the trial share has changed.
+    calcBackupCapacity( aRegionName, aPeriod );
+
     // Set marginal cost for backup to the input object set asside for this
     ( *mBackupCapCostInput )->setPrice( aRegionName, 
                               getMarginalBackupCapCost( aRegionName, mTrialMarketName, aPeriod ), 
@@ -455,61 +478,81 @@ double IntermittentTechnology::getMarginalBackupCapCost( const string& aRegionNa
     // is in GW/EJ, so have to convert to kW/GJ (multiply numerator by 1E6 and
     // denominator by 1E9 to get * 1/1000) to make consistent with market price
     // which is in $/GJ. BackupCost is in $/kw/yr.
-    double backupCost = getMarginalBackupCapacity( aRegionName, aSectorName, aPeriod )
-                        / 1000 * mBackupCapitalCost;   
+    double backupCost = getMarginalBackupCapacity() / 1000 * mBackupCapitalCost;
    return backupCost;
 }
 
 /*!
- * \brief Get the marginal backup capacity required per unit of energy output.
- * \details Uses the internal backup calculator to determine the marginal backup
- *          capacity per unit output. If a backup calculator was not read-in,
- *          this is assumed to be zero. 
- * \author Marshall Wise, Steve Smith, Sonny Kim
+ * \brief Calculate the marginal and average backup capacity required per unit
+ *        of energy output if the trial share or resource variance has changed.
+ * \details Uses the internal backup calculator to determine the backup
+ *          capacity per unit output. Within a period the backup only depends
+ *          on the trial share and the resource variance, which is updated as
+ *          the resource is calculated, so the results are kept along with the
+ *          values they were calculated for and are only recalculated when
+ *          either changes. These are state values so that each thread
+ *          calculating partial derivatives keeps its own. If a backup
+ *          calculator was not read-in the backup is assumed to be zero.
+ * \param aRegionName Region name.
  * \param aPeriod Model period.
- * \return Marginal backup capacity per unit of energy output.
  */
-double IntermittentTechnology::getMarginalBackupCapacity( const string& aRegionName,
-                                                          const string& aSectorName,
-                                                          const int aPeriod ) const {
-    double backupCapacity = 0;
-    if( mBackupCalculator && mResourceInput != mInputs.end() ){
-        const string& resourceName = ( *mResourceInput )->getName();
-        backupCapacity = mBackupCalculator->getMarginalBackupCapacity( aSectorName,
-                         mElectricSectorName, resourceName, aRegionName,
-                         mCapacityFactor, mElecReserveMargin, mAveGridCapacityFactor, aPeriod );
+void IntermittentTechnology::calcBackupCapacity( const string& aRegionName,
+                                                 const int aPeriod )
+{
+    if( !mBackupCalculator ) {
+        return;
+    }
+
+    // The trial market is not created until period 1.
+    const double trialShare = aPeriod > 0 ?
+        mTrialMarket->getPrice( mTrialMarketGoodName, aRegionName, aPeriod ) : -1;
+
+    // The variance is read each time as resources with several subresources
+    // update it during their calculation.
+    double variance = 0;
+    if( mResourceInput != mInputs.end() ) {
+        const IInfo* resourceInfo = mResourceMarket->getMarketInfo( ( *mResourceInput )->getName(),
+                                                                    aRegionName, aPeriod, true );
+        variance = resourceInfo ? resourceInfo->getDouble( "resourceVariance", true ) : 0;
+    }
+    if( trialShare == mBackupTrialShare && variance == mBackupResourceVariance ) {
+        return;
     }
 
+    mBackupTrialShare = trialShare;
+    mBackupResourceVariance = variance;
+    mMarginalBackupCapacity = mResourceInput != mInputs.end() ?
+        mBackupCalculator->getMarginalBackupCapacity( trialShare, variance, mCapacityFactor,
+                                                      mElecReserveMargin, mAveGridCapacityFactor ) : 0.0;
+    mAverageBackupCapacity = mBackupCalculator->getAverageBackupCapacity( trialShare, variance,
+                                                                          mCapacityFactor,
+                                                                          mElecReserveMargin,
+                                                                          mAveGridCapacityFactor );
+}
+
+/*!
+ * \brief Get the marginal backup capacity required per unit of energy output.
+ * \details Returns the value from the last call to calcBackupCapacity.
+ * \author Marshall Wise, Steve Smith, Sonny Kim
+ * \return Marginal backup capacity per unit of energy output.
+ */
+double IntermittentTechnology::getMarginalBackupCapacity() const {
     /*! \post Backup capacity is a valid number and positive. */
-    assert( backupCapacity >= 0 && util::isValidNumber( backupCapacity ) );
-    return backupCapacity;
+    assert( mMarginalBackupCapacity >= 0 && util::isValidNumber( mMarginalBackupCapacity ) );
+    return mMarginalBackupCapacity;
 }
 
 /*!
  * \brief Get the average backup capacity per unit output for the intermittent
  *        subsector.
- * \details Uses the internal backup calculator to determine the average backup
- *          capacity per unit output. If a backup calculator was not read-in,
- *          this is assumed to be zero.
+ * \details Returns the value from the last call to calcBackupCapacity.
  * \author Marshall Wise, Steve Smith, Sonny Kim
- * \param aPeriod Model period.
  * \return Average backup capacity per unit output.
  */
-double IntermittentTechnology::getAverageBackupCapacity( const string& aRegionName,
-                                                         const string& aSectorName,
-                                                         const int aPeriod ) const
-{
-    double backupCapacity = 0;
-    if( mBackupCalculator ){
-        const string& resourceName = ( *mResourceInput )->getName();
-        backupCapacity = mBackupCalculator->getAverageBackupCapacity( aSectorName,
-                         mElectricSectorName, resourceName, aRegionName,
-                         mCapacityFactor, mElecReserveMargin, mAveGridCapacityFactor, aPeriod );
-    }
-
+double IntermittentTechnology::getAverageBackupCapacity() const {
     /*! \post Backup capacity is a valid number and positive. */
-    assert( backupCapacity >= 0 && util::isValidNumber( backupCapacity ) );
-    return backupCapacity;
+    assert( mAverageBackupCapacity >= 0 && util::isValidNumber( mAverageBackupCapacity ) );
+    return mAverageBackupCapacity;
 }
 
 /*! 
@@ -0,0 +1,249 @@
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file checkpoint.h
+ * \ingroup util
+ * \brief Checkpoint class header file.
+ */
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <type_traits>
+#include <boost/core/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+
+#include "util/base/include/time_vector.h"
+
+class Scenario;
+class Market;
+class ITechnology;
+class Value;
+
+/*!
+ * \ingroup util
+ * \brief Saves and restores the complete model state between periods so that
+ *        an interrupted run may be resumed in a new process.
+ * \details GCAMFusion is used to walk every Data member of every CONTAINER
+ *          starting from the Scenario.  All numeric data, which includes
+ *          Values, plain doubles, integers and booleans as well as any vector,
+ *          time vector or map of them, is written in the order visited
+ *          regardless of whether it is flagged as STATE.  The information
+ *          attached to each market is written along with the market.  Strings
+ *          and pointers are not written as they are assumed to be set up from
+ *          the input files.
+ *
+ *          A checkpoint may only be loaded into a model which was built from
+ *          the same input files.  Some objects, such as production states, are
+ *          created during initCalc so each saved period must have been
+ *          initialized before loading.  The dynamic type of each container
+ *          visited is recorded so that loading will fail if the structure of
+ *          the model does not match.  Loading first verifies the whole file
+ *          before any model data is changed.
+ *
+ *          The climate model state is not written.  Since it is fully
+ *          determined by the emissions which are part of the model data it is
+ *          instead recreated by running the climate model for each restored
+ *          period.  Any data which is not declared via DEFINE_DATA is not seen
+ *          and must be derivable during initCalc or postCalc, with the
+ *          exception of solver state carried between periods, such as the
+ *          Jacobian which LogBroyden may reuse, which is written after the
+ *          model data.  A resumed run may be checked against an uninterrupted
+ *          one with compare.
+ *
+ *          A checkpoint of the calibration periods may be reused by any run
+ *          whose inputs to those periods are the same.  In this case the
+ *          checkpoint is named by calcContentHash and loading is limited to the
+ *          calibration periods with setLastRestoredPeriod so that values which
+ *          only apply to later periods, such as policy taxes, are left as read
+ *          from the input files.
+ */
+class Checkpoint: private boost::noncopyable {
+public:
+    explicit Checkpoint( const std::string& aFileName, const std::string& aKey = "" );
+
+    static std::string getConfiguredFileName( const std::string& aScenarioName );
+    static std::string getCalibrationCacheFileName( const std::string& aKey );
+    static std::string calcContentHash( Scenario* aScenario, const int aLastPeriod );
+
+    void setLastRestoredPeriod( const int aLastPeriod );
+
+    bool save( Scenario* aScenario, const int aLastPeriod );
+    int getLastPeriod( const Scenario* aScenario );
+    bool load( Scenario* aScenario );
+    bool compare( Scenario* aScenario );
+
+    // Helpers to read and write the binary encoding.
+    template<typename T>
+    static void writeRaw( std::ostream& aOut, const T& aValue );
+    template<typename T>
+    static void readRaw( std::istream& aIn, T& aValue );
+    static void writeString( std::ostream& aOut, const std::string& aValue );
+    static void readString( std::istream& aIn, std::string& aValue );
+
+    // GCAMFusion callbacks
+    template<typename DataType>
+    void processData( DataType& aData );
+    template<typename DataType>
+    void pushFilterStep( const DataType& aData );
+    template<typename DataType>
+    void pushFilterStep( DataType* const& aData );
+    void pushFilterStep( Market* const& aData );
+    void pushFilterStep( ITechnology* const& aData );
+    template<typename DataType>
+    void popFilterStep( const DataType& aData );
+    void popFilterStep( Market* const& aData );
+    void popFilterStep( ITechnology* const& aData );
+
+private:
+    //! The operation being performed while walking the model.
+    enum Mode {
+        //! Write the model data to mOut.
+        eSave,
+
+        //! Read from mIn checking that it matches the model but do not change
+        //! any model data.
+        eVerify,
+
+        //! Read from mIn into the model data.
+        eLoad,
+
+        //! Write the model data up to the last restored period to mOut, which
+        //! calculates a hash of the content.  Strings are included.
+        eHash
+    };
+
+    //! The file to save to or load from.
+    const std::string mFileName;
+
+    //! The name written in the header to identify what the checkpoint is for,
+    //! if empty the scenario name is used.
+    const std::string mKey;
+
+    //! The last period for which data is hashed or loaded.
+    int mLastRestoredPeriod;
+
+    //! The year of mLastRestoredPeriod, set when the walk starts.
+    int mLastRestoredYear;
+
+    //! The number of objects for later periods than mLastRestoredPeriod
+    //! currently being walked, data is not hashed or loaded when non-zero.
+    int mSkipDepth;
+
+    //! The current operation.
+    Mode mMode;
+
+    //! The stream to write to when saving.
+    std::ostream* mOut;
+
+    //! The stream to read from when verifying or loading.
+    std::istream* mIn;
+
+    //! Whether the file has matched the model so far.
+    bool mIsValid;
+
+    //! A description of the first mismatch found if mIsValid is false.
+    std::string mError;
+
+    const std::string& getHeaderName( const Scenario* aScenario ) const;
+    int readHeader( const Scenario* aScenario, std::istream& aIn );
+    void write( Scenario* aScenario, const int aLastPeriod, std::ostream& aOut );
+    void walk( Scenario* aScenario );
+    void transferSolverState();
+    bool isWriting() const;
+    bool isReading() const;
+    bool isStoring() const;
+    void beginObjectForYear( const int aYear );
+    void endObjectForYear( const int aYear );
+    void fail( const std::string& aError );
+    void checkTag( const boost::uint32_t aTag, const std::string& aWhat );
+    void checkSize( const size_t aSize, const std::string& aWhat );
+    void transferCount( boost::uint32_t& aCount );
+    template<typename T>
+    bool readInto( T& aTarget );
+
+    template<typename T>
+    void transfer( T& aValue, std::false_type aIsCheckpointed );
+    template<typename T>
+    void transfer( T& aValue, std::true_type aIsCheckpointed );
+    void transfer( std::string& aValue, std::false_type aIsCheckpointed );
+
+    template<typename T>
+    void transferData( T& aValue );
+    void transferData( Value& aValue );
+    void transferData( std::vector<bool>& aValue );
+    template<typename T>
+    void transferData( std::vector<T>& aValue );
+    template<typename T>
+    void transferData( objects::PeriodVector<T>& aValue );
+    template<typename T>
+    void transferData( objects::YearVector<T>& aValue );
+    template<typename T>
+    void transferData( objects::TechVintageVector<T>& aValue );
+    template<typename K, typename V>
+    void transferData( std::map<K, V>& aValue );
+    template<typename VectorType>
+    void transferFixed( VectorType& aValue, const size_t aNumRestored );
+};
+
+/*!
+ * \brief Write the raw bytes of a value in the native byte order.
+ * \param aOut The stream to write to.
+ * \param aValue The value to write.
+ */
+template<typename T>
+void Checkpoint::writeRaw( std::ostream& aOut, const T& aValue ) {
+    aOut.write( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+}
+
+/*!
+ * \brief Read the raw bytes of a value written by writeRaw.
+ * \param aIn The stream to read from.
+ * \param aValue The value to read into.
+ */
+template<typename T>
+void Checkpoint::readRaw( std::istream& aIn, T& aValue ) {
+    aIn.read( reinterpret_cast<char*>( &aValue ), sizeof( T ) );
+}
+
+#endif // _CHECKPOINT_H_
@@ -72,6 +72,13 @@
 #define GCAM_PARALLEL_ENABLED 1
 #endif
 
+//! A flag which turns on or off counting every heap allocation so that the
+//! MemoryProfiler can report allocations by model phase.  This replaces the
+//! global operator new and delete which adds a small cost to each allocation.
+#ifndef GCAM_ALLOCATION_PROFILING
+#define GCAM_ALLOCATION_PROFILING 0
+#endif
+
 // This allows for memory leak debugging.
 #if defined(_MSC_VER)
 #   ifdef _DEBUG
@@ -45,21 +45,45 @@
 */
 #include <string>
 #include <vector>
+#include <deque>
 #include <memory>
+#include <cassert>
 
 #include "util/base/include/atom.h"
 #include <boost/functional/hash/hash.hpp>
-#include <boost/shared_ptr.hpp>
+#include <boost/utility/string_view.hpp>
 
 //! Turn on hash map tuning. This imposes a slight overhead.
 #define TUNING_STATS 0
 
+//! Turn on recording of every insert and lookup to hash-map-trace.txt so
+//! that it can be replayed by the hash map benchmark. This is very slow.
+#define HASH_MAP_TRACE 0
+
 //! Set a default initial size for hashmaps.
 #define DEFAULT_SIZE 23
 
 #if TUNING_STATS
 #include <iostream>
 #endif
+
+#if HASH_MAP_TRACE
+#include <fstream>
+#include <mutex>
+
+/*! \brief Get the stream to which all hash maps write their trace.
+* \details The stream and the mutex guarding it are shared by every instantiation
+*          of HashMap so that operations on all maps are interleaved in a single
+*          trace in the order in which they happened.
+*/
+inline std::ofstream& getHashMapTrace( std::mutex*& aMutex ) {
+    static std::mutex traceMutex;
+    static std::ofstream traceFile( "hash-map-trace.txt" );
+    aMutex = &traceMutex;
+    return traceFile;
+}
+#endif
+
 /*!
 * \ingroup Objects
 * \brief A template object which implements a mapping of key to value using a
@@ -70,19 +94,28 @@
 *          key into a pseudo-random value distributed over the range of the
 *          internal storage array. If the hash function converts two distinct
 *          keys into the same value, a collision occurs which the map must
-*          handle. The hash map is implemented as a list of buckets, accessed by
-*          an integer index. Each bucket can contain a single key-value pairing,
-*          or a chain of pairings implemented as a linked list. If there are no
-*          collisions, then each bucket only contains a single key-value pair.
-*          When a collision does occur, the collided values are placed in the
-*          bucket's chain. As a result of this design, access to a value given a
-*          key can occur in constant time unless there is a collision on the
-*          key. To minimize collisions, the hashmap automatically increases its
-*          size to prevent the map from reaching over 40 percent of its
-*          capacity.
+*          handle.
+*
+*          The map uses open addressing: the internal storage is a single
+*          power of two sized array of slots, each holding the full hash of a
+*          key and the position of its key-value pair. A collision is resolved
+*          by moving to the next slot until either the key or an empty slot is
+*          found. Since the full hash is stored in the slot, keys only need to
+*          be compared when the hashes match and the slots can be rehashed
+*          when the map grows without recomputing any hashes. The key-value
+*          pairs themselves are stored in insertion order in a deque, so there
+*          is no allocation per entry, iteration is a linear walk and follows
+*          the order in which keys were added, and references to values remain
+*          valid as the map grows. To minimize collisions, the hashmap
+*          automatically increases its size to prevent the map from reaching
+*          over 50 percent of its capacity.
+*
+*          If the key is a string, it may also be looked up using a
+*          boost::string_view so that callers holding a substring or a
+*          character buffer do not need to construct a temporary string.
 * \note This is not currently a complete map implementation, it only allows for
 *       getting and setting individual values. There is currently not a way to
-*       iterate over the key-value set or remove keys from the map.
+*       remove keys from the map.
 * \note The Value type is required to implement the no-argument constructor.
 *       This condition must be true for standard library containers as well.
 * \note Do not use auto_ptrs as Values as they may be accidentally deleted during
@@ -92,21 +125,12 @@
 
 template <class Key, class Value>
 class HashMap {
-private:
-	// Forward declare the Item so the interface is easier to read.
-	struct Item;
-
-    //! Typedef which defines the type of a pair containing pointer to an Item
-    //! and it's position in the bucket vector.
-    typedef std::pair<Item*,size_t> ItemPair;
-    typedef std::pair<const Item*, size_t> CItemPair;
 public:
 	/*! \brief Constant iterator to a HashMap. */
 	class const_iterator {
 	public:
         const_iterator();
-		explicit const_iterator( const Item* aCurrentItem,
-                                 const size_t aBucketPosition,
+		explicit const_iterator( const size_t aPosition,
                                  const HashMap* aParent );
 
 		bool operator==( const const_iterator& aOther ) const;
@@ -116,9 +140,8 @@ public:
         const_iterator& operator++();    // prefix ++
         const_iterator operator++(int); // postfix ++
 	protected:
-        //! The current item at which the iterator is pointing and it's bucket
-        //! spot.
-        CItemPair mCurrentItem;
+        //! The position of the current key-value pair in the parent's entries.
+        size_t mPosition;
 
         //! Pointer to the parent hashmap of the iterator.
         const HashMap* mParent;
@@ -129,8 +152,7 @@ public:
     class iterator: public const_iterator {
 	public:
         iterator();
-		explicit iterator( Item* aCurrentItem,
-                           const size_t aBucketPosition,
+		explicit iterator( const size_t aPosition,
                            const HashMap* aParent );
 
 		bool operator==( const iterator& aOther ) const;
@@ -149,54 +171,58 @@ public:
     Value& operator[]( const Key& aKey );
 	const_iterator find( const Key& aKey ) const;
 	iterator find( const Key& aKey );
+	const_iterator find( const boost::string_view& aKey ) const;
+	iterator find( const boost::string_view& aKey );
 	const_iterator begin() const;
 	iterator begin();
 	const_iterator end() const;
 	iterator end();
 private:
+    /*! \brief A slot in the open addressing table.
+    * \details A slot stores the hash of a key along with the position of the
+    *          key-value pair in the entries plus one, so that a zero position
+    *          indicates an empty slot.
+    */
+    struct Slot {
+        Slot():mHash( 0 ), mPosition( 0 ){}
+
+        //! The full hash of the key.
+        size_t mHash;
+
+        //! The position of the key-value pair in mEntries plus one, or zero if
+        //! the slot is empty.
+        size_t mPosition;
+    };
+
+    template<class LookupKey>
+    size_t findPosition( const LookupKey& aKey, const size_t aHash ) const;
+
+    void insertSlot( const size_t aHash, const size_t aPosition );
+
 	void resize( const size_t aNewSize );
-    
-    CItemPair getFirstItem() const;
-    CItemPair getNextItem( const CItemPair& aItemPair ) const;
-    
-    ItemPair getFirstItem();
-    ItemPair getNextItem( const ItemPair& aItemPair );
 
-	//! The internal storage for the buckets.
-	std::vector<boost::shared_ptr<Item> > mBuckets;
+    static size_t hashKey( const std::string& aKey );
+    static size_t hashKey( const boost::string_view& aKey );
+    template<class OtherKey>
+    static size_t hashKey( const OtherKey& aKey );
 
-	//! Current size of the storage vector, which is greater than the number of
-    //! values.
-	size_t mSize;
+#if HASH_MAP_TRACE
+    template<class LookupKey>
+    void trace( const char aOperation, const LookupKey& aKey ) const;
+#endif
 
-	//! Number of entries.
-	size_t mNumEntries;
+	//! The open addressing table. The size is always a power of two.
+	std::vector<Slot> mSlots;
 
-	//! The hashmap's hash function
-	boost::hash<Key> mHashFunction;
+	//! The size of mSlots minus one, used to reduce a hash to a slot.
+	size_t mMask;
 
-	/*! \brief An item stores a key value pairing together.
-	* \details The Item structure stores the key value pairing, along with a
-	*          pointer to the next item in the bucket to allow chaining.
-    */
-	struct Item {
-		inline Item( const std::pair<Key, Value>& aKeyValuePair );
-		/*! \brief The key value pair.
-        */
-		std::pair<Key, Value> mKeyValuePair;
-
-		/*! \brief A pointer to the next Item in the bucket, null if it is the
-		*          last item in the bucket.
-		* \note The use of a smart pointer allows for an entire chain to be
-        *       deleted by deleting the head of the chain, which induces a
-        *       cascading deletion.
-        */
-		boost::shared_ptr<Item> mNext;
-	};
+    //! The key-value pairs in the order they were inserted.
+    std::deque<std::pair<Key, Value> > mEntries;
 
 #if( TUNING_STATS )
 	//! Number of collisions if TUNING_STATS is on.
-	unsigned int mNumCollisions;
+	mutable unsigned int mNumCollisions;
 
 	//! Number of resizes if TUNING_STATS is on.
 	unsigned int mNumResizes;
@@ -210,16 +236,24 @@ private:
 */
 template <class Key, class Value>
 HashMap<Key, Value>::HashMap( const size_t aSize ):
-mBuckets( aSize ), mSize( aSize ), mNumEntries( 0 )
+mMask( 0 )
 #if( TUNING_STATS )
 , mNumCollisions( 0 ),
 mNumResizes( 0 )
 #endif
 {
+    // Round the size up to a power of two so that a hash can be reduced to a
+    // slot with a mask instead of a division.
+    size_t numSlots = 8;
+    while( numSlots < aSize ){
+        numSlots *= 2;
+    }
+    mSlots.resize( numSlots );
+    mMask = numSlots - 1;
 }
 
 /*! \brief Destructor
-* \details All memory deallocation is performed by the smart pointers, the
+* \details All memory deallocation is performed by the containers, the
 *          destructor is only responsible for printing hash map statistics(if
 *          TUNING_STATS is compiled on).
 * \warning Deleting the map will not delete any allocated memory the user
@@ -229,10 +263,10 @@ mNumResizes( 0 )
 template <class Key, class Value>
 HashMap<Key, Value>::~HashMap(){
 #if( TUNING_STATS )
-	std::cout << "Hashmap stats - Size: " << static_cast<unsigned int>( mSize ) 
-		<< " Number of entries: " << static_cast<unsigned int>( mNumEntries )
+	std::cout << "Hashmap stats - Size: " << static_cast<unsigned int>( mSlots.size() ) 
+		<< " Number of entries: " << static_cast<unsigned int>( mEntries.size() )
 		<< " Collisions: " << mNumCollisions << " Percent full : " 
-		<< static_cast<double>( mNumEntries ) / mSize * 100 
+		<< static_cast<double>( mEntries.size() ) / mSlots.size() * 100 
 		<< " Number of resizes: " << mNumResizes << std::endl;
 #endif
 }
@@ -243,7 +277,7 @@ HashMap<Key, Value>::~HashMap(){
 template <class Key, class Value>
 bool
 HashMap<Key, Value>::empty() const {
-    return mNumEntries == 0;
+    return mEntries.empty();
 }
 
 /*! \brief Return the number of items in the hashmap.
@@ -252,18 +286,15 @@ HashMap<Key, Value>::empty() const {
 template <class Key, class Value>
 size_t
 HashMap<Key, Value>::size() const {
-    return mNumEntries;
+    return mEntries.size();
 }
 
 /*! \brief Insert a key-value pair to the map.
 * \details This function takes a key value pairing and adds it to the hashmap.
-*          To do this, it first calls the hash function on the key to determine
-*          which bucket the item should reside in. If the bucket is currently
-*          empty, the item is added as the first item in the bucket. Otherwise
-*          the linked list is traversed to see if the item already exists. If it
-*          does, the value is updated and the function will return true.
-*          Otherwise an item is added to the end of the list for this key-value
-*          pairing.
+*          To do this, it first calls the hash function on the key and probes
+*          the table for the key. If it is found the value is updated.
+*          Otherwise the pair is added to the end of the entries and the empty
+*          slot at which the search ended is set to point at it.
 * \param aKeyValuePair The key value pair to add to the hashmap.
 * \return A pair consisting of the iterator where the value was found and a bool
 *         representing whether the insert was a new value.
@@ -271,93 +302,40 @@ HashMap<Key, Value>::size() const {
 template <class Key, class Value>
 std::pair<typename HashMap<Key, Value>::iterator, bool>
 HashMap<Key, Value>::insert( const std::pair<Key, Value> aKeyValuePair ){
-	// First find the hash value and use the modulo function to reduce it to
-	// within the size of the bucket vector.
-	const size_t bucketSpot = mHashFunction( aKeyValuePair.first ) % mSize;
-
-	// We now know which bucket to either add the value to or update. Begin the
-    // search.
-	Item* curr = mBuckets[ bucketSpot ].get();
-	Item* prev = 0;   
-
-	// If the head of the chain is null, avoid attempting to search. Keep
-	// searching until we find the correct Item or the end of the chain. Track
-	// the previous position in the chain so that we can add to the end if the
-	// key is not found.
-	bool update = false;
-	while( curr ){
-		// Check if this is the correct spot.
-		if( curr->mKeyValuePair.first == aKeyValuePair.first ){
-			// Stop the search here as this is the postion to update.
-			update = true;
-			break;
-		}
-
-		// Move to the next item in the chain, which may be null.
-		prev = curr;
-
-		/*! \invariant Ensure that a pointer is not being assigned a reference
-        *              to itself. 
-        */
-		assert( curr != curr->mNext.get() );
-
-		curr = curr->mNext.get();
-	}
-
-	// If we found a spot to update, curr will not be null as the loop will have
-	// been exited by the successful match. Update the value and return that the
-	// value existed.
-	if( update ){
-		curr->mKeyValuePair.second = aKeyValuePair.second;
-		return std::make_pair( iterator( curr, bucketSpot, this ), false );
+#if HASH_MAP_TRACE
+    trace( 'i', aKeyValuePair.first );
+#endif
+    const size_t hash = hashKey( aKeyValuePair.first );
+    const size_t position = findPosition( aKeyValuePair.first, hash );
+
+	// If the key already exists update the value and return that the value
+	// existed.
+	if( position != mEntries.size() ){
+		mEntries[ position ].second = aKeyValuePair.second;
+		return std::make_pair( iterator( position, this ), false );
 	}
 
 	// We are not updating, so a new value must be added.
-	boost::shared_ptr<Item> newValue( new Item( aKeyValuePair ) );
-	++mNumEntries;
+    mEntries.push_back( aKeyValuePair );
 
-	// Add the entry as the first item in the bucket if there is not a previous
-    // pairing.
-	if( !prev ){
-		mBuckets[ bucketSpot ] = newValue;
-	}
-	else {
-		/*! \invariant Ensure that a loop is not created. */
-		assert( prev != newValue.get() );
+	// The ratio of entries to the number of slots at which to increase the map
+	// size. Linear probing degrades quickly as the table fills so this is kept
+	// low as the maps are adjusted for performance not size.
+	const double CAPACITY_THRESHHOLD = 0.5;
 
-		// Add the new item to the end of the chain.
-		prev->mNext = newValue;
-#if( TUNING_STATS )
-		// Record the collision.
-		++mNumCollisions;
-#endif
-	}
-	// The ratio of entries to the maximum size of the map at which to increase
-	// the map size. This is currently a low threshold as the maps are adjusted
-    // for performance not size. This may need to be adjusted for small maps.
-	const double CAPACITY_THRESHHOLD = 0.4;
-
-	// The multiple of the current size to which to set the new size.
-	const unsigned int RESIZE_MULTIPLE = 3;
-
-	// An additional size increment which helps performance for small maps where
-    // resizing by the above factor would not be enough.
-	const unsigned int ADDITIONAL_INCREMENT = 5;
-
-	// Check if the size of the bucket vector should be increased for
-	// performance. This should be done if the ratio of full to total buckets
-	// exceeds CAPACITY_THRESHHOLD.
-	if( static_cast<double>( mNumEntries ) / mSize > CAPACITY_THRESHHOLD ){
-		// Resize to three times the number of current entries plus several
-		// extra to handle small hashmaps. The bucket was empty, so add it as
-		// the first value.
+	// Check if the size of the table should be increased for performance. This
+	// will also add the new entry to the table.
+	if( static_cast<double>( mEntries.size() ) / mSlots.size() > CAPACITY_THRESHHOLD ){
 #if( TUNING_STATS )
 		++mNumResizes;
 #endif
-		resize( mNumEntries * RESIZE_MULTIPLE + ADDITIONAL_INCREMENT );
+		resize( mSlots.size() * 2 );
 	}
+    else {
+        insertSlot( hash, position );
+    }
 	// Return that an add and not an update occurred.
-	return std::make_pair( iterator( newValue.get(), bucketSpot, this ), true );
+	return std::make_pair( iterator( position, this ), true );
 }
 
 /*!
@@ -398,24 +376,10 @@ HashMap<Key, Value>::operator[]( const Key& aKey ){
 template <class Key, class Value>
 typename HashMap<Key, Value>::iterator
 HashMap<Key, Value>::find( const Key& aKey ){
-	// First find the hash value and use the modulus function to reduce it to
-	// within the size of the bucket vector.
-	const size_t bucketSpot = mHashFunction( aKey ) % mSize;
-
-	// We now know which bucket the key resides in if it exists.
-	Item* curr = mBuckets[ bucketSpot ].get();
-
-	// Keep searching until we find the correct Item or the end of the chain.
-	while( curr ){
-		// Check if this is the correct spot.
-		if( curr->mKeyValuePair.first == aKey ){
-			return iterator( curr, bucketSpot, this );
-		}
-		// Move to the next item in the chain, which may be null.
-		curr = curr->mNext.get();
-	}
-	// Return the end iterator is the key was not found.
-	return end();
+#if HASH_MAP_TRACE
+    trace( 'f', aKey );
+#endif
+    return iterator( findPosition( aKey, hashKey( aKey ) ), this );
 }
 
 /*! \brief Returns an immutable value for a given key.
@@ -427,24 +391,42 @@ HashMap<Key, Value>::find( const Key& aKey ){
 template <class Key, class Value>
 typename HashMap<Key, Value>::const_iterator
 HashMap<Key, Value>::find( const Key& aKey ) const {
-	// First find the hash value and use the mod function to reduce it to within
-	// the size of the bucket vector.
-	const size_t bucketSpot = mHashFunction( aKey ) % mSize;
-
-	// We now know which bucket the key resides in if it exists.
-	const Item* curr = mBuckets[ bucketSpot ].get();
-
-	// Keep searching until we find the correct Item or the end of the chain.
-	while( curr ){
-		// Check if this is the correct spot.
-		if( curr->mKeyValuePair.first == aKey ){
-			return const_iterator( curr, bucketSpot, this );
-		}
-		// Move to the next item in the chain, which may be null.
-		curr = curr->mNext.get();
-	}
-	// Return the end iterator is the key was not found.
-	return end();
+#if HASH_MAP_TRACE
+    trace( 'f', aKey );
+#endif
+    return const_iterator( findPosition( aKey, hashKey( aKey ) ), this );
+}
+
+/*! \brief Returns a mutable iterator for a given string key without
+*          requiring a string to be constructed.
+* \details This may only be used if the Key is a string.
+* \param aKey Key for which to return the value.
+* \return An iterator to the requested value or the end iterator if the key was
+*         not found.
+*/
+template <class Key, class Value>
+typename HashMap<Key, Value>::iterator
+HashMap<Key, Value>::find( const boost::string_view& aKey ){
+#if HASH_MAP_TRACE
+    trace( 'f', aKey );
+#endif
+    return iterator( findPosition( aKey, hashKey( aKey ) ), this );
+}
+
+/*! \brief Returns an immutable value for a given string key without
+*          requiring a string to be constructed.
+* \details This may only be used if the Key is a string.
+* \param aKey Key for which to return the value.
+* \return A constant iterator to the result or the end iterator if the key is
+*         not found.
+*/
+template <class Key, class Value>
+typename HashMap<Key, Value>::const_iterator
+HashMap<Key, Value>::find( const boost::string_view& aKey ) const {
+#if HASH_MAP_TRACE
+    trace( 'f', aKey );
+#endif
+    return const_iterator( findPosition( aKey, hashKey( aKey ) ), this );
 }
 
 /*! \brief Return the begin iterator.
@@ -454,8 +436,7 @@ HashMap<Key, Value>::find( const Key& aKey ) const {
 template<class Key, class Value>
 typename HashMap<Key, Value>::iterator
 HashMap<Key, Value>::begin() {
-    ItemPair itemPair = getFirstItem();
-	return iterator( itemPair.first, itemPair.second, this );
+	return iterator( 0, this );
 }
 
 /*! \brief Return the constant begin iterator.
@@ -465,8 +446,7 @@ HashMap<Key, Value>::begin() {
 template<class Key, class Value>
 typename HashMap<Key, Value>::const_iterator
 HashMap<Key, Value>::begin() const {
-    CItemPair itemPair = getFirstItem();
-	return const_iterator( itemPair.first, itemPair.second, this );
+	return const_iterator( 0, this );
 }
 
 /*! \brief Return the end iterator.
@@ -476,7 +456,7 @@ HashMap<Key, Value>::begin() const {
 template<class Key, class Value>
 typename HashMap<Key, Value>::iterator
 HashMap<Key, Value>::end() {
-	return iterator( 0, 0, 0 );
+	return iterator( mEntries.size(), this );
 }
 
 /*! \brief Return the constant end iterator.
@@ -486,239 +466,107 @@ HashMap<Key, Value>::end() {
 template<class Key, class Value>
 typename HashMap<Key, Value>::const_iterator
 HashMap<Key, Value>::end() const {
-	return const_iterator( 0, 0, 0 );
+	return const_iterator( mEntries.size(), this );
 }
 
-/*! \brief Resize the bucket vector. 
-* \details To resize the vector, the function first walks the hashmap to store
-*          the list of all items in the map. It then resizes the bucket vector
-*          and reinserts all the values into the map.
-* \warning This operation is very slow as it requires rehashing all entries.
-* \param aNewSize New size of the bucket vector.
+/*! \brief Find the position of a key in the entries.
+* \details Probes the table starting at the slot given by the hash until either
+*          a slot with a matching hash and key or an empty slot is found.
+* \param aKey The key to search for.
+* \param aHash The hash of the key.
+* \return The position of the key in the entries, or the number of entries if
+*         the key was not found.
 */
 template<class Key, class Value>
-void HashMap<Key, Value>::resize( const size_t aNewSize ){
-	// Check if the new and old size are the same to avoid resizing.
-	if( aNewSize == mSize ){
-		return;
-	}
-
-	// Walk the hashmap and create a list of all items in the tree. Create a
-	// temporary vector to hold all the entries.
-	std::vector<boost::shared_ptr<Item> > temporaryList;
-
-	// Iterate over the buckets.
-	for( unsigned int i = 0; i < mSize; ++i ){
-		// Set a pointer to the first item in the bucket.
-		boost::shared_ptr<Item> curr = mBuckets[ i ];
-		// Add all items in the chain to the temporary list.
-		while( curr.get() ){
-			temporaryList.push_back( curr );
-			
-			/*! \invariant Ensure that no pointer refers to itself. */
-			assert( curr.get() != curr->mNext.get() );
-
-			// Move to the next item in the chain.
-			curr = curr->mNext;
-		}
-	}
-	// Check that the temporary list contains all entries.
-	assert( temporaryList.size() == mNumEntries );
-
-	// Resize the bucket vector.
-	mSize = aNewSize;
-	// Clear the bucket vector before resizing so all pointers are null, not
-	// pointing at old values.
-	mBuckets.clear();
-	mBuckets.resize( mSize );
-
-#if( TUNING_STATS )
-	// Reset the collision count.
-	mNumCollisions = 0;
-#endif
-	// Now add each item back to the list. Can't use the add function as we
-	// already have allocated items and we don't want to change the count of the
-	// number of entries.
-	for( unsigned int i = 0; i < temporaryList.size(); ++i ){
-		/*! \invariant Every position in the temporary list has a valid pointer. */
-		assert( temporaryList[ i ].get() );
-		
-		/*! \invariant There is a second reference to the item pointed to by the
-        *              next pointer. 
-        */
-		assert( !temporaryList[ i ]->mNext.unique() );
-		
-		// Clear out the next pointer as it is no longer valid. The temporary
-		// list is holding a reference to all items in the list, so this cannot
-        // cause a deallocation.
-		temporaryList[ i ]->mNext.reset();
-
-		// Add a single item to the map. Find the hash value and use the mod
-        // function to reduce it to within the size of the bucket vector.
-		const size_t bucketSpot = mHashFunction( temporaryList[ i ]->mKeyValuePair.first ) % mSize;
-
-		// We now know which bucket the key resides in if it exists.
-		Item* curr = mBuckets[ bucketSpot ].get();
-
-		// If the spot is null, add this item as the head of the bucket's chain.
-		if( !curr ){
-			mBuckets[ bucketSpot ] = temporaryList[ i ];
-		}
-		// Otherwise we need to search for the end of the current bucket's
-        // chain.
-		else {
-			while( curr->mNext.get() ){
-				/*! \invariant Ensure that no pointer refers to itself. */
-				assert( curr != curr->mNext.get() );
-				
-				curr = curr->mNext.get();
-			}
-			// Curr now points to the last item in the chain, add the current
-			// item as the end of the chain.
-			/*! \invariant Ensure that no pointer refers to itself. */
-			assert( curr != temporaryList[ i ].get() );
-
-			curr->mNext = temporaryList[ i ];
+template<class LookupKey>
+size_t HashMap<Key, Value>::findPosition( const LookupKey& aKey, const size_t aHash ) const {
+    for( size_t i = aHash & mMask; ; i = ( i + 1 ) & mMask ){
+        const Slot& slot = mSlots[ i ];
+        if( slot.mPosition == 0 ){
+            return mEntries.size();
+        }
+        if( slot.mHash == aHash && mEntries[ slot.mPosition - 1 ].first == aKey ){
+            return slot.mPosition - 1;
+        }
 #if( TUNING_STATS )
-			// Record the collision.
-			++mNumCollisions;
+        ++mNumCollisions;
 #endif
-		}
-	}
+    }
 }
 
-/*! \brief Find the first item in the hashmap.
-* \details This function is used to initialize the constant begin iterator. It
-*          returns a pair containing a constant pointer to the first item and
-*          the position of the item in the bucket vector.
-* \return A pair containing a constant pointer to the first item and its
-*         position in the bucket vector. If the vector is empty this will return
-*         a pair containing null and zero.
+/*! \brief Set the first empty slot for a hash to point at an entry.
+* \param aHash The hash of the entry's key.
+* \param aPosition The position of the entry.
 */
 template<class Key, class Value>
-typename HashMap<Key, Value>::CItemPair
-HashMap<Key, Value>::getFirstItem() const {
-    // Check for empty hashmap first to avoid a slow unsuccessful search.
-    if( empty() ){
-        return CItemPair( static_cast<Item*>( 0 ), 0 );
-    }
-
-    // Search starting at the beginning of the bucket vector to find the first
-    // item.
-    for( unsigned int i = 0; i < mBuckets.size(); i++ ){
-        if( mBuckets[ i ] ){
-            return CItemPair( mBuckets[ i ].get() , i );
-        }
+void HashMap<Key, Value>::insertSlot( const size_t aHash, const size_t aPosition ){
+    size_t i = aHash & mMask;
+    while( mSlots[ i ].mPosition != 0 ){
+        i = ( i + 1 ) & mMask;
     }
-
-    /*! \post An item must have been found because this function initially
-    *         checks for an empty list. 
-    */
-    assert( false );
-    
-    // Make the compiler happy.
-    return CItemPair( static_cast<Item*>( 0 ), 0 );
+    mSlots[ i ].mHash = aHash;
+    mSlots[ i ].mPosition = aPosition + 1;
 }
 
-/*! \brief Return the next item in the hashmap.
-* \details This function is used by the iterator to find the next value in the
-*          hashmap.
-* \param aItemPair A pair containing the current item and its bucket position.
-* \return A pair containing the next item and its bucket position or the end
-*         iterator if it was the last item.
+/*! \brief Resize the table. 
+* \details Since the slots store the hash of the key, the table can be rebuilt
+*          from the existing slots without rehashing any keys. The entries
+*          themselves do not move.
+* \param aNewSize New size of the table, which must be a power of two.
 */
 template<class Key, class Value>
-typename HashMap<Key, Value>::CItemPair
-HashMap<Key, Value>::getNextItem( const CItemPair& aItemPair ) const {
-    // First check if there is a next item in the current item's chain.
-    if( aItemPair.first->mNext ){
-        // Return a pair containing the next item and the current bucket spot
-        // since the item is in the same chain.
-        return CItemPair( aItemPair.first->mNext.get(), aItemPair.second );
-    }
+void HashMap<Key, Value>::resize( const size_t aNewSize ){
+    /*! \pre The new size must be a power of two. */
+    assert( ( aNewSize & ( aNewSize - 1 ) ) == 0 );
 
-    // Otherwise search forward in the bucket vector starting at the current position.
-    for( size_t i = aItemPair.second + 1; i < mBuckets.size(); ++i ){
-        // If there is an item at this bucket position return it.
-        if( mBuckets[ i ] ){
-            return CItemPair( mBuckets[ i ].get(), i );
-        }
-    }
+    mSlots.assign( aNewSize, Slot() );
+    mMask = aNewSize - 1;
 
-    // The end of the bucket vector was reached so there is not a next item.
-    return CItemPair( static_cast<Item*>( 0 ), 0 );
+    // Rebuild the table from the entries as the position of each entry is
+    // needed anyway.
+    for( size_t i = 0; i < mEntries.size(); ++i ){
+        insertSlot( hashKey( mEntries[ i ].first ), i );
+    }
 }
 
-/*! \brief Find the first item in the hashmap.
-* \details This function is used to initialize the begin iterator. It returns a
-*          pair containing a pointer to the first item and the position of the
-*          item in the bucket vector.
-* \return A pair containing a pointer to the first item and its position in the
-*         bucket vector. If the vector is empty this will return a pair
-*         containing null and zero.
+/*! \brief Hash a string key.
+* \details Strings and string views must hash identically so that either can be
+*          used for lookups.
 */
 template<class Key, class Value>
-typename HashMap<Key, Value>::ItemPair HashMap<Key, Value>::getFirstItem() {
-    // Check for empty hashmap first to avoid a slow unsuccessful search.
-    if( empty() ){
-        return ItemPair( static_cast<Item*>( 0 ), 0 );
-    }
-
-    // Search starting at the beginning of the bucket vector to find the first
-    // item.
-    for( unsigned int i = 0; i < mBuckets.size(); i++ ){
-        if( mBuckets[ i ] ){
-            return ItemPair( mBuckets[ i ].get(), i );
-        }
-    }
-
-    /*! \post An item must have been found because this function initially
-    *         checks for an empty list. 
-    */
-    assert( false );
-    
-    // Make the compiler happy.
-    return ItemPair( static_cast<Item*>( 0 ), 0 );
+size_t HashMap<Key, Value>::hashKey( const std::string& aKey ){
+    return boost::hash_range( aKey.begin(), aKey.end() );
 }
 
-/*! \brief Return the next item in the hashmap.
-* \details This function is used by the iterator to find the next value in the
-*          hashmap.
-* \param aItemPair A pair containing the current item and its bucket position.
-* \return A pair containing the next item and its bucket position or the end
-*         iterator if it was the last item.
+/*! \brief Hash a string view key.
 */
 template<class Key, class Value>
-typename HashMap<Key, Value>::ItemPair
-HashMap<Key, Value>::getNextItem( const ItemPair& aItemPair ) {
-    // First check if there is a next item in the current item's chain.
-    if( aItemPair.first->mNext ){
-        // Return a pair containing the next item and the current bucket spot
-        // since the item is in the same chain.
-        return ItemPair( aItemPair.first->mNext, aItemPair.second );
-    }
-
-    // Otherwise search forward in the bucket vector starting at the current position.
-    for( size_t i = aItemPair.second + 1; i < mBuckets.size(); ++i ){
-        // If there is an item at this bucket position return it.
-        if( mBuckets[ i ] ){
-            return ItemPair( mBuckets[ i ], i );
-        }
-    }
+size_t HashMap<Key, Value>::hashKey( const boost::string_view& aKey ){
+    return boost::hash_range( aKey.begin(), aKey.end() );
+}
 
-    // The end of the bucket vector was reached so there is not a next item.
-    return end();
+/*! \brief Hash any other type of key.
+*/
+template<class Key, class Value>
+template<class OtherKey>
+size_t HashMap<Key, Value>::hashKey( const OtherKey& aKey ){
+    return boost::hash<OtherKey>()( aKey );
 }
 
-// ItemPair getNextItem( const ItemPair& aItemPair );
-/*! \brief Item structure constructor.
-* \param aKey The key.
-* \param aValue The value.
+#if HASH_MAP_TRACE
+/*! \brief Record an operation on the map to the trace file.
+* \details Each line contains the address of the map, the operation which is i
+*          for insert or f for find, and the key.
 */
 template<class Key, class Value>
-HashMap<Key, Value>::Item::Item( const std::pair<Key, Value>& aKeyValuePair ):
-mKeyValuePair( aKeyValuePair ){
+template<class LookupKey>
+void HashMap<Key, Value>::trace( const char aOperation, const LookupKey& aKey ) const {
+    std::mutex* traceMutex;
+    std::ofstream& traceFile = getHashMapTrace( traceMutex );
+    std::lock_guard<std::mutex> lock( *traceMutex );
+    traceFile << static_cast<const void*>( this ) << ' ' << aOperation << ' ' << aKey << '\n';
 }
+#endif
 
 /*! \brief iterator constructor which sets the internal pointer to null.
 */
@@ -726,15 +574,13 @@ template<class Key, class Value>
 HashMap<Key, Value>::iterator::iterator(){}
 
 /*! \brief iterator constructor.
-* \param aCurrentItem The current Item.
-* \param aBucketPosition The position of the Item in the bucket vector.
+* \param aPosition The position of the current key-value pair.
 * \param aParent A pointer to the parent hashmap.
 */
 template<class Key, class Value>
-HashMap<Key, Value>::iterator::iterator( Item* aCurrentItem,
-                                         const size_t aBucketPosition,
+HashMap<Key, Value>::iterator::iterator( const size_t aPosition,
                                          const HashMap* aParent ):
-const_iterator( aCurrentItem, aBucketPosition, aParent ){
+const_iterator( aPosition, aParent ){
 }
 
 /*! \brief Equals operator
@@ -760,12 +606,7 @@ bool HashMap<Key, Value>::iterator::operator !=( const typename HashMap<Key, Val
 */
 template<class Key, class Value>
 std::pair<Key, Value>* HashMap<Key, Value>::iterator::operator->(){
-	/*! \pre The current item pointer must be non-null. */
-	assert( const_iterator::mCurrentItem.first != 0 );
-
-    // The mCurrentItem is inherited from const_iterator and must be cast so
-    // that the return value is mutable.
-	return const_cast<std::pair<Key, Value>*>( &const_iterator::mCurrentItem.first->mKeyValuePair );
+	return const_cast<std::pair<Key, Value>*>( const_iterator::operator->() );
 }
 
 /*! \brief Dereference operator
@@ -773,12 +614,7 @@ std::pair<Key, Value>* HashMap<Key, Value>::iterator::operator->(){
 */
 template<class Key, class Value>
 std::pair<Key, Value>& HashMap<Key, Value>::iterator::operator*() {
-	/*! \pre The current item pointer must be non-null. */
-	assert( const_iterator::mCurrentItem.first != 0 );
-
-    // The mCurrentItem is inherited from const_iterator and must be cast so
-    // that the return value is mutable.
-	return const_cast<std::pair<Key, Value>&>( const_iterator::mCurrentItem.first->mKeyValuePair );
+	return const_cast<std::pair<Key, Value>&>( const_iterator::operator*() );
 }
 
 /*! \brief Prefix increment operator.
@@ -787,10 +623,7 @@ std::pair<Key, Value>& HashMap<Key, Value>::iterator::operator*() {
 template<class Key, class Value>
 typename HashMap<Key, Value>::iterator&
 HashMap<Key, Value>::iterator::operator++(){
-    /*! \pre Need a non-null parent hashmap. */
-    assert( const_iterator::mParent );
-
-    const_iterator::mCurrentItem = const_iterator::mParent->getNextItem( const_iterator::mCurrentItem );
+    const_iterator::operator++();
     return *this;
 }
 
@@ -809,19 +642,17 @@ HashMap<Key, Value>::iterator::operator++ (int){
 */
 template<class Key, class Value>
 HashMap<Key, Value>::const_iterator::const_iterator():
-mCurrentItem( 0, 0 ),
+mPosition( 0 ),
 mParent( 0 ){}
 
 /*! \brief const_iterator constructor.
-* \param aCurrentItem The current Item.
-* \param aBucketPosition The position of the current Item within the bucket
-*        vector.
+* \param aPosition The position of the current key-value pair.
+* \param aParent A pointer to the parent hashmap.
 */
 template<class Key, class Value>
-HashMap<Key, Value>::const_iterator::const_iterator( const Item* aCurrentItem,
-                                                     const size_t aBucketPosition,
+HashMap<Key, Value>::const_iterator::const_iterator( const size_t aPosition,
                                                      const HashMap* aParent )
-:mCurrentItem( aCurrentItem, aBucketPosition ),
+:mPosition( aPosition ),
 mParent( aParent ){
 }
 
@@ -831,7 +662,7 @@ mParent( aParent ){
 */
 template<class Key, class Value>
 bool HashMap<Key, Value>::const_iterator::operator ==( const typename HashMap<Key, Value>::const_iterator& aOther ) const {
-	return ( mCurrentItem == aOther.mCurrentItem );
+	return mPosition == aOther.mPosition && mParent == aOther.mParent;
 }
 
 /*! \brief Not-equals operator
@@ -848,9 +679,9 @@ bool HashMap<Key, Value>::const_iterator::operator !=( const typename HashMap<Ke
 */
 template<class Key, class Value>
 const std::pair<Key, Value>* HashMap<Key, Value>::const_iterator::operator->() const {
-	/*! \pre The current item pointer must be non-null. */
-	assert( mCurrentItem.first != 0 );
-	return &mCurrentItem.first->mKeyValuePair;
+	/*! \pre The iterator must point at an entry. */
+	assert( mParent && mPosition < mParent->mEntries.size() );
+	return &mParent->mEntries[ mPosition ];
 }
 
 /*! \brief Prefix increment operator.
@@ -862,7 +693,7 @@ HashMap<Key, Value>::const_iterator::operator++(){
     /*! \pre Need a non-null parent hashmap. */
     assert( mParent );
 
-    mCurrentItem = mParent->getNextItem( mCurrentItem );
+    ++mPosition;
     return *this;
 }
 
@@ -882,9 +713,9 @@ HashMap<Key, Value>::const_iterator::operator++ (int){
 */
 template<class Key, class Value>
 const std::pair<Key, Value>& HashMap<Key, Value>::const_iterator::operator*() const {
-	/*! \pre The current item pointer must be non-null. */
-	assert( mCurrentItem.first != 0 );
-	return mCurrentItem.first->mKeyValuePair;
+	/*! \pre The iterator must point at an entry. */
+	assert( mParent && mPosition < mParent->mEntries.size() );
+	return mParent->mEntries[ mPosition ];
 }
 
 #endif // _HASH_MAP_H_
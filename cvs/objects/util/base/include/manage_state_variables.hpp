@@ -46,6 +46,7 @@
 #include <cassert>
 #include <forward_list>
 #include <string>
+#include <vector>
 #include "util/base/include/definitions.h"
 
 class Value;
@@ -78,6 +79,14 @@ public:
     
     void setPartialDeriv( const bool aIsPartialDeriv );
     
+    void copyCurrentState( std::vector<double>& aState ) const;
+    
+    void setBaseState( const std::vector<double>& aState );
+    
+    const Value* getStateValue( const size_t aIndex ) const;
+    
+    size_t getStateDataBytes() const;
+    
 #if GCAM_PARALLEL_ENABLED
     //! A tbb task arena which is the closest tbb comes to a thread pool which we
     //! will insist parallel calculations use so that we can ensure that we have
@@ -0,0 +1,147 @@
+#ifndef _MEMORY_PROFILER_H_
+#define _MEMORY_PROFILER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file memory_profiler.h
+ * \ingroup util
+ * \brief MemoryProfiler class header file.
+ */
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+class Scenario;
+
+/*!
+ * \ingroup util
+ * \brief Records the memory used by the process at the boundaries between the
+ *        phases of a model run.
+ * \details At each phase boundary the current and peak resident set size are
+ *          recorded.  When GCAM_ALLOCATION_PROFILING is enabled every heap
+ *          allocation is also counted, and the number of allocations and frees,
+ *          the bytes allocated, the live heap bytes and the high-water mark of
+ *          the live heap within the phase are recorded as well.  The phases
+ *          marked by the model are:
+ *          - parse: reading the XML inputs.
+ *          - complete-init: Scenario::completeInit.
+ *          - init-calc: Scenario::initPeriod for each period, which includes
+ *            allocating the state data.  The size of the state data is
+ *            recorded for this phase under the component state-data.
+ *          - solve: solving each period.
+ *          - post-calc: World::postCalc for each period.
+ *          - climate: running the climate model for each period.  If the
+ *            climate model is run in the background its memory is attributed
+ *            to whichever phase is in progress when it finishes.
+ *          - output: writing the XML database.
+ *          Work done between these, such as model feedbacks and debug output
+ *          after a period, is attributed to the next phase.
+ *
+ *          A breakdown by object type from MemoryReport may also be added,
+ *          which the model does after completeInit and once all periods have
+ *          been run.
+ *
+ *          Profiling is turned on by configuring the memoryProfileFileName
+ *          output file to which the records are written as CSV in long form
+ *          with the columns scenario, phase, period, component, metric and
+ *          value.  The component is "process" for the resident set size,
+ *          "heap" for the allocation counts, "state-data" for the state data
+ *          and the object type name for the object breakdown.
+ */
+class MemoryProfiler : private boost::noncopyable {
+public:
+    //! The allocation counts of the process since it started.
+    struct HeapCounters {
+        //! The number of allocations.
+        long long mAllocations;
+        //! The number of frees.
+        long long mFrees;
+        //! The total bytes allocated.
+        long long mAllocatedBytes;
+        //! The bytes currently allocated.
+        long long mLiveBytes;
+        //! The largest number of bytes allocated at once since the last reset.
+        long long mPeakLiveBytes;
+    };
+
+    static MemoryProfiler& getInstance();
+
+    bool isEnabled() const;
+    void markPhase( const std::string& aPhase, const int aPeriod = -1 );
+    void addStateData( const int aPeriod, const size_t aBytes );
+    void addObjectTypes( const std::string& aPhase, Scenario* aScenario );
+    void write( std::ostream& aOut, const std::string& aScenarioName );
+
+    static bool getHeapCounters( HeapCounters& aCounters );
+
+private:
+    //! A single value in the profile.
+    struct Record {
+        //! The phase the value was recorded at.
+        std::string mPhase;
+        //! The model period or -1 if the phase is not for a period.
+        int mPeriod;
+        //! The part of the process the value is for.
+        std::string mComponent;
+        //! The name of the value.
+        std::string mMetric;
+        //! The value.
+        double mValue;
+    };
+
+    //! Whether profiling was configured.
+    const bool mIsEnabled;
+
+    //! All values recorded since the profile was last written.
+    std::vector<Record> mRecords;
+
+    //! The heap counters at the previous phase boundary.
+    HeapCounters mPrevCounters;
+
+    MemoryProfiler();
+
+    static void resetPeakLiveBytes();
+
+    void addRecord( const std::string& aPhase, const int aPeriod, const std::string& aComponent,
+                    const std::string& aMetric, const double aValue );
+};
+
+#endif // _MEMORY_PROFILER_H_
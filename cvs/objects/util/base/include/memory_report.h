@@ -0,0 +1,121 @@
+#ifndef _MEMORY_REPORT_H_
+#define _MEMORY_REPORT_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file memory_report.h
+ * \ingroup util
+ * \brief MemoryReport class header file.
+ */
+
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class Scenario;
+
+/*!
+ * \ingroup util
+ * \brief Tallies the approximate memory used by the model, broken down by the
+ *        type of the object which holds it.
+ * \details GCAMFusion is used to walk every Data member of every CONTAINER
+ *          starting from the Scenario.  The size of each member, including any
+ *          heap storage for strings, vectors, maps and time vectors, is
+ *          attributed to the dynamic type of the innermost containing object.
+ *          Objects which are reached more than once, such as parameters shared
+ *          between technology vintages, are only counted the first time and
+ *          are otherwise tallied as shared references.
+ *
+ *          The sizes are estimates: padding, vtables and allocator overhead
+ *          are not included and members which are not declared via
+ *          DEFINE_DATA are not seen.  They are however consistent between runs
+ *          so may be used to compare changes in the data layout.
+ */
+class MemoryReport {
+public:
+    //! The usage tallied for a single object type.
+    struct TypeUsage {
+        TypeUsage():mCount( 0 ), mSharedRefs( 0 ), mBytes( 0 ) {}
+        //! The number of distinct objects of this type.
+        size_t mCount;
+        //! The number of additional references to objects already counted.
+        size_t mSharedRefs;
+        //! The approximate bytes held directly by objects of this type.
+        size_t mBytes;
+    };
+
+    MemoryReport();
+
+    void collect( Scenario* aScenario );
+    void print( std::ostream& aOut ) const;
+    size_t getTotalBytes() const;
+    const std::map<std::string, TypeUsage>& getUsageByType() const;
+
+    // GCAMFusion callbacks
+    template<typename DataType>
+    void processData( DataType& aData );
+    template<typename DataType>
+    void pushFilterStep( const DataType& aData );
+    template<typename DataType>
+    void pushFilterStep( DataType* const& aData );
+    template<typename DataType>
+    void popFilterStep( const DataType& aData );
+
+private:
+    //! Usage by demangled type name.
+    std::map<std::string, TypeUsage> mUsageByType;
+
+    //! The type names of the containers we are currently in, innermost last.
+    std::vector<std::string> mTypeStack;
+
+    //! For each container we are in whether it had already been visited.
+    std::vector<bool> mIsSharedStack;
+
+    //! The number of already visited containers we are currently in.
+    int mSharedDepth;
+
+    //! The addresses of all containers visited so far.
+    std::set<const void*> mVisited;
+
+    void addBytes( const size_t aBytes );
+};
+
+#endif // _MEMORY_REPORT_H_
@@ -0,0 +1,129 @@
+#ifndef _PARALLEL_CONSISTENCY_CHECKER_H_
+#define _PARALLEL_CONSISTENCY_CHECKER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file parallel_consistency_checker.h
+ * \ingroup util
+ * \brief ParallelConsistencyChecker class header file.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <boost/core/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+
+class Value;
+
+/*!
+ * \ingroup util
+ * \brief Verifies at run time that parallel model calculations reproduce the
+ *        results of the serial calculations.
+ * \details When check-parallel-consistency is set, the scenario creates one of
+ *          these for each period it solves.  It is consulted at the following
+ *          sample points:
+ *            - The initial World::calc of the period.
+ *            - Every Nth Jacobian column calculated with partial derivatives,
+ *              where N is parallel-check-jacobian-interval (zero to skip).
+ *            - The final solution of the period.
+ *
+ *          For the full calculations the model is calculated using the serial
+ *          World::calc and, starting from the same state, with the flow graph.
+ *          For Jacobian columns the state left by each sampled column calculated
+ *          in parallel with the others is saved and the column is then
+ *          recalculated alone on the calling thread.  In both cases every
+ *          active STATE value is compared using parallel-check-tolerance ULPs
+ *          (DBL_CMP_LOOSE by default).  Any difference is logged to the main log
+ *          along with the location of the first few differing values in the
+ *          model, which identifies the region, sector and technology being
+ *          calculated and the name of the variable.  When a full calculation
+ *          differs the serial calculation is repeated one activity at a time to
+ *          also report the first activity in the calculation order which
+ *          wrote a differing value.
+ *
+ *          This is only available with GCAM_PARALLEL_ENABLED.  Saving the state
+ *          of Jacobian columns takes a copy of the entire model state for each
+ *          one so the interval should be large relative to the number of
+ *          markets.
+ */
+class ParallelConsistencyChecker : private boost::noncopyable {
+public:
+    ParallelConsistencyChecker( const int aPeriod );
+
+    static bool isEnabled();
+
+    bool checkFullCalc( const std::string& aSamplePoint );
+
+    void sampleJacobianColumns( const std::vector<int>& aColumns );
+    void saveColumnState( const int aColumn );
+    bool checkJacobianColumns( const std::function<void( const int )>& aCalcColumn );
+
+private:
+    //! The model period being checked.
+    const int mPeriod;
+
+    //! Check every Nth Jacobian column, zero to not check any.
+    const int mJacobianInterval;
+
+    //! The number of ULPs by which values may differ.
+    const boost::int64_t mTolerance;
+
+    //! The number of Jacobian columns seen so far in this period.
+    int mNumColumns;
+
+    //! The state left by each sampled Jacobian column calculated in parallel,
+    //! the entries are created before the parallel calculation starts so that
+    //! each may be filled in from a different thread.
+    std::map<int, std::vector<double> > mColumnStates;
+
+    bool compareStates( const std::string& aSamplePoint, const std::vector<double>& aSerialState,
+                        const std::vector<double>& aParallelState ) const;
+
+    bool isDiffering( const double aSerial, const double aParallel ) const;
+
+    void reportFirstDivergingActivity( const std::vector<double>& aInitialState,
+                                       const std::vector<double>& aSerialState,
+                                       const std::vector<double>& aParallelState ) const;
+
+    static std::map<const Value*, std::string> findValueNames( const std::vector<const Value*>& aValues );
+};
+
+#endif // _PARALLEL_CONSISTENCY_CHECKER_H_
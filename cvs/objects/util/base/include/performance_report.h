@@ -0,0 +1,137 @@
+#ifndef _PERFORMANCE_REPORT_H_
+#define _PERFORMANCE_REPORT_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file performance_report.h
+ * \ingroup util
+ * \brief PerformanceReport class header file.
+ */
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "util/base/include/timer.h"
+
+class CalcCounter;
+class World;
+
+/*!
+ * \ingroup util
+ * \brief Collects timings and solver counts for each model period so that they
+ *        may be written out in a machine readable format.
+ * \details For each period the wall clock and process CPU time, the time spent
+ *          in the predefined timers which are relevant to performance, the
+ *          peak memory usage and the totals from the CalcCounter are recorded.
+ *          Each solver component which ran in the period is also given its own
+ *          wall and CPU time, evaluation, iteration, Jacobian and line search
+ *          step counts.  Totals for the whole run are added by endRun.
+ *
+ *          The report is written as CSV in long form with the columns
+ *          scenario, period, year, component, metric and value so that metrics
+ *          may be added without changing the layout.  The component is
+ *          "period" for period totals, the solver component name for solver
+ *          components and "run" for run totals which have no period or year.
+ *
+ *          Time in the predefined timers is attributed to the period in which
+ *          it is stopped, except for the climate model time which is taken
+ *          from the World for the period the climate model was run through.
+ *          As the climate model may still be running in the background when
+ *          a period ends these values are added by endRun.  Run totals are the
+ *          differences from when the report was created, so that each run of
+ *          a scenario is reported separately.
+ */
+class PerformanceReport {
+public:
+    PerformanceReport();
+
+    void startPeriod();
+    void endPeriod( const int aPeriod, const int aYear, const CalcCounter* aCalcCounter );
+    void endRun( const World* aWorld );
+    void write( std::ostream& aOut, const std::string& aScenarioName ) const;
+
+private:
+    //! A single value in the report.
+    struct Record {
+        //! The model period or -1 for run totals.
+        int mPeriod;
+        //! The model year or -1 for run totals.
+        int mYear;
+        //! The part of the model the value is for.
+        std::string mComponent;
+        //! The name of the value.
+        std::string mMetric;
+        //! The value.
+        double mValue;
+    };
+
+    //! All values recorded so far in the order they were recorded.
+    std::vector<Record> mRecords;
+
+    //! Measures the wall clock time of each period.
+    Timer mPeriodTimer;
+
+    //! The total time on the period timer at the start of the current period.
+    double mPeriodStartWallTime;
+
+    //! The process CPU time at the start of the current period.
+    double mPeriodStartCPUTime;
+
+    //! The predefined timer totals at the start of the current period.
+    std::vector<double> mPeriodStartTimes;
+
+    //! Measures the wall clock time of the run.
+    Timer mRunTimer;
+
+    //! The process CPU time when the report was created.
+    double mRunStartCPUTime;
+
+    //! The predefined timer totals when the report was created.
+    std::vector<double> mRunStartTimes;
+
+    //! The years of the periods which have been recorded by period.
+    std::vector<std::pair<int, int> > mPeriodYears;
+
+    void addRecord( const int aPeriod, const int aYear, const std::string& aComponent,
+                    const std::string& aMetric, const double aValue );
+};
+
+#endif // _PERFORMANCE_REPORT_H_
@@ -68,6 +68,7 @@ public:
     Timer();        
     void start();
     void stop();
+    void addTime( const double aTime );
     double getTotalTimeDifference() const;
     void print( std::ostream& aOut, const std::string& aTitle = "Time: " ) const;
 private:
@@ -113,6 +114,7 @@ public:
         EDFUN_POST,
         EDFUN_AN_RESET,
         WRITE_DATA,
+        CLIMATE_MODEL,
         END
     };
     
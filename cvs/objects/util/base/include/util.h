@@ -613,6 +613,10 @@ namespace objects {
    void printTime( const time_t& aTime, std::ostream& aOut );
 
    int getConfigRunPeriod( const std::string aKey );
+
+   double getProcessCPUTime();
+   double getPeakMemoryUsage();
+   double getCurrentMemoryUsage();
    
 } // End util namespace.
 
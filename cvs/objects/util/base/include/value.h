@@ -70,6 +70,7 @@
 
 class Value {
     friend class ManageStateVariables;
+    friend class Checkpoint;
     /*!
      * \brief Output stream operator to print a Value.
      * \details Output stream operators allow classes to be printed using the <<
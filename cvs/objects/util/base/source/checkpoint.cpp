@@ -0,0 +1,906 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file checkpoint.cpp
+ * \ingroup util
+ * \brief Checkpoint class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <typeinfo>
+#include <algorithm>
+#include <iterator>
+#include <boost/functional/hash.hpp>
+
+#include "util/base/include/checkpoint.h"
+#include "util/base/include/value.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/model_time.h"
+#include "util/logger/include/ilogger.h"
+#include "containers/include/scenario.h"
+#include "containers/include/iinfo.h"
+#include "marketplace/include/market.h"
+#include "technologies/include/itechnology.h"
+#include "solution/solvers/include/solver_component.h"
+#include "solution/solvers/include/logbroyden.hpp"
+#include "util/base/include/gcam_fusion.hpp"
+#include "util/base/include/gcam_data_containers.h"
+
+using namespace std;
+
+namespace {
+    //! Identifies a checkpoint file.
+    const string CHECKPOINT_MAGIC = "GCAM-CHECKPOINT";
+
+    //! The version of the encoding, to be incremented if it changes.
+    const boost::uint32_t CHECKPOINT_VERSION = 2;
+
+    /*!
+     * \brief Type trait to determine if a type of Data is written to a
+     *        checkpoint.
+     * \details Numeric types and Values are written as are any vectors, time
+     *          vectors or maps of them.  Anything else such as strings and
+     *          pointers is assumed to be set up from the input files.
+     */
+    template<typename T>
+    struct IsCheckpointed : public std::is_arithmetic<T> {};
+
+    template<>
+    struct IsCheckpointed<Value> : public std::true_type {};
+
+    template<typename T>
+    struct IsCheckpointed<std::vector<T> > : public IsCheckpointed<T> {};
+
+    template<typename T>
+    struct IsCheckpointed<objects::PeriodVector<T> > : public IsCheckpointed<T> {};
+
+    template<typename T>
+    struct IsCheckpointed<objects::YearVector<T> > : public IsCheckpointed<T> {};
+
+    template<typename T>
+    struct IsCheckpointed<objects::TechVintageVector<T> > : public IsCheckpointed<T> {};
+
+    template<typename K, typename V>
+    struct IsCheckpointed<std::map<K, V> > : public std::integral_constant<bool,
+        ( std::is_arithmetic<K>::value || std::is_same<K, std::string>::value ) && IsCheckpointed<V>::value> {};
+
+    //! Generate a tag to identify a type in the checkpoint file.
+    boost::uint32_t getTypeTag( const type_info& aType ) {
+        return static_cast<boost::uint32_t>( boost::hash<string>()( aType.name() ) );
+    }
+
+    // Overloads to read and write map keys.
+    template<typename K>
+    void writeKey( ostream& aOut, const K& aKey ) {
+        Checkpoint::writeRaw( aOut, aKey );
+    }
+
+    void writeKey( ostream& aOut, const string& aKey ) {
+        Checkpoint::writeString( aOut, aKey );
+    }
+
+    template<typename K>
+    void readKey( istream& aIn, K& aKey ) {
+        Checkpoint::readRaw( aIn, aKey );
+    }
+
+    void readKey( istream& aIn, string& aKey ) {
+        Checkpoint::readString( aIn, aKey );
+    }
+
+    /*!
+     * \brief A stream buffer which calculates a 64 bit FNV-1a hash of all of
+     *        the bytes written to it rather than storing them.
+     */
+    class HashStreamBuf : public streambuf {
+    public:
+        HashStreamBuf():mHash( 14695981039346656037ULL ) {}
+
+        boost::uint64_t getHash() const {
+            return mHash;
+        }
+
+    protected:
+        virtual int_type overflow( int_type aChar ) {
+            if( !traits_type::eq_int_type( aChar, traits_type::eof() ) ) {
+                add( traits_type::to_char_type( aChar ) );
+            }
+            return traits_type::not_eof( aChar );
+        }
+
+        virtual streamsize xsputn( const char* aData, streamsize aSize ) {
+            for( streamsize i = 0; i < aSize; ++i ) {
+                add( aData[ i ] );
+            }
+            return aSize;
+        }
+
+    private:
+        boost::uint64_t mHash;
+
+        void add( const char aChar ) {
+            mHash ^= static_cast<unsigned char>( aChar );
+            mHash *= 1099511628211ULL;
+        }
+    };
+}
+
+/*!
+ * \brief Constructor.
+ * \param aFileName The file to save to or load from.
+ * \param aKey The name to identify the checkpoint in the file header in place
+ *        of the scenario name, used when the checkpoint may be shared between
+ *        scenarios.
+ */
+Checkpoint::Checkpoint( const string& aFileName, const string& aKey ):
+mFileName( aFileName ),
+mKey( aKey ),
+mLastRestoredPeriod( numeric_limits<int>::max() ),
+mLastRestoredYear( numeric_limits<int>::max() ),
+mSkipDepth( 0 ),
+mMode( eSave ),
+mOut( 0 ),
+mIn( 0 ),
+mIsValid( true )
+{
+}
+
+/*!
+ * \brief Get the checkpoint file name as set in the configuration.
+ * \details Follows the <Files> convention and will append the scenario name if
+ *          configured to do so.
+ * \param aScenarioName The name of the scenario.
+ * \return The checkpoint file name.
+ */
+string Checkpoint::getConfiguredFileName( const string& aScenarioName ) {
+    Configuration* conf = Configuration::getInstance();
+    const string fileName = conf->getFile( "checkpoint", "checkpoint/checkpoint", false );
+    const string scnAppend = conf->shouldAppendScnToFile( "checkpoint" ) ? "." + aScenarioName : "";
+    return fileName + scnAppend;
+}
+
+/*!
+ * \brief Get the name of a calibration cache entry.
+ * \details Entries are kept in the directory set by the calibration-cache file
+ *          in the configuration, which must exist.
+ * \param aKey The key for the entry as calculated by calcContentHash.
+ * \return The calibration cache file name.
+ */
+string Checkpoint::getCalibrationCacheFileName( const string& aKey ) {
+    Configuration* conf = Configuration::getInstance();
+    return conf->getFile( "calibration-cache", "calibration-cache", false ) + "/" + aKey;
+}
+
+/*!
+ * \brief Calculate a key from the content of the model which will be the same
+ *        for any model that would give the same results through the given
+ *        period.
+ * \details All data is included as it would be written to a checkpoint, along
+ *          with strings, except for period vectors, markets and technologies
+ *          for later periods.  This must be called before any period has been
+ *          initialized so that the data is as read from the input files.
+ * \param aScenario The scenario to calculate the key for.
+ * \param aLastPeriod The last period whose data is included.
+ * \return The key as a hexadecimal string.
+ */
+string Checkpoint::calcContentHash( Scenario* aScenario, const int aLastPeriod ) {
+    HashStreamBuf hashBuffer;
+    ostream hashStream( &hashBuffer );
+    writeRaw( hashStream, CHECKPOINT_VERSION );
+    writeRaw( hashStream, static_cast<boost::int32_t>( aScenario->getModeltime()->getmaxper() ) );
+    writeRaw( hashStream, static_cast<boost::int32_t>( aLastPeriod ) );
+    // Calibration changes how the periods are solved.
+    writeRaw( hashStream, Configuration::getInstance()->getBool( "CalibrationActive" ) );
+
+    Checkpoint hasher( "" );
+    hasher.setLastRestoredPeriod( aLastPeriod );
+    hasher.mMode = eHash;
+    hasher.mOut = &hashStream;
+    hasher.walk( aScenario );
+    hasher.mOut = 0;
+
+    stringstream key;
+    key << hex << setfill( '0' ) << setw( 16 ) << hashBuffer.getHash();
+    return key.str();
+}
+
+/*!
+ * \brief Limit loading to data for periods up to and including the given
+ *        period.
+ * \details Later period elements of period and year vectors as well as
+ *          markets and technologies for later periods are still checked against
+ *          the model but their data is left unchanged.
+ * \param aLastPeriod The last period to restore.
+ */
+void Checkpoint::setLastRestoredPeriod( const int aLastPeriod ) {
+    mLastRestoredPeriod = aLastPeriod;
+}
+
+/*!
+ * \brief Write the complete model state to the checkpoint file.
+ * \details The data is first written to a temporary file which then replaces
+ *          the checkpoint file so that an interrupted save does not destroy the
+ *          previous checkpoint.
+ * \param aScenario The scenario to save.
+ * \param aLastPeriod The last period which has been completed.
+ * \return Whether the checkpoint was written successfully.
+ */
+bool Checkpoint::save( Scenario* aScenario, const int aLastPeriod ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::DEBUG );
+    mainLog << "Writing checkpoint file: " << mFileName << "... ";
+
+    // Several runs may write the same shared checkpoint at once so give each
+    // its own temporary file.
+    const string tempFileName = mFileName + ( mKey.empty() ? "" : "." + aScenario->getName() ) + ".tmp";
+    {
+        ofstream checkpointFile( tempFileName.c_str(), ios_base::out | ios_base::trunc | ios_base::binary );
+        if( !checkpointFile.is_open() ) {
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Could not open checkpoint file: " << tempFileName << " for write." << endl;
+            return false;
+        }
+
+        write( aScenario, aLastPeriod, checkpointFile );
+        checkpointFile.close();
+        if( !checkpointFile ) {
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Failed writing checkpoint file: " << tempFileName << endl;
+            return false;
+        }
+    }
+
+    // Replace the previous checkpoint.  Not all platforms allow rename to
+    // replace an existing file so remove it and try again if needed.
+    if( rename( tempFileName.c_str(), mFileName.c_str() ) != 0 ) {
+        remove( mFileName.c_str() );
+        if( rename( tempFileName.c_str(), mFileName.c_str() ) != 0 ) {
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Could not move " << tempFileName << " to checkpoint file: " << mFileName << endl;
+            return false;
+        }
+    }
+
+    mainLog << "Done." << endl;
+    return true;
+}
+
+/*!
+ * \brief Write the header and all of the checkpointed data.
+ * \param aScenario The scenario to save.
+ * \param aLastPeriod The last period which has been completed.
+ * \param aOut The stream to write to.
+ */
+void Checkpoint::write( Scenario* aScenario, const int aLastPeriod, ostream& aOut ) {
+    writeString( aOut, CHECKPOINT_MAGIC );
+    writeRaw( aOut, CHECKPOINT_VERSION );
+    writeString( aOut, getHeaderName( aScenario ) );
+    writeRaw( aOut, static_cast<boost::int32_t>( aScenario->getModeltime()->getmaxper() ) );
+    writeRaw( aOut, static_cast<boost::int32_t>( aLastPeriod ) );
+
+    mMode = eSave;
+    mOut = &aOut;
+    walk( aScenario );
+    transferSolverState();
+    mOut = 0;
+}
+
+/*!
+ * \brief Get the name which identifies what the checkpoint was written for.
+ * \param aScenario The scenario being saved or loaded.
+ * \return The key if one was given, otherwise the scenario name.
+ */
+const string& Checkpoint::getHeaderName( const Scenario* aScenario ) const {
+    return mKey.empty() ? aScenario->getName() : mKey;
+}
+
+/*!
+ * \brief Read the header of the checkpoint file and check that it was written
+ *        for the given scenario.
+ * \param aScenario The scenario to be loaded into.
+ * \param aIn The stream to read from.
+ * \return The last period which had been completed when the checkpoint was
+ *         written or -1 if the header does not match.
+ */
+int Checkpoint::readHeader( const Scenario* aScenario, istream& aIn ) {
+    string magic;
+    boost::uint32_t version = 0;
+    string scenarioName;
+    boost::int32_t maxPeriod = 0;
+    boost::int32_t lastPeriod = -1;
+    readString( aIn, magic );
+    readRaw( aIn, version );
+    readString( aIn, scenarioName );
+    readRaw( aIn, maxPeriod );
+    readRaw( aIn, lastPeriod );
+    if( !aIn || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION ) {
+        fail( "not a checkpoint file or an unsupported version" );
+        return -1;
+    }
+    if( scenarioName != getHeaderName( aScenario ) || maxPeriod != aScenario->getModeltime()->getmaxper() ) {
+        fail( "written for " + scenarioName );
+        return -1;
+    }
+    return lastPeriod;
+}
+
+/*!
+ * \brief Get the last period saved in the checkpoint file.
+ * \details Only the header of the file is read.  This is used to determine
+ *          which periods must be set up before the checkpoint can be loaded.
+ * \param aScenario The scenario to be loaded into.
+ * \return The last period which had been completed when the checkpoint was
+ *         written or -1 if there is no checkpoint for the scenario.
+ */
+int Checkpoint::getLastPeriod( const Scenario* aScenario ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    ifstream checkpointFile( mFileName.c_str(), ios_base::in | ios_base::binary );
+    if( !checkpointFile.is_open() ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Could not open checkpoint file: " << mFileName << " for read." << endl;
+        return -1;
+    }
+    const int lastPeriod = readHeader( aScenario, checkpointFile );
+    if( !mIsValid ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Checkpoint file: " << mFileName << " is " << mError << "." << endl;
+    }
+    return lastPeriod;
+}
+
+/*!
+ * \brief Restore the complete model state from the checkpoint file.
+ * \details The entire file is checked against the model before any model data
+ *          is changed.  If it does not match the model is left untouched.
+ * \param aScenario The scenario to load into which must have been set up from
+ *        the same input files and had initCalc called for each period in the
+ *        checkpoint so that any objects created during initCalc exist.
+ * \return Whether the checkpoint was loaded.
+ */
+bool Checkpoint::load( Scenario* aScenario ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    ifstream checkpointFile( mFileName.c_str(), ios_base::in | ios_base::binary );
+    if( !checkpointFile.is_open() ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not open checkpoint file: " << mFileName << " for read." << endl;
+        return false;
+    }
+
+    const int lastPeriod = readHeader( aScenario, checkpointFile );
+    if( mIsValid ) {
+        // Check the entire file against the model first then go back and load
+        // it for real.
+        const streampos dataStart = checkpointFile.tellg();
+        mIn = &checkpointFile;
+        mMode = eVerify;
+        walk( aScenario );
+        transferSolverState();
+        if( mIsValid && checkpointFile.peek() != EOF ) {
+            fail( "has more data than the model" );
+        }
+        if( mIsValid ) {
+            checkpointFile.clear();
+            checkpointFile.seekg( dataStart );
+            mMode = eLoad;
+            walk( aScenario );
+            transferSolverState();
+        }
+        mIn = 0;
+    }
+
+    if( !mIsValid ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Checkpoint file: " << mFileName << " does not match the model, "
+                << mError << "." << endl;
+        return false;
+    }
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Loaded checkpoint file: " << mFileName << " through period " << lastPeriod << "." << endl;
+    return true;
+}
+
+/*!
+ * \brief Check that the model exactly matches the checkpoint file.
+ * \details The model is saved as it would be for a checkpoint through the
+ *          same last period as the file and the two are compared byte for
+ *          byte, so any difference in any value, however small, is found.
+ *          This is used to check that a resumed run reproduces the results of
+ *          an uninterrupted run which saved the file.
+ * \param aScenario The scenario to compare.
+ * \return Whether the model matches the file.
+ */
+bool Checkpoint::compare( Scenario* aScenario ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    const int lastPeriod = getLastPeriod( aScenario );
+    ifstream checkpointFile( mFileName.c_str(), ios_base::in | ios_base::binary );
+    if( !mIsValid || !checkpointFile.is_open() ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not compare the model to checkpoint file: " << mFileName << "." << endl;
+        return false;
+    }
+    const string expected( ( istreambuf_iterator<char>( checkpointFile ) ), istreambuf_iterator<char>() );
+
+    ostringstream currentData( ios_base::out | ios_base::binary );
+    write( aScenario, lastPeriod, currentData );
+    const string current = currentData.str();
+
+    const pair<string::const_iterator, string::const_iterator> firstDiff =
+        mismatch( current.begin(), current.begin() + min( current.size(), expected.size() ), expected.begin() );
+    if( current.size() != expected.size() || firstDiff.first != current.begin() + min( current.size(), expected.size() ) ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Model does not match checkpoint file: " << mFileName << ", first difference at byte "
+                << ( firstDiff.first - current.begin() ) << " of " << expected.size() << "." << endl;
+        return false;
+    }
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Model matches checkpoint file: " << mFileName << " through period " << lastPeriod << "." << endl;
+    return true;
+}
+
+/*!
+ * \brief Write a string as its length followed by its characters.
+ * \param aOut The stream to write to.
+ * \param aValue The string to write.
+ */
+void Checkpoint::writeString( ostream& aOut, const string& aValue ) {
+    writeRaw( aOut, static_cast<boost::uint32_t>( aValue.size() ) );
+    aOut.write( aValue.data(), aValue.size() );
+}
+
+/*!
+ * \brief Read a string written by writeString.
+ * \param aIn The stream to read from.
+ * \param aValue The string to read into.
+ */
+void Checkpoint::readString( istream& aIn, string& aValue ) {
+    boost::uint32_t size = 0;
+    readRaw( aIn, size );
+    aValue.clear();
+    // Read in blocks so that a corrupt size can not cause a huge allocation.
+    const boost::uint32_t BLOCK_SIZE = 4096;
+    char buffer[ BLOCK_SIZE ];
+    while( aIn && size > 0 ) {
+        const boost::uint32_t currSize = min( size, BLOCK_SIZE );
+        aIn.read( buffer, currSize );
+        aValue.append( buffer, static_cast<size_t>( aIn.gcount() ) );
+        size -= currSize;
+    }
+}
+
+/*!
+ * \brief Walk all of the model data starting from the given scenario in the
+ *        current mode.
+ * \param aScenario The scenario to start from.
+ */
+void Checkpoint::walk( Scenario* aScenario ) {
+    const Modeltime* modeltime = aScenario->getModeltime();
+    mLastRestoredYear = mLastRestoredPeriod < modeltime->getmaxper() ?
+        modeltime->getper_to_yr( mLastRestoredPeriod ) : numeric_limits<int>::max();
+    mSkipDepth = 0;
+
+    // A descendant step followed by a step which matches any Data will give
+    // us a processData call back for every Data in the model.
+    vector<FilterStep*> allDataSteps( 2, 0 );
+    allDataSteps[ 0 ] = new FilterStep( "" );
+    allDataSteps[ 1 ] = new FilterStep( "" );
+    GCAMFusion<Checkpoint, true, true, true> walkAllData( *this, allDataSteps );
+    walkAllData.startFilter( aScenario );
+
+    // clean up GCAMFusion related memory
+    for( auto filterStep : allDataSteps ) {
+        delete filterStep;
+    }
+}
+
+//! Whether model data is being written to mOut.
+bool Checkpoint::isWriting() const {
+    return mMode == eSave || ( mMode == eHash && mSkipDepth == 0 );
+}
+
+//! Whether data is being read from mIn.
+bool Checkpoint::isReading() const {
+    return mMode == eVerify || mMode == eLoad;
+}
+
+//! Whether data read from mIn is being stored in the model data.
+bool Checkpoint::isStoring() const {
+    return mMode == eLoad && mSkipDepth == 0;
+}
+
+/*!
+ * \brief Note that the walk is entering an object which only applies to the
+ *        given year.
+ * \details The data of objects after the last restored year is not hashed or
+ *          loaded.  This must be paired with a call to endObjectForYear.
+ * \param aYear The year of the object.
+ */
+void Checkpoint::beginObjectForYear( const int aYear ) {
+    if( aYear > mLastRestoredYear ) {
+        ++mSkipDepth;
+    }
+}
+
+/*!
+ * \brief Note that the walk is leaving an object which only applies to the
+ *        given year.
+ * \param aYear The year of the object.
+ */
+void Checkpoint::endObjectForYear( const int aYear ) {
+    if( aYear > mLastRestoredYear ) {
+        --mSkipDepth;
+    }
+}
+
+/*!
+ * \brief Record that the checkpoint does not match the model.
+ * \details Only the first error is kept and all further processing is skipped.
+ * \param aError A description of the mismatch.
+ */
+void Checkpoint::fail( const string& aError ) {
+    if( mIsValid ) {
+        mIsValid = false;
+        mError = aError;
+    }
+}
+
+/*!
+ * \brief Write a type tag or check that the tag read matches.
+ * \param aTag The expected tag.
+ * \param aWhat A description of what is tagged to use in the error message.
+ */
+void Checkpoint::checkTag( const boost::uint32_t aTag, const string& aWhat ) {
+    if( isWriting() ) {
+        writeRaw( *mOut, aTag );
+    }
+    else if( isReading() ) {
+        boost::uint32_t tag = 0;
+        readRaw( *mIn, tag );
+        if( !*mIn ) {
+            fail( "ended before " + aWhat );
+        }
+        else if( tag != aTag ) {
+            fail( "expected " + aWhat );
+        }
+    }
+}
+
+/*!
+ * \brief Write the size of a fixed size container or check that the size read
+ *        matches.
+ * \param aSize The expected size.
+ * \param aWhat A description of the container to use in the error message.
+ */
+void Checkpoint::checkSize( const size_t aSize, const string& aWhat ) {
+    if( isWriting() ) {
+        writeRaw( *mOut, static_cast<boost::uint32_t>( aSize ) );
+    }
+    else if( isReading() ) {
+        boost::uint32_t size = 0;
+        readRaw( *mIn, size );
+        if( !*mIn || size != aSize ) {
+            fail( "size mismatch for " + aWhat );
+        }
+    }
+}
+
+/*!
+ * \brief Write the number of elements in a variable size container or read
+ *        the number written.
+ * \details Unlike other data the count is always read so that the elements
+ *          which follow can be skipped when verifying.
+ * \param aCount The number of elements, updated when reading.
+ */
+void Checkpoint::transferCount( boost::uint32_t& aCount ) {
+    if( isWriting() ) {
+        writeRaw( *mOut, aCount );
+    }
+    else if( isReading() ) {
+        readRaw( *mIn, aCount );
+        if( !*mIn ) {
+            fail( "ended unexpectedly" );
+            aCount = 0;
+        }
+    }
+}
+
+/*!
+ * \brief Transfer the solver state which is carried between periods but is
+ *        not part of the model data.
+ * \details Currently this is the final Broyden matrix saved by LogBroyden.
+ *          It is not included in the content hash as it is an output of
+ *          solving rather than an input.
+ */
+void Checkpoint::transferSolverState() {
+    if( mMode == eHash || !mIsValid ) {
+        return;
+    }
+    checkTag( getTypeTag( typeid( LogBroyden ) ), "the solver state" );
+    if( !mIsValid ) {
+        return;
+    }
+    boost::int32_t jacobianPeriod = LogBroyden::mLastJacobianPer;
+    transferData( jacobianPeriod );
+    transferData( LogBroyden::mLastJacobianLogPricep );
+    transferData( LogBroyden::mLastJacobianMktIDs );
+
+    boost::uint32_t rows = static_cast<boost::uint32_t>( LogBroyden::mLastJacobian.rows() );
+    boost::uint32_t cols = static_cast<boost::uint32_t>( LogBroyden::mLastJacobian.cols() );
+    transferCount( rows );
+    transferCount( cols );
+    if( isStoring() && mIsValid ) {
+        LogBroyden::mLastJacobianPer = jacobianPeriod;
+        LogBroyden::mLastJacobian.resize( rows, cols );
+    }
+    for( boost::uint32_t j = 0; j < cols && mIsValid; ++j ) {
+        for( boost::uint32_t i = 0; i < rows && mIsValid; ++i ) {
+            double value = isReading() ? 0.0 : LogBroyden::mLastJacobian( i, j );
+            transferData( value );
+            if( isStoring() ) {
+                LogBroyden::mLastJacobian( i, j ) = value;
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Read a value and store it in aTarget if loading.
+ * \param aTarget The model data to read into.
+ * \return Whether a value was read.
+ */
+template<typename T>
+bool Checkpoint::readInto( T& aTarget ) {
+    T value;
+    readRaw( *mIn, value );
+    if( !*mIn ) {
+        fail( "ended unexpectedly" );
+        return false;
+    }
+    if( isStoring() ) {
+        aTarget = value;
+    }
+    return true;
+}
+
+template<typename T>
+void Checkpoint::transfer( T& aValue, std::false_type aIsCheckpointed ) {
+    // Not written to the checkpoint.
+}
+
+template<typename T>
+void Checkpoint::transfer( T& aValue, std::true_type aIsCheckpointed ) {
+    transferData( aValue );
+}
+
+void Checkpoint::transfer( string& aValue, std::false_type aIsCheckpointed ) {
+    // Strings are not written to the checkpoint but names still distinguish
+    // models when calculating a hash.
+    if( mMode == eHash && isWriting() ) {
+        writeString( *mOut, aValue );
+    }
+}
+
+template<typename T>
+void Checkpoint::transferData( T& aValue ) {
+    if( isReading() ) {
+        readInto( aValue );
+    }
+    else if( isWriting() ) {
+        writeRaw( *mOut, aValue );
+    }
+}
+
+void Checkpoint::transferData( Value& aValue ) {
+    if( isReading() ) {
+        if( readInto( aValue.mValue ) ) {
+            readInto( aValue.mIsInit );
+        }
+    }
+    else if( isWriting() ) {
+        writeRaw( *mOut, aValue.mValue );
+        writeRaw( *mOut, aValue.mIsInit );
+    }
+}
+
+void Checkpoint::transferData( vector<bool>& aValue ) {
+    boost::uint32_t size = static_cast<boost::uint32_t>( aValue.size() );
+    transferCount( size );
+    if( isStoring() ) {
+        aValue.resize( size );
+    }
+    for( size_t i = 0; i < size && mIsValid; ++i ) {
+        bool element = isReading() ? false : aValue[ i ];
+        transferData( element );
+        if( isStoring() ) {
+            aValue[ i ] = element;
+        }
+    }
+}
+
+template<typename T>
+void Checkpoint::transferData( vector<T>& aValue ) {
+    // Vectors may grow during a run so read the size and resize to match.
+    boost::uint32_t size = static_cast<boost::uint32_t>( aValue.size() );
+    transferCount( size );
+    if( isStoring() ) {
+        aValue.resize( size );
+    }
+    for( size_t i = 0; i < size && mIsValid; ++i ) {
+        if( isReading() && !isStoring() ) {
+            T scratch = T();
+            transferData( scratch );
+        }
+        else {
+            transferData( aValue[ i ] );
+        }
+    }
+}
+
+template<typename T>
+void Checkpoint::transferData( objects::PeriodVector<T>& aValue ) {
+    const size_t numRestored = mLastRestoredPeriod < static_cast<int>( aValue.size() ) ?
+        mLastRestoredPeriod + 1 : aValue.size();
+    transferFixed( aValue, numRestored );
+}
+
+template<typename T>
+void Checkpoint::transferData( objects::YearVector<T>& aValue ) {
+    const int startYear = aValue.getStartYear();
+    const size_t numRestored = mLastRestoredYear < startYear ? 0 :
+        min( static_cast<size_t>( mLastRestoredYear - startYear ) + 1, aValue.size() );
+    transferFixed( aValue, numRestored );
+}
+
+template<typename T>
+void Checkpoint::transferData( objects::TechVintageVector<T>& aValue ) {
+    // The periods of a technology vintage vector depend on the technology so
+    // these are always restored.
+    transferFixed( aValue, aValue.size() );
+}
+
+template<typename K, typename V>
+void Checkpoint::transferData( map<K, V>& aValue ) {
+    // Maps may gain entries during a run so the keys are written and the map
+    // rebuilt on load.
+    boost::uint32_t size = static_cast<boost::uint32_t>( aValue.size() );
+    transferCount( size );
+    if( !isReading() ) {
+        for( auto& currPair : aValue ) {
+            if( isWriting() ) {
+                writeKey( *mOut, currPair.first );
+            }
+            transferData( currPair.second );
+        }
+    }
+    else {
+        map<K, V> loaded;
+        for( size_t i = 0; i < size && mIsValid; ++i ) {
+            K key;
+            readKey( *mIn, key );
+            V value = V();
+            transferData( value );
+            loaded[ key ] = value;
+        }
+        if( !*mIn ) {
+            fail( "ended unexpectedly" );
+        }
+        if( isStoring() && mIsValid ) {
+            aValue.swap( loaded );
+        }
+    }
+}
+
+template<typename VectorType>
+void Checkpoint::transferFixed( VectorType& aValue, const size_t aNumRestored ) {
+    // Time vectors are sized by the modeltime or technology lifetime which are
+    // set from the input files so the size must match.
+    checkSize( aValue.size(), "time vector" );
+    size_t index = 0;
+    for( auto iter = aValue.begin(); iter != aValue.end() && mIsValid; ++iter, ++index ) {
+        const bool isRestored = index < aNumRestored;
+        if( !isRestored ) {
+            ++mSkipDepth;
+        }
+        transferData( *iter );
+        if( !isRestored ) {
+            --mSkipDepth;
+        }
+    }
+}
+
+template<typename DataType>
+void Checkpoint::processData( DataType& aData ) {
+    if( mIsValid ) {
+        checkTag( getTypeTag( typeid( DataType ) ), "data of type " + string( typeid( DataType ).name() ) );
+    }
+    if( mIsValid ) {
+        transfer( aData, std::integral_constant<bool, IsCheckpointed<DataType>::value>() );
+    }
+}
+
+template<typename DataType>
+void Checkpoint::pushFilterStep( const DataType& aData ) {
+    // Not an object we can identify.
+}
+
+template<typename DataType>
+void Checkpoint::pushFilterStep( DataType* const& aData ) {
+    // Tag each object with its type so that loading into a model with a
+    // different structure will fail.
+    if( mIsValid ) {
+        checkTag( getTypeTag( typeid( *aData ) ), "an object of type " + string( typeid( *aData ).name() ) );
+    }
+}
+
+void Checkpoint::pushFilterStep( Market* const& aData ) {
+    if( mIsValid ) {
+        checkTag( getTypeTag( typeid( *aData ) ), "an object of type " + string( typeid( *aData ).name() ) );
+    }
+    beginObjectForYear( aData->getYear() );
+    // The market info is not part of the Data so handle it here.
+    if( mIsValid ) {
+        if( isWriting() ) {
+            aData->getMarketInfo()->writeCheckpoint( *mOut );
+        }
+        else if( isReading() && !aData->getMarketInfo()->readCheckpoint( *mIn, isStoring() ) ) {
+            fail( "could not read the info for market " + aData->getName() );
+        }
+    }
+}
+
+void Checkpoint::pushFilterStep( ITechnology* const& aData ) {
+    if( mIsValid ) {
+        checkTag( getTypeTag( typeid( *aData ) ), "an object of type " + string( typeid( *aData ).name() ) );
+    }
+    beginObjectForYear( aData->getYear() );
+}
+
+template<typename DataType>
+void Checkpoint::popFilterStep( const DataType& aData ) {
+}
+
+void Checkpoint::popFilterStep( Market* const& aData ) {
+    endObjectForYear( aData->getYear() );
+}
+
+void Checkpoint::popFilterStep( ITechnology* const& aData ) {
+    endObjectForYear( aData->getYear() );
+}
@@ -292,6 +292,56 @@ void ManageStateVariables::setPartialDeriv( const bool aIsPartialDeriv ) {
 #endif
 }
 
+/*!
+ * \brief Copy the state the calling thread is currently using.
+ * \details This is the "base" state unless the thread is calculating a partial
+ *          derivative in which case it is the thread's "scratch" space.
+ * \param aState A vector which will be set to the current state.
+ */
+void ManageStateVariables::copyCurrentState( vector<double>& aState ) const {
+#if !GCAM_PARALLEL_ENABLED
+    const double* currState = Value::sCentralValue;
+#else
+    const double* currState = Value::sCentralValue.local();
+#endif
+    aState.assign( currState, currState + mNumCollected );
+}
+
+/*!
+ * \brief Overwrite the "base" state.
+ * \param aState A state previously retrieved with copyCurrentState.
+ */
+void ManageStateVariables::setBaseState( const vector<double>& aState ) {
+    assert( aState.size() == mNumCollected );
+    if( mNumCollected > 0 ) {
+        memcpy( mStateData[0], &aState[0], (sizeof( double)) * mNumCollected );
+    }
+}
+
+/*!
+ * \brief Get the Value which holds the given position in the state.
+ * \details This requires a linear search and is only intended for reporting.
+ * \param aIndex The position in the state.
+ * \return The Value or null if the index is out of range.
+ */
+const Value* ManageStateVariables::getStateValue( const size_t aIndex ) const {
+    for( auto currValue : mStateValues ) {
+        if( currValue->mCentralValueIndex == aIndex ) {
+            return currValue;
+        }
+    }
+    return 0;
+}
+
+/*!
+ * \brief Get the memory allocated for the state data.
+ * \details This includes every copy of the state, one per thread plus the base.
+ * \return The size of the state data in bytes.
+ */
+size_t ManageStateVariables::getStateDataBytes() const {
+    return static_cast<size_t>( NUM_STATES ) * mNumCollected * sizeof( double );
+}
+
 /*!
  * \brief Generate the appropriate restart file name to use.
  * \details This method will append the model period this instance was created
@@ -0,0 +1,329 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+
+/*!
+ * \file memory_profiler.cpp
+ * \ingroup util
+ * \brief MemoryProfiler class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+#include <cstring>
+
+#include "util/base/include/memory_profiler.h"
+#include "util/base/include/memory_report.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/util.h"
+
+#if GCAM_ALLOCATION_PROFILING
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
+using namespace std;
+
+namespace {
+    //! Bytes in a megabyte.
+    const double MB = 1024.0 * 1024.0;
+}
+
+#if GCAM_ALLOCATION_PROFILING
+namespace {
+    std::atomic<long long> gAllocations( 0 );
+    std::atomic<long long> gFrees( 0 );
+    std::atomic<long long> gAllocatedBytes( 0 );
+    std::atomic<long long> gLiveBytes( 0 );
+    std::atomic<long long> gPeakLiveBytes( 0 );
+
+    //! Space kept in front of each allocation to remember its size, large
+    //! enough to keep the returned memory suitably aligned for any type.
+    const size_t HEADER_SIZE = 16;
+
+    void* countedAlloc( size_t aSize ) {
+        void* block = malloc( aSize + HEADER_SIZE );
+        if( !block ) {
+            return 0;
+        }
+        memcpy( block, &aSize, sizeof( size_t ) );
+        ++gAllocations;
+        gAllocatedBytes += aSize;
+        const long long live = gLiveBytes += aSize;
+        long long peak = gPeakLiveBytes.load( std::memory_order_relaxed );
+        while( live > peak && !gPeakLiveBytes.compare_exchange_weak( peak, live, std::memory_order_relaxed ) ) {
+        }
+        return static_cast<char*>( block ) + HEADER_SIZE;
+    }
+
+    void countedFree( void* aPtr ) {
+        if( !aPtr ) {
+            return;
+        }
+        void* block = static_cast<char*>( aPtr ) - HEADER_SIZE;
+        size_t size;
+        memcpy( &size, block, sizeof( size_t ) );
+        ++gFrees;
+        gLiveBytes -= size;
+        free( block );
+    }
+
+    void* throwingAlloc( size_t aSize ) {
+        void* ptr;
+        while( !( ptr = countedAlloc( aSize ) ) ) {
+            new_handler handler = get_new_handler();
+            if( !handler ) {
+                throw bad_alloc();
+            }
+            handler();
+        }
+        return ptr;
+    }
+}
+
+// Replace the global allocation functions so that all allocations made with
+// new are counted.
+void* operator new( size_t aSize ) {
+    return throwingAlloc( aSize );
+}
+
+void* operator new[]( size_t aSize ) {
+    return throwingAlloc( aSize );
+}
+
+void* operator new( size_t aSize, const nothrow_t& ) noexcept {
+    return countedAlloc( aSize );
+}
+
+void* operator new[]( size_t aSize, const nothrow_t& ) noexcept {
+    return countedAlloc( aSize );
+}
+
+void operator delete( void* aPtr ) noexcept {
+    countedFree( aPtr );
+}
+
+void operator delete[]( void* aPtr ) noexcept {
+    countedFree( aPtr );
+}
+
+void operator delete( void* aPtr, size_t ) noexcept {
+    countedFree( aPtr );
+}
+
+void operator delete[]( void* aPtr, size_t ) noexcept {
+    countedFree( aPtr );
+}
+
+void operator delete( void* aPtr, const nothrow_t& ) noexcept {
+    countedFree( aPtr );
+}
+
+void operator delete[]( void* aPtr, const nothrow_t& ) noexcept {
+    countedFree( aPtr );
+}
+#endif
+
+//! Constructor
+MemoryProfiler::MemoryProfiler():
+mIsEnabled( Configuration::getInstance()->shouldWriteFile( "memoryProfileFileName", false, false ) )
+{
+    getHeapCounters( mPrevCounters );
+}
+
+/*!
+ * \brief Get the singleton instance of the MemoryProfiler.
+ * \details The instance checks the configuration when it is first created so
+ *          this must not be called until the configuration has been read.
+ * \return The MemoryProfiler.
+ */
+MemoryProfiler& MemoryProfiler::getInstance() {
+    static MemoryProfiler MEMORY_PROFILER;
+    return MEMORY_PROFILER;
+}
+
+/*!
+ * \brief Whether profiling has been configured.
+ * \return True if the profile will be written.
+ */
+bool MemoryProfiler::isEnabled() const {
+    return mIsEnabled;
+}
+
+/*!
+ * \brief Record the memory used at the end of a phase of the model run.
+ * \details The heap metrics are for the phase which is ending, i.e. since the
+ *          previous call to markPhase, except the live bytes which is the
+ *          total at the end of the phase.
+ * \param aPhase The name of the phase which just finished.
+ * \param aPeriod The model period of the phase or -1 if it is not for a period.
+ */
+void MemoryProfiler::markPhase( const string& aPhase, const int aPeriod ) {
+    if( !mIsEnabled ) {
+        return;
+    }
+
+    const string PROCESS_COMPONENT = "process";
+    addRecord( aPhase, aPeriod, PROCESS_COMPONENT, "rss-mb", util::getCurrentMemoryUsage() );
+    addRecord( aPhase, aPeriod, PROCESS_COMPONENT, "peak-rss-mb", util::getPeakMemoryUsage() );
+
+    HeapCounters counters;
+    if( getHeapCounters( counters ) ) {
+        const string HEAP_COMPONENT = "heap";
+        addRecord( aPhase, aPeriod, HEAP_COMPONENT, "allocations", counters.mAllocations - mPrevCounters.mAllocations );
+        addRecord( aPhase, aPeriod, HEAP_COMPONENT, "frees", counters.mFrees - mPrevCounters.mFrees );
+        addRecord( aPhase, aPeriod, HEAP_COMPONENT, "allocated-mb",
+                   ( counters.mAllocatedBytes - mPrevCounters.mAllocatedBytes ) / MB );
+        addRecord( aPhase, aPeriod, HEAP_COMPONENT, "live-mb", counters.mLiveBytes / MB );
+        addRecord( aPhase, aPeriod, HEAP_COMPONENT, "peak-live-mb", counters.mPeakLiveBytes / MB );
+        mPrevCounters = counters;
+        // Start tracking the high-water mark of the next phase.
+        resetPeakLiveBytes();
+    }
+}
+
+/*!
+ * \brief Record the size of the state data for a period.
+ * \param aPeriod The model period.
+ * \param aBytes The bytes allocated for the state data.
+ */
+void MemoryProfiler::addStateData( const int aPeriod, const size_t aBytes ) {
+    if( !mIsEnabled ) {
+        return;
+    }
+    addRecord( "init-calc", aPeriod, "state-data", "mb", aBytes / MB );
+}
+
+/*!
+ * \brief Record the approximate memory used by each type of object in the model.
+ * \details This walks the entire model and so should only be done a few times
+ *          in a run.
+ * \param aPhase The name of the point in the model run to record this for.
+ * \param aScenario The scenario to walk.
+ */
+void MemoryProfiler::addObjectTypes( const string& aPhase, Scenario* aScenario ) {
+    if( !mIsEnabled ) {
+        return;
+    }
+    MemoryReport memoryReport;
+    memoryReport.collect( aScenario );
+    const map<string, MemoryReport::TypeUsage>& usageByType = memoryReport.getUsageByType();
+    for( map<string, MemoryReport::TypeUsage>::const_iterator iter = usageByType.begin(); iter != usageByType.end(); ++iter ) {
+        addRecord( aPhase, -1, iter->first, "count", static_cast<double>( iter->second.mCount ) );
+        addRecord( aPhase, -1, iter->first, "shared-refs", static_cast<double>( iter->second.mSharedRefs ) );
+        addRecord( aPhase, -1, iter->first, "mb", iter->second.mBytes / MB );
+    }
+}
+
+/*!
+ * \brief Write all values recorded since the last write as CSV.
+ * \details The records are cleared so that a following scenario starts with
+ *          an empty profile.
+ * \param aOut The stream to write to.
+ * \param aScenarioName The scenario name to write on each line.
+ */
+void MemoryProfiler::write( ostream& aOut, const string& aScenarioName ) {
+    aOut << "scenario,phase,period,component,metric,value" << endl;
+    for( vector<Record>::const_iterator iter = mRecords.begin(); iter != mRecords.end(); ++iter ) {
+        aOut << aScenarioName << ',' << iter->mPhase << ',';
+        // Phases which are not for a period leave it empty.
+        if( iter->mPeriod >= 0 ) {
+            aOut << iter->mPeriod;
+        }
+        // Type names may contain commas from template arguments.
+        if( iter->mComponent.find( ',' ) != string::npos ) {
+            aOut << ",\"" << iter->mComponent << '"';
+        }
+        else {
+            aOut << ',' << iter->mComponent;
+        }
+        aOut << ',' << iter->mMetric << ',' << iter->mValue << '\n';
+    }
+    aOut.flush();
+    mRecords.clear();
+}
+
+/*!
+ * \brief Get the heap allocation counts for the process.
+ * \param aCounters The counters to fill in.
+ * \return Whether allocations are being counted, which requires
+ *         GCAM_ALLOCATION_PROFILING.
+ */
+bool MemoryProfiler::getHeapCounters( HeapCounters& aCounters ) {
+#if GCAM_ALLOCATION_PROFILING
+    aCounters.mAllocations = gAllocations;
+    aCounters.mFrees = gFrees;
+    aCounters.mAllocatedBytes = gAllocatedBytes;
+    aCounters.mLiveBytes = gLiveBytes;
+    aCounters.mPeakLiveBytes = gPeakLiveBytes;
+    return true;
+#else
+    aCounters.mAllocations = 0;
+    aCounters.mFrees = 0;
+    aCounters.mAllocatedBytes = 0;
+    aCounters.mLiveBytes = 0;
+    aCounters.mPeakLiveBytes = 0;
+    return false;
+#endif
+}
+
+/*!
+ * \brief Reset the high-water mark of the live heap to the current live bytes.
+ */
+void MemoryProfiler::resetPeakLiveBytes() {
+#if GCAM_ALLOCATION_PROFILING
+    gPeakLiveBytes = gLiveBytes.load();
+#endif
+}
+
+/*!
+ * \brief Add a value to the profile.
+ * \param aPhase The phase the value was recorded at.
+ * \param aPeriod The model period or -1 if the phase is not for a period.
+ * \param aComponent The part of the process the value is for.
+ * \param aMetric The name of the value.
+ * \param aValue The value.
+ */
+void MemoryProfiler::addRecord( const string& aPhase, const int aPeriod, const string& aComponent,
+                                const string& aMetric, const double aValue )
+{
+    Record record;
+    record.mPhase = aPhase;
+    record.mPeriod = aPeriod;
+    record.mComponent = aComponent;
+    record.mMetric = aMetric;
+    record.mValue = aValue;
+    mRecords.push_back( record );
+}
@@ -0,0 +1,226 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*!
+ * \file memory_report.cpp
+ * \ingroup util
+ * \brief MemoryReport class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <typeinfo>
+#include <boost/core/demangle.hpp>
+
+#include "util/base/include/memory_report.h"
+#include "util/base/include/time_vector.h"
+#include "util/base/include/value.h"
+#include "util/base/include/gcam_fusion.hpp"
+#include "util/base/include/gcam_data_containers.h"
+
+using namespace std;
+
+namespace {
+    // Helpers to estimate the heap storage held by a Data member in addition
+    // to its sizeof.
+    template<typename T>
+    size_t getHeapSize( const T& aData ) {
+        return 0;
+    }
+
+    size_t getHeapSize( const string& aData ) {
+        return aData.capacity();
+    }
+
+    template<typename T>
+    size_t getHeapSize( const vector<T>& aData ) {
+        return aData.capacity() * sizeof( T );
+    }
+
+    template<typename K, typename V>
+    size_t getHeapSize( const map<K, V>& aData ) {
+        // Each node holds the value and roughly four pointers worth of
+        // book keeping.
+        size_t size = aData.size() * ( sizeof( typename map<K, V>::value_type ) + 4 * sizeof( void* ) );
+        for( auto& currPair : aData ) {
+            size += getHeapSize( currPair.first ) + getHeapSize( currPair.second );
+        }
+        return size;
+    }
+
+    template<typename T>
+    size_t getHeapSize( const objects::PeriodVector<T>& aData ) {
+        return aData.size() * sizeof( T );
+    }
+
+    template<typename T>
+    size_t getHeapSize( const objects::YearVector<T>& aData ) {
+        return aData.size() * sizeof( T );
+    }
+
+    template<typename T>
+    size_t getHeapSize( const objects::TechVintageVector<T>& aData ) {
+        return aData.size() * sizeof( T );
+    }
+}
+
+MemoryReport::MemoryReport():
+mSharedDepth( 0 )
+{
+}
+
+/*!
+ * \brief Walk all of the model data starting from the given scenario and tally
+ *        the memory used.
+ * \details Any previously collected usage is cleared.
+ * \param aScenario The scenario to start from.
+ */
+void MemoryReport::collect( Scenario* aScenario ) {
+    mUsageByType.clear();
+    mVisited.clear();
+    mTypeStack.assign( 1, "Scenario" );
+    mIsSharedStack.assign( 1, false );
+    mSharedDepth = 0;
+    ++mUsageByType[ mTypeStack.back() ].mCount;
+
+    // A descendant step followed by a step which matches any Data will give
+    // us a processData call back for every Data in the model.
+    vector<FilterStep*> allDataSteps( 2, 0 );
+    allDataSteps[ 0 ] = new FilterStep( "" );
+    allDataSteps[ 1 ] = new FilterStep( "" );
+    GCAMFusion<MemoryReport, true, true, true> findAllData( *this, allDataSteps );
+    findAllData.startFilter( aScenario );
+
+    // clean up GCAMFusion related memory
+    for( auto filterStep : allDataSteps ) {
+        delete filterStep;
+    }
+}
+
+/*!
+ * \brief Get the total approximate bytes across all object types.
+ * \return The total bytes.
+ */
+size_t MemoryReport::getTotalBytes() const {
+    size_t total = 0;
+    for( auto& usage : mUsageByType ) {
+        total += usage.second.mBytes;
+    }
+    return total;
+}
+
+/*!
+ * \brief Get the usage tallied by the last call to collect.
+ * \return The usage by demangled type name.
+ */
+const map<string, MemoryReport::TypeUsage>& MemoryReport::getUsageByType() const {
+    return mUsageByType;
+}
+
+/*!
+ * \brief Print the usage by object type sorted from largest to smallest.
+ * \param aOut The stream to print to.
+ */
+void MemoryReport::print( ostream& aOut ) const {
+    vector<pair<size_t, string> > sorted;
+    for( auto& usage : mUsageByType ) {
+        sorted.push_back( make_pair( usage.second.mBytes, usage.first ) );
+    }
+    sort( sorted.rbegin(), sorted.rend() );
+
+    const size_t total = getTotalBytes();
+    aOut << "Approximate memory by object type (total " << total / 1024 << " KB)" << endl;
+    aOut << setw( 12 ) << "KB" << setw( 8 ) << "%" << setw( 12 ) << "count"
+         << setw( 12 ) << "shared" << "  type" << endl;
+    for( auto& entry : sorted ) {
+        const TypeUsage& usage = mUsageByType.find( entry.second )->second;
+        aOut << setw( 12 ) << usage.mBytes / 1024
+             << setw( 8 ) << fixed << setprecision( 2 ) << ( total > 0 ? 100.0 * usage.mBytes / total : 0.0 )
+             << setw( 12 ) << usage.mCount << setw( 12 ) << usage.mSharedRefs
+             << "  " << entry.second << endl;
+    }
+}
+
+/*!
+ * \brief Attribute bytes to the innermost containing object unless it has
+ *        already been counted.
+ * \param aBytes The bytes to add.
+ */
+void MemoryReport::addBytes( const size_t aBytes ) {
+    if( mSharedDepth == 0 ) {
+        mUsageByType[ mTypeStack.back() ].mBytes += aBytes;
+    }
+}
+
+template<typename DataType>
+void MemoryReport::processData( DataType& aData ) {
+    addBytes( sizeof( DataType ) + getHeapSize( aData ) );
+}
+
+template<typename DataType>
+void MemoryReport::pushFilterStep( const DataType& aData ) {
+    // Not an object we can identify, attribute anything within it to the
+    // current type.
+    mTypeStack.push_back( mTypeStack.back() );
+    mIsSharedStack.push_back( false );
+}
+
+template<typename DataType>
+void MemoryReport::pushFilterStep( DataType* const& aData ) {
+    mTypeStack.push_back( boost::core::demangle( typeid( *aData ).name() ) );
+    const bool isShared = !mVisited.insert( static_cast<const void*>( aData ) ).second;
+    mIsSharedStack.push_back( isShared );
+    if( isShared ) {
+        // Only the outermost shared object is a reference, anything within it
+        // was reached through that reference.
+        if( mSharedDepth == 0 ) {
+            ++mUsageByType[ mTypeStack.back() ].mSharedRefs;
+        }
+        ++mSharedDepth;
+    }
+    else if( mSharedDepth == 0 ) {
+        ++mUsageByType[ mTypeStack.back() ].mCount;
+    }
+}
+
+template<typename DataType>
+void MemoryReport::popFilterStep( const DataType& aData ) {
+    if( mIsSharedStack.back() ) {
+        --mSharedDepth;
+    }
+    mIsSharedStack.pop_back();
+    mTypeStack.pop_back();
+}
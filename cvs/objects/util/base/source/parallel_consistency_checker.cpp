@@ -0,0 +1,497 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+
+/*!
+ * \file parallel_consistency_checker.cpp
+ * \ingroup util
+ * \brief ParallelConsistencyChecker class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+#include <sstream>
+#include <set>
+#include <typeinfo>
+#include <boost/core/demangle.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+
+#include "util/base/include/parallel_consistency_checker.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/manage_state_variables.hpp"
+#include "util/base/include/fltcmp.hpp"
+#include "util/base/include/util.h"
+#include "util/base/include/value.h"
+#include "util/base/include/time_vector.h"
+#include "util/base/include/inamed.h"
+#include "util/base/include/iyeared.h"
+#include "util/logger/include/ilogger.h"
+#include "containers/include/scenario.h"
+#include "containers/include/world.h"
+#include "containers/include/iactivity.h"
+#include "marketplace/include/marketplace.h"
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/tick_count.h>
+#include "util/base/include/gcam_fusion.hpp"
+#include "util/base/include/gcam_data_containers.h"
+#endif
+
+using namespace std;
+
+extern Scenario* scenario;
+
+//! The maximum number of differing values to locate and log.
+static const size_t MAX_REPORTED = 5;
+
+#if GCAM_PARALLEL_ENABLED
+namespace {
+    // Helpers to call a function on each Value held by a Data member.
+    template<typename T, typename Func>
+    void forEachValue( const T& aData, Func aFunc ) {
+    }
+
+    template<typename Func>
+    void forEachValue( const Value& aData, Func aFunc ) {
+        aFunc( aData );
+    }
+
+    template<typename Func>
+    void forEachValue( const objects::PeriodVector<Value>& aData, Func aFunc ) {
+        for( auto iter = aData.begin(); iter != aData.end(); ++iter ) {
+            aFunc( *iter );
+        }
+    }
+
+    template<typename Func>
+    void forEachValue( const objects::YearVector<Value>& aData, Func aFunc ) {
+        for( auto iter = aData.begin(); iter != aData.end(); ++iter ) {
+            aFunc( *iter );
+        }
+    }
+
+    template<typename Func>
+    void forEachValue( const objects::TechVintageVector<Value>& aData, Func aFunc ) {
+        for( auto iter = aData.begin(); iter != aData.end(); ++iter ) {
+            aFunc( *iter );
+        }
+    }
+
+    template<typename T>
+    bool holdsValue( const T& aData, const Value* aValue ) {
+        bool found = false;
+        forEachValue( aData, [&found, aValue]( const Value& aCurr ) {
+            found |= &aCurr == aValue;
+        } );
+        return found;
+    }
+
+    // Helpers to label a container by its type and name or year.
+    template<typename ContainerType>
+    typename boost::enable_if<boost::is_base_of<INamed, ContainerType>, string>::type
+    getContainerLabel( const ContainerType* aContainer ) {
+        return boost::core::demangle( typeid( *aContainer ).name() ) + "[" + aContainer->getName() + "]";
+    }
+
+    template<typename ContainerType>
+    typename boost::enable_if<boost::is_base_of<IYeared, ContainerType>, string>::type
+    getContainerLabel( const ContainerType* aContainer ) {
+        return boost::core::demangle( typeid( *aContainer ).name() ) + "[" + util::toString( aContainer->getYear() ) + "]";
+    }
+
+    template<typename ContainerType>
+    typename boost::disable_if<boost::mpl::or_<boost::is_base_of<INamed, ContainerType>, boost::is_base_of<IYeared, ContainerType> >, string>::type
+    getContainerLabel( const ContainerType* aContainer ) {
+        return boost::core::demangle( typeid( *aContainer ).name() );
+    }
+
+    /*!
+     * \brief A DataVector handler which finds the name of the Data in a container
+     *        which holds a given Value.
+     */
+    struct FindDataName {
+        FindDataName( const Value* aValue ):mValue( aValue ) {}
+
+        //! The Value to find.
+        const Value* mValue;
+
+        //! The name of the Data which holds mValue if found.
+        string mDataName;
+
+        template<typename DataVectorType>
+        void processDataVector( DataVectorType aDataVector ) {
+            boost::fusion::for_each( aDataVector, [this] ( auto& aData ) {
+                if( holdsValue( aData.mData, this->mValue ) ) {
+                    this->mDataName = aData.mDataName;
+                }
+            } );
+        }
+    };
+
+    /*!
+     * \brief GCAMFusion callbacks to find the location in the model of a set of
+     *        STATE Values.
+     * \details The location is given as the path of containers from the Scenario
+     *          followed by the name of the Data.
+     */
+    class LocateValues {
+    public:
+        LocateValues( const vector<const Value*>& aValues ):mToFind( aValues.begin(), aValues.end() ) {}
+
+        //! The location of each Value which was found.
+        map<const Value*, string> mLocations;
+
+        template<typename DataType>
+        void processData( DataType& aData ) {
+            forEachValue( aData, [this]( const Value& aCurr ) {
+                if( this->mToFind.find( &aCurr ) != this->mToFind.end() ) {
+                    this->mLocations[ &aCurr ] = this->getPath() + this->mFindDataName.back()( &aCurr );
+                }
+            } );
+        }
+
+        template<typename DataType>
+        void pushFilterStep( const DataType& aData ) {
+            // Not a container we can identify.
+            mPath.push_back( "" );
+            mFindDataName.push_back( []( const Value* ) { return string(); } );
+        }
+
+        template<typename ContainerType>
+        void pushFilterStep( ContainerType* const& aContainer ) {
+            mPath.push_back( getContainerLabel( aContainer ) );
+            // Remember how to find the Data names within this container in case
+            // one of the Values is found directly within it.
+            mFindDataName.push_back( [aContainer]( const Value* aValue ) {
+                ExpandDataVector<typename ContainerType::SubClassFamilyVector> getDataVector;
+                aContainer->doDataExpansion( getDataVector );
+                FindDataName findDataName( aValue );
+                getDataVector.getFullDataVector( findDataName );
+                return findDataName.mDataName;
+            } );
+        }
+
+        template<typename DataType>
+        void popFilterStep( const DataType& aData ) {
+            mPath.pop_back();
+            mFindDataName.pop_back();
+        }
+
+    private:
+        //! The Values to find.
+        const set<const Value*> mToFind;
+
+        //! The labels of the containers we are currently in.
+        vector<string> mPath;
+
+        //! For each container we are currently in a function to find the name
+        //! of the Data holding a Value.
+        vector<function<string( const Value* )> > mFindDataName;
+
+        string getPath() const {
+            string path;
+            for( const string& label : mPath ) {
+                if( !label.empty() ) {
+                    path += label + "/";
+                }
+            }
+            return path;
+        }
+    };
+}
+#endif
+
+/*!
+ * \brief Constructor.
+ * \param aPeriod The model period which will be checked.
+ */
+ParallelConsistencyChecker::ParallelConsistencyChecker( const int aPeriod ):
+mPeriod( aPeriod ),
+mJacobianInterval( Configuration::getInstance()->getInt( "parallel-check-jacobian-interval", 0, false ) ),
+mTolerance( Configuration::getInstance()->getInt( "parallel-check-tolerance", static_cast<int>( DBL_CMP_LOOSE ), false ) ),
+mNumColumns( 0 )
+{
+}
+
+/*!
+ * \brief Whether the consistency checks have been turned on in the configuration.
+ * \return True if checks should be made, always false without GCAM_PARALLEL_ENABLED.
+ */
+bool ParallelConsistencyChecker::isEnabled() {
+#if GCAM_PARALLEL_ENABLED
+    return Configuration::getInstance()->getBool( "check-parallel-consistency", false, false );
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief Calculate the full model both in serial and with the flow graph and
+ *        compare the results.
+ * \details Both calculations start from the current state.  The model is left
+ *          in the state calculated with the flow graph which is the state a
+ *          normal parallel calculation would have produced.
+ * \param aSamplePoint A description of the point in the solution process for
+ *                     reporting.
+ * \return Whether the results were consistent.
+ */
+bool ParallelConsistencyChecker::checkFullCalc( const string& aSamplePoint ) {
+#if GCAM_PARALLEL_ENABLED
+    ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    World* world = scenario->getWorld();
+    stateVars->setPartialDeriv( false );
+
+    vector<double> initialState;
+    stateVars->copyCurrentState( initialState );
+
+    tbb::tick_count serialStart = tbb::tick_count::now();
+    world->calc( mPeriod );
+    const double serialTime = ( tbb::tick_count::now() - serialStart ).seconds();
+    vector<double> serialState;
+    stateVars->copyCurrentState( serialState );
+
+    stateVars->setBaseState( initialState );
+    tbb::tick_count parallelStart = tbb::tick_count::now();
+    world->calc( mPeriod, world->getGlobalFlowGraph() );
+    const double parallelTime = ( tbb::tick_count::now() - parallelStart ).seconds();
+    vector<double> parallelState;
+    stateVars->copyCurrentState( parallelState );
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::DEBUG );
+    mainLog << "Period " << mPeriod << " " << aSamplePoint << " serial time: " << serialTime
+            << " parallel time: " << parallelTime << " speedup: " << serialTime / parallelTime << endl;
+
+    if( compareStates( aSamplePoint, serialState, parallelState ) ) {
+        return true;
+    }
+
+    reportFirstDivergingActivity( initialState, serialState, parallelState );
+    stateVars->setBaseState( parallelState );
+    return false;
+#else
+    return true;
+#endif
+}
+
+/*!
+ * \brief Find and log the first activity in the global calculation order which
+ *        writes a value that differs between the serial and parallel results.
+ * \details The serial calculation is repeated from the initial state one
+ *          activity at a time and the state is compared after each to find
+ *          which values the activity wrote.  Activities later in the order
+ *          typically differ only because they consume the results of that
+ *          activity so it is the best place to start looking for the cause.
+ *          The model is left in an arbitrary state.
+ * \param aInitialState The state both calculations started from.
+ * \param aSerialState The state calculated in serial.
+ * \param aParallelState The state calculated in parallel.
+ */
+void ParallelConsistencyChecker::reportFirstDivergingActivity( const vector<double>& aInitialState,
+                                                               const vector<double>& aSerialState,
+                                                               const vector<double>& aParallelState ) const
+{
+#if GCAM_PARALLEL_ENABLED
+    ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    Marketplace* marketplace = scenario->getMarketplace();
+    const vector<IActivity*>& ordering = scenario->getWorld()->getGlobalOrdering();
+    stateVars->setBaseState( aInitialState );
+
+    vector<double> prevState( aInitialState );
+    vector<double> currState;
+    IActivity* diverging = 0;
+    for( vector<IActivity*>::const_iterator it = ordering.begin(); it != ordering.end() && !diverging; ++it ) {
+        marketplace->setCurrentActivity( *it );
+        (*it)->calc( mPeriod );
+        stateVars->copyCurrentState( currState );
+        for( size_t i = 0; i < currState.size() && !diverging; ++i ) {
+            if( !util::isEqual( currState[ i ], prevState[ i ] ) &&
+                isDiffering( aSerialState[ i ], aParallelState[ i ] ) )
+            {
+                diverging = *it;
+            }
+        }
+        prevState.swap( currState );
+    }
+    marketplace->setCurrentActivity( 0 );
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::ERROR );
+    if( diverging ) {
+        mainLog << "First diverging activity in calculation order: " << diverging->getDescription() << endl;
+    }
+    else {
+        mainLog << "No single activity wrote the differing values when recalculated in order." << endl;
+    }
+#endif
+}
+
+/*!
+ * \brief Determine which of the Jacobian columns about to be calculated in
+ *        parallel should be checked.
+ * \details Columns are counted across all Jacobians in the period so that each
+ *          Jacobian may have a different column sampled.
+ * \param aColumns The columns which will be calculated.
+ */
+void ParallelConsistencyChecker::sampleJacobianColumns( const vector<int>& aColumns ) {
+    mColumnStates.clear();
+    if( mJacobianInterval <= 0 ) {
+        return;
+    }
+    for( const int column : aColumns ) {
+        if( ++mNumColumns % mJacobianInterval == 0 ) {
+            mColumnStates[ column ];
+        }
+    }
+}
+
+/*!
+ * \brief Save the state left by calculating a Jacobian column if it was
+ *        sampled.
+ * \details This is called from the thread which calculated the column right
+ *          after calculating it.  Each column is saved in its own entry so this
+ *          may be called concurrently for different columns.
+ * \param aColumn The column which was just calculated.
+ */
+void ParallelConsistencyChecker::saveColumnState( const int aColumn ) {
+    map<int, vector<double> >::iterator iter = mColumnStates.find( aColumn );
+    if( iter != mColumnStates.end() ) {
+        scenario->getManageStateVariables()->copyCurrentState( iter->second );
+    }
+}
+
+/*!
+ * \brief Recalculate each sampled Jacobian column alone and compare the state
+ *        to when it was calculated in parallel.
+ * \param aCalcColumn A function which will calculate the given column on the
+ *                    calling thread.
+ * \return Whether all of the sampled columns were consistent.
+ */
+bool ParallelConsistencyChecker::checkJacobianColumns( const function<void( const int )>& aCalcColumn ) {
+    bool isConsistent = true;
+    vector<double> serialState;
+    for( map<int, vector<double> >::const_iterator iter = mColumnStates.begin(); iter != mColumnStates.end(); ++iter ) {
+        aCalcColumn( iter->first );
+        scenario->getManageStateVariables()->copyCurrentState( serialState );
+        isConsistent &= compareStates( "Jacobian column " + util::toString( iter->first ),
+                                       serialState, iter->second );
+    }
+    mColumnStates.clear();
+    return isConsistent;
+}
+
+/*!
+ * \brief Compare every value in a state calculated in serial and in parallel
+ *        and report any differences.
+ * \param aSamplePoint A description of where the states were calculated.
+ * \param aSerialState The state calculated in serial.
+ * \param aParallelState The state calculated in parallel.
+ * \return Whether the states were consistent.
+ */
+bool ParallelConsistencyChecker::compareStates( const string& aSamplePoint, const vector<double>& aSerialState,
+                                                const vector<double>& aParallelState ) const
+{
+    assert( aSerialState.size() == aParallelState.size() );
+
+    // State is numbered in the reverse of the order it is found in the model so
+    // search backwards to report differences in model order.
+    vector<size_t> differing;
+    size_t numDiffering = 0;
+    for( size_t i = aSerialState.size(); i-- > 0; ) {
+        if( isDiffering( aSerialState[ i ], aParallelState[ i ] ) ) {
+            if( differing.size() < MAX_REPORTED ) {
+                differing.push_back( i );
+            }
+            ++numDiffering;
+        }
+    }
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    if( numDiffering == 0 ) {
+        mainLog.setLevel( ILogger::DEBUG );
+        mainLog << "Period " << mPeriod << " " << aSamplePoint << " parallel calc consistent with serial." << endl;
+        return true;
+    }
+
+    vector<const Value*> values;
+    const ManageStateVariables* stateVars = scenario->getManageStateVariables();
+    for( const size_t index : differing ) {
+        values.push_back( stateVars->getStateValue( index ) );
+    }
+    const map<const Value*, string> names = findValueNames( values );
+
+    mainLog.setLevel( ILogger::ERROR );
+    mainLog << "Parallel calc failed to reproduce serial results at " << aSamplePoint << " in period "
+            << mPeriod << ": " << numDiffering << " of " << aSerialState.size() << " state values differ." << endl;
+    for( size_t i = 0; i < differing.size(); ++i ) {
+        map<const Value*, string>::const_iterator nameIter = names.find( values[ i ] );
+        mainLog << ( nameIter != names.end() ? nameIter->second : "state " + util::toString( differing[ i ] ) )
+                << " serial: " << aSerialState[ differing[ i ] ]
+                << " parallel: " << aParallelState[ differing[ i ] ] << endl;
+    }
+    return false;
+}
+
+/*!
+ * \brief Whether a serial and parallel value differ by more than the tolerance.
+ * \param aSerial The value calculated in serial.
+ * \param aParallel The value calculated in parallel.
+ * \return True if the values are not consistent.
+ */
+bool ParallelConsistencyChecker::isDiffering( const double aSerial, const double aParallel ) const {
+    return !util::isEqual( aSerial, aParallel ) && !dblcmp( aSerial, aParallel, mTolerance );
+}
+
+/*!
+ * \brief Find the location in the model of each of the given Values.
+ * \param aValues The Values to find.
+ * \return The location of each Value that could be found.
+ */
+map<const Value*, string> ParallelConsistencyChecker::findValueNames( const vector<const Value*>& aValues ) {
+#if GCAM_PARALLEL_ENABLED
+    LocateValues locateValues( aValues );
+    vector<FilterStep*> stateSteps( 2, 0 );
+    stateSteps[ 0 ] = new FilterStep( "" );
+    stateSteps[ 1 ] = new FilterStep( "", DataFlags::STATE );
+    GCAMFusion<LocateValues, true, true, true> findState( locateValues, stateSteps );
+    findState.startFilter( scenario );
+    for( auto filterStep : stateSteps ) {
+        delete filterStep;
+    }
+    return locateValues.mLocations;
+#else
+    return map<const Value*, string>();
+#endif
+}
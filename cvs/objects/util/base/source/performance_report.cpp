@@ -0,0 +1,228 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+
+/*!
+ * \file performance_report.cpp
+ * \ingroup util
+ * \brief PerformanceReport class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+
+#include "util/base/include/performance_report.h"
+#include "util/base/include/util.h"
+#include "solution/util/include/calc_counter.h"
+#include "containers/include/world.h"
+
+using namespace std;
+
+namespace {
+    //! A predefined timer to include in the report along with its metric name.
+    struct TimerMetric {
+        TimerRegistry::PredefinedTimers mTimer;
+        const char* mMetric;
+        //! Whether the time is attributed to the period in which it was stopped.
+        bool mIsFromPeriodTimer;
+    };
+
+    //! The predefined timers which are reported for each period and the run.
+    const TimerMetric TIMER_METRICS[] = {
+        { TimerRegistry::SOLVER, "solver-time", true },
+        { TimerRegistry::BISECT, "bisection-time", true },
+        { TimerRegistry::JACOBIAN, "jacobian-time", true },
+        { TimerRegistry::EVAL_FULL, "full-evaluation-time", true },
+        { TimerRegistry::EVAL_PART, "partial-evaluation-time", true },
+        { TimerRegistry::CLIMATE_MODEL, "climate-model-time", false },
+        { TimerRegistry::WRITE_DATA, "output-time", true }
+    };
+
+    const size_t NUM_TIMER_METRICS = sizeof( TIMER_METRICS ) / sizeof( TIMER_METRICS[ 0 ] );
+}
+
+//! Constructor
+PerformanceReport::PerformanceReport():
+mPeriodStartWallTime( 0.0 ),
+mPeriodStartCPUTime( 0.0 ),
+mPeriodStartTimes( NUM_TIMER_METRICS, 0.0 ),
+mRunStartCPUTime( util::getProcessCPUTime() ),
+mRunStartTimes( NUM_TIMER_METRICS, 0.0 )
+{
+    TimerRegistry& timers = TimerRegistry::getInstance();
+    for( size_t i = 0; i < NUM_TIMER_METRICS; ++i ) {
+        mRunStartTimes[ i ] = timers.getTimer( TIMER_METRICS[ i ].mTimer ).getTotalTimeDifference();
+    }
+    mRunTimer.start();
+}
+
+/*!
+ * \brief Mark the beginning of a model period.
+ */
+void PerformanceReport::startPeriod() {
+    TimerRegistry& timers = TimerRegistry::getInstance();
+    for( size_t i = 0; i < NUM_TIMER_METRICS; ++i ) {
+        mPeriodStartTimes[ i ] = timers.getTimer( TIMER_METRICS[ i ].mTimer ).getTotalTimeDifference();
+    }
+    mPeriodStartCPUTime = util::getProcessCPUTime();
+    mPeriodStartWallTime = mPeriodTimer.getTotalTimeDifference();
+    mPeriodTimer.start();
+}
+
+/*!
+ * \brief Record the values for a model period which has just finished.
+ * \param aPeriod The model period.
+ * \param aYear The year of the model period.
+ * \param aCalcCounter The calc counter which has the counts for the period.
+ */
+void PerformanceReport::endPeriod( const int aPeriod, const int aYear, const CalcCounter* aCalcCounter ) {
+    mPeriodTimer.stop();
+    const string PERIOD_COMPONENT = "period";
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "wall-time",
+               mPeriodTimer.getTotalTimeDifference() - mPeriodStartWallTime );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "cpu-time",
+               util::getProcessCPUTime() - mPeriodStartCPUTime );
+
+    TimerRegistry& timers = TimerRegistry::getInstance();
+    for( size_t i = 0; i < NUM_TIMER_METRICS; ++i ) {
+        if( TIMER_METRICS[ i ].mIsFromPeriodTimer ) {
+            addRecord( aPeriod, aYear, PERIOD_COMPONENT, TIMER_METRICS[ i ].mMetric,
+                       timers.getTimer( TIMER_METRICS[ i ].mTimer ).getTotalTimeDifference() - mPeriodStartTimes[ i ] );
+        }
+    }
+    mPeriodYears.push_back( make_pair( aPeriod, aYear ) );
+
+    // Record each solver component and sum the counts for the period.
+    vector<int> periodEvents( CalcCounter::END, 0 );
+    int periodIterations = 0;
+    const vector<string> methods = aCalcCounter->getMethodNames();
+    for( vector<string>::const_iterator methodIter = methods.begin(); methodIter != methods.end(); ++methodIter ) {
+        // Evaluations made before any solver component started, such as when
+        // the period is initialized, are not attributed to a method.
+        const string& component = methodIter->empty() ? "unattributed" : *methodIter;
+        addRecord( aPeriod, aYear, component, "wall-time", aCalcCounter->getMethodWallTime( *methodIter ) );
+        addRecord( aPeriod, aYear, component, "cpu-time", aCalcCounter->getMethodCPUTime( *methodIter ) );
+        addRecord( aPeriod, aYear, component, "calcs", aCalcCounter->getMethodCount( *methodIter ) );
+        const int iterations = aCalcCounter->getMethodIterations( *methodIter );
+        addRecord( aPeriod, aYear, component, "iterations", iterations );
+        periodIterations += iterations;
+        const int fullEvaluations = aCalcCounter->getMethodEventCount( *methodIter, CalcCounter::FULL_EVALUATION );
+        addRecord( aPeriod, aYear, component, "full-evaluations", fullEvaluations );
+        periodEvents[ CalcCounter::FULL_EVALUATION ] += fullEvaluations;
+        const int partialEvaluations = aCalcCounter->getMethodEventCount( *methodIter, CalcCounter::PARTIAL_EVALUATION );
+        addRecord( aPeriod, aYear, component, "partial-evaluations", partialEvaluations );
+        periodEvents[ CalcCounter::PARTIAL_EVALUATION ] += partialEvaluations;
+        const int jacobians = aCalcCounter->getMethodEventCount( *methodIter, CalcCounter::JACOBIAN );
+        addRecord( aPeriod, aYear, component, "jacobians", jacobians );
+        periodEvents[ CalcCounter::JACOBIAN ] += jacobians;
+        const int lineSearchSteps = aCalcCounter->getMethodEventCount( *methodIter, CalcCounter::LINE_SEARCH_STEP );
+        addRecord( aPeriod, aYear, component, "line-search-steps", lineSearchSteps );
+        periodEvents[ CalcCounter::LINE_SEARCH_STEP ] += lineSearchSteps;
+    }
+
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "calcs", aCalcCounter->getPeriodCount() );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "iterations", periodIterations );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "full-evaluations", periodEvents[ CalcCounter::FULL_EVALUATION ] );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "partial-evaluations", periodEvents[ CalcCounter::PARTIAL_EVALUATION ] );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "jacobians", periodEvents[ CalcCounter::JACOBIAN ] );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "line-search-steps", periodEvents[ CalcCounter::LINE_SEARCH_STEP ] );
+    addRecord( aPeriod, aYear, PERIOD_COMPONENT, "peak-memory-mb", util::getPeakMemoryUsage() );
+}
+
+/*!
+ * \brief Record the climate model time of each period and the totals for the
+ *        whole run.
+ * \details This should be called after the outputs have been written so that
+ *          the output time is complete.
+ * \param aWorld The world which ran the climate model.
+ */
+void PerformanceReport::endRun( const World* aWorld ) {
+    const string PERIOD_COMPONENT = "period";
+    for( vector<pair<int, int> >::const_iterator iter = mPeriodYears.begin(); iter != mPeriodYears.end(); ++iter ) {
+        addRecord( iter->first, iter->second, PERIOD_COMPONENT, "climate-model-time",
+                   aWorld->getClimateModelTime( iter->first ) );
+    }
+
+    const string RUN_COMPONENT = "run";
+    mRunTimer.stop();
+    addRecord( -1, -1, RUN_COMPONENT, "wall-time", mRunTimer.getTotalTimeDifference() );
+    addRecord( -1, -1, RUN_COMPONENT, "cpu-time", util::getProcessCPUTime() - mRunStartCPUTime );
+    TimerRegistry& timers = TimerRegistry::getInstance();
+    for( size_t i = 0; i < NUM_TIMER_METRICS; ++i ) {
+        addRecord( -1, -1, RUN_COMPONENT, TIMER_METRICS[ i ].mMetric,
+                   timers.getTimer( TIMER_METRICS[ i ].mTimer ).getTotalTimeDifference() - mRunStartTimes[ i ] );
+    }
+    addRecord( -1, -1, RUN_COMPONENT, "peak-memory-mb", util::getPeakMemoryUsage() );
+}
+
+/*!
+ * \brief Write all recorded values as CSV.
+ * \param aOut The stream to write to.
+ * \param aScenarioName The scenario name to write on each line.
+ */
+void PerformanceReport::write( ostream& aOut, const string& aScenarioName ) const {
+    aOut << "scenario,period,year,component,metric,value" << endl;
+    for( vector<Record>::const_iterator iter = mRecords.begin(); iter != mRecords.end(); ++iter ) {
+        aOut << aScenarioName << ',';
+        // Run totals leave the period and year empty.
+        if( iter->mPeriod >= 0 ) {
+            aOut << iter->mPeriod << ',' << iter->mYear;
+        }
+        else {
+            aOut << ',';
+        }
+        aOut << ',' << iter->mComponent << ',' << iter->mMetric << ',' << iter->mValue << '\n';
+    }
+    aOut.flush();
+}
+
+/*!
+ * \brief Add a value to the report.
+ * \param aPeriod The model period or -1 for run totals.
+ * \param aYear The model year or -1 for run totals.
+ * \param aComponent The part of the model the value is for.
+ * \param aMetric The name of the value.
+ * \param aValue The value.
+ */
+void PerformanceReport::addRecord( const int aPeriod, const int aYear, const string& aComponent,
+                                   const string& aMetric, const double aValue )
+{
+    Record record;
+    record.mPeriod = aPeriod;
+    record.mYear = aYear;
+    record.mComponent = aComponent;
+    record.mMetric = aMetric;
+    record.mValue = aValue;
+    mRecords.push_back( record );
+}
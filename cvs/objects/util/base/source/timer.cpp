@@ -83,6 +83,18 @@ void Timer::stop(){
     mRunning = std::max( mRunning, 0 );
 }
 
+/*!
+ * \brief Add time which was measured elsewhere, such as on another thread, to
+ *        the total.
+ * \param aTime The time to add in seconds.
+ */
+void Timer::addTime( const double aTime ) {
+#if GCAM_PARALLEL_ENABLED
+    tbb::spin_mutex::scoped_lock lock( mMutex );
+#endif
+    mTotalTime += aTime;
+}
+
 /*!
  * \brief Get the total time measured by this timer between all start and stops.
  * \return The total time in seconds.
@@ -199,6 +211,9 @@ void TimerRegistry::printAllTimers( ostream& aOut ) const {
             case EDFUN_AN_RESET:
                 timerName = "EDFUN affected nodes reset";
                 break;
+            case CLIMATE_MODEL:
+                timerName = "Climate model";
+                break;
                 
             default: timerName = "Predefined timer";
         }
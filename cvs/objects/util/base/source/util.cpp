@@ -48,6 +48,19 @@
 #include <string>
 #include <ctime>
 
+#if defined(_MSC_VER)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fstream>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+#endif
+
 using namespace std;
 
 extern Scenario* scenario;
@@ -342,6 +355,90 @@ int getConfigRunPeriod( const string aKey ) {
     return newPeriod;
 }
 
+/*!
+ * \brief Get the CPU time used so far by this process.
+ * \details The user and system time of all threads are included so in a
+ *          parallel run this will generally exceed the wall clock time.
+ * \return The CPU time in seconds.
+ */
+double getProcessCPUTime() {
+#if defined(_MSC_VER)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if( !GetProcessTimes( GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime ) ) {
+        return 0.0;
+    }
+    // FILETIMEs are in units of 100 nanoseconds.
+    const double kernel = static_cast<double>( ( static_cast<unsigned long long>( kernelTime.dwHighDateTime ) << 32 ) | kernelTime.dwLowDateTime );
+    const double user = static_cast<double>( ( static_cast<unsigned long long>( userTime.dwHighDateTime ) << 32 ) | userTime.dwLowDateTime );
+    return ( kernel + user ) * 1.0e-7;
+#else
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+        return 0.0;
+    }
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+        ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) * 1.0e-6;
+#endif
+}
+
+/*!
+ * \brief Get the largest amount of physical memory this process has used so far.
+ * \return The peak resident set size in megabytes, or zero if it is not
+ *         available on this platform.
+ */
+double getPeakMemoryUsage() {
+#if defined(_MSC_VER)
+    PROCESS_MEMORY_COUNTERS counters;
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ) {
+        return 0.0;
+    }
+    return counters.PeakWorkingSetSize / ( 1024.0 * 1024.0 );
+#else
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+        return 0.0;
+    }
+#if defined(__APPLE__)
+    // Reported in bytes on macOS.
+    return usage.ru_maxrss / ( 1024.0 * 1024.0 );
+#else
+    // Reported in kilobytes on Linux.
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+
+/*!
+ * \brief Get the amount of physical memory this process is currently using.
+ * \return The resident set size in megabytes, or zero if it is not available
+ *         on this platform.
+ */
+double getCurrentMemoryUsage() {
+#if defined(_MSC_VER)
+    PROCESS_MEMORY_COUNTERS counters;
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) ) {
+        return 0.0;
+    }
+    return counters.WorkingSetSize / ( 1024.0 * 1024.0 );
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>( &info ), &count ) != KERN_SUCCESS ) {
+        return 0.0;
+    }
+    return info.resident_size / ( 1024.0 * 1024.0 );
+#else
+    // The second field of statm is the resident set size in pages.
+    std::ifstream statm( "/proc/self/statm" );
+    long totalPages = 0;
+    long residentPages = 0;
+    if( !( statm >> totalPages >> residentPages ) ) {
+        return 0.0;
+    }
+    return residentPages * static_cast<double>( sysconf( _SC_PAGESIZE ) ) / ( 1024.0 * 1024.0 );
+#endif
+}
 
 }
 
@@ -93,6 +93,7 @@ public:
 
     void invertAxises();
     PointSet* getPointSet();
+    void compile( const bool aBuildUniformGrid = false );
 protected:
     
     // Define data such that introspection utilities can process the data from this
@@ -110,5 +111,23 @@ protected:
     static double getXIntercept( const double slope, const double x1, const double y1 );
     void print( std::ostream& out, const double lowDomain = -DBL_MAX, const double highDomain = DBL_MAX,
         const double lowRange = -DBL_MAX, const double highRange = DBL_MAX, const int minPoints = 0 ) const;
+
+    //! Flag indicating the compiled lookup table below is current with the point set.
+    bool mIsCompiled;
+
+    //! Distinct X values of the point set sorted in increasing order, built by compile.
+    std::vector<double> mCompiledX;
+
+    //! Y values corresponding to mCompiledX.
+    std::vector<double> mCompiledY;
+
+    //! Optional uniform grid over [min X, max X] giving for each cell the index of the
+    //! last compiled point at or below the cell's lower edge.  Empty if not built.
+    std::vector<unsigned int> mGridStart;
+
+    //! The inverse of the width of a uniform grid cell.
+    double mGridInvWidth;
+
+    unsigned int findSegment( const double aXValue ) const;
 };
 #endif // _POINT_SET_CURVE_H_
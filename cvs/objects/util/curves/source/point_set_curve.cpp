@@ -48,6 +48,7 @@
 #include <xercesc/dom/DOMNodeList.hpp>
 #include <vector>
 #include <cassert>
+#include <algorithm>
 #include <cfloat>
 
 using namespace std;
@@ -56,7 +57,10 @@ using namespace std;
 * \warning This curve is takes responsibility for this PointSet one it is constructed. 
 * \param pointSetIn The PointSet which defines this curve's data.
 */
-PointSetCurve::PointSetCurve( PointSet* pointSetIn ) {
+PointSetCurve::PointSetCurve( PointSet* pointSetIn ):
+mIsCompiled( false ),
+mGridInvWidth( 0 )
+{
     pointSet = pointSetIn;
 }
 
@@ -71,7 +75,10 @@ PointSetCurve::PointSetCurve( PointSet* pointSetIn ) {
 * \param xInterval The amount to increment each X value by. 
 * \todo This currently is forced to use a ExplicitPointSet.
 */
-PointSetCurve::PointSetCurve( const string pointSetType, const string dataPointType, const vector<double> yValues, const double xStart, const double xInterval ) {
+PointSetCurve::PointSetCurve( const string pointSetType, const string dataPointType, const vector<double> yValues, const double xStart, const double xInterval ):
+mIsCompiled( false ),
+mGridInvWidth( 0 )
+{
     
     // Create the PointSet
     ExplicitPointSet* exPointSet = new ExplicitPointSet();
@@ -108,6 +115,11 @@ PointSetCurve* PointSetCurve::clone() const {
     PointSetCurve* clone = new PointSetCurve();
     clone->copy( *this );
     clone->pointSet = pointSet ? pointSet->clone() : 0;
+    clone->mIsCompiled = mIsCompiled;
+    clone->mCompiledX = mCompiledX;
+    clone->mCompiledY = mCompiledY;
+    clone->mGridStart = mGridStart;
+    clone->mGridInvWidth = mGridInvWidth;
     return clone;
 }
 
@@ -122,16 +134,116 @@ const string& PointSetCurve::getXMLName() const {
     return getXMLNameStatic();
 }
 
-//! Get the underlying PointSet
+/*! \brief Get the underlying PointSet
+* \details Since the caller may modify the points through the returned pointer
+*          any compiled lookup table is discarded.
+*/
 PointSet* PointSetCurve::getPointSet() {
+    mIsCompiled = false;
     return pointSet;
 }
 
+/*! \brief Compile the point set into a flat lookup table for fast evaluation.
+* \details Copies the distinct points, sorted by X, into contiguous arrays which
+*          getY, getMinX, and getMaxX will use instead of searching the PointSet.
+*          The results are the same as the uncompiled path: points are returned
+*          exactly and values outside of the domain are extrapolated along the end
+*          segments.  The table is discarded by any change made through this curve
+*          so this should be called once the curve is fully read in, such as in
+*          completeInit, and never during the (possibly parallel) calculations.
+* \param aBuildUniformGrid Whether to also build a uniform grid over the domain
+*        so that the bracketing segment can be found in constant time.  This is
+*        only worthwhile when the X values are fairly evenly spaced.
+*/
+void PointSetCurve::compile( const bool aBuildUniformGrid ) {
+    mCompiledX.clear();
+    mCompiledY.clear();
+    mGridStart.clear();
+    mGridInvWidth = 0;
+
+    const PointSet::SortedPairVector sortedPoints = pointSet ? pointSet->getSortedPairs() : PointSet::SortedPairVector();
+    mCompiledX.reserve( sortedPoints.size() );
+    mCompiledY.reserve( sortedPoints.size() );
+    for( PointSet::SortedPairVector::const_iterator pointIter = sortedPoints.begin(); pointIter != sortedPoints.end(); ++pointIter ){
+        // The point set treats X values within tolerance as the same point.
+        if( mCompiledX.empty() || !util::isEqual( pointIter->first, mCompiledX.back() ) ){
+            mCompiledX.push_back( pointIter->first );
+            mCompiledY.push_back( pointIter->second );
+        }
+    }
+
+    const unsigned int numPoints = mCompiledX.size();
+    if( aBuildUniformGrid && numPoints > 2 ){
+        // Use two cells per segment so that the typical lookup lands on the
+        // correct segment directly.
+        const unsigned int numCells = 2 * ( numPoints - 1 );
+        const double cellWidth = ( mCompiledX.back() - mCompiledX.front() ) / numCells;
+        mGridInvWidth = 1.0 / cellWidth;
+        mGridStart.resize( numCells + 1 );
+        unsigned int pointIndex = 0;
+        for( unsigned int cell = 0; cell <= numCells; ++cell ){
+            const double cellEdge = mCompiledX.front() + cell * cellWidth;
+            while( pointIndex + 1 < numPoints && mCompiledX[ pointIndex + 1 ] <= cellEdge ){
+                ++pointIndex;
+            }
+            mGridStart[ cell ] = pointIndex;
+        }
+    }
+    mIsCompiled = true;
+}
+
+/*! \brief Find the index of the compiled point which starts the segment to use for aXValue.
+* \details Returns the last point at or below aXValue, or the first point if
+*          aXValue is below the domain.  Requires at least one compiled point.
+*/
+unsigned int PointSetCurve::findSegment( const double aXValue ) const {
+    if( !mGridStart.empty() ){
+        const double cellPosition = ( aXValue - mCompiledX.front() ) * mGridInvWidth;
+        const double lastCell = mGridStart.size() - 1;
+        unsigned int index = mGridStart[ static_cast<unsigned int>( max( 0.0, min( cellPosition, lastCell ) ) ) ];
+        // Correct for any rounding at the cell edges.
+        while( index + 1 < mCompiledX.size() && mCompiledX[ index + 1 ] <= aXValue ){
+            ++index;
+        }
+        while( index > 0 && mCompiledX[ index ] > aXValue ){
+            --index;
+        }
+        return index;
+    }
+
+    // Binary search without an early exit so that the comparison compiles to a
+    // conditional move rather than a hard to predict branch.
+    const double* base = &mCompiledX[ 0 ];
+    size_t length = mCompiledX.size();
+    while( length > 1 ){
+        const size_t half = length / 2;
+        base = base[ half ] <= aXValue ? base + half : base;
+        length -= half;
+    }
+    return static_cast<unsigned int>( base - &mCompiledX[ 0 ] );
+}
+
 //! Get the Y value corresponding to a given X value.
 //
 // \todo This is a terrible way to do interpolation.  We should
 //         replace this with something more orthodox.
 double PointSetCurve::getY( const double xValue ) const {
+    if( mIsCompiled ){
+        const unsigned int numPoints = mCompiledX.size();
+        if( numPoints == 0 ){
+            return -DBL_MAX;
+        }
+        if( numPoints == 1 ){
+            return mCompiledY[ 0 ];
+        }
+        // Interpolate on the segment starting at the bracketing point, or past the
+        // last point extrapolate along the final segment as below.
+        const unsigned int lower = findSegment( xValue );
+        const unsigned int other = lower + 1 < numPoints ? lower + 1 : lower - 1;
+        return linearInterpolateY( xValue, mCompiledX[ lower ], mCompiledY[ lower ],
+                                   mCompiledX[ other ], mCompiledY[ other ] );
+    }
+
     double retValue;
 
     // First check if the point exists.
@@ -161,7 +273,7 @@ double PointSetCurve::getY( const double xValue ) const {
                 x1 = pointSet->getNearestXAbove( x2 );
 
                 // Check if that is valid
-                if( x1 == -DBL_MAX ){
+                if( x1 == DBL_MAX ){
                     // There is only one valid point.  Since we can't
                     // compute a slope, just return the one value we
                     // have.
@@ -236,12 +348,14 @@ double PointSetCurve::getX( const double yValue ) const {
 //! Set the Y value for a point associated with an X value.
 bool PointSetCurve::setY( const double xValue, const double yValue ){
     // Need to do more here I think. Add point?
+    mIsCompiled = false;
     return pointSet->setY( xValue, yValue );
 }
 
 //! Set an X value for a point associated with a Y value.
 bool PointSetCurve::setX( const double yValue, const double xValue ){
     // Need to do more here I think. Add point?
+    mIsCompiled = false;
     return pointSet->setX( yValue, xValue );
 }
 
@@ -253,6 +367,9 @@ double PointSetCurve::getSlope( const double x1, const double x2 ) const {
 
 //! Return the maximum X value contained in the underlying PointSet
 double PointSetCurve::getMaxX() const {
+    if( mIsCompiled && !mCompiledX.empty() ){
+        return mCompiledX.back();
+    }
     return pointSet->getMaxX();
 }
 
@@ -263,6 +380,9 @@ double PointSetCurve::getMaxY() const {
 
 //! Return the minimum X value contained in the underlying PointSet
 double PointSetCurve::getMinX() const {
+    if( mIsCompiled && !mCompiledX.empty() ){
+        return mCompiledX.front();
+    }
     return pointSet->getMinX();
 }
 
@@ -356,6 +476,7 @@ bool PointSetCurve::XMLParseDerived( const xercesc::DOMNode* node ) {
         nodeParsed = true;
         // First clear the existing pointset to prevent a memory leak.
         delete pointSet;
+        mIsCompiled = false;
         pointSet = PointSet::getPointSet( XMLHelper<string>::getAttr( node, "type" ) );
         pointSet->XMLParse( node );
     }
@@ -367,6 +488,7 @@ void PointSetCurve::invertAxises() {
     swap( xAxisLabel, yAxisLabel );
     swap( xAxisUnits, yAxisUnits );
     pointSet->invertAxises();
+    mIsCompiled = false;
 }
 
 //! Perform a linear interpolation determining a y value.
@@ -145,6 +145,9 @@ protected:
     
 	//! Log a message with the given warning level.
     virtual void logCompleteMessage( const std::string& aMessage ) = 0;
+
+	//! Append the contents of a log written by another process.
+    virtual void appendLog( std::istream& aLog ) = 0;
     void printToScreenIfConfigured( const std::string& aMessage );
     static void parseHeader( std::string& aHeader );
     static const std::string& convertLevelToString( ILogger::WarningLevel aLevel );
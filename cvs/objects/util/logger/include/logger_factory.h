@@ -69,8 +69,13 @@ public:
     static Logger& getLogger( const std::string& aLogName );
     static void toDebugXML( std::ostream& aOut, Tabs* aTabs );
     static void logNewScenarioStarting( const std::string& aScenarioName );
+    static void redirectToFiles( const std::string& aFileSuffix );
+    static void appendRedirectedFiles( const std::string& aFileSuffix );
+    static void closeAll();
+    static void setFileSuffix( const std::string& aFileSuffix );
 private:
     static std::map<std::string,Logger*> mLoggers; //!< Map of logger names to loggers.
+    static std::string mFileSuffix; //!< Suffix appended to configured log file names.
     static void XMLParse( const xercesc::DOMNode* aRoot );
     static void cleanUp();
     //! Private undefined constructor to prevent creating a LoggerFactory.
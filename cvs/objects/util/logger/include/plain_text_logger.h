@@ -67,6 +67,7 @@ class PlainTextLogger: public Logger {
     void open( const char[] = 0 );
     void close();
     void logCompleteMessage( const std::string& aMessage );
+    void appendLog( std::istream& aLog );
 private:
     std::ofstream mLogFile; //!< The filestream to which data is written.
     PlainTextLogger( const std::string& aLoggerName ="" );
@@ -68,6 +68,7 @@ public:
     void close();
     void logCompleteMessage( const std::string& aMessage );	
 
+    void appendLog( std::istream& aLog );
 private:
     std::ofstream mLogFile; //!< The filestream to which data is written.
     XMLLogger( const std::string& loggerName ="" );
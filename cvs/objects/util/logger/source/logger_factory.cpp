@@ -44,6 +44,8 @@
 #include <string>
 #include <map>
 #include <cassert>
+#include <fstream>
+#include <cstdio>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "util/base/include/xml_helper.h"
@@ -58,6 +60,7 @@ using namespace std;
 using namespace xercesc;
 
 map<string,Logger*> LoggerFactory::mLoggers;
+string LoggerFactory::mFileSuffix;
 
 //! Parse the XML data.
 void LoggerFactory::XMLParse( const DOMNode* aRoot ){
@@ -90,6 +93,7 @@ void LoggerFactory::XMLParse( const DOMNode* aRoot ){
 			}
 			
 			newLogger->XMLParse( curr );
+			newLogger->mFileName += mFileSuffix;
 			newLogger->open();
 			mLoggers[ newLogger->mName ] = newLogger;
 		}
@@ -110,13 +114,71 @@ Logger& LoggerFactory::getLogger( const string& aLoggerName ) {
 	}
 	else {
 		cout << "Creating an uninitialized logger " << aLoggerName << endl;
-		Logger* newLogger = new PlainTextLogger( aLoggerName );
+		Logger* newLogger = new PlainTextLogger( aLoggerName + mFileSuffix );
 		newLogger->open();
         mLoggers[ aLoggerName ] = newLogger;
 		return *mLoggers[ aLoggerName ];
 	}
 }
 
+/*!
+ * \brief Close all loggers and reopen them writing to their configured file
+ *        name with the given suffix appended.
+ * \details This is used by processes forked to run part of a batch so that
+ *          they do not interleave messages with each other in the shared log
+ *          files. The parent process later collects the redirected files with
+ *          appendRedirectedFiles.
+ * \param aFileSuffix Suffix to append to each log file name.
+ */
+void LoggerFactory::redirectToFiles( const string& aFileSuffix ) {
+	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); ++logIter ){
+		logIter->second->close();
+		logIter->second->mFileName += aFileSuffix;
+		logIter->second->open();
+	}
+}
+
+/*!
+ * \brief Append the contents of log files written by redirectToFiles with the
+ *        given suffix to the corresponding loggers and remove those files.
+ * \param aFileSuffix The suffix which was passed to redirectToFiles.
+ */
+void LoggerFactory::appendRedirectedFiles( const string& aFileSuffix ) {
+	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); ++logIter ){
+		const string redirectedName = logIter->second->mFileName + aFileSuffix;
+		ifstream redirectedLog( redirectedName.c_str() );
+		if( redirectedLog.is_open() ){
+			logIter->second->appendLog( redirectedLog );
+			redirectedLog.close();
+			remove( redirectedName.c_str() );
+		}
+	}
+}
+
+/*!
+ * \brief Set a suffix to append to the file name of each logger opened after
+ *        this call.
+ * \details This is used by worker processes started to run part of a model
+ *          run so that they write to their own log files from the start. The
+ *          parent process later collects them with appendRedirectedFiles.
+ * \param aFileSuffix Suffix to append to each log file name.
+ */
+void LoggerFactory::setFileSuffix( const string& aFileSuffix ) {
+	mFileSuffix = aFileSuffix;
+}
+
+/*!
+ * \brief Close all loggers so that their contents are written out.
+ * \details This must be called before a process exits without unwinding, such
+ *          as a forked process calling _exit, since the LoggerFactoryWrapper will
+ *          not get a chance to clean up.
+ */
+void LoggerFactory::closeAll() {
+	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); ++logIter ){
+		logIter->second->close();
+	}
+}
+
 //! Cleans up the logger.
 void LoggerFactory::cleanUp() {
 	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); logIter++ ){
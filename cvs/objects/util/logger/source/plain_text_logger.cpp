@@ -73,6 +73,12 @@ void PlainTextLogger::close(){
     mLogFile.close();
 }
 
+//! Appends the contents of another log file without any formatting.
+void PlainTextLogger::appendLog( istream& aLog ){
+    mLogFile << aLog.rdbuf();
+    mLogFile.flush();
+}
+
 //! Logs a single message.
 void PlainTextLogger::logCompleteMessage( const string& aMessage ){
     // Decide whether to print the message
@@ -78,6 +78,16 @@ void XMLLogger::close(){
 	mLogFile.close();
 }
 
+//! Appends the log entries from another XML log file, skipping its root tags.
+void XMLLogger::appendLog( istream& aLog ){
+    string line;
+    while( getline( aLog, line ) ){
+        if( line.compare( 0, 10, "<XMLLogger" ) != 0 && line != "</XMLLogger>" ){
+            mLogFile << line << endl;
+        }
+    }
+}
+
 //! Logs a single message.
 void XMLLogger::logCompleteMessage( const string& aMessage ){
 	// Decide whether to print the message